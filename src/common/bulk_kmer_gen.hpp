@@ -0,0 +1,345 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    bulk_kmer_gen.hpp
+ * @ingroup common
+ * @author  tpan
+ * @brief   bulk kmer generation from a contiguous ascii character span.
+ * @details the iterator stack used by KmerParser (filter_iterator for EOL -> transform_iterator for ASCII2 -> KmerGenerationIterator)
+ *          touches each character through 3 levels of iterator indirection.  for contiguous input, this file provides
+ *          a block oriented alternative:
+ *          1. translate_strip_eol:  removes '\n' and '\r', and converts ascii to alphabet values, into a byte buffer.
+ *             for alphabets whose FROM_ASCII table is case symmetric (DNA, DNA5, DNA16), bytes in [0x40, 0x80) are
+ *             converted 16 (SSSE3) or 32 (AVX2) at a time with 2 pshufb lookups.  blocks containing EOL are compacted
+ *             after the lookup, and blocks with other characters (digits, '-', '.', etc) fall back to the scalar table lookup.
+ *          2. generate_kmers:  translates the span in cache-sized chunks, then rolls the kmer over the translated values
+ *             with nextFromChar, writing every kmer to the output iterator.
+ *          3. generate_canonical_kmers:  as 2, but also rolls the reverse complement, and writes the smaller of the 2.
+ *
+ *          output is identical to that of the iterator stack.
+ */
+#ifndef SRC_COMMON_BULK_KMER_GEN_HPP_
+#define SRC_COMMON_BULK_KMER_GEN_HPP_
+
+#include <cstdint>       // uint8_t
+#include <cstddef>       // size_t
+#include <iterator>      // iterator_traits
+#include <type_traits>
+#include <algorithm>   // min
+#include <vector>
+#include <string>
+
+#include "bliss-config.hpp"
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <x86intrin.h>   // all intrinsics.  will be enabled based on compiler flag such as __SSSE3__ internally.
+#endif
+
+#if defined __GNUC__ && __GNUC__>=6
+// disable __m128i and __m256i ignored attribute warning in gcc
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+
+namespace bliss {
+
+  namespace common {
+
+    /**
+     * @brief  trait to identify iterators over contiguous char storage, for which bulk kmer generation can be used.
+     * @details c++11 has no contiguous iterator concept, so recognize pointers and vector/string iterators.
+     */
+    template <typename Iter>
+    struct is_contiguous_char_iterator {
+      protected:
+        using V = typename ::std::remove_cv<typename ::std::iterator_traits<Iter>::value_type>::type;
+      public:
+        static constexpr bool value = (sizeof(V) == 1) && ::std::is_integral<V>::value &&
+            (::std::is_pointer<Iter>::value ||
+             ::std::is_same<Iter, typename ::std::vector<V>::iterator>::value ||
+             ::std::is_same<Iter, typename ::std::vector<V>::const_iterator>::value ||
+             ::std::is_same<Iter, typename ::std::basic_string<V>::iterator>::value ||
+             ::std::is_same<Iter, typename ::std::basic_string<V>::const_iterator>::value);
+    };
+
+
+    /**
+     * @brief  converts ascii to alphabet values and removes EOL characters, for a contiguous span.
+     * @details  the simd path needs FROM_ASCII to be case symmetric in [0x40, 0x80), which is checked once per alphabet.
+     *           the output buffer needs to be at least as large as the input, since writes are speculative.
+     * @tparam Alphabet   alphabet with a FROM_ASCII table.
+     */
+    template <typename Alphabet>
+    class ASCII2AlphabetBulk {
+      protected:
+
+        /// check that FROM_ASCII[0x40 + i] == FROM_ASCII[0x60 + i], i.e. lower and upper case map the same.
+        static bool check_symmetric() {
+          for (size_t i = 0; i < 32; ++i) {
+            if (Alphabet::FROM_ASCII[0x40 + i] != Alphabet::FROM_ASCII[0x60 + i]) return false;
+          }
+          return true;
+        }
+
+      public:
+        /// whether the simd lookup is valid for this alphabet.
+        static bool simd_enabled() {
+          static const bool symmetric = check_symmetric();
+          return symmetric;
+        }
+
+        /// scalar version.  branchless:  always write, advance output only for non-EOL chars.
+        static size_t translate_seq(uint8_t const * in, size_t n, uint8_t * out) {
+          size_t j = 0;
+          uint8_t c;
+          for (size_t i = 0; i < n; ++i) {
+            c = in[i];
+            out[j] = Alphabet::FROM_ASCII[c];
+            j += ((c != '\n') && (c != '\r')) ? 1 : 0;
+          }
+          return j;
+        }
+
+      protected:
+        /// compact translated block:  keep only bytes whose bit is set in keep.  in place since j <= k.
+        static size_t compact(uint8_t * out, size_t len, uint32_t keep) {
+          size_t j = 0;
+          for (size_t k = 0; k < len; ++k) {
+            out[j] = out[k];
+            j += (keep >> k) & 0x1;
+          }
+          return j;
+        }
+
+      public:
+
+#if defined(__SSSE3__)
+        /// SSSE3 version.  16 chars per iteration.
+        static size_t translate_ssse3(uint8_t const * in, size_t n, uint8_t * out) {
+          if (!simd_enabled()) return translate_seq(in, n, out);
+
+          __m128i lut_lo = _mm_loadu_si128(reinterpret_cast<__m128i const *>(Alphabet::FROM_ASCII.data() + 0x40));
+          __m128i lut_hi = _mm_loadu_si128(reinterpret_cast<__m128i const *>(Alphabet::FROM_ASCII.data() + 0x50));
+          __m128i mask_c0 = _mm_set1_epi8(static_cast<char>(0xC0));
+          __m128i val_40 = _mm_set1_epi8(0x40);
+          __m128i mask_10 = _mm_set1_epi8(0x10);
+          __m128i nl = _mm_set1_epi8('\n');
+          __m128i cr = _mm_set1_epi8('\r');
+
+          __m128i v, lo, hi, sel, letters, eol;
+          uint32_t lmask, emask;
+          size_t i = 0, j = 0;
+          for (; (i + 16) <= n; i += 16) {
+            v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in + i));
+
+            // bytes in [0x40, 0x80).  pshufb uses the low 4 bits.  bit 0x10 selects between the 2 tables.
+            letters = _mm_cmpeq_epi8(_mm_and_si128(v, mask_c0), val_40);
+            lmask = static_cast<uint32_t>(_mm_movemask_epi8(letters));
+            eol = _mm_or_si128(_mm_cmpeq_epi8(v, nl), _mm_cmpeq_epi8(v, cr));
+            emask = static_cast<uint32_t>(_mm_movemask_epi8(eol));
+
+            if ((lmask | emask) != 0xFFFF) {
+              // other characters present.  use table.
+              j += translate_seq(in + i, 16, out + j);
+              continue;
+            }
+
+            lo = _mm_shuffle_epi8(lut_lo, v);
+            hi = _mm_shuffle_epi8(lut_hi, v);
+            sel = _mm_cmpeq_epi8(_mm_and_si128(v, mask_10), mask_10);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + j), _mm_or_si128(_mm_and_si128(sel, hi), _mm_andnot_si128(sel, lo)));
+
+            j += (emask == 0) ? 16 : compact(out + j, 16, lmask);
+          }
+          // remainder
+          return j + translate_seq(in + i, n - i, out + j);
+        }
+#endif
+
+#if defined(__AVX2__)
+        /// AVX2 version.  32 chars per iteration.  pshufb operates per 128 bit lane, so the tables are broadcast.
+        static size_t translate_avx2(uint8_t const * in, size_t n, uint8_t * out) {
+          if (!simd_enabled()) return translate_seq(in, n, out);
+
+          __m256i lut_lo = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<__m128i const *>(Alphabet::FROM_ASCII.data() + 0x40)));
+          __m256i lut_hi = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<__m128i const *>(Alphabet::FROM_ASCII.data() + 0x50)));
+          __m256i mask_c0 = _mm256_set1_epi8(static_cast<char>(0xC0));
+          __m256i val_40 = _mm256_set1_epi8(0x40);
+          __m256i mask_10 = _mm256_set1_epi8(0x10);
+          __m256i nl = _mm256_set1_epi8('\n');
+          __m256i cr = _mm256_set1_epi8('\r');
+
+          __m256i v, lo, hi, sel, letters, eol;
+          uint32_t lmask, emask;
+          size_t i = 0, j = 0;
+          for (; (i + 32) <= n; i += 32) {
+            v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(in + i));
+
+            letters = _mm256_cmpeq_epi8(_mm256_and_si256(v, mask_c0), val_40);
+            lmask = static_cast<uint32_t>(_mm256_movemask_epi8(letters));
+            eol = _mm256_or_si256(_mm256_cmpeq_epi8(v, nl), _mm256_cmpeq_epi8(v, cr));
+            emask = static_cast<uint32_t>(_mm256_movemask_epi8(eol));
+
+            if ((lmask | emask) != 0xFFFFFFFFU) {
+              j += translate_seq(in + i, 32, out + j);
+              continue;
+            }
+
+            lo = _mm256_shuffle_epi8(lut_lo, v);
+            hi = _mm256_shuffle_epi8(lut_hi, v);
+            sel = _mm256_cmpeq_epi8(_mm256_and_si256(v, mask_10), mask_10);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + j), _mm256_blendv_epi8(lo, hi, sel));
+
+            j += (emask == 0) ? 32 : compact(out + j, 32, lmask);
+          }
+          return j + translate_seq(in + i, n - i, out + j);
+        }
+#endif
+
+        /// dispatch to the widest version enabled at compile time.
+        static size_t translate(uint8_t const * in, size_t n, uint8_t * out) {
+#if defined(__AVX2__)
+          return translate_avx2(in, n, out);
+#elif defined(__SSSE3__)
+          return translate_ssse3(in, n, out);
+#else
+          return translate_seq(in, n, out);
+#endif
+        }
+    };
+
+
+    /**
+     * @brief  translate ascii to alphabet values, removing EOL.  output buffer should have at least n bytes.
+     * @return number of values written.
+     */
+    template <typename Alphabet>
+    inline size_t translate_strip_eol(uint8_t const * in, size_t n, uint8_t * out) {
+      return ASCII2AlphabetBulk<Alphabet>::translate(in, n, out);
+    }
+
+
+    /**
+     * @brief  rolls a kmer over alphabet values, emitting each complete kmer.  state persists across calls so input can be chunked.
+     * @tparam KmerType    type of kmer to generate
+     */
+    template <typename KmerType>
+    struct KmerRoller {
+        using kmer_type = KmerType;
+
+        KmerType km;   // cleared
+        size_t filled = 0;   // number of chars in km, up to k.
+
+        template <typename CharIter, typename OutputIt>
+        OutputIt operator()(CharIter it, CharIter end, OutputIt out) {
+          // fill the first kmer.
+          for (; (filled < KmerType::size) && (it != end); ++it) {
+            km.nextFromChar(*it);
+            if (++filled == KmerType::size) {
+              *out = km;
+              ++out;
+            }
+          }
+          // then roll.
+          for (; it != end; ++it) {
+            km.nextFromChar(*it);
+            *out = km;
+            ++out;
+          }
+          return out;
+        }
+    };
+
+    /**
+     * @brief  rolls the forward kmer and its reverse complement together, emitting the lexicographically smaller of the 2.
+     * @details  the reverse complement is updated with nextReverseFromChar on the complemented character, so there is
+     *           no per-kmer reverse_complement() call.  output is identical to lex_less applied to each forward kmer.
+     * @tparam KmerType    type of kmer to generate
+     */
+    template <typename KmerType>
+    struct CanonicalKmerRoller {
+        using kmer_type = KmerType;
+        using Alphabet = typename KmerType::KmerAlphabet;
+
+        KmerType km;   // cleared
+        KmerType rc;   // cleared
+        size_t filled = 0;   // number of chars in km, up to k.
+
+        template <typename CharIter, typename OutputIt>
+        OutputIt operator()(CharIter it, CharIter end, OutputIt out) {
+          uint8_t c;
+          for (; (filled < KmerType::size) && (it != end); ++it) {
+            c = *it;
+            km.nextFromChar(c);
+            rc.nextReverseFromChar(Alphabet::TO_COMPLEMENT[c]);
+            if (++filled == KmerType::size) {
+              *out = (km < rc) ? km : rc;
+              ++out;
+            }
+          }
+          for (; it != end; ++it) {
+            c = *it;
+            km.nextFromChar(c);
+            rc.nextReverseFromChar(Alphabet::TO_COMPLEMENT[c]);
+            *out = (km < rc) ? km : rc;
+            ++out;
+          }
+          return out;
+        }
+    };
+
+
+    /**
+     * @brief  generate all kmers from a contiguous ascii span, skipping EOL characters.
+     * @details  equivalent to copying from KmerGenerationIterator over transform_iterator<filter_iterator<NotEOL>, ASCII2>.
+     *           input is translated in chunks into a stack buffer, so memory use is constant.
+     * @tparam KmerType    type of kmer to generate
+     * @tparam OutputIt    output iterator with KmerType as value type.
+     * @tparam Roller      KmerRoller or CanonicalKmerRoller.
+     * @return  output iterator after the last inserted kmer.
+     */
+    template <typename KmerType, typename OutputIt, typename Roller = KmerRoller<KmerType> >
+    OutputIt generate_kmers(uint8_t const * in, size_t n, OutputIt out, Roller && roller = Roller()) {
+      using Alphabet = typename KmerType::KmerAlphabet;
+      constexpr size_t chunk = 4096;
+
+      uint8_t buf[chunk];
+      size_t len;
+
+      for (size_t i = 0; i < n; i += chunk) {
+        len = ASCII2AlphabetBulk<Alphabet>::translate(in + i, ::std::min(chunk, n - i), buf);
+        out = roller(buf, buf + len, out);
+      }
+      return out;
+    }
+
+    /**
+     * @brief  generate canonical (lex_less) kmers from a contiguous ascii span, skipping EOL characters.
+     * @return  output iterator after the last inserted kmer.
+     */
+    template <typename KmerType, typename OutputIt>
+    OutputIt generate_canonical_kmers(uint8_t const * in, size_t n, OutputIt out) {
+      return generate_kmers<KmerType>(in, n, out, CanonicalKmerRoller<KmerType>());
+    }
+
+  } // namespace common
+} // namespace bliss
+
+#if defined __GNUC__ && __GNUC__>=6
+  #pragma GCC diagnostic pop
+#endif
+
+#endif /* SRC_COMMON_BULK_KMER_GEN_HPP_ */
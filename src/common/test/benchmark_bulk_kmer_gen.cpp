@@ -0,0 +1,171 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    benchmark_bulk_kmer_gen.cpp
+ * @ingroup
+ * @author  tpan
+ * @brief   compare bulk (simd translate + roll) kmer generation to the iterator stack used by KmerParser.
+ * @details input is fasta-like:  80 chars per line.
+ */
+
+#include "utils/logging.h"
+
+// include google test
+#include <gtest/gtest.h>
+
+#include <random>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/kmer.hpp"
+#include "common/alphabets.hpp"
+#include "common/alphabet_traits.hpp"
+#include "common/bulk_kmer_gen.hpp"
+#include "common/kmer_iterators.hpp"
+#include "iterators/transform_iterator.hpp"
+#include "iterators/filter_iterator.hpp"
+#include "utils/file_utils.hpp"
+#include "utils/benchmark_utils.hpp"
+
+
+template <typename T>
+class BulkKmerGenBenchmark : public ::testing::Test {
+  protected:
+
+    static constexpr size_t iterations = 10000000;
+
+    static std::string input;
+    std::vector<T> outputs;
+
+  public:
+    static void SetUpTestCase()
+    {
+      std::string chars("ACGTacgt");
+      std::default_random_engine generator(23);
+      std::uniform_int_distribution<size_t> distribution(0, chars.size() - 1);
+
+      input.clear();
+      input.reserve(iterations + iterations / 80 + 1);
+      for (size_t i = 0; i < iterations; ++i) {
+        // mostly ACGT, with occasional N.
+        input.push_back(((i % 97) == 0) ? 'N' : chars[distribution(generator)]);
+        if ((i % 80) == 79) input.push_back('\n');
+      }
+    }
+
+    static void TearDownTestCase() {
+      std::string().swap(input);
+    }
+
+    virtual void SetUp() {
+      outputs.resize(iterations);
+    }
+
+    virtual void TearDown() {
+      std::vector<T>().swap(outputs);
+    }
+};
+
+template <typename T>
+constexpr size_t BulkKmerGenBenchmark<T>::iterations;
+template <typename T>
+std::string BulkKmerGenBenchmark<T>::input;
+
+
+// indicate this is a typed test
+TYPED_TEST_CASE_P(BulkKmerGenBenchmark);
+
+TYPED_TEST_P(BulkKmerGenBenchmark, translate)
+{
+  using Alphabet = typename TypeParam::KmerAlphabet;
+  std::string const & input = BulkKmerGenBenchmark<TypeParam>::input;
+  uint8_t const * in = reinterpret_cast<uint8_t const *>(input.data());
+  std::vector<uint8_t> out(input.size());
+  size_t len = 0, len2 = 0;
+
+  BL_TIMER_INIT(km);
+
+  BL_TIMER_START(km);
+  len = ::bliss::common::ASCII2AlphabetBulk<Alphabet>::translate_seq(in, input.size(), out.data());
+  BL_TIMER_END(km, "scalar", len);
+
+#if defined(__SSSE3__)
+  BL_TIMER_START(km);
+  len2 = ::bliss::common::ASCII2AlphabetBulk<Alphabet>::translate_ssse3(in, input.size(), out.data());
+  BL_TIMER_END(km, "ssse3", len2);
+  EXPECT_EQ(len, len2);
+#endif
+
+#if defined(__AVX2__)
+  BL_TIMER_START(km);
+  len2 = ::bliss::common::ASCII2AlphabetBulk<Alphabet>::translate_avx2(in, input.size(), out.data());
+  BL_TIMER_END(km, "avx2", len2);
+  EXPECT_EQ(len, len2);
+#endif
+
+  BL_TIMER_REPORT(km);
+}
+
+TYPED_TEST_P(BulkKmerGenBenchmark, generate)
+{
+  using Alphabet = typename TypeParam::KmerAlphabet;
+  using BaseIterator = std::string::const_iterator;
+  using CharIter = bliss::iterator::filter_iterator<bliss::utils::file::NotEOL, BaseIterator>;
+  using Decoder = bliss::common::ASCII2<Alphabet, typename BaseIterator::value_type>;
+  using BaseCharIterator = bliss::iterator::transform_iterator<CharIter, Decoder>;
+  using KmerIterator = bliss::common::KmerGenerationIterator<BaseCharIterator, TypeParam>;
+
+  std::string const & input = BulkKmerGenBenchmark<TypeParam>::input;
+  uint8_t const * in = reinterpret_cast<uint8_t const *>(input.data());
+  bliss::utils::file::NotEOL neol;
+
+  BL_TIMER_INIT(km);
+
+  BL_TIMER_START(km);
+  KmerIterator start(BaseCharIterator(CharIter(neol, input.cbegin(), input.cend()), Decoder()), true);
+  KmerIterator end(BaseCharIterator(CharIter(neol, input.cend()), Decoder()), false);
+  auto it = std::copy(start, end, this->outputs.begin());
+  size_t count = std::distance(this->outputs.begin(), it);
+  BL_TIMER_END(km, "iterators", count);
+
+  std::vector<TypeParam> gold(this->outputs.begin(), it);
+
+  BL_TIMER_START(km);
+  it = ::bliss::common::generate_kmers<TypeParam>(in, input.size(), this->outputs.begin());
+  size_t count2 = std::distance(this->outputs.begin(), it);
+  BL_TIMER_END(km, "bulk", count2);
+
+  EXPECT_EQ(count, count2);
+  EXPECT_TRUE(std::equal(gold.begin(), gold.end(), this->outputs.begin()));
+
+  BL_TIMER_REPORT(km);
+}
+
+
+REGISTER_TYPED_TEST_CASE_P(BulkKmerGenBenchmark, translate, generate);
+
+typedef ::testing::Types<
+    ::bliss::common::Kmer< 21, bliss::common::DNA,   uint64_t>,
+    ::bliss::common::Kmer< 31, bliss::common::DNA,   uint64_t>,
+    ::bliss::common::Kmer< 63, bliss::common::DNA,   uint64_t>,
+    ::bliss::common::Kmer< 21, bliss::common::DNA5,  uint64_t>,
+    ::bliss::common::Kmer< 31, bliss::common::DNA5,  uint64_t>,
+    ::bliss::common::Kmer< 15, bliss::common::DNA16, uint64_t>,
+    ::bliss::common::Kmer< 31, bliss::common::DNA16, uint64_t>
+> BulkKmerGenBenchmarkTypes;
+INSTANTIATE_TYPED_TEST_CASE_P(Bliss, BulkKmerGenBenchmark, BulkKmerGenBenchmarkTypes);
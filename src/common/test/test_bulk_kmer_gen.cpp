@@ -0,0 +1,153 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// include google test
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <random>
+
+// include classes to test
+#include "common/kmer.hpp"
+#include "common/alphabets.hpp"
+#include "common/alphabet_traits.hpp"
+#include "common/bulk_kmer_gen.hpp"
+#include "common/kmer_transform.hpp"
+#include "iterators/transform_iterator.hpp"
+#include "iterators/filter_iterator.hpp"
+#include "common/kmer_iterators.hpp"
+#include "utils/file_utils.hpp"
+#include "utils/logging.h"
+
+
+/// generate random ascii sequence with EOLs every line_len chars, optionally with some extra characters (N, '-', digits).
+std::string make_input(size_t len, size_t line_len, std::string const & extra, unsigned int seed) {
+  std::string chars("ACGTacgt");
+  chars.append(extra);
+
+  std::default_random_engine generator(seed);
+  std::uniform_int_distribution<size_t> distribution(0, chars.size() - 1);
+
+  std::string input;
+  for (size_t i = 0; i < len; ++i) {
+    input.push_back(chars[distribution(generator)]);
+    if ((i % line_len) == (line_len - 1)) {
+      if (i % 3 == 0) input.push_back('\r');
+      input.push_back('\n');
+    }
+  }
+  return input;
+}
+
+/// compare bulk translate and kmer generation against the iterator stack used by KmerParser.
+template<typename Alphabet, int K>
+void compare_kmer_gen(std::string const & input) {
+
+  using KmerType = bliss::common::Kmer<K, Alphabet>;
+
+  using BaseIterator = std::string::const_iterator;
+  using CharIter = bliss::iterator::filter_iterator<bliss::utils::file::NotEOL, BaseIterator>;
+  using Decoder = bliss::common::ASCII2<Alphabet, typename BaseIterator::value_type>;
+  using BaseCharIterator = bliss::iterator::transform_iterator<CharIter, Decoder>;
+  using KmerIterator = bliss::common::KmerGenerationIterator<BaseCharIterator, KmerType>;
+
+  bliss::utils::file::NotEOL neol;
+
+  // gold translation
+  std::vector<uint8_t> gold_chars(BaseCharIterator(CharIter(neol, input.cbegin(), input.cend()), Decoder()),
+                                  BaseCharIterator(CharIter(neol, input.cend()), Decoder()));
+
+  std::vector<uint8_t> chars(input.size());
+  uint8_t const * in = reinterpret_cast<uint8_t const *>(input.data());
+
+  size_t len = bliss::common::translate_strip_eol<Alphabet>(in, input.size(), chars.data());
+  ASSERT_EQ(gold_chars.size(), len);
+  EXPECT_TRUE(std::equal(gold_chars.begin(), gold_chars.end(), chars.begin()));
+
+  len = bliss::common::ASCII2AlphabetBulk<Alphabet>::translate_seq(in, input.size(), chars.data());
+  ASSERT_EQ(gold_chars.size(), len);
+  EXPECT_TRUE(std::equal(gold_chars.begin(), gold_chars.end(), chars.begin()));
+
+  // gold kmers.
+  std::vector<KmerType> gold;
+  if (gold_chars.size() >= K) {
+    KmerIterator start(BaseCharIterator(CharIter(neol, input.cbegin(), input.cend()), Decoder()), true);
+    KmerIterator end(BaseCharIterator(CharIter(neol, input.cend()), Decoder()), false);
+    gold.assign(start, end);
+  }
+
+  std::vector<KmerType> kmers;
+  bliss::common::generate_kmers<KmerType>(in, input.size(), std::back_inserter(kmers));
+
+  ASSERT_EQ(gold.size(), kmers.size());
+  for (size_t i = 0; i < gold.size(); ++i) {
+    EXPECT_EQ(gold[i], kmers[i]);
+  }
+
+  // canonical, compare to lex_less on each kmer.
+  bliss::kmer::transform::lex_less<KmerType> lex_less;
+  kmers.clear();
+  bliss::common::generate_canonical_kmers<KmerType>(in, input.size(), std::back_inserter(kmers));
+
+  ASSERT_EQ(gold.size(), kmers.size());
+  for (size_t i = 0; i < gold.size(); ++i) {
+    EXPECT_EQ(lex_less(gold[i]), kmers[i]);
+  }
+}
+
+
+TEST(BulkKmerGen, DNA)
+{
+  std::string input = make_input(10000, 60, "", 23);
+  compare_kmer_gen<bliss::common::DNA, 21>(input);
+  compare_kmer_gen<bliss::common::DNA, 31>(input);
+  compare_kmer_gen<bliss::common::DNA, 33>(input);
+
+  // with non-ACGT characters, which take the scalar path.
+  input = make_input(10000, 80, "N", 17);
+  compare_kmer_gen<bliss::common::DNA, 21>(input);
+}
+
+TEST(BulkKmerGen, DNA5)
+{
+  std::string input = make_input(10000, 60, "Nn", 23);
+  compare_kmer_gen<bliss::common::DNA5, 21>(input);
+  compare_kmer_gen<bliss::common::DNA5, 33>(input);
+
+  input = make_input(10000, 100, "Nn-.1", 17);
+  compare_kmer_gen<bliss::common::DNA5, 21>(input);
+}
+
+TEST(BulkKmerGen, DNA16)
+{
+  std::string input = make_input(10000, 60, "NnRYKMSWBDHVrykmswbdhv", 23);
+  compare_kmer_gen<bliss::common::DNA16, 15>(input);
+  compare_kmer_gen<bliss::common::DNA16, 31>(input);
+
+  input = make_input(10000, 70, "Nn-.X", 17);
+  compare_kmer_gen<bliss::common::DNA16, 15>(input);
+}
+
+TEST(BulkKmerGen, Short)
+{
+  // shorter than a simd block, and shorter than k.
+  for (size_t l = 0; l < 70; ++l) {
+    std::string input = make_input(l, 7, "N", l);
+    compare_kmer_gen<bliss::common::DNA5, 21>(input);
+    compare_kmer_gen<bliss::common::DNA, 5>(input);
+  }
+}
@@ -60,6 +60,7 @@
 
 #include "containers/distributed_map_base.hpp"
 #include "containers/densehash_map.hpp"
+#include "containers/map_snapshot.hpp"
 
 #include "utils/benchmark_utils.hpp"  // for timing.
 #include "utils/logging.h"
@@ -167,6 +168,17 @@ namespace dsc  // distributed std container
           inline int operator()(::std::pair<const Key, V> const & x) const {
             return this->operator()(x.first);
           }
+
+          /// number of elements the batch operator handles at a time.  from the distribution hash function.
+          static constexpr uint8_t batch_size = ::fsc::hash_batch_size<typename Base::DistTransformedFunc>::value;
+
+          /// batch interface.  ranks of count (at most batch_size) elements starting at first.
+          template <typename Iter>
+          inline void operator()(Iter first, size_t count, size_t * out) const {
+            uint64_t h[batch_size];
+            proc_trans_hash(first, count, h);
+            for (size_t i = 0; i < count; ++i) out[i] = h[i] % p;
+          }
       } key_to_rank;
 
       /**
@@ -538,77 +550,23 @@ namespace dsc  // distributed std container
 
             //==== reserve
             BL_BENCH_START(find);
-            auto resp_displs = mxx::impl::get_displacements(resp_counts);  // compute response displacements.
-
-            auto resp_total = resp_displs[this->comm.size() - 1] + resp_counts[this->comm.size() - 1];
-            auto max_send_count = *(::std::max_element(send_counts.begin(), send_counts.end()));
+            auto resp_total = ::std::accumulate(resp_counts.begin(), resp_counts.end(), static_cast<size_t>(0));
             results.resize(resp_total);   // allocate, not just reserve
-            ::std::vector<::std::pair<Key, T> > local_results(2 * max_send_count);
-            size_t local_offset = 0;
-            auto local_results_iter = local_results.begin();
-
-            //printf("reserving %lu\n", keys.size() * this->key_multiplicity);
             BL_BENCH_END(find, "reserve", resp_total);
 
-            //=== process queries and send results.  O(p) iterations
+            //=== process queries and send results, pipelined.  O(p) iterations
             BL_BENCH_START(find);
-            auto recv_displs = mxx::impl::get_displacements(recv_counts);  // compute response displacements.
-            int recv_from, send_to;
-            size_t found;
-            total = 0;
-            std::vector<MPI_Request> recv_reqs(this->comm.size());
-            std::vector<MPI_Request> send_reqs(this->comm.size());
-
-            mxx::datatype dt = mxx::get_datatype<::std::pair<Key, T> >();
-
-            for (int i = 0; i < this->comm.size(); ++i) {
-
-              recv_from = (this->comm.rank() + (this->comm.size() - i)) % this->comm.size(); // rank to recv data from
-              // set up receive.
-              MPI_Irecv(&results[resp_displs[recv_from]], resp_counts[recv_from], dt.type(),
-                        recv_from, i, this->comm, &recv_reqs[i]);
-            }
-
-
-            for (int i = 0; i < this->comm.size(); ++i) {
-              send_to = (this->comm.rank() + i) % this->comm.size();    // rank to send data to
-
-              local_offset = (i % 2) * max_send_count;
-              local_results_iter = local_results.begin() + local_offset;
-
-              //== get data for the dest rank
-              start = keys.begin();                                   // keys for the query for the dest rank
-              ::std::advance(start, recv_displs[send_to]);
-              end = start;
-              ::std::advance(end, recv_counts[send_to]);
-
-              // work on query from process i.
-              found = QueryProcessor::process(this->c, start, end, local_results_iter, find_element, sorted_input, pred);
-              // if (this->comm.rank() == 0) BL_DEBUGF("R %d added %d results for %d queries for process %d\n", this->comm.rank(), send_counts[i], recv_counts[i], i);
-              total += found;
-              //== now send the results immediately - minimizing data usage so we need to wait for both send and recv to complete right now.
-
-
-              // verify correct? done by comparing to previous code.
-
-
-              MPI_Isend(&(local_results[local_offset]), found, dt.type(), send_to,
-                        i, this->comm, &send_reqs[i]);
-
-              // wait for previous requests to complete.
-              if (i > 0) MPI_Wait(&send_reqs[(i - 1)], MPI_STATUS_IGNORE);
-
-              //printf("Rank %d local find send to %d:  query %d result sent %d (%d).  recv from %d received %d\n", this->comm.rank(), send_to, recv_counts[send_to], found, send_counts[send_to], recv_from, resp_counts[recv_from]);
-            }
-            // last pair
-            MPI_Wait(&send_reqs[(this->comm.size() - 1)], MPI_STATUS_IGNORE);
-
-            // wait for all the receives
-            MPI_Waitall(this->comm.size(), &(recv_reqs[0]), MPI_STATUSES_IGNORE);
-
-
-            //printf("Rank %d total find %lu\n", this->comm.rank(), total);
+            auto recv_displs = mxx::impl::get_displacements(recv_counts);
+            ::dsc::query_pipeline<::std::pair<Key, T> > pipe(this->comm, this->query_slots, this->query_max_bytes);
+            total = pipe.exchange(send_counts, resp_counts,
+                [&](int dest, ::std::pair<Key, T> * out) {
+                  auto qstart = keys.begin() + recv_displs[dest];
+                  return QueryProcessor::process(this->c, qstart, qstart + recv_counts[dest], out, find_element, sorted_input, pred);
+                }, results.data());
             BL_BENCH_END(find, "find_send", results.size());
+            BL_BENCH_ADD_METRIC(find, "overlap_efficiency", pipe.overlap_efficiency());
+            BL_BENCH_ADD_METRIC(find, "compute_s", pipe.compute_time());
+            BL_BENCH_ADD_METRIC(find, "wait_s", pipe.wait_time());
 
           } else {
 
@@ -1112,6 +1070,51 @@ namespace dsc  // distributed std container
         c.keys(result);
       }
 
+      /**
+       * @brief save the local elements to <path>.<rank>.  collective.
+       * @param tags  user metadata, checked by load.
+       */
+      void save(std::string const & path, uint64_t const (&tags)[2] = ::dsc::snapshot::no_tags) const {
+        BL_BENCH_INIT(save);
+
+        // densehash multimaps do not provide iterators, so go through a vector.
+        BL_BENCH_START(save);
+        ::std::vector<::std::pair<Key, T> > temp;
+        this->to_vector(temp);
+        BL_BENCH_END(save, "to_vector", temp.size());
+
+        BL_BENCH_START(save);
+        ::dsc::snapshot::save(path, this->comm, ::dsc::snapshot::hash_name(typeid(*this).name()),
+                              tags, 0, temp.data(), temp.size());
+        BL_BENCH_END(save, "write", temp.size());
+
+        BL_BENCH_REPORT_MPI_NAMED(save, "base_densehash:save", this->comm);
+      }
+
+      /**
+       * @brief replace the content with a snapshot from save().  collective.
+       * @details  the snapshot must be from the same map type, tags and number of ranks.  elements are already on
+       *           their owning ranks, so no communication is needed.
+       * @throw  std::invalid_argument if the snapshot does not match.
+       */
+      void load(std::string const & path, uint64_t const (&tags)[2] = ::dsc::snapshot::no_tags) {
+        BL_BENCH_INIT(load);
+
+        BL_BENCH_START(load);
+        this->local_clear();
+        ::dsc::snapshot::load<::std::pair<Key, T> >(path, this->comm, ::dsc::snapshot::hash_name(typeid(*this).name()), tags,
+          [this](size_t count) {
+            this->local_reserve(count);
+          },
+          [this](::std::vector<::std::pair<Key, T> > & chunk) {
+            this->c.insert(chunk);
+          });
+        this->local_changed = true;
+        BL_BENCH_END(load, "read", c.size());
+
+        BL_BENCH_REPORT_MPI_NAMED(load, "base_densehash:load", this->comm);
+      }
+
 
 
       /**
@@ -1167,32 +1170,28 @@ namespace dsc  // distributed std container
             BL_BENCH_END(count, "dist_query", keys.size());
 
 
-            // local count. memory utilization a potential problem.
-            // do for each src proc one at a time.
-            BL_BENCH_START(count);
-            results.reserve(keys.size() );                   // TODO:  should estimate coverage.
-            BL_BENCH_END(count, "reserve", results.capacity());
+            // 1 count per query, so the response counts are the query counts.
+            BL_BENCH_COLLECTIVE_START(count, "a2a_count", this->comm);
+            std::vector<size_t> resp_counts = mxx::all2all(recv_counts, this->comm);
+            BL_BENCH_END(count, "a2a_count", resp_counts.size());
 
             BL_BENCH_START(count);
-            auto start = keys.begin();
-            auto end = start;
-            for (int i = 0; i < this->comm.size(); ++i) {
-              ::std::advance(end, recv_counts[i]);
+            results.resize(::std::accumulate(resp_counts.begin(), resp_counts.end(), static_cast<size_t>(0)));
+            BL_BENCH_END(count, "reserve", results.size());
 
-              // within start-end, values are unique, so don't need to set unique to true.
-              QueryProcessor::process(c, start, end, emplace_iter, count_element, sorted_input, pred);
-
-              if (this->comm.rank() == 0)
-                BL_DEBUGF("R %d added %lu results for %lu queries for process %d\n", this->comm.rank(), send_counts[i], recv_counts[i], i);
-
-              start = end;
-            }
-            BL_BENCH_END(count, "local_count", results.size());
-
-            // send back using the constructed recv count
-            BL_BENCH_COLLECTIVE_START(count, "a2a2", this->comm);
-            mxx::all2allv(results, recv_counts, this->comm).swap(results);
-            BL_BENCH_END(count, "a2a2", results.size());
+            // local count for each src proc, and send back, pipelined.
+            BL_BENCH_START(count);
+            auto recv_displs = mxx::impl::get_displacements(recv_counts);
+            ::dsc::query_pipeline<::std::pair<Key, size_type> > pipe(this->comm, this->query_slots, this->query_max_bytes);
+            pipe.exchange(recv_counts, resp_counts,
+                [&](int dest, ::std::pair<Key, size_type> * out) {
+                  auto qstart = keys.begin() + recv_displs[dest];
+                  return QueryProcessor::process(c, qstart, qstart + recv_counts[dest], out, count_element, sorted_input, pred);
+                }, results.data());
+            BL_BENCH_END(count, "count_send", results.size());
+            BL_BENCH_ADD_METRIC(count, "overlap_efficiency", pipe.overlap_efficiency());
+            BL_BENCH_ADD_METRIC(count, "compute_s", pipe.compute_time());
+            BL_BENCH_ADD_METRIC(count, "wait_s", pipe.wait_time());
 
 
           } else {
@@ -1362,7 +1361,8 @@ namespace dsc  // distributed std container
         if (! this->local_empty()) {
           ::fsc::back_emplace_iterator<::std::vector<::std::pair<Key, size_t> > > emplace_iter(results);
 
-          auto keys = this->keys();
+          ::std::vector<Key> keys;
+          this->keys(keys);
           results.reserve(keys.size());
 
           QueryProcessor::process(c, keys.begin(), keys.end(), emplace_iter, count_element, false, pred);
@@ -1380,7 +1380,8 @@ namespace dsc  // distributed std container
         if (! this->local_empty()) {
           ::fsc::back_emplace_iterator<::std::vector<::std::pair<Key, size_t> > > emplace_iter(results);
 
-          auto keys = this->keys();
+          ::std::vector<Key> keys;
+          this->keys(keys);
           results.reserve(keys.size());
 
           QueryProcessor::process(c, keys.begin(), keys.end(), emplace_iter, count_element, false, pred, trans);
@@ -1937,9 +1938,15 @@ namespace dsc  // distributed std container
         }
 
 
+        if (this->reserve_precision != 0) {
+          BL_BENCH_START(insert);
+          // size the table once for the estimated distinct keys, instead of rehashing while growing.
+          this->local_reserve(this->c.size() + this->estimate_distinct(input.begin(), input.end()));
+          BL_BENCH_END(insert, "reserve", this->c.bucket_count());
+        }
+
         BL_BENCH_START(insert);
         // local compute part.  called by the communicator.
-        //this->c.resize(input.size() / 2);
         if (this->comm.rank() == 0)
         std::cout << "rank " << this->comm.rank() <<
           " BEFORE input=" << input.size() << " size=" << this->local_size() << " buckets=" << this->c.bucket_count() << std::endl;
@@ -2464,7 +2471,8 @@ namespace dsc  // distributed std container
       size_t local_insert(InputIterator first, InputIterator last) {
           size_t before = this->c.size();
 
-          //this->local_reserve(before + ::std::distance(first, last));
+          // without the estimate, the table grows as needed:  reserving for the whole input oversizes it for duplicate keys.
+          if (this->reserve_precision != 0) this->local_reserve(before + this->estimate_distinct(first, last));
 
           for (auto it = first; it != last; ++it) {
             auto v = *it;
@@ -2490,7 +2498,8 @@ namespace dsc  // distributed std container
       size_t local_insert(InputIterator first, InputIterator last, Predicate const & pred) {
           size_t before = this->c.size();
 
-          //this->local_reserve(before + ::std::distance(first, last));
+          // without the estimate, the table grows as needed:  reserving for the whole input oversizes it for duplicate keys.
+          if (this->reserve_precision != 0) this->local_reserve(before + this->estimate_distinct(first, last));
 
           for (auto it = first; it != last; ++it) {
             auto v = *it;
@@ -2519,8 +2528,8 @@ namespace dsc  // distributed std container
         BL_BENCH_INIT(reduce_tuple);
 
         BL_BENCH_START(reduce_tuple);
-        local_container_type temp(input.size());  // reserve with buckets.
-        BL_BENCH_END(reduce_tuple, "reserve", input.size());
+        local_container_type temp(this->estimate_distinct(input.begin(), input.end()));  // reserve with buckets.
+        BL_BENCH_END(reduce_tuple, "reserve", temp.bucket_count());
 
         BL_BENCH_START(reduce_tuple);
         auto max = input.end();
@@ -2593,6 +2602,13 @@ namespace dsc  // distributed std container
           BL_BENCH_END(insert, "dist_data", input.size());
         }
 
+        // solid key build:  drop the keys that the first pass counted too few times.
+        if (this->solid_threshold > 1) {
+          BL_BENCH_START(insert);
+          this->solid_filter_local(input);
+          BL_BENCH_END(insert, "solid_filter", input.size());
+        }
+
         //
         //        // after communication, sort again to keep unique  - may not be needed
         //        local_reduction(input, sorted_input);
@@ -2673,6 +2689,28 @@ namespace dsc  // distributed std container
     protected:
       using Base = reduction_densehash_map<Key, T, MapParams, SpecialKeys, ::std::plus<T>, Alloc>;
 
+      /// send keys or key-count pairs to their owners, and count them into the owners' solid filters.  COLLECTIVE
+      template <typename V>
+      void sketch_dist(std::vector<V> & input) {
+        if (this->comm.size() > 1) {
+          std::vector<size_t> recv_counts;
+          std::vector<size_t> i2o;
+          std::vector< V > buffer;
+          ::imxx::distribute(input, this->key_to_rank, recv_counts, i2o, buffer, this->comm);
+          input.swap(buffer);
+        }
+        this->solid_update_local(input);
+      }
+
+      /// predicate for erasing the entries counted fewer than threshold times.
+      struct BelowCount {
+          T threshold;
+          BelowCount(T const & _threshold) : threshold(_threshold) {}
+
+          template <typename V>
+          bool operator()(V const & x) const { return x.second < threshold; }
+      };
+
     public:
       using local_container_type = typename Base::local_container_type;
 
@@ -2706,6 +2744,104 @@ namespace dsc  // distributed std container
       using Base::unique_size;
       using Base::update;
 
+      /**
+       * @brief configure a solid key build, which keeps only the keys that occur at least threshold times.  local, but use the same values on all ranks.
+       * @details  see counting_unordered_map::set_solid_filter.  sketch all of the input first, then insert it.
+       * @param threshold  minimum occurrences, at most 15.  0 or 1 disables the filtering and frees the filter.
+       * @param counters   filter counters per rank, rounded up to a power of 2.
+       * @param hashes     filter counters per key.
+       */
+      void set_solid_filter(uint8_t threshold, size_t counters, uint8_t hashes = 3) {
+        if (threshold > Base::SolidFilterType::max_count) throw std::invalid_argument("solid threshold must be at most 15.");
+        if ((threshold > 1) && (counters == 0)) throw std::invalid_argument("solid filter needs at least 1 counter.");
+
+        this->solid_threshold = (threshold > 1) ? threshold : 0;
+        this->solid_filter = typename Base::SolidFilterType((this->solid_threshold > 1) ? counters : 0, hashes);
+      }
+
+      /**
+       * @brief first pass of a solid key build:  count key-count pairs into the owners' solid filters.  nothing is inserted.
+       * @note  COLLECTIVE.  input is consumed:  on return it holds the elements this rank owns, which can be inserted as is.
+       * @return  number of elements counted on this rank.
+       */
+      template <typename V>
+      size_t sketch(std::vector< V >& input) {
+        if (this->solid_threshold < 2) throw std::logic_error("sketch needs set_solid_filter with a threshold of at least 2.");
+
+        BL_BENCH_INIT(sketch);
+
+        if (::dsc::empty(input, this->comm)) {
+          BL_BENCH_REPORT_MPI_NAMED(sketch, "count_densehash_map:sketch", this->comm);
+          return 0;
+        }
+
+        BL_BENCH_START(sketch);
+        this->transform_input(input);
+        BL_BENCH_END(sketch, "transform_input", input.size());
+
+        BL_BENCH_START(sketch);
+        this->sketch_dist(input);
+        BL_BENCH_END(sketch, "dist_update", input.size());
+
+        BL_BENCH_REPORT_MPI_NAMED(sketch, "count_densehash_map:sketch", this->comm);
+
+        return input.size();
+      }
+
+      /**
+       * @brief first pass of a solid key build for raw keys.  duplicates are counted locally before sending, as in insert.
+       * @note  COLLECTIVE.  input is consumed:  on return it holds the keys this rank owns, which can be inserted as is.
+       */
+      size_t sketch(std::vector< Key >& input) {
+        if (this->solid_threshold < 2) throw std::logic_error("sketch needs set_solid_filter with a threshold of at least 2.");
+
+        BL_BENCH_INIT(sketch);
+
+        if (::dsc::empty(input, this->comm)) {
+          BL_BENCH_REPORT_MPI_NAMED(sketch, "count_densehash_map:sketch_key", this->comm);
+          return 0;
+        }
+
+        BL_BENCH_START(sketch);
+        this->transform_input(input);
+        BL_BENCH_END(sketch, "transform_input", input.size());
+
+        std::vector<::std::pair<Key, T> > combined;
+        BL_BENCH_START(sketch);
+        if ((this->comm.size() > 1) && (this->combiner_capacity > 0)) {
+          typename Base::template LocalCombinerType<T> combiner(this->combiner_capacity);
+          combiner.combine(input, combined);
+        }
+        BL_BENCH_END(sketch, "combine", combined.size());
+
+        BL_BENCH_START(sketch);
+        this->sketch_dist(input);
+        this->sketch_dist(combined);
+        BL_BENCH_END(sketch, "dist_update", input.size() + combined.size());
+
+        // expand the combined keys, so input holds all the owned keys again.
+        BL_BENCH_START(sketch);
+        for (auto const & x : combined) input.insert(input.end(), x.second, x.first);
+        BL_BENCH_END(sketch, "expand", input.size());
+
+        BL_BENCH_REPORT_MPI_NAMED(sketch, "count_densehash_map:sketch_key", this->comm);
+
+        return input.size();
+      }
+
+      /**
+       * @brief end a solid key build:  erase the entries counted fewer than threshold times, which the filter's false
+       *        positives let through, then free the filter.  afterwards, inserts are not filtered.
+       * @note  COLLECTIVE
+       * @return  number of entries erased on this rank.
+       */
+      size_t solid_finish() {
+        size_t erased = 0;
+        if (this->solid_threshold > 1) erased = this->erase(BelowCount(this->solid_threshold));
+        this->set_solid_filter(0, 0);
+        return erased;
+      }
+
       /**
        * @brief insert new elements in the distributed densehash_multimap.
        * @param first
@@ -2768,9 +2904,20 @@ namespace dsc  // distributed std container
         this->transform_input(input);
         BL_BENCH_END(insert, "transform_input", input.size());
 
+        // duplicate keys are counted locally, and sent as (key, count) pairs.
+        bool combine = (this->combiner_capacity > 0) && ::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value;
+        std::vector<::std::pair<Key, T> > combined;
+
         // then send the raw k-mers.
         // communication part
         if (this->comm.size() > 1) {
+          BL_BENCH_START(insert);
+          if (combine) {
+            typename Base::template LocalCombinerType<T> combiner(this->combiner_capacity);
+            combiner.combine(input, combined);
+          }
+          BL_BENCH_END(insert, "combine", combined.size());
+
           BL_BENCH_START(insert);
           // first remove duplicates.  sort, then get unique, finally remove the rest.  may not be needed
           std::vector<size_t> recv_counts;
@@ -2779,11 +2926,25 @@ namespace dsc  // distributed std container
           ::imxx::distribute(input, this->key_to_rank, recv_counts, i2o, buffer, this->comm);
           input.swap(buffer);
 
+          if (combine) {
+            std::vector<::std::pair<Key, T> > combined_buffer;
+            ::imxx::distribute(combined, this->key_to_rank, recv_counts, i2o, combined_buffer, this->comm);
+            combined.swap(combined_buffer);
+          }
+
 //          auto recv_counts = ::dsc::distribute(input, this->key_to_rank, sorted_input, this->comm);
 //          BLISS_UNUSED(recv_counts);
           BL_BENCH_END(insert, "dist_data", input.size());
         }
 
+        // solid key build:  drop the keys that the first pass counted too few times.
+        if (this->solid_threshold > 1) {
+          BL_BENCH_START(insert);
+          this->solid_filter_local(input);
+          this->solid_filter_local(combined);
+          BL_BENCH_END(insert, "solid_filter", input.size() + combined.size());
+        }
+
 //        // once received, then transform and locally insert.
 //        BL_BENCH_START(insert);
 //        size_t count = 0;
@@ -2877,6 +3038,8 @@ namespace dsc  // distributed std container
             count += this->Base::local_insert(local_start, local_end, pred);
           else
             count += this->Base::local_insert(local_start, local_end);
+          if (!combined.empty())
+            count += this->Base::local_insert(combined.begin(), combined.end());
 
           if (this->comm.rank() == 0)
           std::cout << "rank " << this->comm.rank() <<
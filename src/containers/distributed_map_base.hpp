@@ -30,7 +30,14 @@
 #include <iterator>
 #include <vector>
 #include <unordered_set>
+#include <stdexcept>  // invalid_argument
+#include <cmath>  // ceil
+#include <cstdint>
 #include "containers/dsc_container_utils.hpp"
+#include "containers/dsc_query_pipeline.hpp"
+#include "containers/dsc_local_combiner.hpp"
+#include "containers/fsc_hyperloglog.hpp"
+#include "containers/fsc_counting_bloom_filter.hpp"
 #include <mxx/collective.hpp>
 
 #include "utils/benchmark_utils.hpp"
@@ -151,10 +158,12 @@ namespace dsc
       class Alloc = ::std::allocator< ::std::pair<Key, T> >
   >  class map_base {
 
-    protected:
-
+    public:
+      /// transform applied to the input keys, e.g. lex_less for canonical kmers.  public so callers can check it.
 	  using InputTransform = typename MapParams<Key>::InputTransform;
 
+    protected:
+
 	  using DistFunc = typename MapParams<Key>::template DistFunction<Key>;
 	  using DistTrans = typename MapParams<Key>::template DistTransform<Key>;
 
@@ -182,9 +191,75 @@ namespace dsc
       template <typename V>
       using UniqueKeySetUtilityType = ::std::unordered_set<V, StoreTransformedFarmHash, StoreTransformedEqual>;
 
+      /// local pre-aggregation for counting maps.  see dsc::local_combiner
+      template <typename Count>
+      using LocalCombinerType = ::dsc::local_combiner<Key, Count, StoreTransformedFarmHash, StoreTransformedEqual>;
+
+      /// distinct key estimator for sizing local containers.  see estimate_distinct
+      using CardinalitySketchType = ::fsc::hyperloglog<Key, StoreTransformedFarmHash>;
+
+      /// approximate occurrence counts for solid key filtering in counting maps.  see solid_filter_local
+      using SolidFilterType = ::fsc::counting_bloom_filter<Key, StoreTransformedFarmHash>;
+
       // communication stuff...
       const mxx::comm& comm;
 
+      /// input has already been transformed by InputTransform (e.g. by a canonical kmer parser).  transform_input becomes a no-op.
+      bool input_pretransformed = false;
+
+      /// in-flight slots of the query response pipeline.  see dsc::query_pipeline
+      size_t query_slots = 2;
+      /// memory cap of the query response pipeline slots, in bytes.  0 for no cap.
+      size_t query_max_bytes = 0;
+      /// table capacity of the local combiner in counting map inserts.  0, the default, disables it.  see set_local_combiner
+      size_t combiner_capacity = 0;
+      /// HyperLogLog precision for sizing unique key containers before insert.  0 reserves for the whole input,
+      /// or not at all for densehash maps.  off by default:  the sketch hashes every received element a second time.
+      uint8_t reserve_precision = 0;
+      /// occurrence counts of the keys this rank owns, from a first pass over the input.  empty when not filtering.
+      SolidFilterType solid_filter;
+      /// keys with fewer estimated occurrences are dropped at insert.  0 or 1 disables the filtering.
+      uint8_t solid_threshold = 0;
+
+      /// occurrences of a key, or of a key-count pair.
+      static inline size_t solid_count(Key const &) { return 1; }
+      template <typename C>
+      static inline size_t solid_count(::std::pair<Key, C> const & x) { return static_cast<size_t>(x.second); }
+
+      /// count the received keys or key-count pairs into the solid filter.  the input is owned by this rank.
+      template <typename V>
+      void solid_update_local(::std::vector<V> const & input) {
+        for (auto const & x : input) solid_filter.update(::fsc::detail::get_key(x), solid_count(x));
+      }
+
+      /// drop the received keys or key-count pairs that occur fewer than solid_threshold times, per the solid filter.  no-op when not filtering.
+      template <typename V>
+      void solid_filter_local(::std::vector<V> & input) const {
+        if (solid_threshold < 2) return;
+        input.erase(::std::remove_if(input.begin(), input.end(), [this](V const & x){
+          return this->solid_filter.estimate(::fsc::detail::get_key(x)) < this->solid_threshold;
+        }), input.end());
+      }
+
+      /**
+       * @brief estimated number of distinct keys in [first, last), for reserving a unique key container before insert.
+       * @details one pass with a HyperLogLog sketch (16KB at the default precision).  the estimate is raised by 2
+       *          standard errors, so the container rarely has to grow, and capped at the input size.  the input is
+       *          the data this rank received, so this is the distinct count for this rank.
+       */
+      template <typename Iter>
+      size_t estimate_distinct(Iter first, Iter last) const {
+        size_t n = ::std::distance(first, last);
+        // not worth a pass for inputs that the sketch's registers outnumber.
+        if ((reserve_precision == 0) || (n <= (static_cast<size_t>(1) << reserve_precision))) return n;
+
+        CardinalitySketchType sketch(reserve_precision);
+        for (; first != last; ++first) sketch.update(::fsc::detail::get_key(*first));
+
+        double est = ::std::ceil(sketch.estimate() * (1.0 + 2.0 * sketch.error()));
+        return ::std::min(n, static_cast<size_t>(est));
+      }
+
       // ============= local modifiers.  not directly accessible publically.  meant to be called via collective calls.
 
       // abstract declarations - need to access the local containers, therefore override in subclases.
@@ -197,6 +272,42 @@ namespace dsc
     public:
       virtual ~map_base() {};
 
+      /**
+       * @brief configure the pipelined response exchange used by find and count.
+       * @param slots      in-flight slots.  more slots overlap the local lookups with more transfers.
+       * @param max_bytes  memory cap for the slots, in bytes.  0 for no cap.  lowers the slot count if needed.
+       */
+      void set_query_pipeline(size_t slots, size_t max_bytes = 0) {
+        if (slots == 0) throw std::invalid_argument("query pipeline needs at least 1 slot.");
+        query_slots = slots;
+        query_max_bytes = max_bytes;
+      }
+
+      /**
+       * @brief configure the local combiner of counting map inserts.  local, but use the same value on all ranks.
+       * @details  counting maps count duplicate keys locally in a table of this many slots before sending them, for the
+       *           chunks of the input where that reduces the volume.  other maps ignore it.
+       * @param capacity  table slots, at least 16, e.g. LocalCombinerType<T>::default_capacity.  0, the default, disables the combiner.
+       */
+      void set_local_combiner(size_t capacity) {
+        if ((capacity > 0) && (capacity < 16)) throw std::invalid_argument("local combiner needs at least 16 slots.");
+        combiner_capacity = capacity;
+      }
+
+      /**
+       * @brief configure the sizing of unique key containers before insert.  local.
+       * @details  hash maps reserve for the distinct keys in the received input, estimated by a HyperLogLog sketch,
+       *           instead of for the whole input.  multimaps ignore it.  the sketch costs an extra hash pass over the
+       *           received input per insert, so it pays off only when the input has many duplicates.
+       * @param precision  log2 of the sketch registers, between 4 and 18, e.g. 14.  0, the default, reserves for the whole input,
+       *                   except in densehash maps, which then grow their tables as needed.
+       */
+      void set_reserve_estimation(uint8_t precision) {
+        if ((precision > 0) && ((precision < CardinalitySketchType::min_precision) || (precision > CardinalitySketchType::max_precision)))
+          throw std::invalid_argument("reserve estimation precision must be 0, or between 4 and 18.");
+        reserve_precision = precision;
+      }
+
 
       // ================ data access functions
       virtual void to_vector(std::vector<std::pair<Key, T> > & result) const  = 0;
@@ -283,13 +394,27 @@ namespace dsc
           comm.barrier();
       }
 
+      /// declare that subsequent inputs are already transformed by InputTransform, e.g. canonical kmers for lex_less.  local, not collective.
+      void set_input_pretransformed(bool pretransformed) {
+        input_pretransformed = pretransformed;
+      }
+
+      bool is_input_pretransformed() const {
+        return input_pretransformed;
+      }
+
       template <typename V>
       void transform_input(std::vector<V> & input) const {
+        if (input_pretransformed) return;
     	  std::transform(input.begin(), input.end(), input.begin(), InputTransform());
       }
 
       template <typename V>
       void transform_input(std::vector<V> const & input, std::vector<V> & output) const {
+        if (input_pretransformed) {
+          output.assign(input.begin(), input.end());
+          return;
+        }
         output.resize(input.size());
 
         std::transform(input.begin(), input.end(), output.begin(), InputTransform());
@@ -297,6 +422,10 @@ namespace dsc
 
       template <typename IT, typename OT>
       void transform_input(IT _begin, IT _end, OT output) const {
+        if (input_pretransformed) {
+          std::copy(_begin, _end, output);
+          return;
+        }
         std::transform(_begin, _end, output, InputTransform());
       }
   };
@@ -65,7 +65,10 @@
 #include "containers/distributed_map_base.hpp"
 #include "common/kmer_transform.hpp"
 #include "containers/dsc_container_utils.hpp"
+#include "containers/fsc_sorted_index.hpp"
+#include "containers/map_snapshot.hpp"
 #include "io/incremental_mxx.hpp"
+#include "iterators/transform_iterator.hpp"
 
 
 namespace dsc  // distributed std container
@@ -81,10 +84,47 @@ using SortedMapParams = ::dsc::DistributedMapParams<
 		Key, InputTrans, Trans, Less, Equal, Trans, Less, Equal,
 		::fsc::TransformedComparator, ::fsc::TransformedComparator>;
 
+/**
+ * @brief  SortedMapParams that makes freeze() build a prefix offset table instead of the default eytzinger index.
+ * @details  for kmer keys.  the table has 2^PrefixBits entries, i.e. a fixed memory overhead.
+ */
+template <typename Key,
+  	  template <typename> class InputTrans,
+  	  template <typename> class Trans,
+  	  template <typename> class Less,
+  	  template <typename> class Equal,
+  	  unsigned int PrefixBits = 16
+  	  >
+struct PrefixSortedMapParams : public SortedMapParams<Key, InputTrans, Trans, Less, Equal> {
+    template <typename K, typename KLess, typename KTrans>
+    using StorageIndex = ::fsc::prefix_index<K, KLess, KTrans, PrefixBits>;
+};
+
 // =================
 // NOTE: when using this, need to further alias so that only Key param remains.
 // =================
 
+namespace detail {
+
+  template <typename T>
+  struct always_void {
+      using type = void;
+  };
+
+  /// search index for frozen sorted maps.  MapParams may choose one with a StorageIndex<K, Less, Trans> alias template.
+  template <typename Params, typename K, typename Less, typename Trans, typename = void>
+  struct frozen_index {
+      using type = ::fsc::eytzinger_index<K, Less, Trans>;
+  };
+
+  template <typename Params, typename K, typename Less, typename Trans>
+  struct frozen_index<Params, K, Less, Trans,
+    typename always_void<typename Params::template StorageIndex<K, Less, Trans> >::type> {
+      using type = typename Params::template StorageIndex<K, Less, Trans>;
+  };
+
+}  // namespace detail
+
 
   /**
    * @brief  distributed unordered map following std unordered map's interface.
@@ -212,7 +252,7 @@ using SortedMapParams = ::dsc::DistributedMapParams<
 
             // make sure query is sorted sorted.
             if (!sorted_query) {
-            	::std::sort(query_begin, query_end, typename Base::StoreTransformedFunc());
+            	::fsc::sort(query_begin, query_end, typename Base::StoreTransformedFunc());
             	sorted_query = true;
             }
 
@@ -242,7 +282,7 @@ using SortedMapParams = ::dsc::DistributedMapParams<
 
               //if (!sorted_target) Base::sort_ascending(range_begin, range_end);  range_begin and range_end often are const iterators.
               if (!sorted_query)
-            	  ::std::sort(query_begin, query_end, typename Base::StoreTransformedFunc());
+            	  ::fsc::sort(query_begin, query_end, typename Base::StoreTransformedFunc());
 
               auto el_end = range_begin;
               size_t count = 0;
@@ -302,8 +342,60 @@ using SortedMapParams = ::dsc::DistributedMapParams<
               return count;
           }
 
+          /// frozen version:  locate each query in [db_begin, db_end) with the index built on it.  queries need not be sorted.
+          template <class Index, class DBIter, class QueryIter, class OutputIter, class Operator, class Predicate = ::bliss::filter::TruePredicate>
+          static size_t process(Index const & index, DBIter db_begin, DBIter db_end,
+                                QueryIter query_begin, QueryIter query_end,
+                                OutputIter &output, Operator & op,
+                                bool & sorted_query, Predicate const &pred = Predicate()) {
+
+              if (db_begin == db_end) return 0;
+              if (query_begin == query_end) return 0;  // no input
+
+              // duplicates need to be adjacent to be skipped.
+              if (skip_duplicate_query && !sorted_query) {
+                ::fsc::sort(query_begin, query_end, typename Base::StoreTransformedFunc());
+                sorted_query = true;
+              }
+
+              constexpr size_t batch_size = 256;
+              size_t pos[batch_size];
+              size_t count = 0;
+              typename Base::StoreTransformedEqual eq;
+              typename ::std::iterator_traits<QueryIter>::value_type v;
+              DBIter range_begin, el_end;
+
+              size_t total = ::std::distance(query_begin, query_end);
+              bool first = true;
+              for (size_t b = 0; b < total; b += batch_size) {
+                size_t bn = ::std::min(batch_size, total - b);
+                index.lower_bound(db_begin, query_begin + b, bn, pos);
+
+                for (size_t i = 0; i < bn; ++i) {
+                  // compiler optimize out the conditional.
+                  if (skip_duplicate_query && !first && eq(v, *(query_begin + (b + i)))) continue;
+                  v = *(query_begin + (b + i));
+                  first = false;
+
+                  // range already starts at the lower bound, so the op's search is trivial.
+                  range_begin = el_end = db_begin + pos[i];
+                  if (!::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value)
+                    count += op.template operator()<true>(range_begin, el_end, db_end, v, output, pred);
+                  else
+                    count += op.template operator()<true>(range_begin, el_end, db_end, v, output);
+                }
+              }
+
+              return count;
+          }
+
       };
 
+      /// search index for the frozen local container.  chosen by MapParams, eytzinger_index by default.
+      using FrozenIndex = typename ::dsc::detail::frozen_index<MapParams<Key>, Key,
+          typename MapParams<Key>::template StorageFunction<Key>,
+          typename MapParams<Key>::template StorageTransform<Key> >::type;
+
 
 
     public:
@@ -343,10 +435,17 @@ using SortedMapParams = ::dsc::DistributedMapParams<
        */
       bool sorted;   // this is a local variable.
 
+      /**
+       * @brief  search index over c, built by freeze().  empty if not frozen.
+       * @note   cleared whenever the container is changed, i.e. with set_balanced(false).
+       */
+      mutable FrozenIndex frozen;
+
 
       // =========== accessors to change the local state of the container
       void set_balanced(bool v) const {
         balanced = v;
+        if (!v) frozen.clear();
       }
       // =========== accessors to change the local state of the container
       void set_globally_sorted(bool v) const {
@@ -554,10 +653,7 @@ using SortedMapParams = ::dsc::DistributedMapParams<
 
               // count results for process i
               count_results.clear();
-              auto overlap = QueryProcessor<false>::intersect(this->c.begin(), this->c.end(), start, end,
-            		  sorted_input);
-              QueryProcessor<false>::process(overlap.first, overlap.second, start, end,
-            		  count_emplace_iter, count_element, sorted_input, pred);
+              this->template local_query<false>(start, end, count_emplace_iter, count_element, sorted_input, pred);
               send_counts[i] = ::std::accumulate(count_results.begin(), count_results.end(), static_cast<size_t>(0),
                                                  [](size_t v, ::std::pair<Key, size_t> const & x) {
                              return v + x.second;
@@ -577,73 +673,24 @@ using SortedMapParams = ::dsc::DistributedMapParams<
 
 
             //==== reserve
-
             BL_BENCH_START(find);
-            auto resp_displs = mxx::impl::get_displacements(resp_counts);  // compute response displacements.
-
-            auto resp_total = resp_displs[this->comm.size() - 1] + resp_counts[this->comm.size() - 1];
-            auto max_send_count = *(::std::max_element(send_counts.begin(), send_counts.end()));
+            auto resp_total = ::std::accumulate(resp_counts.begin(), resp_counts.end(), static_cast<size_t>(0));
             results.resize(resp_total);   // allocate, not just reserve
-            ::std::vector<::std::pair<Key, T> > local_results(2 * max_send_count);
-            size_t local_offset = 0;
-            auto local_results_iter = local_results.begin();
-
             BL_BENCH_END(find, "reserve", resp_total);
 
-            //=== process queries and send results.  O(p) iterations
+            //=== process queries and send results, pipelined.  O(p) iterations
             BL_BENCH_START(find);
-            auto recv_displs = mxx::impl::get_displacements(recv_counts);  // compute response displacements.
-            int recv_from, send_to;
-            size_t found;
-            total = 0;
-            std::vector<MPI_Request> recv_reqs(this->comm.size());
-            std::vector<MPI_Request> send_reqs(this->comm.size());
-
-            mxx::datatype dt = mxx::get_datatype<::std::pair<Key, T>>();
-
-            for (int i = 0; i < this->comm.size(); ++i) {
-
-              recv_from = (this->comm.rank() + (this->comm.size() - i)) % this->comm.size(); // rank to recv data from
-              // set up receive.
-              MPI_Irecv(&results[resp_displs[recv_from]], resp_counts[recv_from], dt.type(),
-                        recv_from, i, this->comm, &recv_reqs[i]);
-            }
-
-            for (int i = 0; i < this->comm.size(); ++i) {
-              send_to = (this->comm.rank() + i) % this->comm.size();    // rank to send data to
-
-              local_offset = (i % 2) * max_send_count;
-              local_results_iter = local_results.begin() + local_offset;
-
-              //== get data for the dest rank
-              start = keys.begin();                                   // keys for the query for the dest rank
-              ::std::advance(start, recv_displs[send_to]);
-              end = start;
-              ::std::advance(end, recv_counts[send_to]);
-
-              // work on query from process i.
-              auto overlap = QueryProcessor<false>::intersect(this->c.begin(), this->c.end(),
-            		  start, end, sorted_input);
-              found = QueryProcessor<false>::process(overlap.first, overlap.second,
-            		  start, end, local_results_iter, lf, sorted_input, pred);
-              total += found;
-              //== now send the results immediately - minimizing data usage so we need to wait for both send and recv to complete right now.
-
-              MPI_Isend(&(local_results[local_offset]), found, dt.type(), send_to,
-                        i, this->comm, &send_reqs[i]);
-
-              // wait for previous requests to complete.
-              if (i > 0) MPI_Wait(&send_reqs[(i - 1)], MPI_STATUS_IGNORE);
-
-              //printf("Rank %d local find send to %d:  query %d result sent %d (%d).  recv from %d received %d\n", this->comm.rank(), send_to, recv_counts[send_to], found, send_counts[send_to], recv_from, resp_counts[recv_from]);
-            }
-            // last pair
-            MPI_Wait(&send_reqs[(this->comm.size() - 1)], MPI_STATUS_IGNORE);
-
-            // wait for all the receives
-            MPI_Waitall(this->comm.size(), &(recv_reqs[0]), MPI_STATUSES_IGNORE);
-
+            auto recv_displs = mxx::impl::get_displacements(recv_counts);
+            ::dsc::query_pipeline<::std::pair<Key, T> > pipe(this->comm, this->query_slots, this->query_max_bytes);
+            total = pipe.exchange(send_counts, resp_counts,
+                [&](int dest, ::std::pair<Key, T> * out) {
+                  auto qstart = keys.begin() + recv_displs[dest];
+                  return this->template local_query<false>(qstart, qstart + recv_counts[dest], out, lf, sorted_input, pred);
+                }, results.data());
             BL_BENCH_END(find, "find_send", results.size());
+            BL_BENCH_ADD_METRIC(find, "overlap_efficiency", pipe.overlap_efficiency());
+            BL_BENCH_ADD_METRIC(find, "compute_s", pipe.compute_time());
+            BL_BENCH_ADD_METRIC(find, "wait_s", pipe.wait_time());
 
           } else {
               // ensure that the container splitters are setup properly, and load balanced.
@@ -669,10 +716,7 @@ using SortedMapParams = ::dsc::DistributedMapParams<
             ::fsc::back_emplace_iterator<::std::vector<::std::pair<Key, T> > > emplace_iter(results);
 
             // count now.
-            auto overlap = QueryProcessor<false>::intersect(this->c.begin(), this->c.end(),
-            		keys.begin(), keys.end(), sorted_input);
-            QueryProcessor<false>::process(overlap.first, overlap.second,
-            		keys.begin(), keys.end(), count_emplace_iter, count_element, sorted_input, pred);
+            this->template local_query<false>(keys.begin(), keys.end(), count_emplace_iter, count_element, sorted_input, pred);
             size_t count = ::std::accumulate(count_results.begin(), count_results.end(), static_cast<size_t>(0),
                                           [](size_t v, ::std::pair<Key, size_t> const & x) {
                       return v + x.second;
@@ -686,8 +730,7 @@ using SortedMapParams = ::dsc::DistributedMapParams<
 
             BL_BENCH_START(find);
             // within start-end, values are unique, so don't need to set unique to true.
-            QueryProcessor<false>::process(overlap.first, overlap.second,
-            		keys.begin(), keys.end(), emplace_iter, lf, sorted_input, pred);
+            this->template local_query<false>(keys.begin(), keys.end(), emplace_iter, lf, sorted_input, pred);
             BL_BENCH_END(find, "local_find", results.size());
 
           }
@@ -783,11 +826,8 @@ using SortedMapParams = ::dsc::DistributedMapParams<
               req_sofar += recv_counts[i];
 
               // work on query from process i.  specify no skip_duplicate.
-              auto overlap = QueryProcessor<false>::intersect(this->c.begin(), this->c.end(), start, end, sorted_input);
-
               // within start-end, values are unique, so don't need to set unique to true.
-              send_counts[i] = QueryProcessor<false>::process(overlap.first, overlap.second,
-            		  start, end, emplace_iter, lf, sorted_input, pred);
+              send_counts[i] = this->template local_query<false>(start, end, emplace_iter, lf, sorted_input, pred);
 
               start = end;
             }
@@ -825,11 +865,7 @@ using SortedMapParams = ::dsc::DistributedMapParams<
 
 
             BL_BENCH_START(find);
-            auto overlap = QueryProcessor<false>::intersect(this->c.begin(), this->c.end(),
-            		keys.begin(), keys.begin() + estimating, sorted_input);
-
-            QueryProcessor<false>::process(overlap.first, overlap.second, keys.begin(), keys.begin() + estimating,
-            		emplace_iter, lf, sorted_input, pred);
+            this->template local_query<false>(keys.begin(), keys.begin() + estimating, emplace_iter, lf, sorted_input, pred);
             BL_BENCH_END(find, "local_find_0.1", estimating);
 
             BL_BENCH_START(find);
@@ -838,11 +874,7 @@ using SortedMapParams = ::dsc::DistributedMapParams<
             BL_BENCH_END(find, "reserve_est", results.capacity());
 
             BL_BENCH_START(find);
-            overlap = QueryProcessor<false>::intersect(this->c.begin(), this->c.end(),
-            		keys.begin() + estimating, keys.end(), sorted_input);
-
-            QueryProcessor<false>::process(overlap.first, overlap.second, keys.begin() + estimating, keys.end(),
-            		emplace_iter, lf, sorted_input, pred);
+            this->template local_query<false>(keys.begin() + estimating, keys.end(), emplace_iter, lf, sorted_input, pred);
             BL_BENCH_END(find, "local_find", results.size());
 
             if (this->comm.rank() == 0) printf("rank %d result size %lu capacity %lu\n", this->comm.rank(), results.size(), results.capacity());
@@ -871,7 +903,8 @@ using SortedMapParams = ::dsc::DistributedMapParams<
 
             ::fsc::back_emplace_iterator<::std::vector<::std::pair<Key, T> > > emplace_iter(results);
 
-            auto keys = this->keys();
+            ::std::vector<Key> keys;
+            this->keys(keys);
 
             ::std::vector<::std::pair<Key, size_t> > count_results;
             count_results.reserve(keys.size());
@@ -946,15 +979,61 @@ using SortedMapParams = ::dsc::DistributedMapParams<
         const_cast<typename std::remove_cv<typename std::remove_reference<decltype(*this)>::type>::type *>(this)->local_sort();
       }
 
+      /// local part of a query.  uses the frozen index if there is one, else intersects and searches the sorted container.
+      template <bool skip_duplicate_query, class QueryIter, class OutputIter, class Operator, class Predicate>
+      size_t local_query(QueryIter query_begin, QueryIter query_end, OutputIter & output, Operator & op,
+                         bool & sorted_query, Predicate const & pred) const {
+        if (this->is_frozen())
+          return QueryProcessor<skip_duplicate_query>::process(frozen, c.begin(), c.end(), query_begin, query_end,
+                                                               output, op, sorted_query, pred);
+
+        auto overlap = QueryProcessor<skip_duplicate_query>::intersect(c.begin(), c.end(),
+                                                                       query_begin, query_end, sorted_query);
+        return QueryProcessor<skip_duplicate_query>::process(overlap.first, overlap.second, query_begin, query_end,
+                                                             output, op, sorted_query, pred);
+      }
+
 
 
     public:
 
       virtual ~sorted_map_base() {};
 
-      /// returns the local storage.  please use sparingly.
+      /// returns the local storage.  please use sparingly.  modifying it while frozen requires thaw().
       local_container_type& get_local_container() { return c; }
 
+      /**
+       * @brief  make the map read only for faster find and count.  collective.
+       * @details  redistributes (or sorts locally), then builds a cache friendly search index over the local
+       *           container, an eytzinger layout or a prefix table depending on MapParams.  batched queries then
+       *           locate their keys with prefetching instead of binary search.
+       *           any insert or erase thaws the map.
+       */
+      void freeze() {
+        BL_BENCH_INIT(freeze);
+
+        BL_BENCH_START(freeze);
+        if (this->comm.size() > 1) this->redistribute();
+        else this->local_sort();
+        BL_BENCH_END(freeze, "redistribute", c.size());
+
+        BL_BENCH_START(freeze);
+        frozen.build(c.begin(), c.end());
+        BL_BENCH_END(freeze, "index", frozen.memory());
+
+        BL_BENCH_REPORT_MPI_NAMED(freeze, "base_sorted_map:freeze", this->comm);
+      }
+
+      /// drop the search index.
+      void thaw() {
+        frozen.clear();
+      }
+
+      /// whether the local container has a current search index.
+      bool is_frozen() const {
+        return !frozen.empty() && (frozen.size() == c.size());
+      }
+
       const_iterator cbegin() const
       {
         return c.cbegin();
@@ -997,6 +1076,60 @@ using SortedMapParams = ::dsc::DistributedMapParams<
 
       }
 
+      /**
+       * @brief save the local elements and the sortedness flags to <path>.<rank>.  collective.
+       * @param tags  user metadata, checked by load.
+       */
+      void save(std::string const & path, uint64_t const (&tags)[2] = ::dsc::snapshot::no_tags) const {
+        BL_BENCH_INIT(save);
+
+        BL_BENCH_START(save);
+        uint64_t flags = (this->sorted ? 0x1 : 0x0) |
+            (this->is_globally_sorted() ? 0x2 : 0x0) |
+            (this->is_balanced() ? 0x4 : 0x0);
+        ::dsc::snapshot::save(path, this->comm, ::dsc::snapshot::hash_name(typeid(*this).name()),
+                              tags, flags, c.data(), c.size());
+        BL_BENCH_END(save, "write", c.size());
+
+        BL_BENCH_REPORT_MPI_NAMED(save, "base_sorted_map:save", this->comm);
+      }
+
+      /**
+       * @brief replace the content with a snapshot from save().  collective.
+       * @details  the snapshot must be from the same map type, tags and number of ranks.  the payload is memory
+       *           mapped and copied into the local vector.  if the snapshot was globally sorted, the splitters are
+       *           rebuilt from the first element on each rank, as in redistribute(), so no sorting is needed.
+       * @throw  std::invalid_argument if the snapshot does not match.
+       */
+      void load(std::string const & path, uint64_t const (&tags)[2] = ::dsc::snapshot::no_tags) {
+        BL_BENCH_INIT(load);
+
+        BL_BENCH_START(load);
+        ::dsc::snapshot::header h =
+            ::dsc::snapshot::load(path, this->comm, ::dsc::snapshot::hash_name(typeid(*this).name()), tags, c);
+        this->sorted = (h.flags & 0x1) != 0;
+        this->set_globally_sorted((h.flags & 0x2) != 0);
+        this->set_balanced((h.flags & 0x4) != 0);
+        frozen.clear();
+        BL_BENCH_END(load, "read", c.size());
+
+        BL_BENCH_START(load);
+        this->key_to_rank.map.clear();
+        if ((h.flags & 0x2) != 0) {
+          if ((this->comm.rank() > 0) && (this->c.size() > 0)) {
+            this->key_to_rank.map.emplace_back(this->c.front().first, this->comm.rank() - 1);
+          }
+          ::mxx::allgatherv(this->key_to_rank.map, this->comm).swap(this->key_to_rank.map);
+          // note that key_to_rank.map needs to be unique.
+          auto map_end = std::unique(this->key_to_rank.map.begin(), this->key_to_rank.map.end(),
+                                     typename Base::StoreTransformedEqual());
+          this->key_to_rank.map.erase(map_end, this->key_to_rank.map.end());
+        }
+        BL_BENCH_END(load, "splitters", this->key_to_rank.map.size());
+
+        BL_BENCH_REPORT_MPI_NAMED(load, "base_sorted_map:load", this->comm);
+      }
+
 
 
       /**
@@ -1060,33 +1193,29 @@ using SortedMapParams = ::dsc::DistributedMapParams<
           BL_BENCH_END(count, "dist_query", keys.size());
 
 
-          BL_BENCH_START(count);
-          // local find. memory utilization a potential problem.
-          // do for each src proc one at a time.
-          results.reserve(keys.size());                   // TODO:  should estimate coverage.
-          BL_BENCH_END(count, "reserve", results.capacity());
+          // 1 count per query, so the response counts are the query counts.
+          BL_BENCH_COLLECTIVE_START(count, "a2a_count", this->comm);
+          std::vector<size_t> resp_counts = mxx::all2all(recv_counts, this->comm);
+          BL_BENCH_END(count, "a2a_count", resp_counts.size());
 
           BL_BENCH_START(count);
-          auto start = keys.begin();
-          auto end = start;
-          for (int i = 0; i < this->comm.size(); ++i) {
-            ::std::advance(end, recv_counts[i]);
-
-            // work on query from process i.
-            auto overlap = QueryProcessor<false>::intersect(this->c.begin(), this->c.end(), start, end, sorted_input);
-
-            // within start-end, values are unique, so don't need to set unique to true.
-            QueryProcessor<false>::process(overlap.first, overlap.second,
-            		start, end, emplace_iter, count_element, sorted_input, pred);
+          results.resize(::std::accumulate(resp_counts.begin(), resp_counts.end(), static_cast<size_t>(0)));
+          BL_BENCH_END(count, "reserve", results.size());
 
-            start = end;
-          }
-          BL_BENCH_END(count, "local_count", results.size());
-
-          BL_BENCH_COLLECTIVE_START(count, "a2a2", this->comm);
-          // send back using the constructed recv count
-          mxx::all2allv(results, recv_counts, this->comm).swap(results);
-          BL_BENCH_END(count, "a2a2", results.size());
+          // local count for each src proc, and send back, pipelined.
+          BL_BENCH_START(count);
+          auto recv_displs = mxx::impl::get_displacements(recv_counts);
+          ::dsc::query_pipeline<::std::pair<Key, size_type> > pipe(this->comm, this->query_slots, this->query_max_bytes);
+          pipe.exchange(recv_counts, resp_counts,
+              [&](int dest, ::std::pair<Key, size_type> * out) {
+                auto qstart = keys.begin() + recv_displs[dest];
+                // within start-end, values are unique, so don't need to set unique to true.
+                return this->template local_query<false>(qstart, qstart + recv_counts[dest], out, count_element, sorted_input, pred);
+              }, results.data());
+          BL_BENCH_END(count, "count_send", results.size());
+          BL_BENCH_ADD_METRIC(count, "overlap_efficiency", pipe.overlap_efficiency());
+          BL_BENCH_ADD_METRIC(count, "compute_s", pipe.compute_time());
+          BL_BENCH_ADD_METRIC(count, "wait_s", pipe.wait_time());
 
 
         } else {
@@ -1109,12 +1238,8 @@ using SortedMapParams = ::dsc::DistributedMapParams<
 
           BL_BENCH_START(count);
           // work on query from process i.
-          auto overlap = QueryProcessor<true>::intersect(this->c.begin(), this->c.end(),
-        		  keys.begin(), keys.end(), sorted_input);
-
           // within key, values may not be unique,
-          QueryProcessor<true>::process(overlap.first, overlap.second,
-        		  keys.begin(), keys.end(), emplace_iter, count_element, sorted_input, pred);
+          this->template local_query<true>(keys.begin(), keys.end(), emplace_iter, count_element, sorted_input, pred);
           BL_BENCH_END(count, "local_count", results.size());
 
         }
@@ -1137,7 +1262,8 @@ using SortedMapParams = ::dsc::DistributedMapParams<
 
           ::fsc::back_emplace_iterator<::std::vector<::std::pair<Key, size_type> > > emplace_iter(results);
 
-          auto keys = this->keys();
+          ::std::vector<Key> keys;
+          this->keys(keys);
           results.reserve(keys.size());
 
           // keys already unique
@@ -1530,7 +1656,7 @@ using SortedMapParams = ::dsc::DistributedMapParams<
     		  bool sorted_input = false) {
 
 		if (first == last) return output;
-		if (!sorted_input) ::std::sort(first, last, typename Base::StoreTransformedFunc());
+		if (!sorted_input) ::fsc::sort(first, last, typename Base::StoreTransformedFunc());
 		// then just get the unique stuff and remove rest.
 		if (first == output)
 			return ::std::unique(first, last, typename Base::StoreTransformedEqual());
@@ -2752,7 +2878,7 @@ using SortedMapParams = ::dsc::DistributedMapParams<
     		  bool sorted_input = false) {
 
 		if (first == last) return output;
-		if (!sorted_input) ::std::sort(first, last, typename Base::StoreTransformedFunc());
+		if (!sorted_input) ::fsc::sort(first, last, typename Base::StoreTransformedFunc());
 
         typename Base::Base::Base::StoreTransformedEqual store_equal;
 
@@ -2870,12 +2996,35 @@ using SortedMapParams = ::dsc::DistributedMapParams<
 
         BL_BENCH_START(insert);
         ::std::vector<::std::pair<Key, T> > temp;
-        temp.reserve(input.size());
         ::fsc::back_emplace_iterator<::std::vector<::std::pair<Key, T> > > temp_emplacer(temp);
-        ::std::transform(input.begin(), input.end(), temp_emplacer, [&trans](Key const & x) {
-        	return ::std::make_pair(trans(x), T(1));
-        });
-        BL_BENCH_END(insert, "convert", input.size());
+        if ((this->combiner_capacity > 0) && ::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value) {
+          // count duplicates locally, so fewer pairs are stored, sorted and sent.  pairs are stored either way, so
+          // combining a chunk pays once it removes a third of its elements.  the other chunks become (key, 1).
+          typename Base::template LocalCombinerType<T> combiner(this->combiner_capacity, 1.5);
+          ::std::vector<Key> raw;
+          if (this->input_pretransformed) {
+            combiner.combine(input.begin(), input.end(), temp, ::std::back_inserter(raw));
+          } else {
+            combiner.combine(::bliss::iterator::make_transform_iterator(input.begin(), trans),
+                             ::bliss::iterator::make_transform_iterator(input.end(), trans),
+                             temp, ::std::back_inserter(raw));
+          }
+          ::std::transform(raw.begin(), raw.end(), temp_emplacer, [](Key const & x) {
+            return ::std::make_pair(x, T(1));
+          });
+        } else {
+          temp.reserve(input.size());
+          if (this->input_pretransformed) {
+            ::std::transform(input.begin(), input.end(), temp_emplacer, [](Key const & x) {
+              return ::std::make_pair(x, T(1));
+            });
+          } else {
+            ::std::transform(input.begin(), input.end(), temp_emplacer, [&trans](Key const & x) {
+              return ::std::make_pair(trans(x), T(1));
+            });
+          }
+        }
+        BL_BENCH_END(insert, "convert", temp.size());
 
         size_t before = this->c.size();
         BL_BENCH_START(insert);
@@ -54,6 +54,9 @@
 #include <cstdint>  // for uint8, etc.
 
 #include <type_traits>
+#include <cmath>  // ceil
+#include <stdexcept>  // invalid_argument
+#include <chrono>  // pipelined insert timings
 
 #include <mxx/collective.hpp>
 #include <mxx/reduction.hpp>
@@ -68,6 +71,9 @@
 #include "common/kmer_transform.hpp"
 
 #include "containers/dsc_container_utils.hpp"
+#include "containers/thread_partitioned_map.hpp"
+#include "containers/map_snapshot.hpp"
+#include "containers/fsc_count_min_sketch.hpp"
 
 #include "io/incremental_mxx.hpp"
 
@@ -147,16 +153,26 @@ namespace dsc  // distributed std container
 
       struct KeyToRank {
           typename Base::DistTransformedFunc proc_trans_hash;
+          /// storage hash, for single hash mode.
+          typename Base::StoreTransformedFunc store_hash;
           const int p;
+          /// single hash mode:  the rank is from the high bits of the storage hash, instead of from the distribution hash.
+          bool single_hash;
 
           // 2x comm size to allow more even distribution?
           KeyToRank(int comm_size) :
         	  proc_trans_hash(typename Base::DistFunc(ceilLog2(comm_size)),
         			  	  	  typename Base::DistTrans()),
-        			  p(comm_size) {};
+        			  p(comm_size), single_hash(false) {};
+
+          /// rank of a storage hash value:  its high 32 bits scaled to [0, p).  the local table uses the low bits.
+          inline int rank_of_hash(uint64_t h) const {
+            return static_cast<int>(((h >> 32) * static_cast<uint64_t>(p)) >> 32);
+          }
 
           inline int operator()(Key const & x) const {
             //            printf("KeyToRank operator. commsize %d  key.  hashed to %d, mapped to proc %d \n", p, proc_hash(Base::trans(x)), proc_hash(Base::trans(x)) % p);
+            if (single_hash) return rank_of_hash(store_hash(x));
             return proc_trans_hash(x) % p;
           }
           template<typename V>
@@ -167,8 +183,64 @@ namespace dsc  // distributed std container
           inline int operator()(::std::pair<const Key, V> const & x) const {
             return this->operator()(x.first);
           }
+
+          /// number of elements the batch operator handles at a time.  from the distribution hash function.
+          static constexpr uint8_t batch_size = ::fsc::hash_batch_size<typename Base::DistTransformedFunc>::value;
+
+          /// batch interface.  ranks of count (at most batch_size) elements starting at first.
+          template <typename Iter>
+          inline void operator()(Iter first, size_t count, size_t * out) const {
+            if (single_hash) {
+              for (size_t i = 0; i < count; ++i, ++first) out[i] = rank_of_hash(store_hash(*first));
+              return;
+            }
+            uint64_t h[batch_size];
+            proc_trans_hash(first, count, h);
+            for (size_t i = 0; i < count; ++i) out[i] = h[i] % p;
+          }
       } key_to_rank;
 
+      /// element with the storage hash of its key attached, as sent in single hash mode.
+      template <typename V>
+      using Hashed = ::std::pair<V, uint64_t>;
+
+      /// rank of a hashed element, from the attached hash.
+      struct HashToRank {
+          KeyToRank const & owner;
+
+          HashToRank(KeyToRank const & _owner) : owner(_owner) {};
+
+          template <typename V>
+          inline int operator()(Hashed<V> const & x) const {
+            return owner.rank_of_hash(x.second);
+          }
+      };
+
+      /// keys per visitor call in find_stream on a single process.
+      static constexpr size_t stream_batch_size = 1UL << 16;
+
+      using HotKeySet = typename Base::template UniqueKeySetUtilityType<Key>;
+
+      /// rank of an element:  elements of hot keys are dealt round robin to all ranks, the others go to their owner.
+      struct SpreadToRank {
+          KeyToRank const & owner;
+          HotKeySet const & hot;
+          const int p;
+          /// advanced once per hot element.  imxx::distribute calls this once per element, in order.
+          mutable size_t next;
+
+          SpreadToRank(KeyToRank const & _owner, HotKeySet const & _hot, int comm_size, size_t first) :
+            owner(_owner), hot(_hot), p(comm_size), next(first) {};
+
+          inline int operator()(Key const & x) const {
+            return (hot.find(x) == hot.end()) ? owner(x) : static_cast<int>(next++ % p);
+          }
+          template<typename V>
+          inline int operator()(::std::pair<Key, V> const & x) const {
+            return this->operator()(x.first);
+          }
+      };
+
 
       /**
        * @brief count elements with the specified keys in the distributed sorted_multimap.
@@ -188,6 +260,56 @@ namespace dsc  // distributed std container
 
               if (query_begin == query_end) return 0;
 
+              return process_impl(db, query_begin, query_end, output, op, pred,
+                                  ::fsc::is_thread_partitioned<typename ::std::remove_const<DB>::type>());
+          }
+
+        protected:
+          /// thread partitioned container:  queries are grouped by sub-map, and sub-maps are processed in parallel.
+          template <class DB, class QueryIter, class OutputIter, class Operator, class Predicate>
+          static size_t process_impl(DB &db,
+                                QueryIter query_begin, QueryIter query_end,
+                                OutputIter &output, Operator & op,
+                                Predicate const &pred, ::std::true_type const &) {
+              if (!::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value)
+                return db.apply(query_begin, query_end, output, op, pred);
+              else
+                return db.apply(query_begin, query_end, output, op);
+          }
+
+          template <class DB, class QueryIter, class OutputIter, class Operator, class Predicate>
+          static size_t process_impl(DB &db,
+                                QueryIter query_begin, QueryIter query_end,
+                                OutputIter &output, Operator & op,
+                                Predicate const &pred, ::std::false_type const &) {
+              return process_seq(db, query_begin, query_end, output, op, pred,
+                                 ::fsc::has_prefetch<typename ::std::remove_const<DB>::type>());
+          }
+
+          /// container with a prefetch hint:  the lookups are pipelined, with the buckets of later queries prefetched.
+          template <class DB, class QueryIter, class OutputIter, class Operator, class Predicate>
+          static size_t process_seq(DB &db,
+                                QueryIter query_begin, QueryIter query_end,
+                                OutputIter &output, Operator & op,
+                                Predicate const &pred, ::std::true_type const &) {
+              size_t count = 0;  // before size.
+              if (!::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value)
+                ::fsc::prefetch_for_each(db, query_begin, query_end,
+                    [&db, &output, &op, &pred, &count](typename ::std::iterator_traits<QueryIter>::value_type const & q) {
+                  count += op(db, q, output, pred);
+                });
+              else
+                ::fsc::prefetch_for_each(db, query_begin, query_end,
+                    [&db, &output, &op, &count](typename ::std::iterator_traits<QueryIter>::value_type const & q) {
+                  count += op(db, q, output);
+                });
+              return count;
+          }
+          template <class DB, class QueryIter, class OutputIter, class Operator, class Predicate>
+          static size_t process_seq(DB &db,
+                                QueryIter query_begin, QueryIter query_end,
+                                OutputIter &output, Operator & op,
+                                Predicate const &pred, ::std::false_type const &) {
               size_t count = 0;  // before size.
               if (!::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value)
                 for (auto it = query_begin; it != query_end; ++it) {
@@ -228,6 +350,215 @@ namespace dsc  // distributed std container
 
       mutable bool local_changed;
 
+      /// hot key ratio for skew mitigation in insert.  0 disables it.  see set_skew_mitigation
+      double skew_ratio;
+      /// keys that a multimap insert spread over all ranks, so queries for them go to all ranks.  same on all ranks.
+      HotKeySet hot_keys;
+      /// hot_keys in the order they were added, which is the same on all ranks.
+      ::std::vector<Key> hot_list;
+      /// number of elements this rank received in the last insert.
+      size_t recv_local;
+      /// recv_local of all ranks, gathered on first use after an insert.  empty until then.
+      mutable ::std::vector<size_t> recv_per_rank;
+
+      /**
+       * @brief find the local heavy hitters in input with a count-min sketch.
+       * @details a key is hot if it occurs at least skew_ratio * input.size() / p times, i.e. it alone is a skew_ratio
+       *          fraction of what this rank sends to each rank on average.  the sketch overcounts by at most
+       *          1/4 of that threshold w.h.p.
+       */
+      template <typename V>
+      void find_hot_keys(::std::vector<V> const & input, HotKeySet & hot) const {
+        hot.clear();
+        if ((skew_ratio <= 0.0) || input.empty()) return;
+
+        double p = this->comm.size();
+        size_t threshold = ::std::max(static_cast<size_t>(2),
+                                      static_cast<size_t>(::std::ceil(skew_ratio * static_cast<double>(input.size()) / p)));
+        size_t width = ::std::min(static_cast<size_t>(1) << 24,
+                                  ::std::max(static_cast<size_t>(1024), static_cast<size_t>(::std::ceil(4.0 * 2.718281828 * p / skew_ratio))));
+
+        ::fsc::count_min_sketch<Key, typename Base::StoreTransformedFarmHash> sketch(width);
+        for (auto it = input.begin(); it != input.end(); ++it) {
+          Key const & k = ::fsc::detail::get_key<Key>(*it);
+          if (sketch.update(k) == threshold) hot.emplace(k);
+        }
+      }
+
+      /// add the hot keys of all ranks to hot_keys.  COLLECTIVE
+      void add_hot_keys(HotKeySet const & local_hot) {
+        ::std::vector<Key> local(local_hot.begin(), local_hot.end());
+        ::std::vector<Key> all = ::mxx::allgatherv(local, this->comm);
+        for (auto it = all.begin(); it != all.end(); ++it) {
+          if (hot_keys.emplace(*it).second) hot_list.emplace_back(*it);
+        }
+      }
+
+      /**
+       * @brief combine the elements of the local heavy hitters in input, one element per hot key, in place.
+       * @details  the first element of a hot key stays in its position, and the values of the later ones are folded into
+       *           it with reduce(existing, new), in input order.  the others keep their order.
+       * @return   number of elements removed.
+       */
+      template <typename V, typename Reduce>
+      size_t combine_hot(::std::vector<::std::pair<Key, V> > & input, Reduce const & reduce) const {
+        HotKeySet hot;
+        find_hot_keys(input, hot);
+        if (hot.empty()) return 0;
+
+        ::std::unordered_map<Key, size_t, typename Base::StoreTransformedFarmHash, typename Base::StoreTransformedEqual> first(hot.size());
+        size_t out = 0;
+        for (size_t i = 0; i < input.size(); ++i) {
+          if (hot.find(input[i].first) != hot.end()) {
+            auto pos = first.find(input[i].first);
+            if (pos != first.end()) {
+              input[pos->second].second = reduce(input[pos->second].second, input[i].second);
+              continue;
+            }
+            first.emplace(input[i].first, out);
+          }
+          if (out != i) input[out] = input[i];
+          ++out;
+        }
+        size_t removed = input.size() - out;
+        input.resize(out);
+        return removed;
+      }
+
+      /// distribute query keys to the ranks that may hold them:  the owner, or all ranks for a spread hot key.
+      void distribute_queries(::std::vector<Key> & keys, ::std::vector<size_t> & recv_counts) const {
+        std::vector<size_t> i2o;
+        std::vector<Key > buffer;
+        if (hot_keys.empty()) {
+          ::imxx::distribute(keys, this->key_to_rank, recv_counts, i2o, buffer, this->comm);
+        } else {
+          // replace each hot key by p consecutive copies, which SpreadToRank sends to ranks 0 .. p-1.
+          int p = this->comm.size();
+          buffer.reserve(keys.size());
+          for (auto it = keys.begin(); it != keys.end(); ++it) {
+            if (hot_keys.find(*it) == hot_keys.end()) buffer.emplace_back(*it);
+            else buffer.insert(buffer.end(), p, *it);
+          }
+          keys.swap(buffer);
+          ::imxx::distribute(keys, SpreadToRank(this->key_to_rank, hot_keys, p, 0), recv_counts, i2o, buffer, this->comm);
+        }
+        keys.swap(buffer);
+      }
+
+      /// counts of a spread hot key come from all ranks.  sum them into 1 entry per key.
+      template <typename S>
+      void merge_hot_counts(::std::vector<::std::pair<Key, S> > & results) const {
+        if (hot_keys.empty()) return;
+
+        ::std::unordered_map<Key, S, typename Base::StoreTransformedFarmHash, typename Base::StoreTransformedEqual> sums;
+        size_t out = 0;
+        for (size_t i = 0; i < results.size(); ++i) {
+          if (hot_keys.find(results[i].first) != hot_keys.end()) {
+            sums[results[i].first] += results[i].second;
+          } else {
+            if (out != i) results[out] = results[i];
+            ++out;
+          }
+        }
+        results.resize(out);
+        results.insert(results.end(), sums.begin(), sums.end());
+      }
+
+      void clear_hot_keys() {
+        hot_keys.clear();
+        hot_list.clear();
+      }
+
+      /// record the number of elements this rank received in an insert.  local:  get_recv_counts gathers them.
+      void record_recv_counts(size_t received) {
+        recv_local = received;
+        recv_per_rank.clear();
+      }
+
+      /// whether insert, find and count send the storage hash with each key.  see set_single_hash
+      bool send_hashes() const {
+        return ::fsc::has_hashed_lookup<local_container_type>::value && key_to_rank.single_hash && (this->comm.size() > 1);
+      }
+
+      static Key const & hashed_key(Hashed<Key> const & x) { return x.first; }
+      template <typename V>
+      static Key const & hashed_key(Hashed<::std::pair<Key, V> > const & x) { return x.first.first; }
+
+      /**
+       * @brief send each element to its owner with the storage hash of its key attached.  single hash mode.  COLLECTIVE
+       * @details  the hashes are computed here, once, and pick the ranks.  the owners pass them to the local container.
+       *           input is cleared, and hashed holds the received elements.
+       */
+      template <typename V>
+      void distribute_hashed(::std::vector<V> & input, ::std::vector<Hashed<V> > & hashed, ::std::vector<size_t> & recv_counts) const {
+        constexpr size_t batch = Base::StoreTransformedFunc::batch_size;
+        uint64_t hs[batch];
+        hashed.resize(input.size());
+        for (size_t i = 0; i < input.size(); i += batch) {
+          size_t b = ::std::min(batch, input.size() - i);
+          key_to_rank.store_hash(input.begin() + i, b, hs);
+          for (size_t j = 0; j < b; ++j) hashed[i + j] = Hashed<V>(input[i + j], hs[j]);
+        }
+        ::std::vector<V>().swap(input);
+
+        std::vector<size_t> i2o;
+        std::vector<Hashed<V> > buffer;
+        ::imxx::distribute(hashed, HashToRank(this->key_to_rank), recv_counts, i2o, buffer, this->comm);
+        hashed.swap(buffer);
+      }
+
+      /// estimate_distinct for hashed elements.
+      template <typename V>
+      size_t estimate_distinct_hashed(::std::vector<Hashed<V> > const & input) const {
+        auto key = [](Hashed<V> const & x) { return hashed_key(x); };
+        return this->estimate_distinct(::bliss::iterator::make_transform_iterator(input.begin(), key),
+                                       ::bliss::iterator::make_transform_iterator(input.end(), key));
+      }
+
+      /// solid_filter_local for hashed elements.
+      template <typename V>
+      void solid_filter_hashed(::std::vector<Hashed<V> > & input) const {
+        if (this->solid_threshold < 2) return;
+        input.erase(::std::remove_if(input.begin(), input.end(), [this](Hashed<V> const & x){
+          return this->solid_filter.estimate(hashed_key(x)) < this->solid_threshold;
+        }), input.end());
+      }
+
+      /// local find in single hash mode:  the elements of the keys in [first, last) that are present go to output.
+      template <class HashedIter, class OutputIter>
+      size_t find_hashed_local(HashedIter first, HashedIter last, OutputIter & output, ::std::true_type const &) const {
+        size_t count = 0;
+        ::fsc::prefetch_for_each_hashed(c, first, last, [this, &output, &count](Hashed<Key> const & q) {
+          auto it = this->c.find(q.first, q.second);
+          if (it != this->c.end()) {
+            *output = *it;
+            ++output;
+            ++count;
+          }
+        });
+        return count;
+      }
+      template <class HashedIter, class OutputIter>
+      size_t find_hashed_local(HashedIter, HashedIter, OutputIter &, ::std::false_type const &) const {
+        throw ::std::logic_error("single hash mode needs a local container that takes precomputed hashes.");
+      }
+
+      /// local count in single hash mode:  a (key, count) pair is written to output for each key in [first, last).
+      template <class HashedIter, class OutputIter>
+      size_t count_hashed_local(HashedIter first, HashedIter last, OutputIter output, ::std::true_type const &) const {
+        size_t count = 0;
+        ::fsc::prefetch_for_each_hashed(c, first, last, [this, &output, &count](Hashed<Key> const & q) {
+          *output = ::std::make_pair(q.first, this->c.count(q.first, q.second));
+          ++output;
+          ++count;
+        });
+        return count;
+      }
+      template <class HashedIter, class OutputIter>
+      size_t count_hashed_local(HashedIter, HashedIter, OutputIter, ::std::false_type const &) const {
+        throw ::std::logic_error("single hash mode needs a local container that takes precomputed hashes.");
+      }
+
       struct LocalCount {
           // unfiltered.
           template<class DB, typename Query, class OutputIter>
@@ -292,6 +623,30 @@ namespace dsc  // distributed std container
           // no filter by range AND elemenet for now.
       } erase_element;
 
+      /// whether the local container keeps 1 element per key, so inserts reserve for the distinct keys only.  multimaps override.
+      virtual bool local_unique_keys() const { return true; }
+
+      /// emplace into a thread partitioned container, with sub-maps filled in parallel.
+      template <class InputIterator>
+      void local_emplace(InputIterator first, InputIterator last, ::std::true_type const &) {
+        c.insert(first, last);
+      }
+      template <class InputIterator>
+      void local_emplace(InputIterator first, InputIterator last, ::std::false_type const &) {
+        local_emplace_seq(first, last, ::fsc::has_prefetch<local_container_type>());
+      }
+      /// container with a prefetch hint, e.g. swiss_map:  its range insert is batched, with the buckets prefetched.
+      template <class InputIterator>
+      void local_emplace_seq(InputIterator first, InputIterator last, ::std::true_type const &) {
+        c.insert(first, last);
+      }
+      template <class InputIterator>
+      void local_emplace_seq(InputIterator first, InputIterator last, ::std::false_type const &) {
+        for (auto it = first; it != last; ++it) {
+          c.emplace(*it);
+        }
+      }
+
       /**
        * @brief insert new elements in the distributed unordered_multimap.
        * @param first
@@ -302,7 +657,9 @@ namespace dsc  // distributed std container
     	  BL_BENCH_INIT(local_insert);
 
     	  BL_BENCH_START(local_insert);
-          this->local_reserve(c.size() + ::std::distance(first, last));  // before branching, because reserve calls collective "empty()"
+          // before branching, because reserve calls collective "empty()".  unique key maps only need room for distinct keys.
+          this->local_reserve(c.size() + (this->local_unique_keys() ? this->estimate_distinct(first, last) :
+                                                                      static_cast<size_t>(::std::distance(first, last))));
           BL_BENCH_END(local_insert, "reserve", this->c.size());
 
           if (first == last) return 0;
@@ -310,9 +667,7 @@ namespace dsc  // distributed std container
           size_t before = c.size();
 
           BL_BENCH_START(local_insert);
-          for (auto it = first; it != last; ++it) {
-            c.emplace(*it);
-          }
+          local_emplace(first, last, ::fsc::is_thread_partitioned<local_container_type>());
           BL_BENCH_END(local_insert, "emplace", this->c.size());
 
           if (c.size() != before) local_changed = true;
@@ -324,6 +679,33 @@ namespace dsc  // distributed std container
           return c.size() - before;
       }
 
+      /**
+       * @brief local_insert for single hash mode:  the local container takes the received hashes, so the keys are not hashed again.
+       * @details  keeps the first element of a key, as local_insert does for a unique key container.
+       */
+      template <typename V>
+      size_t local_insert_hashed(::std::vector<Hashed<V> > const & input) {
+          this->local_reserve(c.size() + this->estimate_distinct_hashed(input));
+
+          if (input.empty()) return 0;
+
+          size_t before = c.size();
+          local_emplace_hashed(input, ::fsc::has_hashed_lookup<local_container_type>());
+          if (c.size() != before) local_changed = true;
+
+          return c.size() - before;
+      }
+      template <typename V>
+      void local_emplace_hashed(::std::vector<Hashed<V> > const & input, ::std::true_type const &) {
+        ::fsc::prefetch_for_each_hashed(c, input.begin(), input.end(), [this](Hashed<V> const & x) {
+          this->c.insert(x.first, x.second);
+        });
+      }
+      template <typename V>
+      void local_emplace_hashed(::std::vector<Hashed<V> > const &, ::std::false_type const &) {
+        throw ::std::logic_error("single hash mode needs a local container that takes precomputed hashes.");
+      }
+
       /**
        * @brief insert new elements in the distributed unordered_multimap.  example use: stop inserting if more than x entries.
        * @param first
@@ -392,10 +774,7 @@ namespace dsc  // distributed std container
               // distribute (communication part)
               std::vector<size_t> recv_counts;
               {
-  				std::vector<size_t> i2o;
-  				std::vector<Key > buffer;
-  				::imxx::distribute(keys, this->key_to_rank, recv_counts, i2o, buffer, this->comm);
-  				keys.swap(buffer);
+  				this->distribute_queries(keys, recv_counts);
   	//            ::dsc::distribute_unique(keys, this->key_to_rank, sorted_input, this->comm,
   	//            				typename Base::StoreTransformedFunc(),
   	//            				typename Base::StoreTransformedEqual()).swap(recv_counts);
@@ -441,76 +820,23 @@ namespace dsc  // distributed std container
 
             //==== reserve
             BL_BENCH_START(find);
-            auto resp_displs = mxx::impl::get_displacements(resp_counts);  // compute response displacements.
-
-            auto resp_total = resp_displs[this->comm.size() - 1] + resp_counts[this->comm.size() - 1];
-            auto max_send_count = *(::std::max_element(send_counts.begin(), send_counts.end()));
+            auto resp_total = ::std::accumulate(resp_counts.begin(), resp_counts.end(), static_cast<size_t>(0));
             results.resize(resp_total);   // allocate, not just reserve
-            ::std::vector<::std::pair<Key, T> > local_results(2 * max_send_count);
-            size_t local_offset = 0;
-            auto local_results_iter = local_results.begin();
-
-            //printf("reserving %lu\n", keys.size() * this->key_multiplicity);
             BL_BENCH_END(find, "reserve", resp_total);
 
-            //=== process queries and send results.  O(p) iterations
+            //=== process queries and send results, pipelined.  O(p) iterations
             BL_BENCH_START(find);
-            auto recv_displs = mxx::impl::get_displacements(recv_counts);  // compute response displacements.
-            int recv_from, send_to;
-            size_t found;
-            total = 0;
-            std::vector<MPI_Request> recv_reqs(this->comm.size());
-            std::vector<MPI_Request> send_reqs(this->comm.size());
-
-
-            mxx::datatype dt = mxx::get_datatype<::std::pair<Key, T> >();
-
-            for (int i = 0; i < this->comm.size(); ++i) {
-
-              recv_from = (this->comm.rank() + (this->comm.size() - i)) % this->comm.size(); // rank to recv data from
-              // set up receive.
-              MPI_Irecv(&results[resp_displs[recv_from]], resp_counts[recv_from], dt.type(),
-                        recv_from, i, this->comm, &recv_reqs[i]);
-                        
-            }
-
-
-            for (int i = 0; i < this->comm.size(); ++i) {
-              send_to = (this->comm.rank() + i) % this->comm.size();    // rank to send data to
-
-              local_offset = (i % 2) * max_send_count;
-              local_results_iter = local_results.begin() + local_offset;
-
-              //== get data for the dest rank
-              start = keys.begin();                                   // keys for the query for the dest rank
-              ::std::advance(start, recv_displs[send_to]);
-              end = start;
-              ::std::advance(end, recv_counts[send_to]);
-
-              // work on query from process i.
-              found = QueryProcessor::process(c, start, end, local_results_iter, find_element, sorted_input, pred);
-              // if (this->comm.rank() == 0) BL_DEBUGF("R %d added %d results for %d queries for process %d\n", this->comm.rank(), send_counts[i], recv_counts[i], i);
-              total += found;
-              //== now send the results immediately - minimizing data usage so we need to wait for both send and recv to complete right now.
-
-
-              MPI_Isend(&(local_results[local_offset]), found, dt.type(), send_to,
-                        i, this->comm, &send_reqs[i]);
-
-              // wait for previous requests to complete.
-              if (i > 0) MPI_Wait(&send_reqs[(i - 1)], MPI_STATUS_IGNORE);
-
-              //printf("Rank %d local find send to %d:  query %d result sent %d (%d).  recv from %d received %d\n", this->comm.rank(), send_to, recv_counts[send_to], found, send_counts[send_to], recv_from, resp_counts[recv_from]);
-            }
-            // last pair
-            MPI_Wait(&send_reqs[(this->comm.size() - 1)], MPI_STATUS_IGNORE);
-
-            // wait for all the receives
-            MPI_Waitall(this->comm.size(), &(recv_reqs[0]), MPI_STATUSES_IGNORE);
-
-
-            //printf("Rank %d total find %lu\n", this->comm.rank(), total);
+            auto recv_displs = mxx::impl::get_displacements(recv_counts);
+            ::dsc::query_pipeline<::std::pair<Key, T> > pipe(this->comm, this->query_slots, this->query_max_bytes);
+            total = pipe.exchange(send_counts, resp_counts,
+                [&](int dest, ::std::pair<Key, T> * out) {
+                  auto qstart = keys.begin() + recv_displs[dest];
+                  return QueryProcessor::process(c, qstart, qstart + recv_counts[dest], out, find_element, sorted_input, pred);
+                }, results.data());
             BL_BENCH_END(find, "find_send", results.size());
+            BL_BENCH_ADD_METRIC(find, "overlap_efficiency", pipe.overlap_efficiency());
+            BL_BENCH_ADD_METRIC(find, "compute_s", pipe.compute_time());
+            BL_BENCH_ADD_METRIC(find, "wait_s", pipe.wait_time());
 
           } else {
 
@@ -556,6 +882,121 @@ namespace dsc  // distributed std container
       }
 
 
+      /**
+       * @brief find elements with the specified keys, and hand the results to a visitor instead of returning them.
+       * @details  same communication pattern as find_overlap, but results from each source process are passed to
+       *        visitor(src_rank, first, last) as they arrive, then dropped.  only the pipeline slots' results are in
+       *        memory at a time, instead of the whole result set.  first and last are ::std::pair<Key, T> const *.
+       *        visitor may be called more than once for the same source process.  for a single process, results are
+       *        passed in batches of stream_batch_size keys.
+       *
+       * @param keys    content will be changed and reordered.
+       * @return        number of results passed to the visitor.
+       */
+      template <class LocalFind, class Visitor, typename Predicate = ::bliss::filter::TruePredicate>
+      size_t find_stream(LocalFind & find_element, ::std::vector<Key>& keys, Visitor & visitor, bool sorted_input = false, Predicate const& pred = Predicate()) const {
+          BL_BENCH_INIT(find);
+
+          if (this->empty() || ::dsc::empty(keys, this->comm)) {
+            BL_BENCH_REPORT_MPI_NAMED(find, "base_hashmap:find_stream", this->comm);
+            return 0;
+          }
+
+          BL_BENCH_START(find);
+          this->transform_input(keys);
+          BL_BENCH_END(find, "transform_input", keys.size());
+
+          BL_BENCH_START(find);
+          ::fsc::unique(keys, sorted_input,
+                        typename Base::StoreTransformedFunc(),
+                        typename Base::StoreTransformedEqual());
+          BL_BENCH_END(find, "unique", keys.size());
+
+          size_t total = 0;
+
+          if (this->comm.size() > 1) {
+
+            BL_BENCH_COLLECTIVE_START(find, "dist_query", this->comm);
+            std::vector<size_t> recv_counts;
+            this->distribute_queries(keys, recv_counts);
+            BL_BENCH_END(find, "dist_query", keys.size());
+
+
+            //======= local count to size the send and receive buffers.
+            BL_BENCH_START(find);
+            ::std::vector<::std::pair<Key, size_t> > count_results;
+            size_t max_key_count = *(::std::max_element(recv_counts.begin(), recv_counts.end()));
+            count_results.reserve(max_key_count);
+            ::fsc::back_emplace_iterator<::std::vector<::std::pair<Key, size_t> > > count_emplace_iter(count_results);
+
+            std::vector<size_t> send_counts(this->comm.size(), 0);
+
+            auto start = keys.begin();
+            auto end = start;
+            for (int i = 0; i < this->comm.size(); ++i) {
+              ::std::advance(end, recv_counts[i]);
+
+              count_results.clear();
+              QueryProcessor::process(c, start, end, count_emplace_iter, count_element, sorted_input, pred);
+              send_counts[i] =
+                  ::std::accumulate(count_results.begin(), count_results.end(), static_cast<size_t>(0),
+                                    [](size_t v, ::std::pair<Key, size_t> const & x) {
+                return v + x.second;
+              });
+              start = end;
+            }
+            ::std::vector<::std::pair<Key, size_t> >().swap(count_results);
+            BL_BENCH_END(find, "local_count", keys.size());
+
+
+            BL_BENCH_COLLECTIVE_START(find, "a2a_count", this->comm);
+            std::vector<size_t> resp_counts = mxx::all2all(send_counts, this->comm);
+            BL_BENCH_END(find, "a2a_count", keys.size());
+
+
+            //=== process queries, send results, and visit received results, pipelined.  O(p) iterations
+            BL_BENCH_START(find);
+            auto recv_displs = mxx::impl::get_displacements(recv_counts);
+            ::dsc::query_pipeline<::std::pair<Key, T> > pipe(this->comm, this->query_slots, this->query_max_bytes);
+            pipe.exchange(send_counts, resp_counts,
+                [&](int dest, ::std::pair<Key, T> * out) {
+                  auto qstart = keys.begin() + recv_displs[dest];
+                  return QueryProcessor::process(c, qstart, qstart + recv_counts[dest], out, find_element, sorted_input, pred);
+                }, visitor);
+            total = ::std::accumulate(resp_counts.begin(), resp_counts.end(), static_cast<size_t>(0));
+            BL_BENCH_END(find, "find_send_visit", total);
+            BL_BENCH_ADD_METRIC(find, "overlap_efficiency", pipe.overlap_efficiency());
+            BL_BENCH_ADD_METRIC(find, "compute_s", pipe.compute_time());
+            BL_BENCH_ADD_METRIC(find, "wait_s", pipe.wait_time());
+
+          } else {
+
+            BL_BENCH_START(find);
+            ::std::vector<::std::pair<Key, T> > results;
+            ::fsc::back_emplace_iterator<::std::vector<::std::pair<Key, T> > > emplace_iter(results);
+
+            for (auto start = keys.begin(); start != keys.end(); ) {
+              auto end = start;
+              ::std::advance(end, ::std::min(static_cast<size_t>(::std::distance(start, keys.end())),
+                                         static_cast<size_t>(stream_batch_size)));
+
+              results.clear();
+              QueryProcessor::process(c, start, end, emplace_iter, find_element, sorted_input, pred);
+              visitor(this->comm.rank(), static_cast<::std::pair<Key, T> const *>(results.data()),
+                      static_cast<::std::pair<Key, T> const *>(results.data() + results.size()));
+              total += results.size();
+
+              start = end;
+            }
+            BL_BENCH_END(find, "local_find_visit", total);
+          }
+
+          BL_BENCH_REPORT_MPI_NAMED(find, "base_hashmap:find_stream", this->comm);
+
+          return total;
+      }
+
+
       /**
        * @brief find elements with the specified keys in the distributed unordered_multimap.
        * @param keys  content will be changed and reordered
@@ -589,35 +1030,40 @@ namespace dsc  // distributed std container
                 BL_BENCH_COLLECTIVE_START(find, "dist_query", this->comm);
                 // distribute (communication part)
                 std::vector<size_t> recv_counts;
+                // single hash mode:  the queries carry their hashes.
+                std::vector<Hashed<Key> > hashed;
+                bool hashes = this->send_hashes() && this->hot_keys.empty() &&
+                    ::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value;
                 {
-  				  std::vector<size_t> i2o;
-  				  std::vector<Key > buffer;
-  				  ::imxx::distribute(keys, this->key_to_rank, recv_counts, i2o, buffer, this->comm);
-  				  keys.swap(buffer);
+                  if (hashes)
+                    this->distribute_hashed(keys, hashed, recv_counts);
+                  else
+  				    this->distribute_queries(keys, recv_counts);
   	  //            ::dsc::distribute_unique(keys, this->key_to_rank, sorted_input, this->comm,
   	  //            				typename Base::StoreTransformedFunc(),
   	  //            				typename Base::StoreTransformedEqual()).swap(recv_counts);
                 }
-                BL_BENCH_END(find, "dist_query", keys.size());
+                BL_BENCH_END(find, "dist_query", keys.size() + hashed.size());
 
 
             // local find. memory utilization a potential problem.
             // do for each src proc one at a time.
 
             BL_BENCH_START(find);
-            results.reserve(keys.size() * 10);                   // TODO:  should estimate coverage.
+            results.reserve((keys.size() + hashed.size()) * 10);                   // TODO:  should estimate coverage.
             BL_BENCH_END(find, "reserve", results.capacity());
 
             BL_BENCH_START(find);
             std::vector<size_t> send_counts(this->comm.size(), 0);
             auto start = keys.begin();
             auto end = start;
+            auto hstart = hashed.begin();
             size_t new_est = 0;
             size_t req_sofar = 0;
             size_t req_total = ::std::accumulate(recv_counts.begin(), recv_counts.end(), static_cast<size_t>(0));
 
             for (int i = 0; i < this->comm.size(); ++i) {
-              ::std::advance(end, recv_counts[i]);
+              if (!hashes) ::std::advance(end, recv_counts[i]);
 
               // estimate the local intermediate results size after the first 3 iterations.
               //if (i == std::ceil(static_cast<double>(this->comm.size()) * 0.05)) {
@@ -633,6 +1079,12 @@ namespace dsc  // distributed std container
               req_sofar += recv_counts[i];
 
               // work on query from process i.
+              if (hashes) {
+                send_counts[i] = this->find_hashed_local(hstart, hstart + recv_counts[i], emplace_iter,
+                                                         ::fsc::has_hashed_lookup<local_container_type>());
+                hstart += recv_counts[i];
+                continue;
+              }
               send_counts[i] = QueryProcessor::process(c, start, end, emplace_iter, find_element, sorted_input, pred);
               // if (this->comm.rank() == 0) BL_DEBUGF("R %d added %d results for %d queries for process %d\n", this->comm.rank(), send_counts[i], recv_counts[i], i);
 
@@ -695,7 +1147,8 @@ namespace dsc  // distributed std container
 
           ::fsc::back_emplace_iterator<::std::vector<::std::pair<Key, T> > > emplace_iter(results);
 
-          auto keys = this->keys();
+          ::std::vector<Key> keys;
+          this->keys(keys);
 
           ::std::vector<::std::pair<Key, size_t> > count_results;
           count_results.reserve(keys.size());
@@ -738,11 +1191,8 @@ namespace dsc  // distributed std container
   //            BLISS_UNUSED(recv_counts);
               std::vector<size_t> recv_counts;
               {
-  				std::vector<size_t> i2o;
-  				std::vector<Key > buffer;
-  				::imxx::distribute(keys, this->key_to_rank, recv_counts, i2o, buffer, this->comm);
+  				this->distribute_queries(keys, recv_counts);
   				//::imxx::destructive_distribute(input, this->key_to_rank, recv_counts, buffer, this->comm);
-  				keys.swap(buffer);
               }
               BL_BENCH_END(erase, "dist_query", keys.size());
 
@@ -788,7 +1238,8 @@ namespace dsc  // distributed std container
 
             if (!::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value) {
 
-              auto keys = this->keys();  // already unique
+              ::std::vector<Key> keys;
+              this->keys(keys);  // already unique
 
               auto dummy_iter = keys.end();  // process requires a reference.
               count = QueryProcessor::process(c, keys.begin(), keys.end(), dummy_iter, erase_element, false, pred);
@@ -805,7 +1256,139 @@ namespace dsc  // distributed std container
       }
 
       unordered_map_base(const mxx::comm& _comm) : Base(_comm),
-          key_to_rank(_comm.size()), local_changed(false) {}
+          key_to_rank(_comm.size()), local_changed(false), skew_ratio(0.0), recv_local(0) {}
+
+
+      /// combine functor for insert_async_impl that sends the chunk as is.
+      struct NoCombine {
+          template <typename V>
+          void operator()(::std::vector<V> &) const {}
+      };
+
+      /// double buffer for pipelined insert.  slot curr receives the next chunk posted.  the other slot holds the chunk still in flight.
+      template <typename V>
+      struct pipeline_buffers {
+          ::imxx::idistribute_request<V> requests[2];
+          ::std::vector<V> recvs[2];
+          int curr;
+
+          /// per phase seconds and element counts summed over the chunks, reported once by insert_flush_impl.
+          enum { TRANSFORM = 0, POST = 1, WAIT = 2, INSERT = 3, PHASES = 4 };
+          double seconds[PHASES];
+          size_t elements[PHASES];
+          size_t chunks;
+
+          pipeline_buffers() : curr(0) { reset_stats(); }
+
+          void reset_stats() {
+            ::std::fill(seconds, seconds + PHASES, 0.0);
+            ::std::fill(elements, elements + PHASES, 0);
+            chunks = 0;
+          }
+
+          /// add the time since t to phase, and reset t to now.
+          void add_stat(int phase, ::std::chrono::steady_clock::time_point & t, size_t n) {
+            auto now = ::std::chrono::steady_clock::now();
+            seconds[phase] += ::std::chrono::duration<double>(now - t).count();
+            elements[phase] += n;
+            t = now;
+          }
+      };
+
+      /**
+       * @brief one step of pipelined insert:  post chunk i's count exchange (non-blocking), wait for chunk i-1 and insert
+       *        it locally while the counts are in flight, then post chunk i's data all2allv.
+       * @details  the caller generates chunk i+1 after this returns, overlapping with chunk i's all2allv.
+       *        timings are accumulated over the chunks, and reported by insert_flush_impl.
+       * @note  COLLECTIVE.  input is consumed.
+       * @param local_ins   functor that inserts a received vector into the local container, returns count inserted.
+       * @param combine     functor that pre-aggregates the transformed chunk in place before it is sent, e.g. its hot keys.
+       */
+      template <typename V, typename LocalInsert, typename Combine = NoCombine>
+      size_t insert_async_impl(std::vector<V>& input, pipeline_buffers<V> & pipe, LocalInsert const & local_ins,
+                               Combine const & combine = Combine()) {
+        auto t = ::std::chrono::steady_clock::now();
+        ++pipe.chunks;
+
+        this->transform_input(input);
+        if (this->comm.size() > 1) combine(input);
+        pipe.add_stat(pipe.TRANSFORM, t, input.size());
+
+        return insert_async_step(input, pipe, this->key_to_rank, local_ins);
+      }
+
+      /// the communication and local insert part of insert_async_impl, for input that is already transformed.  COLLECTIVE
+      template <typename V, typename ToRank, typename LocalInsert>
+      size_t insert_async_step(std::vector<V>& input, pipeline_buffers<V> & pipe, ToRank const & to_rank, LocalInsert const & local_ins) {
+        auto t = ::std::chrono::steady_clock::now();
+
+        int prev = 1 - pipe.curr;
+        if (this->comm.size() > 1) {
+          ::imxx::idistribute(input, to_rank, pipe.recvs[pipe.curr], pipe.requests[pipe.curr], this->comm);
+        } else {
+          pipe.recvs[pipe.curr].swap(input);
+          input.clear();
+        }
+        pipe.add_stat(pipe.POST, t, pipe.recvs[pipe.curr].size());
+
+        pipe.requests[prev].wait();
+        pipe.add_stat(pipe.WAIT, t, pipe.recvs[prev].size());
+
+        size_t count = local_ins(pipe.recvs[prev]);
+        pipe.recvs[prev].clear();   // keep capacity for reuse.
+        pipe.add_stat(pipe.INSERT, t, this->c.size());
+
+        // counts have had the local insert to arrive.  start the data exchange, which overlaps with the caller's next chunk.
+        pipe.requests[pipe.curr].post();
+        pipe.requests[pipe.curr].test();  // nudge progress on the outstanding transfer.
+        pipe.curr = prev;
+        pipe.add_stat(pipe.POST, t, 0);
+
+        return count;
+      }
+
+      /**
+       * @brief completes a pipelined insert:  waits for the last posted chunk and inserts it locally.  releases the buffers,
+       *        and reports the timings of the whole pipeline.
+       * @note  COLLECTIVE in the sense that all ranks must call it after the same number of insert_async calls.
+       */
+      template <typename V, typename LocalInsert>
+      size_t insert_flush_impl(pipeline_buffers<V> & pipe, LocalInsert const & local_ins,
+                               ::std::string const & name = "base_hashmap:insert_async") {
+        bool report = pipe.chunks > 0;
+        BL_BENCH_INIT(insert_async);
+
+        BL_BENCH_START(insert_async);
+        BL_BENCH_END(insert_async, "chunks", pipe.chunks);
+        BL_BENCH_ADD_METRIC(insert_async, "transform_input_s", pipe.seconds[pipe.TRANSFORM]);
+        BL_BENCH_ADD_METRIC(insert_async, "transform_input_n", pipe.elements[pipe.TRANSFORM]);
+        BL_BENCH_ADD_METRIC(insert_async, "post_dist_s", pipe.seconds[pipe.POST]);
+        BL_BENCH_ADD_METRIC(insert_async, "post_dist_n", pipe.elements[pipe.POST]);
+        BL_BENCH_ADD_METRIC(insert_async, "wait_prev_s", pipe.seconds[pipe.WAIT]);
+        BL_BENCH_ADD_METRIC(insert_async, "local_insert_prev_s", pipe.seconds[pipe.INSERT]);
+
+        BL_BENCH_START(insert_async);
+        int last = 1 - pipe.curr;
+        pipe.requests[last].wait();
+        // for the load imbalance statistics, as insert records them.
+        if (report) this->record_recv_counts(pipe.elements[pipe.WAIT] + pipe.recvs[last].size());
+        BL_BENCH_END(insert_async, "wait_last", pipe.recvs[last].size());
+
+        BL_BENCH_START(insert_async);
+        size_t count = local_ins(pipe.recvs[last]);
+        BL_BENCH_END(insert_async, "local_insert_last", this->c.size());
+
+        ::std::vector<V>().swap(pipe.recvs[0]);
+        ::std::vector<V>().swap(pipe.recvs[1]);
+        pipe.curr = 0;
+        pipe.reset_stats();
+
+        if (report) {
+          BL_BENCH_REPORT_MPI_NAMED(insert_async, name, this->comm);
+        }
+
+        return count;
+      }
 
 
       // ================ local overrides
@@ -849,6 +1432,81 @@ namespace dsc  // distributed std container
       using Base::get_multiplicity;
       using Base::local_size;
 
+      /// clears the distributed container, and its hot keys.  COLLECTIVE
+      virtual void clear() {
+        this->clear_hot_keys();
+        Base::clear();
+      }
+
+      virtual void reset() {
+        this->clear_hot_keys();
+        Base::reset();
+      }
+
+      /**
+       * @brief enable skew mitigation in insert.  local, but use the same value on all ranks.
+       * @details  before distribution, each rank finds its heavy hitter keys with a count-min sketch:  keys that occur at
+       *           least hot_ratio * (local input size / p) times in one insert.  counting and reduction maps pre-aggregate
+       *           them to 1 element per key, so the reduction operator has to be associative.  maps keep the first element
+       *           of each.  multimaps deal them round robin to all ranks instead, and then send queries for them to all ranks.
+       *           insert_async finds the hot keys of each chunk the same way.
+       * @param hot_ratio  0 disables.  smaller values find more hot keys.
+       */
+      void set_skew_mitigation(double hot_ratio) {
+        if (hot_ratio < 0.0) throw std::invalid_argument("skew mitigation ratio must not be negative.");
+        skew_ratio = hot_ratio;
+      }
+
+      double get_skew_mitigation() const {
+        return skew_ratio;
+      }
+
+      /**
+       * @brief single hash mode:  each key is hashed once, with the storage hash, for both its rank and its local slot.
+       * @details  the rank comes from the high bits of the storage hash instead of the distribution hash, and the local
+       *           container uses the low bits.  insert, find and count send the hash with each element, 8 more bytes, and
+       *           the owner passes it to the local container instead of hashing the key again.  insert_async, find_stream,
+       *           erase and the solid build route keys the same way, but hash them again on the owner.  needs a local
+       *           container that takes precomputed hashes (fsc::swiss_map), and a storage hash with good high bits, e.g. farm.
+       * @note  COLLECTIVE.  call with the same value on all ranks, while the map is empty:  the ranks of the keys change.
+       * @throw std::invalid_argument if the local container does not take hashes.  std::logic_error if the map is not empty.
+       */
+      void set_single_hash(bool single) {
+        if (single && !::fsc::has_hashed_lookup<local_container_type>::value)
+          throw std::invalid_argument("single hash mode needs a local container that takes precomputed hashes, e.g. fsc::swiss_map.");
+        if (!this->empty()) throw std::logic_error("single hash mode can only be changed on an empty map.");
+        key_to_rank.single_hash = single;
+      }
+
+      bool get_single_hash() const {
+        return key_to_rank.single_hash;
+      }
+
+      /**
+       * @brief number of elements each rank received in the last insert, by rank.  empty on 1 rank.
+       * @note  COLLECTIVE on the first call after an insert, which gathers the counts.  inserts only record the local count.
+       */
+      ::std::vector<size_t> const & get_recv_counts() const {
+        if (recv_per_rank.empty() && (this->comm.size() > 1))
+          recv_per_rank = ::mxx::allgather(recv_local, this->comm);
+        return recv_per_rank;
+      }
+
+      /// load imbalance of the last insert:  max / mean of get_recv_counts().  1 if balanced.  COLLECTIVE, see get_recv_counts.
+      double get_recv_imbalance() const {
+        get_recv_counts();
+        if (recv_per_rank.empty()) return 1.0;
+        double total = ::std::accumulate(recv_per_rank.begin(), recv_per_rank.end(), 0.0);
+        if (total == 0.0) return 1.0;
+        return static_cast<double>(*(::std::max_element(recv_per_rank.begin(), recv_per_rank.end()))) *
+            static_cast<double>(recv_per_rank.size()) / total;
+      }
+
+      /// number of keys a multimap spread over all ranks.
+      size_t hot_key_count() const {
+        return hot_list.size();
+      }
+
       /// convert the map to a vector
       virtual void to_vector(std::vector<std::pair<Key, T> > & result) const {
         result.clear();
@@ -870,6 +1528,46 @@ namespace dsc  // distributed std container
         result.assign(temp.begin(), temp.end());
       }
 
+      /**
+       * @brief save the local elements to <path>.<rank>.  collective.
+       * @param tags  user metadata, checked by load.
+       */
+      void save(std::string const & path, uint64_t const (&tags)[2] = ::dsc::snapshot::no_tags) const {
+        BL_BENCH_INIT(save);
+
+        BL_BENCH_START(save);
+        ::dsc::snapshot::save<::std::pair<Key, T> >(path, this->comm, ::dsc::snapshot::hash_name(typeid(*this).name()),
+                                                     tags, 0, c.size(), c.begin(), c.end());
+        BL_BENCH_END(save, "write", c.size());
+
+        BL_BENCH_REPORT_MPI_NAMED(save, "base_hashmap:save", this->comm);
+      }
+
+      /**
+       * @brief replace the content with a snapshot from save().  collective.
+       * @details  the snapshot must be from the same map type, tags and number of ranks.  elements are already on
+       *           their owning ranks, so no communication is needed.
+       * @throw  std::invalid_argument if the snapshot does not match.
+       */
+      void load(std::string const & path, uint64_t const (&tags)[2] = ::dsc::snapshot::no_tags) {
+        BL_BENCH_INIT(load);
+
+        BL_BENCH_START(load);
+        this->local_clear();
+        this->clear_hot_keys();
+        ::dsc::snapshot::load<::std::pair<Key, T> >(path, this->comm, ::dsc::snapshot::hash_name(typeid(*this).name()), tags,
+          [this](size_t count) {
+            this->local_reserve(count);
+          },
+          [this](::std::vector<::std::pair<Key, T> > & chunk) {
+            this->local_emplace(chunk.begin(), chunk.end(), ::fsc::is_thread_partitioned<local_container_type>());
+          });
+        this->local_changed = true;
+        BL_BENCH_END(load, "read", c.size());
+
+        BL_BENCH_REPORT_MPI_NAMED(load, "base_hashmap:load", this->comm);
+      }
+
 
 
       /**
@@ -916,44 +1614,54 @@ namespace dsc  // distributed std container
               BL_BENCH_COLLECTIVE_START(count, "dist_query", this->comm);
               // distribute (communication part)
               std::vector<size_t> recv_counts;
+              // single hash mode:  the queries carry their hashes.
+              std::vector<Hashed<Key> > hashed;
+              bool hashes = this->send_hashes() && this->hot_keys.empty() &&
+                  ::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value;
               {
-				  std::vector<size_t> i2o;
-				  std::vector<Key > buffer;
-				  ::imxx::distribute(keys, this->key_to_rank, recv_counts, i2o, buffer, this->comm);
-				  keys.swap(buffer);
+                if (hashes)
+                  this->distribute_hashed(keys, hashed, recv_counts);
+                else
+				  this->distribute_queries(keys, recv_counts);
 	  //            ::dsc::distribute_unique(keys, this->key_to_rank, sorted_input, this->comm,
 	  //            				typename Base::StoreTransformedFunc(),
 	  //            				typename Base::StoreTransformedEqual()).swap(recv_counts);
               }
-              BL_BENCH_END(count, "dist_query", keys.size());
+              BL_BENCH_END(count, "dist_query", keys.size() + hashed.size());
 
 
-            // local count. memory utilization a potential problem.
-            // do for each src proc one at a time.
-            BL_BENCH_START(count);
-            results.reserve(keys.size() );                   // TODO:  should estimate coverage.
-            BL_BENCH_END(count, "reserve", results.capacity());
+            // 1 count per query, so the response counts are the query counts.
+            BL_BENCH_COLLECTIVE_START(count, "a2a_count", this->comm);
+            std::vector<size_t> resp_counts = mxx::all2all(recv_counts, this->comm);
+            BL_BENCH_END(count, "a2a_count", resp_counts.size());
 
             BL_BENCH_START(count);
-            auto start = keys.begin();
-            auto end = start;
-            for (int i = 0; i < this->comm.size(); ++i) {
-              ::std::advance(end, recv_counts[i]);
-
-              // within start-end, values are unique, so don't need to set unique to true.
-              QueryProcessor::process(c, start, end, emplace_iter, count_element, sorted_input, pred);
+            results.resize(::std::accumulate(resp_counts.begin(), resp_counts.end(), static_cast<size_t>(0)));
+            BL_BENCH_END(count, "reserve", results.size());
 
-              if (this->comm.rank() == 0)
-                BL_DEBUGF("R %d added %lu results for %lu queries for process %d\n", this->comm.rank(), send_counts[i], recv_counts[i], i);
-
-              start = end;
-            }
-            BL_BENCH_END(count, "local_count", results.size());
+            // local count for each src proc, and send back, pipelined.
+            BL_BENCH_START(count);
+            auto recv_displs = mxx::impl::get_displacements(recv_counts);
+            ::dsc::query_pipeline<::std::pair<Key, size_type> > pipe(this->comm, this->query_slots, this->query_max_bytes);
+            pipe.exchange(recv_counts, resp_counts,
+                [&](int dest, ::std::pair<Key, size_type> * out) {
+                  if (hashes) {
+                    auto hstart = hashed.begin() + recv_displs[dest];
+                    return this->count_hashed_local(hstart, hstart + recv_counts[dest], out,
+                                                    ::fsc::has_hashed_lookup<local_container_type>());
+                  }
+                  auto qstart = keys.begin() + recv_displs[dest];
+                  // within start-end, values are unique, so don't need to set unique to true.
+                  return QueryProcessor::process(c, qstart, qstart + recv_counts[dest], out, count_element, sorted_input, pred);
+                }, results.data());
+            BL_BENCH_END(count, "count_send", results.size());
+            BL_BENCH_ADD_METRIC(count, "overlap_efficiency", pipe.overlap_efficiency());
+            BL_BENCH_ADD_METRIC(count, "compute_s", pipe.compute_time());
+            BL_BENCH_ADD_METRIC(count, "wait_s", pipe.wait_time());
 
-            // send back using the constructed recv count
-            BL_BENCH_COLLECTIVE_START(count, "a2a2", this->comm);
-            mxx::all2allv(results, recv_counts, this->comm).swap(results);
-            BL_BENCH_END(count, "a2a2", results.size());
+            BL_BENCH_START(count);
+            this->merge_hot_counts(results);
+            BL_BENCH_END(count, "merge_hot", results.size());
           } else {
 
 //            BL_BENCH_START(count);
@@ -992,7 +1700,8 @@ namespace dsc  // distributed std container
 
           ::fsc::back_emplace_iterator<::std::vector<::std::pair<Key, size_t> > > emplace_iter(results);
 
-          auto keys = this->keys();
+          ::std::vector<Key> keys;
+          this->keys(keys);
           results.reserve(keys.size());
 
           QueryProcessor::process(c, keys.begin(), keys.end(), emplace_iter, count_element, false, pred);
@@ -1066,14 +1775,19 @@ namespace dsc  // distributed std container
    * @tparam Hash   hash function for local and distribution.  requires a template arugment (Key), and a bool (prefix, chooses the MSBs of hash instead of LSBs)
    * @tparam Equal   default to ::std::equal_to<Key>   equal function for the local storage.
    * @tparam Alloc  default to ::std::allocator< ::std::pair<const Key, T> >    allocator for local storage.
+   * @tparam Container  default to ::std::unordered_map.   local storage.  ::fsc::thread_partitioned<...>::type for multithreaded local storage.
    */
   template<typename Key, typename T,
   	  template <typename> class MapParams,
-  class Alloc = ::std::allocator< ::std::pair<const Key, T> >
+  class Alloc = ::std::allocator< ::std::pair<const Key, T> >,
+  template <typename, typename, typename, typename, typename...> class Container = ::std::unordered_map
   >
-  class unordered_map : public unordered_map_base<Key, T, ::std::unordered_map, MapParams, Alloc> {
+  class unordered_map : public unordered_map_base<Key, T, Container, MapParams, Alloc> {
     protected:
-      using Base = unordered_map_base<Key, T, ::std::unordered_map, MapParams, Alloc>;
+      using Base = unordered_map_base<Key, T, Container, MapParams, Alloc>;
+
+      /// in-flight chunks for insert_async
+      typename Base::template pipeline_buffers<::std::pair<Key, T> > pipe;
 
 
     public:
@@ -1165,6 +1879,13 @@ namespace dsc  // distributed std container
                                                           Predicate const& pred = Predicate()) const {
           return Base::find(find_element, keys, sorted_input, pred);
       }
+
+      /// find, with results passed to visitor(src_rank, first, last) as they arrive.  see unordered_map_base::find_stream
+      template <class Visitor, class Predicate = ::bliss::filter::TruePredicate>
+      size_t find_stream(::std::vector<Key>& keys, Visitor & visitor, bool sorted_input = false,
+                         Predicate const& pred = Predicate()) const {
+          return Base::find_stream(find_element, keys, visitor, sorted_input, pred);
+      }
 //      template <class Predicate = ::bliss::filter::TruePredicate>
 //      ::std::vector<::std::pair<Key, T> > find_sendrecv(::std::vector<Key>& keys, bool sorted_input = false,
 //                                                          Predicate const& pred = Predicate()) const {
@@ -1196,26 +1917,44 @@ namespace dsc  // distributed std container
         this->transform_input(input);
         BL_BENCH_END(insert, "transform_intput", input.size());
 
+        // single hash mode:  the elements carry their hashes.
+        std::vector<typename Base::template Hashed<::std::pair<Key, T> > > hashed;
+        bool hashes = this->send_hashes() && ::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value;
+
         // communication part
         if (this->comm.size() > 1) {
+          BL_BENCH_START(insert);
+          // a map keeps the first element of a key, so later elements of hot keys need not be sent.
+          if ((this->skew_ratio > 0.0) && ::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value) {
+            this->combine_hot(input, [](T const & x, T const &) { return x; });
+          }
+          BL_BENCH_END(insert, "combine_hot", input.size());
+
           BL_BENCH_START(insert);
           // get mapping to proc
           // TODO: keep unique only may not be needed - comm speed may be faster than we can compute unique.
 //          auto recv_counts(::dsc::distribute(input, this->key_to_rank, sorted_input, this->comm));
 //          BLISS_UNUSED(recv_counts);
           std::vector<size_t> recv_counts;
+          if (hashes) {
+            this->distribute_hashed(input, hashed, recv_counts);
+          } else {
 			  std::vector<size_t> i2o;
 			  std::vector<::std::pair<Key, T> > buffer;
 			  ::imxx::distribute(input, this->key_to_rank, recv_counts, i2o, buffer, this->comm);
 			  input.swap(buffer);
-          BL_BENCH_END(insert, "dist_data", input.size());
+          }
+          this->record_recv_counts(input.size() + hashed.size());
+          BL_BENCH_END(insert, "dist_data", input.size() + hashed.size());
         }
 
 
         BL_BENCH_START(insert);
         // local compute part.  called by the communicator.
         size_t count = 0;
-        if (!::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value)
+        if (hashes)
+          count = this->Base::local_insert_hashed(hashed);
+        else if (!::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value)
           count = this->Base::local_insert(input.begin(), input.end(), pred);
         else
           count = this->Base::local_insert(input.begin(), input.end());
@@ -1227,6 +1966,29 @@ namespace dsc  // distributed std container
       }
 
 
+      /**
+       * @brief pipelined insert.  posts the distribution of this chunk and locally inserts the previous chunk while this one is in flight.
+       * @details  intended for chunked construction (parse chunk i+1 while chunk i is in flight and chunk i-1 is inserted).
+       *          call insert_flush() after the last chunk, before any query.  no predicate support.
+       *          with skew mitigation, only the first element of each hot key in a chunk is sent, as in insert.
+       * @note  COLLECTIVE.  input is consumed.
+       */
+      size_t insert_async(std::vector<::std::pair<Key, T> >& input) {
+        return this->insert_async_impl(input, this->pipe, [this](std::vector<::std::pair<Key, T> > & v){
+          return this->Base::local_insert(v.begin(), v.end());
+        }, [this](std::vector<::std::pair<Key, T> > & v){
+          if (this->skew_ratio > 0.0) this->combine_hot(v, [](T const & x, T const &) { return x; });
+        });
+      }
+
+      /// finish a pipelined insert.  see insert_async.  COLLECTIVE
+      size_t insert_flush() {
+        return this->insert_flush_impl(this->pipe, [this](std::vector<::std::pair<Key, T> > & v){
+          return this->Base::local_insert(v.begin(), v.end());
+        });
+      }
+
+
   };
 
 
@@ -1258,14 +2020,19 @@ namespace dsc  // distributed std container
    * @tparam Hash   hash function for local and distribution.  requires a template arugment (Key), and a bool (prefix, chooses the MSBs of hash instead of LSBs)
    * @tparam Equal   default to ::std::equal_to<Key>   equal function for the local storage.
    * @tparam Alloc  default to ::std::allocator< ::std::pair<const Key, T> >    allocator for local storage.
+   * @tparam Container  default to ::std::unordered_multimap.   local storage.  ::fsc::thread_partitioned<...>::type for multithreaded local storage.
    */
   template<typename Key, typename T,
   template <typename> class MapParams,
-  class Alloc = ::std::allocator< ::std::pair<const Key, T> >
+  class Alloc = ::std::allocator< ::std::pair<const Key, T> >,
+  template <typename, typename, typename, typename, typename...> class Container = ::std::unordered_multimap
   >
-  class unordered_multimap : public unordered_map_base<Key, T, ::std::unordered_multimap, MapParams, Alloc> {
+  class unordered_multimap : public unordered_map_base<Key, T, Container, MapParams, Alloc> {
     protected:
-      using Base = unordered_map_base<Key, T, ::std::unordered_multimap, MapParams, Alloc>;
+      using Base = unordered_map_base<Key, T, Container, MapParams, Alloc>;
+
+      /// in-flight chunks for insert_async
+      typename Base::template pipeline_buffers<::std::pair<Key, T> > pipe;
 
 
     public:
@@ -1288,6 +2055,8 @@ namespace dsc  // distributed std container
       using difference_type       = typename local_container_type::difference_type;
 
     protected:
+      /// every element takes a slot.
+      virtual bool local_unique_keys() const { return false; }
 
       struct LocalFind {
         // unfiltered.
@@ -1338,7 +2107,39 @@ namespace dsc  // distributed std container
 
       using Base::count;
       using Base::erase;
-      using Base::unique_size;
+
+      /// number of unique keys.  a hot key spread over several ranks is counted once.  COLLECTIVE
+      virtual size_t unique_size() const {
+        size_t s = Base::unique_size();
+        if ((this->comm.size() == 1) || this->hot_list.empty()) return s;
+
+        ::std::vector<size_t> present(this->hot_list.size(), 0);
+        for (size_t i = 0; i < this->hot_list.size(); ++i) {
+          if (this->c.count(this->hot_list[i]) > 0) present[i] = 1;
+        }
+        present = ::mxx::allreduce(present, this->comm);
+        for (size_t i = 0; i < present.size(); ++i) {
+          if (present[i] > 1) s -= present[i] - 1;
+        }
+        return s;
+      }
+
+      /**
+       * @brief replace the content with a snapshot from save().  see unordered_map_base::load.
+       * @details  the keys held off their owning rank were spread as hot keys, so they are hot keys again.  COLLECTIVE
+       */
+      void load(std::string const & path, uint64_t const (&tags)[2] = ::dsc::snapshot::no_tags) {
+        Base::load(path, tags);
+
+        if (this->comm.size() == 1) return;
+        typename Base::HotKeySet local_hot;
+        int rank = this->comm.rank();
+        auto max = this->c.end();
+        for (auto it = this->c.begin(); it != max; ++it) {
+          if (this->key_to_rank((*it).first) != rank) local_hot.emplace((*it).first);
+        }
+        this->add_hot_keys(local_hot);
+      }
 
 
       template <class Predicate = ::bliss::filter::TruePredicate>
@@ -1346,6 +2147,13 @@ namespace dsc  // distributed std container
                                                Predicate const& pred = Predicate()) const {
           return Base::find_overlap(find_element, keys, sorted_input, pred);
       }
+
+      /// find, with results passed to visitor(src_rank, first, last) as they arrive.  see unordered_map_base::find_stream
+      template <class Visitor, class Predicate = ::bliss::filter::TruePredicate>
+      size_t find_stream(::std::vector<Key>& keys, Visitor & visitor, bool sorted_input = false,
+                         Predicate const& pred = Predicate()) const {
+          return Base::find_stream(find_element, keys, visitor, sorted_input, pred);
+      }
 //      template <class Predicate = ::bliss::filter::TruePredicate>
 //      ::std::vector<::std::pair<Key, T> > find(::std::vector<Key>& keys, bool sorted_input = false,
 //                                                          Predicate const& pred = Predicate()) const {
@@ -1485,14 +2293,29 @@ namespace dsc  // distributed std container
 
         // communication part
         if (this->comm.size() > 1) {
+          BL_BENCH_START(insert);
+          if (this->skew_ratio > 0.0) {
+            typename Base::HotKeySet local_hot;
+            this->find_hot_keys(input, local_hot);
+            this->add_hot_keys(local_hot);
+          }
+          BL_BENCH_END(insert, "hot_keys", this->hot_list.size());
+
           BL_BENCH_START(insert);
           // first remove duplicates.  sort, then get unique, finally remove the rest.  may not be needed
 
           std::vector<size_t> recv_counts;
           std::vector<size_t> i2o;
           std::vector<::std::pair<Key, T> > buffer;
-          ::imxx::distribute(input, this->key_to_rank, recv_counts, i2o, buffer, this->comm);
+          if (this->hot_keys.empty()) {
+            ::imxx::distribute(input, this->key_to_rank, recv_counts, i2o, buffer, this->comm);
+          } else {
+            // spread the elements of hot keys over all ranks, starting at a different rank on each.
+            ::imxx::distribute(input, typename Base::SpreadToRank(this->key_to_rank, this->hot_keys, this->comm.size(), this->comm.rank()),
+                               recv_counts, i2o, buffer, this->comm);
+          }
           input.swap(buffer);
+          this->record_recv_counts(input.size());
 
           //auto recv_counts = ::dsc::distribute(input, this->key_to_rank, sorted_input, this->comm);
           //BLISS_UNUSED(recv_counts);
@@ -1515,6 +2338,45 @@ namespace dsc  // distributed std container
       }
 
 
+      /**
+       * @brief pipelined insert.  posts the distribution of this chunk and locally inserts the previous chunk while this one is in flight.
+       * @details  intended for chunked construction (parse chunk i+1 while chunk i is in flight and chunk i-1 is inserted).
+       *          call insert_flush() after the last chunk, before any query.  no predicate support.
+       *          with skew mitigation, the hot keys of each chunk are found and spread over all ranks, as in insert.
+       * @note  COLLECTIVE.  input is consumed.
+       */
+      size_t insert_async(std::vector<::std::pair<Key, T> >& input) {
+        auto t = ::std::chrono::steady_clock::now();
+        ++this->pipe.chunks;
+
+        this->transform_input(input);
+        if ((this->comm.size() > 1) && (this->skew_ratio > 0.0)) {
+          typename Base::HotKeySet local_hot;
+          this->find_hot_keys(input, local_hot);
+          this->add_hot_keys(local_hot);
+        }
+        this->pipe.add_stat(this->pipe.TRANSFORM, t, input.size());
+
+        auto local_ins = [this](std::vector<::std::pair<Key, T> > & v){
+          return this->Base::local_insert(v.begin(), v.end());
+        };
+        // hot_keys is the same on all ranks, so they all take the same branch.
+        if (this->hot_keys.empty())
+          return this->insert_async_step(input, this->pipe, this->key_to_rank, local_ins);
+        else
+          return this->insert_async_step(input, this->pipe,
+                                         typename Base::SpreadToRank(this->key_to_rank, this->hot_keys, this->comm.size(), this->comm.rank()),
+                                         local_ins);
+      }
+
+      /// finish a pipelined insert.  see insert_async.  COLLECTIVE
+      size_t insert_flush() {
+        return this->insert_flush_impl(this->pipe, [this](std::vector<::std::pair<Key, T> > & v){
+          return this->Base::local_insert(v.begin(), v.end());
+        });
+      }
+
+
       /// get the size of unique keys in the current local container.
       virtual size_t local_unique_size() const {
         if (this->local_changed) {
@@ -1561,17 +2423,19 @@ namespace dsc  // distributed std container
    * @tparam Reduc  default to ::std::plus<key>    reduction operator
    * @tparam Equal   default to ::std::equal_to<Key>   equal function for the local storage.
    * @tparam Alloc  default to ::std::allocator< ::std::pair<const Key, T> >    allocator for local storage.
+   * @tparam Container  default to ::std::unordered_map.   local storage.  ::fsc::thread_partitioned<...>::type for multithreaded local storage.
    */
   template<typename Key, typename T,
   template <typename> class MapParams,
   typename Reduc = ::std::plus<T>,
-  class Alloc = ::std::allocator< ::std::pair<const Key, T> >
+  class Alloc = ::std::allocator< ::std::pair<const Key, T> >,
+  template <typename, typename, typename, typename, typename...> class Container = ::std::unordered_map
   >
-  class reduction_unordered_map : public unordered_map<Key, T, MapParams, Alloc> {
+  class reduction_unordered_map : public unordered_map<Key, T, MapParams, Alloc, Container> {
       static_assert(::std::is_arithmetic<T>::value, "mapped type has to be arithmetic");
 
     protected:
-      using Base = unordered_map<Key, T, MapParams, Alloc>;
+      using Base = unordered_map<Key, T, MapParams, Alloc, Container>;
 
     public:
       using local_container_type = typename Base::local_container_type;
@@ -1595,6 +2459,41 @@ namespace dsc  // distributed std container
     protected:
       Reduc r;
 
+      /// merge entries into a thread partitioned container, with sub-maps reduced in parallel.
+      template <class InputIterator>
+      void reduce_into(local_container_type & db, InputIterator first, InputIterator last, ::std::true_type const &) {
+        Reduc const & reduc = r;
+        db.insert(first, last, [&reduc](typename local_container_type::subcontainer_type & part,
+            typename ::std::iterator_traits<InputIterator>::value_type const & x) {
+          auto it = part.find(x.first);
+          if (it == part.end()) part.emplace(x);
+          else it->second = reduc(it->second, x.second);
+        });
+      }
+      template <class InputIterator>
+      void reduce_into(local_container_type & db, InputIterator first, InputIterator last, ::std::false_type const &) {
+        reduce_into_seq(db, first, last, ::fsc::has_prefetch<local_container_type>());
+      }
+      /// container with a prefetch hint:  the find-or-insert of later elements is prefetched.
+      template <class InputIterator>
+      void reduce_into_seq(local_container_type & db, InputIterator first, InputIterator last, ::std::true_type const &) {
+        Reduc const & reduc = r;
+        ::fsc::prefetch_for_each(db, first, last,
+            [&db, &reduc](typename ::std::iterator_traits<InputIterator>::value_type const & x) {
+          auto it = db.find(x.first);
+          if (it == db.end()) db.emplace(x);
+          else it->second = reduc(it->second, x.second);
+        });
+      }
+      template <class InputIterator>
+      void reduce_into_seq(local_container_type & db, InputIterator first, InputIterator last, ::std::false_type const &) {
+        for (auto it = first; it != last; ++it) {
+          if (db.find((*it).first) == db.end()) db.emplace(*it);
+          else
+            db.at((*it).first) = r(db.at((*it).first), (*it).second);
+        }
+      }
+
       /**
        * @brief insert new elements in the distributed unordered_multimap.
        * @param first
@@ -1604,13 +2503,9 @@ namespace dsc  // distributed std container
       size_t local_insert(InputIterator first, InputIterator last) {
           size_t before = this->c.size();
 
-          this->local_reserve(before + ::std::distance(first, last));
+          this->local_reserve(before + this->estimate_distinct(first, last));
 
-          for (auto it = first; it != last; ++it) {
-            if (this->c.find((*it).first) == this->c.end()) this->c.emplace(*it);
-            else
-              this->c.at((*it).first) = r(this->c.at((*it).first), (*it).second);
-          }
+          reduce_into(this->c, first, last, ::fsc::is_thread_partitioned<local_container_type>());
 
           if (this->c.size() != before) this->local_changed = true;
 
@@ -1626,7 +2521,7 @@ namespace dsc  // distributed std container
       size_t local_insert(InputIterator first, InputIterator last, Predicate const & pred) {
           size_t before = this->c.size();
 
-          this->local_reserve(before + ::std::distance(first, last));
+          this->local_reserve(before + this->estimate_distinct(first, last));
 
           for (auto it = first; it != last; ++it) {
             if (pred(*it)) {
@@ -1642,6 +2537,42 @@ namespace dsc  // distributed std container
 
       }
 
+      /// the element a hashed input adds:  a raw key counts as 1, for the counting map.
+      static ::std::pair<Key, T> const & hashed_value(::std::pair<Key, T> const & x) { return x; }
+      static ::std::pair<Key, T> hashed_value(Key const & x) { return ::std::make_pair(x, T(1)); }
+
+      /**
+       * @brief local_insert for single hash mode:  the local container takes the received hashes, so the keys are not hashed again.
+       */
+      template <typename V>
+      size_t local_insert_hashed(::std::vector<typename Base::template Hashed<V> > const & input) {
+          size_t before = this->c.size();
+
+          this->local_reserve(before + this->estimate_distinct_hashed(input));
+
+          reduce_hashed(input, ::fsc::has_hashed_lookup<local_container_type>());
+
+          if (this->c.size() != before) this->local_changed = true;
+
+          return this->c.size() - before;
+      }
+      template <typename V>
+      void reduce_hashed(::std::vector<typename Base::template Hashed<V> > const & input, ::std::true_type const &) {
+        local_container_type & db = this->c;
+        Reduc const & reduc = r;
+        ::fsc::prefetch_for_each_hashed(db, input.begin(), input.end(),
+            [&db, &reduc](typename Base::template Hashed<V> const & x) {
+          auto const & v = hashed_value(x.first);
+          auto it = db.find(v.first, x.second);
+          if (it == db.end()) db.insert(v, x.second);
+          else it->second = reduc(it->second, v.second);
+        });
+      }
+      template <typename V>
+      void reduce_hashed(::std::vector<typename Base::template Hashed<V> > const &, ::std::false_type const &) {
+        throw ::std::logic_error("single hash mode needs a local container that takes precomputed hashes.");
+      }
+
       /// local reduction via a copy of local container type (i.e. unordered_map).
       /// this takes quite a bit of memory due to use of unordered_map, but is significantly faster than sorting.
       virtual void local_reduction(::std::vector<::std::pair<Key, T> >& input, bool & sorted_input) {
@@ -1652,19 +2583,11 @@ namespace dsc  // distributed std container
         BL_BENCH_INIT(reduce_tuple);
 
         BL_BENCH_START(reduce_tuple);
-        local_container_type temp(input.size());  // reserve with buckets.
-        BL_BENCH_END(reduce_tuple, "reserve", input.size());
+        local_container_type temp(this->estimate_distinct(input.begin(), input.end()));  // reserve with buckets.
+        BL_BENCH_END(reduce_tuple, "reserve", temp.bucket_count());
 
         BL_BENCH_START(reduce_tuple);
-        Key k;
-        T v;
-        auto end = input.end();
-        for (auto it = input.begin(); it != end; ++it) {
-          k = (*it).first;
-          v = (*it).second;
-          if (temp.find(k) == temp.end()) temp.emplace(k, v);  // don't rely on initialization to set T to 0.
-          else temp.at(k) = r(temp.at(k), v);
-        }
+        reduce_into(temp, input.begin(), input.end(), ::fsc::is_thread_partitioned<local_container_type>());
         BL_BENCH_END(reduce_tuple, "reduce", temp.size());
 
         BL_BENCH_START(reduce_tuple);
@@ -1709,22 +2632,44 @@ namespace dsc  // distributed std container
         this->transform_input(input);
         BL_BENCH_END(insert, "transform_intput", input.size());
 
+        // single hash mode:  the elements carry their hashes.
+        std::vector<typename Base::template Hashed<::std::pair<Key, T> > > hashed;
+        bool hashes = this->send_hashes() && ::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value;
 
         // communication part
         if (this->comm.size() > 1) {
+          BL_BENCH_START(insert);
+          // pre-aggregate hot keys, so their owners receive 1 element per key from each rank.
+          if ((this->skew_ratio > 0.0) && ::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value) {
+            this->combine_hot(input, this->r);
+          }
+          BL_BENCH_END(insert, "combine_hot", input.size());
+
           BL_BENCH_START(insert);
           // first remove duplicates.  sort, then get unique, finally remove the rest.  may not be needed
           std::vector<size_t> recv_counts;
-          std::vector<size_t> i2o;
-          std::vector<::std::pair<Key, T> > buffer;
-          ::imxx::distribute(input, this->key_to_rank, recv_counts, i2o, buffer, this->comm);
-          input.swap(buffer);
+          if (hashes) {
+            this->distribute_hashed(input, hashed, recv_counts);
+          } else {
+            std::vector<size_t> i2o;
+            std::vector<::std::pair<Key, T> > buffer;
+            ::imxx::distribute(input, this->key_to_rank, recv_counts, i2o, buffer, this->comm);
+            input.swap(buffer);
+          }
+          this->record_recv_counts(input.size() + hashed.size());
 
 //          auto recv_counts = ::dsc::distribute(input, this->key_to_rank, sorted_input, this->comm);
 //          BLISS_UNUSED(recv_counts);
-          BL_BENCH_END(insert, "dist_data", input.size());
+          BL_BENCH_END(insert, "dist_data", input.size() + hashed.size());
         }
 
+        // solid key build:  drop the keys that the first pass counted too few times.
+        if (this->solid_threshold > 1) {
+          BL_BENCH_START(insert);
+          this->solid_filter_local(input);
+          this->solid_filter_hashed(hashed);
+          BL_BENCH_END(insert, "solid_filter", input.size() + hashed.size());
+        }
 
         //
         //        // after communication, sort again to keep unique  - may not be needed
@@ -1733,7 +2678,9 @@ namespace dsc  // distributed std container
         // local compute part.  called by the communicator.
         BL_BENCH_START(insert);
         size_t count = 0;
-        if (!::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value)
+        if (hashes)
+          count = this->local_insert_hashed(hashed);
+        else if (!::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value)
           count = this->local_insert(input.begin(), input.end(), pred);
         else
           count = this->local_insert(input.begin(), input.end());
@@ -1745,6 +2692,31 @@ namespace dsc  // distributed std container
       }
 
 
+      /**
+       * @brief pipelined insert.  posts the distribution of this chunk and locally inserts the previous chunk while this one is in flight.
+       * @details  intended for chunked construction (parse chunk i+1 while chunk i is in flight and chunk i-1 is inserted).
+       *          call insert_flush() after the last chunk, before any query.  no predicate support.
+       *          with skew mitigation, the elements of each hot key in a chunk are reduced to 1 before sending, as in insert.
+       * @note  COLLECTIVE.  input is consumed.
+       */
+      size_t insert_async(std::vector<::std::pair<Key, T> >& input) {
+        return this->insert_async_impl(input, this->pipe, [this](std::vector<::std::pair<Key, T> > & v){
+          this->solid_filter_local(v);
+          return this->local_insert(v.begin(), v.end());
+        }, [this](std::vector<::std::pair<Key, T> > & v){
+          if (this->skew_ratio > 0.0) this->combine_hot(v, this->r);
+        });
+      }
+
+      /// finish a pipelined insert.  see insert_async.  COLLECTIVE
+      size_t insert_flush() {
+        return this->insert_flush_impl(this->pipe, [this](std::vector<::std::pair<Key, T> > & v){
+          this->solid_filter_local(v);
+          return this->local_insert(v.begin(), v.end());
+        });
+      }
+
+
   };
 
 
@@ -1776,16 +2748,86 @@ namespace dsc  // distributed std container
    * @tparam Hash   hash function for local and distribution.  requires a template arugment (Key), and a bool (prefix, chooses the MSBs of hash instead of LSBs)
    * @tparam Equal   default to ::std::equal_to<Key>   equal function for the local storage.
    * @tparam Alloc  default to ::std::allocator< ::std::pair<const Key, T> >    allocator for local storage.
+   * @tparam Container  default to ::std::unordered_map.   local storage.  ::fsc::thread_partitioned<...>::type for multithreaded local storage.
    */
   template<typename Key, typename T,
   template <typename> class MapParams,
-  class Alloc = ::std::allocator< ::std::pair<const Key, T> >
+  class Alloc = ::std::allocator< ::std::pair<const Key, T> >,
+  template <typename, typename, typename, typename, typename...> class Container = ::std::unordered_map
   >
-  class counting_unordered_map : public reduction_unordered_map<Key, T, MapParams, ::std::plus<T>, Alloc> {
+  class counting_unordered_map : public reduction_unordered_map<Key, T, MapParams, ::std::plus<T>, Alloc, Container> {
       static_assert(::std::is_integral<T>::value, "count type has to be integral");
 
     protected:
-      using Base = reduction_unordered_map<Key, T, MapParams, ::std::plus<T>, Alloc>;
+      using Base = reduction_unordered_map<Key, T, MapParams, ::std::plus<T>, Alloc, Container>;
+
+      /// in-flight chunks for insert_async of raw keys
+      typename Base::template pipeline_buffers< Key > key_pipe;
+
+      /// insert distributed keys into the local container, each with count 1.
+      size_t local_insert_keys(std::vector< Key > & input) {
+        this->solid_filter_local(input);
+
+        auto trans = [](Key const & x) {
+          return ::std::make_pair(x, T(1));
+        };
+        auto local_start = ::bliss::iterator::make_transform_iterator(input.begin(), trans);
+        auto local_end = ::bliss::iterator::make_transform_iterator(input.end(), trans);
+        return this->Base::local_insert(local_start, local_end);
+      }
+
+      /// remove the elements of the local heavy hitters from input, and count them into hot_counts instead.
+      void combine_hot_keys(std::vector< Key > & input, std::vector<::std::pair<Key, T> > & hot_counts) const {
+        hot_counts.clear();
+
+        typename Base::HotKeySet hot;
+        this->find_hot_keys(input, hot);
+        if (hot.empty()) return;
+
+        ::std::unordered_map<Key, T, typename Base::StoreTransformedFarmHash, typename Base::StoreTransformedEqual> counts(hot.size());
+        size_t out = 0;
+        for (size_t i = 0; i < input.size(); ++i) {
+          if (hot.find(input[i]) != hot.end()) ++counts[input[i]];
+          else input[out++] = input[i];
+        }
+        input.resize(out);
+        hot_counts.assign(counts.begin(), counts.end());
+      }
+
+      /// count duplicate keys locally into combined:  all of them with the local combiner, else only the hot keys.
+      void combine_keys(std::vector< Key > & input, std::vector<::std::pair<Key, T> > & combined) const {
+        if (this->combiner_capacity == 0) {
+          combine_hot_keys(input, combined);
+          return;
+        }
+        combined.clear();
+        typename Base::template LocalCombinerType<T> combiner(this->combiner_capacity);
+        combiner.combine(input, combined);
+      }
+
+      /// send keys or key-count pairs to their owners, and count them into the owners' solid filters.  COLLECTIVE
+      template <typename V>
+      void sketch_dist(std::vector<V> & input) {
+        if (this->comm.size() > 1) {
+          std::vector<size_t> recv_counts;
+          std::vector<size_t> i2o;
+          std::vector< V > buffer;
+          ::imxx::distribute(input, this->key_to_rank, recv_counts, i2o, buffer, this->comm);
+          input.swap(buffer);
+        }
+        this->solid_update_local(input);
+      }
+
+      /// predicate for erasing the entries counted fewer than threshold times.
+      struct BelowCount {
+          T threshold;
+          BelowCount(T const & _threshold) : threshold(_threshold) {}
+
+          template <typename Iter>
+          bool operator()(Iter, Iter) const { return true; }
+          template <typename V>
+          bool operator()(V const & x) const { return x.second < threshold; }
+      };
 
     public:
       using local_container_type = typename Base::local_container_type;
@@ -1813,11 +2855,129 @@ namespace dsc  // distributed std container
       virtual ~counting_unordered_map() {};
 
       using Base::insert;
+      using Base::insert_async;
       using Base::count;
       using Base::find;
       using Base::erase;
       using Base::unique_size;
 
+      /**
+       * @brief configure a solid key build, which keeps only the keys that occur at least threshold times.  local, but use the same values on all ranks.
+       * @details  a first pass counts the input into a counting Bloom filter on each key's owner (sketch), then the second
+       *           pass (insert, insert_async) drops the keys that the filter counted fewer than threshold times before they
+       *           reach the local container.  the filter takes counters / 2 bytes per rank.  about 8 counters per distinct
+       *           key on the rank keeps the false positives to a few percent, and solid_finish removes those.
+       * @param threshold  minimum occurrences, at most 15.  0 or 1 disables the filtering and frees the filter.
+       * @param counters   filter counters per rank, rounded up to a power of 2.
+       * @param hashes     filter counters per key.
+       */
+      void set_solid_filter(uint8_t threshold, size_t counters, uint8_t hashes = 3) {
+        if (threshold > Base::SolidFilterType::max_count) throw std::invalid_argument("solid threshold must be at most 15.");
+        if ((threshold > 1) && (counters == 0)) throw std::invalid_argument("solid filter needs at least 1 counter.");
+
+        this->solid_threshold = (threshold > 1) ? threshold : 0;
+        this->solid_filter = typename Base::SolidFilterType((this->solid_threshold > 1) ? counters : 0, hashes);
+      }
+
+      /**
+       * @brief first pass of a solid key build:  count keys, or key-count pairs, into the owners' solid filters.  nothing is inserted.
+       * @details  call set_solid_filter first, and sketch all of the input, possibly in chunks, before inserting any of it.
+       *           elements are sent as is.  for raw keys, the overload with a counts vector combines duplicates first.
+       * @note  COLLECTIVE.  input is consumed:  on return it holds the elements this rank owns, for insert_sketched.
+       * @return  number of elements counted on this rank.
+       */
+      template <typename V>
+      size_t sketch(std::vector< V >& input) {
+        if (this->solid_threshold < 2) throw std::logic_error("sketch needs set_solid_filter with a threshold of at least 2.");
+
+        BL_BENCH_INIT(sketch);
+
+        if (::dsc::empty(input, this->comm)) {
+          BL_BENCH_REPORT_MPI_NAMED(sketch, "count_hashmap:sketch", this->comm);
+          return 0;
+        }
+
+        BL_BENCH_START(sketch);
+        this->transform_input(input);
+        BL_BENCH_END(sketch, "transform_input", input.size());
+
+        BL_BENCH_START(sketch);
+        this->sketch_dist(input);
+        BL_BENCH_END(sketch, "dist_update", input.size());
+
+        BL_BENCH_REPORT_MPI_NAMED(sketch, "count_hashmap:sketch", this->comm);
+
+        return input.size();
+      }
+
+      /**
+       * @brief first pass of a solid key build for raw keys.  duplicates are counted locally before sending, as in insert.
+       * @note  COLLECTIVE.  input is consumed:  on return, input holds the raw keys this rank owns, and counts the
+       *        combined (key, count) pairs it owns.  pass both to insert_sketched.
+       * @return  number of elements counted on this rank.
+       */
+      size_t sketch(std::vector< Key >& input, std::vector<::std::pair<Key, T> >& counts) {
+        if (this->solid_threshold < 2) throw std::logic_error("sketch needs set_solid_filter with a threshold of at least 2.");
+
+        BL_BENCH_INIT(sketch);
+
+        counts.clear();
+        if (::dsc::empty(input, this->comm)) {
+          BL_BENCH_REPORT_MPI_NAMED(sketch, "count_hashmap:sketch_key", this->comm);
+          return 0;
+        }
+
+        BL_BENCH_START(sketch);
+        this->transform_input(input);
+        BL_BENCH_END(sketch, "transform_input", input.size());
+
+        BL_BENCH_START(sketch);
+        if ((this->comm.size() > 1) && ((this->combiner_capacity > 0) || (this->skew_ratio > 0.0)))
+          this->combine_keys(input, counts);
+        BL_BENCH_END(sketch, "combine", counts.size());
+
+        BL_BENCH_START(sketch);
+        this->sketch_dist(input);
+        this->sketch_dist(counts);
+        BL_BENCH_END(sketch, "dist_update", input.size() + counts.size());
+
+        BL_BENCH_REPORT_MPI_NAMED(sketch, "count_hashmap:sketch_key", this->comm);
+
+        return input.size() + counts.size();
+      }
+
+      /**
+       * @brief second pass of a solid key build for the output of sketch:  the elements are already on their owners,
+       *        so they are inserted locally, without another distribute.  the solid filter drops the rare ones.
+       * @note  local.  input is consumed.
+       * @return  number of elements inserted.
+       */
+      template <typename V>
+      size_t insert_sketched(std::vector< V >& input) {
+        this->solid_filter_local(input);
+        return this->Base::local_insert(input.begin(), input.end());
+      }
+      size_t insert_sketched(std::vector< Key >& input) {
+        return this->local_insert_keys(input);
+      }
+      /// insert the raw keys and the key-count pairs from the combining sketch overload.  local.  input and counts are consumed.
+      size_t insert_sketched(std::vector< Key >& input, std::vector<::std::pair<Key, T> >& counts) {
+        return this->insert_sketched(input) + this->insert_sketched(counts);
+      }
+
+      /**
+       * @brief end a solid key build:  erase the entries counted fewer than threshold times, which the filter's false
+       *        positives let through, then free the filter.  afterwards, inserts are not filtered.
+       * @note  COLLECTIVE
+       * @return  number of entries erased on this rank.
+       */
+      size_t solid_finish() {
+        size_t erased = 0;
+        if (this->solid_threshold > 1) erased = this->erase(BelowCount(this->solid_threshold));
+        this->set_solid_filter(0, 0);
+        return erased;
+      }
+
       /**
        * @brief insert new elements in the distributed unordered_multimap.
        * @param first
@@ -1839,20 +2999,65 @@ namespace dsc  // distributed std container
         this->transform_input(input);
         BL_BENCH_END(insert, "transform_input", input.size());
 
+        // duplicate keys are counted locally, and sent as (key, count) pairs.
+        bool combine = ::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value &&
+            ((this->combiner_capacity > 0) || (this->skew_ratio > 0.0));
+        std::vector<::std::pair<Key, T> > combined;
+
+        // single hash mode:  the keys and the pairs carry their hashes.
+        bool hashes = this->send_hashes() && ::std::is_same<Predicate, ::bliss::filter::TruePredicate>::value;
+        std::vector<typename Base::template Hashed< Key > > hashed;
+        std::vector<typename Base::template Hashed<::std::pair<Key, T> > > hashed_combined;
+
         // then send the raw k-mers.
         // communication part
         if (this->comm.size() > 1) {
+          BL_BENCH_START(insert);
+          if (combine) this->combine_keys(input, combined);
+          BL_BENCH_END(insert, "combine", combined.size());
+
           BL_BENCH_START(insert);
           // first remove duplicates.  sort, then get unique, finally remove the rest.  may not be needed
           std::vector<size_t> recv_counts;
-          std::vector<size_t> i2o;
-          std::vector< Key > buffer;
-          ::imxx::distribute(input, this->key_to_rank, recv_counts, i2o, buffer, this->comm);
-          input.swap(buffer);
+          if (hashes) {
+            this->distribute_hashed(input, hashed, recv_counts);
+            if (combine) this->distribute_hashed(combined, hashed_combined, recv_counts);
+          } else {
+            std::vector<size_t> i2o;
+            std::vector< Key > buffer;
+            ::imxx::distribute(input, this->key_to_rank, recv_counts, i2o, buffer, this->comm);
+            input.swap(buffer);
+
+            if (combine) {
+              std::vector<::std::pair<Key, T> > combined_buffer;
+              ::imxx::distribute(combined, this->key_to_rank, recv_counts, i2o, combined_buffer, this->comm);
+              combined.swap(combined_buffer);
+            }
+          }
+          this->record_recv_counts(input.size() + combined.size() + hashed.size() + hashed_combined.size());
 
-          BL_BENCH_END(insert, "dist_data", input.size());
+          BL_BENCH_END(insert, "dist_data", input.size() + hashed.size());
+        }
+
+        // solid key build:  drop the keys that the first pass counted too few times.
+        if (this->solid_threshold > 1) {
+          BL_BENCH_START(insert);
+          this->solid_filter_local(input);
+          this->solid_filter_local(combined);
+          this->solid_filter_hashed(hashed);
+          this->solid_filter_hashed(hashed_combined);
+          BL_BENCH_END(insert, "solid_filter", input.size() + combined.size() + hashed.size() + hashed_combined.size());
         }
 
+        if (hashes) {
+          BL_BENCH_START(insert);
+          size_t count = this->local_insert_hashed(hashed);
+          count += this->local_insert_hashed(hashed_combined);
+          BL_BENCH_END(insert, "local_insert", this->local_size());
+
+          BL_BENCH_REPORT_MPI_NAMED(insert, "count_hashmap:insert_key", this->comm);
+          return count;
+        }
 
           size_t count = 0;
           auto trans = [](Key const & x) {
@@ -1874,6 +3079,8 @@ namespace dsc  // distributed std container
             count += this->Base::local_insert(local_start, local_end, pred);
           else
             count += this->Base::local_insert(local_start, local_end);
+          if (!combined.empty())
+            count += this->Base::local_insert(combined.begin(), combined.end());
         BL_BENCH_END(insert, "local_insert", this->local_size());
 
 
@@ -1884,6 +3091,51 @@ namespace dsc  // distributed std container
       }
 
 
+      /**
+       * @brief pipelined insert of raw keys.  see unordered_map::insert_async.  call insert_flush() after the last chunk.
+       * @details  as in insert, duplicate keys of each chunk are counted locally first:  all of them with the local combiner,
+       *           else the hot keys with skew mitigation.  the (key, count) pairs go through their own pipeline, next to the
+       *           remaining raw keys.
+       * @note  COLLECTIVE.  input is consumed.
+       */
+      size_t insert_async(std::vector< Key >& input) {
+        auto t = ::std::chrono::steady_clock::now();
+        ++this->key_pipe.chunks;
+
+        this->transform_input(input);
+
+        bool combine = (this->comm.size() > 1) && ((this->combiner_capacity > 0) || (this->skew_ratio > 0.0));
+        std::vector<::std::pair<Key, T> > combined;
+        if (combine) this->combine_keys(input, combined);
+        this->key_pipe.add_stat(this->key_pipe.TRANSFORM, t, input.size() + combined.size());
+
+        size_t count = this->insert_async_step(input, this->key_pipe, this->key_to_rank, [this](std::vector< Key > & v){
+          return this->local_insert_keys(v);
+        });
+        if (combine) {
+          ++this->pipe.chunks;
+          count += this->insert_async_step(combined, this->pipe, this->key_to_rank, [this](std::vector<::std::pair<Key, T> > & v){
+            return this->insert_sketched(v);
+          });
+        }
+        return count;
+      }
+
+      /// finish a pipelined insert, for both key and key-count pair inputs.  COLLECTIVE
+      size_t insert_flush() {
+        bool keys = this->key_pipe.chunks > 0;
+        bool pairs = this->pipe.chunks > 0;
+        size_t count = this->insert_flush_impl(this->key_pipe, [this](std::vector< Key > & v){
+          return this->local_insert_keys(v);
+        }, "count_hashmap:insert_async_key");
+        size_t received = this->recv_local;
+        count += Base::insert_flush();
+        // each flush records its own pipeline.  this rank received from both.
+        if (keys && pairs) this->record_recv_counts(received + this->recv_local);
+        return count;
+      }
+
+
   };
 
 
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    dsc_local_combiner.hpp
+ * @ingroup
+ * @author  tpan
+ * @brief   adaptive local pre-aggregation of keys into (key, count) pairs, with a bounded hash table.
+ * @details counting maps send every key occurrence to its owner.  the combiner counts duplicates locally first, so that
+ *          a key occurring c times in a window is sent once, as (key, c).
+ *
+ *          the table has a fixed capacity that fits in cache.  it is flushed to the output when it is half full, so a
+ *          key may be emitted more than once, with partial counts that sum to its count.
+ *
+ *          the input is processed in chunks of capacity keys.  the first 1/8 of a chunk always goes through the table,
+ *          and the duplication ratio observed on it (keys in / new table entries) decides the rest of the chunk:
+ *          combined if the ratio reaches min_ratio, or passed through as raw keys otherwise.  a pair is larger than a
+ *          key, so for communication min_ratio defaults to sizeof(pair) / sizeof(key).
+ */
+#ifndef SRC_CONTAINERS_DSC_LOCAL_COMBINER_HPP_
+#define SRC_CONTAINERS_DSC_LOCAL_COMBINER_HPP_
+
+#include <vector>
+#include <utility>  // pair
+#include <functional>  // hash, equal_to
+#include <algorithm>  // min, max
+#include <limits>
+#include <cstdint>
+#include <stdexcept>  // invalid_argument
+
+
+namespace dsc {
+
+  /**
+   * @brief  bounded, adaptive key combiner.  see file description.
+   * @tparam Count  count type.  a count that reaches its maximum is emitted, and restarted at 1.
+   */
+  template <typename Key, typename Count, typename Hash = ::std::hash<Key>, typename Equal = ::std::equal_to<Key> >
+  class local_combiner {
+
+    protected:
+      Hash hash;
+      Equal eq;
+
+      ::std::vector<::std::pair<Key, Count> > slots;
+      ::std::vector<uint8_t> used;
+      /// used slots, for flushing without scanning the table.
+      ::std::vector<size_t> occupied;
+      /// capacity - 1.  capacity is a power of 2.
+      size_t mask;
+
+      double min_ratio;
+
+      /// statistics of the last combine call.
+      size_t keys_in;
+      size_t pairs_out;
+      size_t raw_out;
+      size_t combined_chunks;
+      size_t raw_chunks;
+
+      /// 64 bit finalizer from murmur3.  the key hash may be weak, e.g. std::hash on integers.
+      static inline uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+      }
+
+      /// emit the table content to out, and empty the table.
+      void flush(::std::vector<::std::pair<Key, Count> > & out) {
+        for (auto it = occupied.begin(); it != occupied.end(); ++it) {
+          out.emplace_back(slots[*it]);
+          used[*it] = 0;
+        }
+        pairs_out += occupied.size();
+        occupied.clear();
+      }
+
+      /// count key in the table.  returns true if it took a new slot.
+      inline bool add(Key const & key, ::std::vector<::std::pair<Key, Count> > & out) {
+        size_t i = mix(static_cast<uint64_t>(hash(key))) & mask;
+        while (used[i]) {
+          if (eq(slots[i].first, key)) {
+            if (slots[i].second == ::std::numeric_limits<Count>::max()) {
+              out.emplace_back(slots[i]);
+              ++pairs_out;
+              slots[i].second = 1;
+            } else {
+              ++slots[i].second;
+            }
+            return false;
+          }
+          i = (i + 1) & mask;
+        }
+
+        used[i] = 1;
+        slots[i] = ::std::make_pair(key, Count(1));
+        occupied.emplace_back(i);
+
+        // keep the probe sequences short.
+        if ((occupied.size() << 1) > mask) flush(out);
+        return true;
+      }
+
+    public:
+      /// default table capacity.  2^15 slots, so a table of 16 byte pairs is 512KB.
+      static constexpr size_t default_capacity = 1UL << 15;
+
+      /**
+       * @param capacity    table slots.  rounded up to a power of 2.  also the chunk size.
+       * @param _min_ratio  minimum duplication ratio for combining a chunk.
+       */
+      local_combiner(size_t capacity = default_capacity,
+                     double _min_ratio = static_cast<double>(sizeof(::std::pair<Key, Count>)) / static_cast<double>(sizeof(Key)),
+                     Hash const & _hash = Hash(), Equal const & _eq = Equal()) :
+        hash(_hash), eq(_eq), mask(0), min_ratio(_min_ratio),
+        keys_in(0), pairs_out(0), raw_out(0), combined_chunks(0), raw_chunks(0) {
+        if (capacity < 16) throw ::std::invalid_argument("local_combiner capacity must be at least 16.");
+
+        size_t w = 1;
+        while (w < capacity) w <<= 1;
+        mask = w - 1;
+        slots.resize(w);
+        used.resize(w, 0);
+        occupied.reserve(w >> 1);
+      }
+
+      /**
+       * @brief combine the keys in [first, last).
+       * @param out     (key, count) pairs are appended here.
+       * @param raw     output iterator for the keys of chunks that were not combined, in input order.
+       * @return        raw after the last key written.
+       */
+      template <typename Iter, typename RawIter>
+      RawIter combine(Iter first, Iter last, ::std::vector<::std::pair<Key, Count> > & out, RawIter raw) {
+        keys_in = 0;
+        pairs_out = 0;
+        raw_out = 0;
+        combined_chunks = 0;
+        raw_chunks = 0;
+
+        size_t chunk = mask + 1;
+        size_t sample = chunk >> 3;
+
+        while (first != last) {
+          // sample the start of the chunk.
+          size_t n = 0;
+          size_t added = 0;
+          for (; (first != last) && (n < sample); ++first, ++n) {
+            if (add(*first, out)) ++added;
+          }
+
+          double ratio = static_cast<double>(n) / static_cast<double>(::std::max(added, static_cast<size_t>(1)));
+          if (ratio >= min_ratio) {
+            for (; (first != last) && (n < chunk); ++first, ++n) add(*first, out);
+            ++combined_chunks;
+          } else {
+            size_t m = n;
+            for (; (first != last) && (n < chunk); ++first, ++n, ++raw) *raw = *first;
+            raw_out += n - m;
+            ++raw_chunks;
+          }
+          keys_in += n;
+        }
+        flush(out);
+
+        return raw;
+      }
+
+      /**
+       * @brief combine input in place.  the keys that were not combined stay in input, in order.
+       * @return number of keys combined.
+       */
+      size_t combine(::std::vector<Key> & input, ::std::vector<::std::pair<Key, Count> > & out) {
+        auto end = combine(input.begin(), input.end(), out, input.begin());  // raw keys are written behind the reads.
+        size_t n = input.size();
+        input.erase(end, input.end());
+        return n - input.size();
+      }
+
+      /// number of input keys in the last combine.
+      size_t input_count() const { return keys_in; }
+      /// number of pairs emitted by the last combine.
+      size_t pair_count() const { return pairs_out; }
+      /// number of keys passed through by the last combine.
+      size_t raw_count() const { return raw_out; }
+      /// chunks combined, and passed through, in the last combine.
+      size_t combined_chunk_count() const { return combined_chunks; }
+      size_t raw_chunk_count() const { return raw_chunks; }
+
+      /// reduction in elements of the last combine:  input keys / (pairs + raw keys).  1 if nothing was combined.
+      double reduction() const {
+        size_t out = pairs_out + raw_out;
+        return (out == 0) ? 1.0 : static_cast<double>(keys_in) / static_cast<double>(out);
+      }
+  };
+
+}  // namespace dsc
+
+#endif /* SRC_CONTAINERS_DSC_LOCAL_COMBINER_HPP_ */
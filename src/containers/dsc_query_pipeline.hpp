@@ -0,0 +1,225 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    dsc_query_pipeline.hpp
+ * @ingroup
+ * @author  tpan
+ * @brief   pipelined exchange of query responses between processes, with k in-flight slots.
+ * @details after the queries are distributed, each process holds the queries from every source process.  the responses
+ *          are computed and sent back in ring order:  in round i, process r computes the responses for (r + i) % p into
+ *          one of k send slots and sends them, and receives the responses from (r - i) % p.  a send slot is reused only
+ *          after its send from k rounds ago completes, so computing the responses of round i overlaps with the
+ *          transfers of the previous k - 1 rounds.
+ *
+ *          receives are posted early:  all of them when the responses go to a preallocated output, or k rounds ahead
+ *          when they go to k receive slots and are passed to a consumer.
+ *
+ *          k = 2 is the scheme of the original find_overlap.  a memory cap in bytes lowers k so that the slots fit.
+ */
+#ifndef SRC_CONTAINERS_DSC_QUERY_PIPELINE_HPP_
+#define SRC_CONTAINERS_DSC_QUERY_PIPELINE_HPP_
+
+#include <vector>
+#include <algorithm>  // max_element, min, max
+#include <chrono>
+#include <stdexcept>  // invalid_argument
+
+#include <mxx/comm.hpp>
+#include <mxx/datatypes.hpp>
+
+namespace dsc {
+
+  /**
+   * @brief  pipelined response exchange.  see file description.
+   * @tparam V  response type.  must have an mxx datatype.
+   */
+  template <typename V>
+  class query_pipeline {
+    protected:
+      ::mxx::comm const & comm;
+
+      /// requested in-flight slots.
+      size_t slots;
+      /// memory cap for the slots, in bytes.  0 for no cap.
+      size_t max_bytes;
+
+      /// time in produce, in MPI_Wait, and in the whole exchange, for the last exchange.
+      double compute_secs;
+      double wait_secs;
+      double total_secs;
+      /// slots used by the last exchange.
+      size_t used_slots;
+
+      using clock = ::std::chrono::steady_clock;
+
+      static inline double elapsed(clock::time_point const & start) {
+        return ::std::chrono::duration_cast<::std::chrono::duration<double> >(clock::now() - start).count();
+      }
+
+      inline void wait(MPI_Request & req) {
+        auto t = clock::now();
+        MPI_Wait(&req, MPI_STATUS_IGNORE);
+        wait_secs += elapsed(t);
+      }
+
+      /// slots that fit in the memory cap, at least 1 and at most p.
+      size_t fit_slots(size_t slot_bytes) const {
+        size_t k = ::std::min(slots, static_cast<size_t>(comm.size()));
+        if ((max_bytes > 0) && (slot_bytes > 0)) k = ::std::min(k, ::std::max(static_cast<size_t>(1), max_bytes / slot_bytes));
+        return k;
+      }
+
+      /**
+       * @brief the ring.  responses for round j are received at recv_ptr(j).  receives are posted window rounds ahead.
+       *        after round j's receive completes, consume(j) is called, and the receive for round j + window is posted.
+       */
+      template <typename Produce, typename RecvPtr, typename Consume>
+      size_t run(::std::vector<size_t> const & send_counts, ::std::vector<size_t> const & recv_counts,
+                 size_t k, size_t window, Produce & produce, RecvPtr recv_ptr, Consume consume) {
+        auto start = clock::now();
+        compute_secs = 0.0;
+        wait_secs = 0.0;
+        used_slots = k;
+
+        int p = comm.size();
+        int rank = comm.rank();
+        ::mxx::datatype dt = ::mxx::get_datatype<V>();
+
+        size_t max_send_count = *(::std::max_element(send_counts.begin(), send_counts.end()));
+        ::std::vector<V> local_results(k * max_send_count);
+
+        ::std::vector<MPI_Request> recv_reqs(p, MPI_REQUEST_NULL);
+        ::std::vector<MPI_Request> send_reqs(p, MPI_REQUEST_NULL);
+
+        auto post_recv = [&](int j) {
+          int recv_from = (rank + (p - j)) % p;
+          MPI_Irecv(recv_ptr(j), recv_counts[recv_from], dt.type(), recv_from, j, comm, &recv_reqs[j]);
+        };
+        auto finish_recv = [&](int j) {
+          wait(recv_reqs[j]);
+          consume(j);
+          if ((j + static_cast<int>(window)) < p) post_recv(j + window);
+        };
+
+        for (int j = 0; j < ::std::min(p, static_cast<int>(window)); ++j) post_recv(j);
+
+        size_t total = 0;
+        for (int i = 0; i < p; ++i) {
+          int send_to = (rank + i) % p;
+          V * slot = local_results.data() + (i % k) * max_send_count;
+
+          // slot is free once its send from k rounds ago completes.
+          if (i >= static_cast<int>(k)) wait(send_reqs[i - k]);
+
+          auto t = clock::now();
+          size_t found = produce(send_to, slot);
+          compute_secs += elapsed(t);
+          total += found;
+
+          MPI_Isend(slot, found, dt.type(), send_to, i, comm, &send_reqs[i]);
+
+          // responses from k - 1 rounds ago.
+          if (i >= static_cast<int>(k - 1)) finish_recv(i - (k - 1));
+        }
+        for (int j = ::std::max(0, p - static_cast<int>(k - 1)); j < p; ++j) finish_recv(j);
+
+        auto t = clock::now();
+        MPI_Waitall(p, send_reqs.data(), MPI_STATUSES_IGNORE);
+        wait_secs += elapsed(t);
+
+        total_secs = elapsed(start);
+        return total;
+      }
+
+    public:
+      /**
+       * @param _slots      number of in-flight send (and receive) slots.  at least 1.
+       * @param _max_bytes  memory cap for the slots, in bytes.  0 for no cap.
+       */
+      query_pipeline(::mxx::comm const & _comm, size_t _slots = 2, size_t _max_bytes = 0) :
+        comm(_comm), slots(_slots), max_bytes(_max_bytes),
+        compute_secs(0.0), wait_secs(0.0), total_secs(0.0), used_slots(0) {
+        if (slots == 0) throw ::std::invalid_argument("query_pipeline needs at least 1 slot.");
+      }
+
+      /**
+       * @brief  compute and exchange responses.  received responses are written to out, in source rank order.
+       * @param send_counts   maximum number of responses for each destination.  sizes the send slots.
+       * @param recv_counts   exact number of responses from each source.
+       * @param produce       produce(dest_rank, V* out) writes the responses for dest_rank and returns their count.
+       * @param out           room for the sum of recv_counts.
+       * @return              number of responses sent.
+       */
+      template <typename Produce>
+      size_t exchange(::std::vector<size_t> const & send_counts, ::std::vector<size_t> const & recv_counts,
+                      Produce produce, V * out) {
+        size_t max_send_count = *(::std::max_element(send_counts.begin(), send_counts.end()));
+        size_t k = fit_slots(max_send_count * sizeof(V));
+
+        ::std::vector<size_t> recv_displs(recv_counts.size(), 0);
+        for (size_t i = 1; i < recv_counts.size(); ++i) recv_displs[i] = recv_displs[i - 1] + recv_counts[i - 1];
+
+        int p = comm.size();
+        int rank = comm.rank();
+        return run(send_counts, recv_counts, k, p, produce,
+                   [&](int j) { return out + recv_displs[(rank + (p - j)) % p]; },
+                   [](int) {});
+      }
+
+      /**
+       * @brief  compute and exchange responses.  received responses go to k receive slots, and are passed to
+       *         consume(src_rank, V const * first, V const * last) in ring order.
+       * @return number of responses sent.
+       */
+      template <typename Produce, typename Consume>
+      size_t exchange(::std::vector<size_t> const & send_counts, ::std::vector<size_t> const & recv_counts,
+                      Produce produce, Consume & consume) {
+        size_t max_send_count = *(::std::max_element(send_counts.begin(), send_counts.end()));
+        size_t max_recv_count = *(::std::max_element(recv_counts.begin(), recv_counts.end()));
+        size_t k = fit_slots((max_send_count + max_recv_count) * sizeof(V));
+
+        ::std::vector<V> results(k * max_recv_count);
+
+        int p = comm.size();
+        int rank = comm.rank();
+        return run(send_counts, recv_counts, k, k, produce,
+                   [&](int j) { return results.data() + (j % k) * max_recv_count; },
+                   [&](int j) {
+                      int src = (rank + (p - j)) % p;
+                      V const * first = results.data() + (j % k) * max_recv_count;
+                      consume(src, first, first + recv_counts[src]);
+                   });
+      }
+
+      /// time spent computing responses in the last exchange.
+      double compute_time() const { return compute_secs; }
+      /// time spent waiting for transfers in the last exchange.
+      double wait_time() const { return wait_secs; }
+      /// time of the last exchange.
+      double total_time() const { return total_secs; }
+      /// slots used by the last exchange, after the memory cap.
+      size_t slot_count() const { return used_slots; }
+
+      /// fraction of the last exchange not spent waiting for transfers.  1 when communication is fully hidden.
+      double overlap_efficiency() const {
+        return (total_secs > 0.0) ? (1.0 - wait_secs / total_secs) : 1.0;
+      }
+  };
+
+}  // namespace dsc
+
+#endif /* SRC_CONTAINERS_DSC_QUERY_PIPELINE_HPP_ */
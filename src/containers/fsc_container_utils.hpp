@@ -26,11 +26,15 @@
 #define SRC_CONTAINERS_FSC_CONTAINER_UTILS_HPP_
 
 #include <iterator>  // iterator_traits
+#include <type_traits>  // integral_constant
+#include <utility>  // declval, pair
+#include <cstdint>
 #include <unordered_set>
 #include <algorithm>  // upper bound, unique, sort, etc.
 
 #include "utils/benchmark_utils.hpp"
 #include "utils/filter_utils.hpp"
+#include "containers/fsc_radix_sort.hpp"
 
 namespace fsc {
 
@@ -63,11 +67,79 @@ namespace fsc {
 
 
 
+  /// number of keys a hash functor's batch interface hashes at a time.  1 if it has no batch_size member (e.g. std::hash).
+  template <typename Hash, typename = void>
+  struct hash_batch_size : public ::std::integral_constant<uint8_t, 1> {};
+  template <typename Hash>
+  struct hash_batch_size<Hash, typename ::std::enable_if<(Hash::batch_size > 0)>::type> :
+    public ::std::integral_constant<uint8_t, Hash::batch_size> {};
+
+  /// whether a container has a prefetch(key) hint, e.g. swiss_map.
+  template <typename C, typename = void>
+  struct has_prefetch : public ::std::false_type {};
+  template <typename C>
+  struct has_prefetch<C, decltype(::std::declval<C const &>().prefetch(::std::declval<typename C::key_type const &>()))> :
+    public ::std::true_type {};
+
+  /// whether a container takes precomputed hashes:  insert(v, h), find(key, h), count(key, h) and prefetch(key, h), e.g. swiss_map.
+  template <typename C, typename = void>
+  struct has_hashed_lookup : public ::std::false_type {};
+  template <typename C>
+  struct has_hashed_lookup<C, decltype(::std::declval<C const &>().prefetch(::std::declval<typename C::key_type const &>(),
+                                                                            ::std::declval<uint64_t>()))> :
+    public ::std::true_type {};
+
+  namespace detail {
+    template <typename Key>
+    inline Key const & get_key(Key const & x) { return x; }
+    template <typename Key, typename V>
+    inline Key const & get_key(::std::pair<Key, V> const & x) { return x.first; }
+    template <typename Key, typename V>
+    inline Key const & get_key(::std::pair<const Key, V> const & x) { return x.first; }
+  }
+
+  /**
+   * @brief call op on each element of [first, last) in order, with db.prefetch on the key distance elements ahead.
+   * @details software pipelined lookups:  up to distance cache misses on db are in flight, instead of 1 at a time.
+   *          for lookups that go through per-element functors and cannot use a container's batched calls.
+   */
+  template <typename DB, typename Iter, typename Op>
+  inline void prefetch_for_each(DB const & db, Iter first, Iter last, Op op, size_t distance = 16) {
+    Iter ahead = first;
+    for (size_t i = 0; (i < distance) && (ahead != last); ++i, ++ahead) db.prefetch(detail::get_key(*ahead));
+    for (; first != last; ++first) {
+      if (ahead != last) {
+        db.prefetch(detail::get_key(*ahead));
+        ++ahead;
+      }
+      op(*first);
+    }
+  }
+
+  /**
+   * @brief prefetch_for_each for (element, hash) pairs:  the prefetch uses the precomputed hash.  see has_hashed_lookup
+   */
+  template <typename DB, typename Iter, typename Op>
+  inline void prefetch_for_each_hashed(DB const & db, Iter first, Iter last, Op op, size_t distance = 16) {
+    Iter ahead = first;
+    for (size_t i = 0; (i < distance) && (ahead != last); ++i, ++ahead) db.prefetch(detail::get_key((*ahead).first), (*ahead).second);
+    for (; first != last; ++first) {
+      if (ahead != last) {
+        db.prefetch(detail::get_key((*ahead).first), (*ahead).second);
+        ++ahead;
+      }
+      op(*first);
+    }
+  }
+
   template <typename Key, template <typename> class Hash, template <typename> class Transform>
   struct TransformedHash {
       Hash<Key> h;
       Transform<Key> trans;
 
+      /// forwarded from Hash.  callers that can, hash this many keys at a time via the batch operator.
+      static constexpr uint8_t batch_size = hash_batch_size<Hash<Key> >::value;
+
       TransformedHash(Hash<Key> const & _hash = Hash<Key>(),
     		  Transform<Key> const &_trans = Transform<Key>()) : h(_hash), trans(_trans) {};
 
@@ -82,7 +154,27 @@ namespace fsc {
       inline uint64_t operator()(::std::pair<const Key, V> const& x) const {
         return this->operator()(x.first);
       }
+
+      /// batch interface.  hash count (at most batch_size) keys or key-value pairs starting at first into out.
+      template <typename Iter>
+      inline void operator()(Iter first, size_t count, uint64_t * out) const {
+        this->batch(first, count, out, ::std::integral_constant<bool, (batch_size > 1)>());
+      }
+
+    protected:
+      template <typename Iter>
+      inline void batch(Iter first, size_t count, uint64_t * out, ::std::true_type const &) const {
+        Key keys[batch_size];
+        for (size_t i = 0; i < count; ++i, ++first) keys[i] = trans(detail::get_key(*first));
+        h(keys, count, out);
+      }
+      template <typename Iter>
+      inline void batch(Iter first, size_t count, uint64_t * out, ::std::false_type const &) const {
+        for (size_t i = 0; i < count; ++i, ++first) out[i] = this->operator()(*first);
+      }
   };
+  template <typename Key, template <typename> class Hash, template <typename> class Transform>
+  constexpr uint8_t TransformedHash<Key, Hash, Transform>::batch_size;
 
 
   template <typename Key, template <typename> class Predicate, template <typename> class Transform>
@@ -326,7 +418,7 @@ namespace fsc {
   template <typename V, typename Less>
   void sort(::std::vector<V> & input, bool & sorted_input,
                    const Less & less = Less()) {
-    if (!sorted_input) ::std::sort(input.begin(), input.end(), less);
+    if (!sorted_input) ::fsc::sort(input.begin(), input.end(), less);
 
     sorted_input = true;
   }
@@ -339,7 +431,7 @@ namespace fsc {
   void sorted_unique(::std::vector<V> & input, bool & sorted_input,
                    const Less & less = Less(), const Eq & equal = Eq()) {
     if (input.size() == 0) return;
-    if (!sorted_input) ::std::sort(input.begin(), input.end(), less);
+    if (!sorted_input) ::fsc::sort(input.begin(), input.end(), less);
     // then just get the unique stuff and remove rest.
     auto end = ::std::unique(input.begin(), input.end(), equal);
     input.erase(end, input.end());
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    fsc_count_min_sketch.hpp
+ * @ingroup fsc::containers
+ * @author  tpan
+ * @brief   count-min sketch, for finding heavy hitter keys in one pass with fixed memory.
+ * @details depth rows of width counters.  a key increments one counter per row, and its count is estimated as the
+ *          minimum of its counters.  the estimate never undercounts, and overcounts by at most e * n / width
+ *          with probability 1 - exp(-depth), for n updates.
+ *
+ *          updates are conservative:  only the counters at the current minimum are incremented, which lowers the
+ *          overcount without losing the lower bound.  so an update increases the estimate by exactly 1, and a
+ *          caller can detect a key reaching a threshold by comparing the returned estimate for equality.
+ *
+ *          the row positions are derived from one 64 bit hash of the key by double hashing.  the hash is mixed
+ *          first, so weak hash functions (e.g. std::hash on integers) are fine.
+ */
+#ifndef SRC_CONTAINERS_FSC_COUNT_MIN_SKETCH_HPP_
+#define SRC_CONTAINERS_FSC_COUNT_MIN_SKETCH_HPP_
+
+#include <vector>
+#include <functional>  // hash
+#include <algorithm>  // min, fill
+#include <limits>
+#include <cstdint>
+#include <stdexcept>  // invalid_argument
+
+
+namespace fsc {  // fast standard container
+
+  /**
+   * @brief  count-min sketch with conservative update.  see file description.
+   * @tparam Hash   hash function on Key.
+   * @tparam Count  counter type.  counters saturate at its maximum.
+   */
+  template <typename Key, typename Hash = ::std::hash<Key>, typename Count = uint32_t>
+  class count_min_sketch {
+
+    protected:
+      Hash hash;
+      /// counters, row major.
+      ::std::vector<Count> counts;
+      size_t depth;
+      /// width - 1.  width is a power of 2.
+      size_t mask;
+
+      /// 64 bit finalizer from murmur3.
+      static inline uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+      }
+
+      /// position of key in each row.
+      inline void positions(Key const & key, size_t * pos) const {
+        uint64_t h = mix(static_cast<uint64_t>(hash(key)));
+        uint64_t h1 = h;
+        uint64_t h2 = (h >> 32) | 1;  // odd, so rows do not repeat.
+        for (size_t i = 0; i < depth; ++i) {
+          pos[i] = i * (mask + 1) + ((h1 + i * h2) & mask);
+        }
+      }
+
+    public:
+      /// maximum number of rows.
+      static constexpr size_t max_depth = 8;
+
+      /**
+       * @param width   counters per row.  rounded up to a power of 2.
+       * @param _depth  number of rows, between 1 and max_depth.
+       */
+      count_min_sketch(size_t width, size_t _depth = 4, Hash const & _hash = Hash()) :
+        hash(_hash), depth(_depth), mask(0) {
+        if (width == 0) throw ::std::invalid_argument("count_min_sketch width must be positive.");
+        if ((depth == 0) || (depth > max_depth)) throw ::std::invalid_argument("count_min_sketch depth must be between 1 and max_depth.");
+
+        size_t w = 1;
+        while (w < width) w <<= 1;
+        mask = w - 1;
+        counts.resize(depth * w, 0);
+      }
+
+      /// add 1 to the count of key.  returns the new estimate.
+      Count update(Key const & key) {
+        size_t pos[max_depth] = {};
+        positions(key, pos);
+
+        Count est = counts[pos[0]];
+        for (size_t i = 1; i < depth; ++i) est = ::std::min(est, counts[pos[i]]);
+        if (est == ::std::numeric_limits<Count>::max()) return est;
+
+        // conservative update:  raise only the counters at the minimum.
+        for (size_t i = 0; i < depth; ++i) {
+          if (counts[pos[i]] == est) ++counts[pos[i]];
+        }
+        return est + 1;
+      }
+
+      /// estimated count of key.  at least the true count.
+      Count estimate(Key const & key) const {
+        size_t pos[max_depth] = {};
+        positions(key, pos);
+
+        Count est = counts[pos[0]];
+        for (size_t i = 1; i < depth; ++i) est = ::std::min(est, counts[pos[i]]);
+        return est;
+      }
+
+      void clear() {
+        ::std::fill(counts.begin(), counts.end(), 0);
+      }
+
+      size_t width() const { return mask + 1; }
+      size_t rows() const { return depth; }
+
+      /// memory used by the counters, in bytes.
+      size_t memory() const { return counts.size() * sizeof(Count); }
+  };
+
+}  // namespace fsc
+
+#endif /* SRC_CONTAINERS_FSC_COUNT_MIN_SKETCH_HPP_ */
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    fsc_counting_bloom_filter.hpp
+ * @ingroup fsc::containers
+ * @author  tpan
+ * @brief   counting Bloom filter with 4 bit saturating counters, for approximate occurrence counts in fixed memory.
+ * @details a key maps to hash_count counters, by double hashing on its mixed hash.  update raises only the smallest of
+ *          them (conservative update), and the estimate is the smallest counter.  the estimate is never below the true
+ *          count (capped at max_count), and is above it only when all of the key's counters are shared with other keys.
+ *
+ *          2 counters per byte, so 2^k counters take 2^(k-1) bytes.  for n distinct keys, 8n counters and 3 hashes give
+ *          a false positive rate of about 3% at threshold 2.
+ *
+ *          the hash is mixed first, so weak hash functions (e.g. std::hash on integers) are fine.
+ */
+#ifndef SRC_CONTAINERS_FSC_COUNTING_BLOOM_FILTER_HPP_
+#define SRC_CONTAINERS_FSC_COUNTING_BLOOM_FILTER_HPP_
+
+#include <vector>
+#include <functional>  // hash
+#include <algorithm>  // min, fill
+#include <cstdint>
+#include <stdexcept>  // invalid_argument
+
+
+namespace fsc {  // fast standard container
+
+  /**
+   * @brief  counting Bloom filter.  see file description.
+   * @tparam Hash   hash function on Key.
+   */
+  template <typename Key, typename Hash = ::std::hash<Key> >
+  class counting_bloom_filter {
+
+    protected:
+      Hash hash;
+      ::std::vector<uint8_t> counters;
+      /// counter count - 1.  the counter count is a power of 2.
+      size_t mask;
+      uint8_t hashes;
+
+      /// 64 bit finalizer from murmur3.
+      static inline uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+      }
+
+      inline uint8_t get(size_t i) const {
+        return (counters[i >> 1] >> ((i & 1) << 2)) & max_count;
+      }
+      inline void set(size_t i, uint8_t v) {
+        uint8_t shift = (i & 1) << 2;
+        counters[i >> 1] = (counters[i >> 1] & ~(max_count << shift)) | (v << shift);
+      }
+
+      /// the key's counter positions, in pos[0, hashes).  the step is odd, so the positions are distinct when hashes <= counter count.
+      inline void positions(Key const & key, size_t * pos) const {
+        uint64_t h = mix(static_cast<uint64_t>(hash(key)));
+        uint64_t step = ((h >> 32) | (h << 32)) | 1;
+        for (uint8_t i = 0; i < hashes; ++i, h += step) pos[i] = static_cast<size_t>(h) & mask;
+      }
+
+    public:
+      /// largest count a counter holds.  counts saturate there.
+      static constexpr uint8_t max_count = 15;
+      /// most hash functions per key.
+      static constexpr uint8_t max_hashes = 16;
+
+      /**
+       * @param _counters  number of counters, rounded up to a power of 2.  0 for an empty filter, to be resized before use.
+       * @param _hashes    counters per key, between 1 and max_hashes.
+       */
+      explicit counting_bloom_filter(size_t _counters = 0, uint8_t _hashes = 3, Hash const & _hash = Hash()) :
+        hash(_hash), mask(0), hashes(_hashes) {
+        if ((hashes == 0) || (hashes > max_hashes))
+          throw ::std::invalid_argument("counting bloom filter needs between 1 and max_hashes hash functions.");
+        resize(_counters);
+      }
+
+      /// reallocate with at least _counters counters, all 0.  0 frees the counters.
+      void resize(size_t _counters) {
+        if (_counters == 0) {
+          ::std::vector<uint8_t>().swap(counters);
+          mask = 0;
+          return;
+        }
+        size_t n = 2;
+        while (n < _counters) n <<= 1;
+        ::std::vector<uint8_t>(n >> 1, 0).swap(counters);
+        mask = n - 1;
+      }
+
+      /// add count occurrences of key.  returns the new estimate of its count.
+      inline uint8_t update(Key const & key, size_t count = 1) {
+        size_t pos[max_hashes] = {};
+        positions(key, pos);
+
+        uint8_t lo = max_count;
+        for (uint8_t i = 0; i < hashes; ++i) lo = ::std::min(lo, get(pos[i]));
+
+        // conservative update:  raise only the counters below the new minimum.
+        uint8_t v = static_cast<uint8_t>(::std::min(static_cast<size_t>(lo) + count, static_cast<size_t>(max_count)));
+        for (uint8_t i = 0; i < hashes; ++i) {
+          if (get(pos[i]) < v) set(pos[i], v);
+        }
+        return v;
+      }
+
+      /// estimated count of key, at least its true count, capped at max_count.
+      inline uint8_t estimate(Key const & key) const {
+        size_t pos[max_hashes] = {};
+        positions(key, pos);
+
+        uint8_t lo = max_count;
+        for (uint8_t i = 0; i < hashes; ++i) lo = ::std::min(lo, get(pos[i]));
+        return lo;
+      }
+
+      void clear() {
+        ::std::fill(counters.begin(), counters.end(), 0);
+      }
+
+      bool empty() const { return counters.empty(); }
+
+      size_t counter_count() const { return counters.empty() ? 0 : mask + 1; }
+
+      uint8_t hash_count() const { return hashes; }
+
+      /// memory used by the counters, in bytes.
+      size_t memory() const { return counters.size(); }
+  };
+
+  template <typename Key, typename Hash>
+  constexpr uint8_t counting_bloom_filter<Key, Hash>::max_count;
+  template <typename Key, typename Hash>
+  constexpr uint8_t counting_bloom_filter<Key, Hash>::max_hashes;
+
+}  // namespace fsc
+
+#endif /* SRC_CONTAINERS_FSC_COUNTING_BLOOM_FILTER_HPP_ */
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    fsc_hyperloglog.hpp
+ * @ingroup fsc::containers
+ * @author  tpan
+ * @brief   HyperLogLog sketch, for estimating the number of distinct keys in one pass with fixed memory.
+ * @details 2^precision 1 byte registers.  the high precision bits of a key's hash select a register, and the register
+ *          keeps the maximum position of the first 1 bit in the rest of the hash.  the estimate is the normalized
+ *          harmonic mean of 2^register over all registers (Flajolet et al. 2007), with linear counting on the empty
+ *          registers for small cardinalities.  the hash is 64 bit, so no large range correction is needed.
+ *
+ *          the relative standard error is about 1.04 / sqrt(2^precision), e.g. 0.8% for precision 14 (16KB).
+ *          sketches of the same precision can be merged, giving the sketch of the union.
+ *
+ *          the hash is mixed first, so weak hash functions (e.g. std::hash on integers) are fine.
+ */
+#ifndef SRC_CONTAINERS_FSC_HYPERLOGLOG_HPP_
+#define SRC_CONTAINERS_FSC_HYPERLOGLOG_HPP_
+
+#include <vector>
+#include <functional>  // hash
+#include <algorithm>  // max, fill
+#include <cmath>  // log, sqrt, ldexp
+#include <cstdint>
+#include <stdexcept>  // invalid_argument
+
+
+namespace fsc {  // fast standard container
+
+  /**
+   * @brief  HyperLogLog distinct count estimator.  see file description.
+   * @tparam Hash   hash function on Key.
+   */
+  template <typename Key, typename Hash = ::std::hash<Key> >
+  class hyperloglog {
+
+    protected:
+      Hash hash;
+      ::std::vector<uint8_t> registers;
+      uint8_t precision;
+
+      /// 64 bit finalizer from murmur3.
+      static inline uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+      }
+
+    public:
+      /// smallest and largest precision.
+      static constexpr uint8_t min_precision = 4;
+      static constexpr uint8_t max_precision = 18;
+
+      /**
+       * @param _precision  log2 of the number of registers, between min_precision and max_precision.
+       */
+      explicit hyperloglog(uint8_t _precision = 14, Hash const & _hash = Hash()) :
+        hash(_hash), precision(_precision) {
+        if ((precision < min_precision) || (precision > max_precision))
+          throw ::std::invalid_argument("hyperloglog precision must be between min_precision and max_precision.");
+        registers.resize(static_cast<size_t>(1) << precision, 0);
+      }
+
+      /// add key.
+      inline void update(Key const & key) {
+        uint64_t h = mix(static_cast<uint64_t>(hash(key)));
+        size_t i = static_cast<size_t>(h >> (64 - precision));
+        // rank of the first 1 bit in the remaining bits.  the sentinel bit caps it at 64 - precision + 1.
+        uint64_t rest = (h << precision) | (static_cast<uint64_t>(1) << (precision - 1));
+        uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+        registers[i] = ::std::max(registers[i], rank);
+      }
+
+      /// estimated number of distinct keys added.
+      double estimate() const {
+        double m = static_cast<double>(registers.size());
+        double sum = 0.0;
+        size_t zeros = 0;
+        for (auto r : registers) {
+          sum += ::std::ldexp(1.0, -static_cast<int>(r));
+          if (r == 0) ++zeros;
+        }
+
+        double alpha = 0.7213 / (1.0 + 1.079 / m);
+        double est = alpha * m * m / sum;
+
+        // small range:  linear counting is more accurate while there are empty registers.
+        if ((est <= 2.5 * m) && (zeros > 0)) est = m * ::std::log(m / static_cast<double>(zeros));
+        return est;
+      }
+
+      /// relative standard error of estimate.
+      double error() const {
+        return 1.04 / ::std::sqrt(static_cast<double>(registers.size()));
+      }
+
+      /// merge other into this, giving the sketch of the union of the 2 key sets.
+      void merge(hyperloglog const & other) {
+        if (other.precision != precision) throw ::std::invalid_argument("hyperloglog merge needs the same precision.");
+        for (size_t i = 0; i < registers.size(); ++i) registers[i] = ::std::max(registers[i], other.registers[i]);
+      }
+
+      void clear() {
+        ::std::fill(registers.begin(), registers.end(), 0);
+      }
+
+      size_t register_count() const { return registers.size(); }
+
+      /// memory used by the registers, in bytes.
+      size_t memory() const { return registers.size(); }
+  };
+
+  template <typename Key, typename Hash>
+  constexpr uint8_t hyperloglog<Key, Hash>::min_precision;
+  template <typename Key, typename Hash>
+  constexpr uint8_t hyperloglog<Key, Hash>::max_precision;
+
+}  // namespace fsc
+
+#endif /* SRC_CONTAINERS_FSC_HYPERLOGLOG_HPP_ */
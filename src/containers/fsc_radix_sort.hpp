@@ -0,0 +1,293 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    fsc_radix_sort.hpp
+ * @ingroup fsc::containers
+ * @author  tpan
+ * @brief   MSD radix sort for kmers and (kmer, value) pairs.
+ * @details kmers are fixed width integers stored as little endian words, and Kmer::operator< compares them as such.
+ *          so a comparator that is std::less on the (transformed) kmer can be replaced by a radix sort on the bits of the
+ *          (transformed) kmer, 8 bits at a time from the most significant bit.
+ *
+ *          the top level pass is parallel with OpenMP:  histogram per thread, scatter into 1 extra buffer, then each
+ *          bucket is sorted in place (american flag sort) by a thread and moved back.  lower levels are sequential.
+ *          each element's digit is computed once per pass and cached, so the permutation never re-derives it.
+ *          small buckets are finished with std::sort.
+ *
+ *          fsc::sort(first, last, less) dispatches:  radix sort when less is std::less<Kmer> or
+ *          fsc::TransformedComparator<Kmer, std::less, Trans>, std::sort otherwise.
+ *
+ *          the digits are taken from the transformed kmer, so any transform that returns a Kmer works.
+ *          requires the unused high bits of the kmer to be 0, which Kmer maintains.
+ */
+#ifndef SRC_CONTAINERS_FSC_RADIX_SORT_HPP_
+#define SRC_CONTAINERS_FSC_RADIX_SORT_HPP_
+
+#include "bliss-config.hpp"
+
+#if defined(USE_OPENMP)
+#include "omp.h"
+#endif
+
+#include <vector>
+#include <functional>  // less
+#include <utility>  // pair, move, swap
+#include <iterator>
+#include <type_traits>
+#include <algorithm>  // sort
+#include <cstdint>
+#include <cassert>
+
+#include "common/kmer.hpp"
+#include "utils/transform_utils.hpp"
+
+
+namespace fsc {  // fast standard container
+
+  template <typename Key, template <typename> class Comparator, template <typename> class Transform>
+  struct TransformedComparator;
+
+  namespace radix {
+
+    /// buckets at or below this size are sorted with std::sort.
+    constexpr size_t small_size = 64;
+    /// inputs at or above this size use the parallel top level pass.
+    constexpr size_t parallel_size = 1UL << 16;
+
+    /// radix key of a transformed kmer.
+    template <typename Kmer, template <typename> class Trans>
+    struct kmer_key : public ::std::true_type {
+        static constexpr int nBits = Kmer::nBits;
+        using WordType = typename Kmer::KmerWordType;
+        static constexpr unsigned int wordBits = sizeof(WordType) * 8;
+
+        Trans<Kmer> trans;
+
+        inline Kmer key(Kmer const & x) const {
+          return trans(x);
+        }
+        template <typename V>
+        inline Kmer key(::std::pair<Kmer, V> const & x) const {
+          return trans(x.first);
+        }
+        template <typename V>
+        inline Kmer key(::std::pair<const Kmer, V> const & x) const {
+          return trans(x.first);
+        }
+
+        /// 8 bits of the kmer starting at bit s.  for s < 0, the lowest 8 + s bits.
+        /// read from the kmer words, not through a byte alias of the (temporary) transformed kmer.
+        static inline uint32_t digit(Kmer const & k, int s) {
+          WordType const * words = k.getData();
+          uint32_t mask = 0xFF;
+          if (s < 0) {
+            mask >>= -s;
+            s = 0;
+          }
+          unsigned int i = static_cast<unsigned int>(s) / wordBits;
+          unsigned int o = static_cast<unsigned int>(s) % wordBits;
+          uint64_t v = static_cast<uint64_t>(words[i]) >> o;
+          if ((o + 8 > wordBits) && (i + 1 < Kmer::nWords)) v |= static_cast<uint64_t>(words[i + 1]) << (wordBits - o);
+          return static_cast<uint32_t>(v) & mask;
+        }
+
+        template <typename V>
+        inline uint32_t operator()(V const & x, int s) const {
+          Kmer const k = key(x);
+          return digit(k, s);
+        }
+    };
+
+    /// maps a comparator to its radix key.  value is false if radix sort does not apply.
+    template <typename Less>
+    struct key_traits : public ::std::false_type {};
+
+    template <unsigned int K, typename Alphabet, typename WordType>
+    struct key_traits< ::std::less< ::bliss::common::Kmer<K, Alphabet, WordType> > > :
+      public kmer_key< ::bliss::common::Kmer<K, Alphabet, WordType>, ::bliss::transform::identity> {};
+
+    template <unsigned int K, typename Alphabet, typename WordType, template <typename> class Trans>
+    struct key_traits< ::fsc::TransformedComparator< ::bliss::common::Kmer<K, Alphabet, WordType>, ::std::less, Trans> > :
+      public kmer_key< ::bliss::common::Kmer<K, Alphabet, WordType>, Trans> {};
+
+
+    /**
+     * @brief sequential in place MSD radix sort (american flag sort) of [first, last) on the digits at s, s - 8, ... .
+     * @param digits  scratch of size last - first.  each element's digit is computed once per pass and permuted with it.
+     */
+    template <typename Iter, typename Key, typename Less>
+    void msd_sort(Iter first, Iter last, int s, Key const & kt, Less const & less, uint8_t * digits) {
+
+      size_t n = ::std::distance(first, last);
+
+      while (true) {
+        if (n <= small_size) {
+          ::std::sort(first, last, less);
+          return;
+        }
+        if (s <= -8) return;  // all bits used.  remaining are equal.
+
+        size_t counts[256] = {0};
+        Iter it = first;
+        for (size_t i = 0; i < n; ++i, ++it) {
+          digits[i] = kt(*it, s);
+          ++counts[digits[i]];
+        }
+
+        // single bucket:  nothing to move, go to next digit.
+        if (counts[digits[0]] == n) {
+          s -= 8;
+          continue;
+        }
+
+        size_t heads[256];
+        size_t tails[256];
+        size_t offset = 0;
+        for (size_t b = 0; b < 256; ++b) {
+          heads[b] = offset;
+          offset += counts[b];
+          tails[b] = offset;
+        }
+
+        // permute cycles in place, carrying each element's digit along.
+        for (uint32_t b = 0; b < 256; ++b) {
+          while (heads[b] < tails[b]) {
+            size_t i = heads[b];
+            uint8_t d = digits[i];
+            if (d != b) {
+              auto v = ::std::move(*(first + i));
+              while (d != b) {
+                assert(heads[d] < tails[d]);
+                size_t j = heads[d]++;
+                ::std::swap(v, *(first + j));
+                ::std::swap(d, digits[j]);
+              }
+              *(first + i) = ::std::move(v);
+              digits[i] = d;
+            }
+            ++heads[b];
+          }
+        }
+
+        // then sort each bucket on the next digit.
+        offset = 0;
+        for (size_t b = 0; b < 256; ++b) {
+          if (counts[b] > 1) msd_sort(first + offset, first + offset + counts[b], s - 8, kt, less, digits + offset);
+          offset += counts[b];
+        }
+        return;
+      }
+    }
+
+  }  // namespace radix
+
+
+  /**
+   * @brief  MSD radix sort of kmers or (kmer, value) pairs, in the order of less.
+   * @details  top level pass uses nthreads threads (0 for omp_get_max_threads()) and 1 extra buffer.  1 byte per element
+   *          caches the current digit.
+   *          not stable, same as std::sort.
+   */
+  template <typename Iter, typename Less>
+  void radix_sort(Iter first, Iter last, Less const & less, int nthreads = 0) {
+    static_assert(radix::key_traits<Less>::value, "radix_sort requires std::less on kmers, optionally with a transform.");
+
+    radix::key_traits<Less> kt;
+    int s = radix::key_traits<Less>::nBits - 8;
+
+#if defined(USE_OPENMP)
+    size_t n = ::std::distance(first, last);
+    int nt = (nthreads < 1) ? omp_get_max_threads() : nthreads;
+
+    if ((nt > 1) && (n >= radix::parallel_size)) {
+      using V = typename ::std::iterator_traits<Iter>::value_type;
+      ::std::vector<V> buffer(n);
+      ::std::vector<uint8_t> digits(n);
+
+      ::std::vector<size_t> counts(nt * 256, 0);
+      size_t bounds[257];
+
+#pragma omp parallel num_threads(nt)
+      {
+        int tid = omp_get_thread_num();
+        int nthr = omp_get_num_threads();
+        size_t lo = (n * tid) / nthr;
+        size_t hi = (n * (tid + 1)) / nthr;
+        size_t * cnt = counts.data() + tid * 256;
+
+        Iter it = first + lo;
+        for (size_t i = lo; i < hi; ++i, ++it) {
+          digits[i] = kt(*it, s);
+          ++cnt[digits[i]];
+        }
+
+#pragma omp barrier
+#pragma omp single
+        {
+          // per thread output offsets, bucket major.
+          size_t offset = 0;
+          for (size_t d = 0; d < 256; ++d) {
+            bounds[d] = offset;
+            for (int t = 0; t < nthr; ++t) {
+              size_t c = counts[t * 256 + d];
+              counts[t * 256 + d] = offset;
+              offset += c;
+            }
+          }
+          bounds[256] = offset;
+        }  // implicit barrier
+
+        it = first + lo;
+        for (size_t i = lo; i < hi; ++i, ++it) {
+          buffer[cnt[digits[i]]++] = ::std::move(*it);
+        }
+
+#pragma omp barrier
+#pragma omp for schedule(dynamic)
+        for (size_t d = 0; d < 256; ++d) {
+          // digits is reused as the buckets' scratch.
+          if (bounds[d + 1] - bounds[d] > 1)
+            radix::msd_sort(buffer.begin() + bounds[d], buffer.begin() + bounds[d + 1], s - 8, kt, less, digits.data() + bounds[d]);
+          ::std::move(buffer.begin() + bounds[d], buffer.begin() + bounds[d + 1], first + bounds[d]);
+        }
+      }
+      return;
+    }
+#else
+    (void)nthreads;
+#endif
+
+    ::std::vector<uint8_t> digits(::std::distance(first, last));
+    radix::msd_sort(first, last, s, kt, less, digits.data());
+  }
+
+
+  /// sort [first, last).  radix sort when less compares kmers with std::less (after a transform), else std::sort
+  template <typename Iter, typename Less>
+  inline typename ::std::enable_if<radix::key_traits<Less>::value>::type
+  sort(Iter first, Iter last, Less const & less) {
+    ::fsc::radix_sort(first, last, less);
+  }
+  template <typename Iter, typename Less>
+  inline typename ::std::enable_if<!radix::key_traits<Less>::value>::type
+  sort(Iter first, Iter last, Less const & less) {
+    ::std::sort(first, last, less);
+  }
+
+}  // namespace fsc
+
+#endif /* SRC_CONTAINERS_FSC_RADIX_SORT_HPP_ */
@@ -0,0 +1,343 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    fsc_sorted_index.hpp
+ * @ingroup fsc::containers
+ * @author  tpan
+ * @brief   static search indices over a sorted array, for read only (frozen) sorted maps.
+ * @details eytzinger_index:  every block_size-th key of the sorted array is stored in eytzinger (BFS) order, as a
+ *          perfect binary tree padded with copies of the largest key.  a search descends the tree without branches,
+ *          which yields the block, then finishes with a binary search within the block.
+ *          the top levels of the tree stay in cache, and the 2 children of a node are adjacent.
+ *
+ *          batch lookups interleave group_size queries level by level, and prefetch the next node of each,
+ *          so the cache misses of different queries overlap.
+ *
+ *          keys are stored and compared after the transform, so the transform is applied once per query.
+ *          memory overhead is about sizeof(Key) / block_size bytes per element.
+ *
+ *          prefix_index:  direct address table on the top Bits bits of a (transformed) kmer.  entry p is the offset of
+ *          the first element with prefix >= p, so a query jumps to the elements that share its prefix and finishes
+ *          with a binary search there.  kmers are close to uniformly distributed, so the range is about n / 2^Bits.
+ *          memory overhead is fixed at (2^Bits + 1) * sizeof(size_t) bytes.
+ *
+ *          both provide build(first, last), clear(), empty(), size(), memory() and the batched
+ *          lower_bound(first, queries, count, out).
+ */
+#ifndef SRC_CONTAINERS_FSC_SORTED_INDEX_HPP_
+#define SRC_CONTAINERS_FSC_SORTED_INDEX_HPP_
+
+#include <vector>
+#include <functional>  // less
+#include <iterator>
+#include <algorithm>  // lower_bound, min
+#include <cstdint>
+#include <type_traits>
+
+#include "common/kmer.hpp"
+#include "containers/fsc_container_utils.hpp"  // detail::get_key
+#include "utils/transform_utils.hpp"
+
+
+namespace fsc {  // fast standard container
+
+  /**
+   * @brief  blocked eytzinger layout search index for a sorted array of keys or (key, value) pairs.
+   * @tparam Less   comparator on transformed keys
+   * @tparam Trans  transform applied to keys before comparison.  the array must be sorted by Less(Trans(x), Trans(y)).
+   */
+  template <typename Key, typename Less = ::std::less<Key>, typename Trans = ::bliss::transform::identity<Key> >
+  class eytzinger_index {
+
+    public:
+      /// number of array elements per indexed key.
+      static constexpr size_t block_size = 16;
+      /// number of queries interleaved in a batch lookup.
+      static constexpr size_t group_size = 16;
+
+    protected:
+      /// perfect binary tree in BFS order, 1 based.  tree[0] is unused.
+      ::std::vector<Key> tree;
+      /// number of levels in the tree.
+      unsigned int height;
+      /// number of elements in the indexed array
+      size_t n;
+      /// number of indexed keys (blocks).
+      size_t m;
+
+      Less less;
+      Trans trans;
+
+      /// in-order fill of the subtree at k, from indexed key i onwards.  positions past m get the largest key.
+      template <typename Iter>
+      void fill(Iter first, size_t k, size_t & i) {
+        if (k >= tree.size()) return;
+        fill(first, 2 * k, i);
+        tree[k] = trans(::fsc::detail::get_key(*(first + ::std::min(i, m - 1) * block_size)));
+        ++i;
+        fill(first, 2 * k + 1, i);
+      }
+
+    public:
+      eytzinger_index() : height(0), n(0), m(0) {}
+
+      /// index the sorted range [first, last).  replaces any previous index.
+      template <typename Iter>
+      void build(Iter first, Iter last) {
+        clear();
+        n = ::std::distance(first, last);
+        if (n == 0) return;
+
+        m = (n + block_size - 1) / block_size;
+        height = 0;
+        while (((static_cast<size_t>(1) << height) - 1) < m) ++height;
+        tree.resize(static_cast<size_t>(1) << height);
+
+        size_t i = 0;
+        fill(first, 1, i);
+      }
+
+      void clear() {
+        ::std::vector<Key>().swap(tree);
+        height = 0;
+        n = 0;
+        m = 0;
+      }
+
+      bool empty() const {
+        return n == 0;
+      }
+
+      /// number of elements in the indexed array.
+      size_t size() const {
+        return n;
+      }
+
+      /// bytes used by the index.
+      size_t memory() const {
+        return tree.capacity() * sizeof(Key);
+      }
+
+      /**
+       * @brief  positions of the lower bounds of count queries in the indexed range starting at first.
+       * @param first    beginning of the same range given to build.
+       * @param queries  keys or (key, value) pairs, not transformed.  need not be sorted.
+       * @param out      count offsets from first.  n if the query is larger than all elements.
+       */
+      template <typename Iter, typename QueryIter>
+      void lower_bound(Iter first, QueryIter queries, size_t count, size_t * out) const {
+        if (n == 0) {
+          for (size_t i = 0; i < count; ++i) out[i] = 0;
+          return;
+        }
+
+        using V = typename ::std::iterator_traits<Iter>::value_type;
+        Less const & lt = less;
+        Trans const & tr = trans;
+        auto comp = [&lt, &tr](V const & x, Key const & y) {
+          return lt(tr(::fsc::detail::get_key(x)), y);
+        };
+
+        Key const * t = tree.data();
+        const size_t leaves = static_cast<size_t>(1) << height;
+
+        Key keys[group_size];
+        size_t k[group_size];
+        size_t hi[group_size];
+
+        for (size_t g = 0; g < count; g += group_size) {
+          size_t gn = ::std::min(group_size, count - g);
+
+          for (size_t i = 0; i < gn; ++i) {
+            keys[i] = trans(::fsc::detail::get_key(*(queries + (g + i))));
+            k[i] = 1;
+          }
+
+          // descend the tree level by level for the whole group.
+          for (unsigned int h = 1; h < height; ++h) {
+            for (size_t i = 0; i < gn; ++i) {
+              k[i] = 2 * k[i] + (less(t[k[i]], keys[i]) ? 1 : 0);
+              __builtin_prefetch(t + k[i]);
+            }
+          }
+          for (size_t i = 0; i < gn; ++i) {
+            k[i] = 2 * k[i] + (less(t[k[i]], keys[i]) ? 1 : 0);
+
+            // leaf k - leaves is the number of indexed keys less than the query.  answer is in block j - 1, after its first element.
+            size_t j = ::std::min(k[i] - leaves, m);
+            size_t lo = (j == 0) ? 0 : (j - 1) * block_size + 1;
+            hi[i] = ::std::min(j * block_size, n);
+            out[g + i] = lo;
+            if (lo < hi[i]) __builtin_prefetch(&(*(first + lo)));
+          }
+
+          // binary search within the block.
+          for (size_t i = 0; i < gn; ++i) {
+            if (out[g + i] < hi[i])
+              out[g + i] = ::std::distance(first, ::std::lower_bound(first + out[g + i], first + hi[i], keys[i], comp));
+          }
+        }
+      }
+
+  };
+
+  template <typename Key, typename Less, typename Trans>
+  constexpr size_t eytzinger_index<Key, Less, Trans>::block_size;
+  template <typename Key, typename Less, typename Trans>
+  constexpr size_t eytzinger_index<Key, Less, Trans>::group_size;
+
+
+  /**
+   * @brief  offset table on the top bits of sorted kmers, or (kmer, value) pairs.
+   * @tparam Less   comparator on transformed keys.  must be std::less, so that the order follows the top bits.
+   * @tparam Trans  transform applied to keys before comparison.  the array must be sorted by Less(Trans(x), Trans(y)).
+   * @tparam Bits   prefix length.  at most 24.  capped at the number of bits in the kmer.
+   */
+  template <typename Key, typename Less = ::std::less<Key>, typename Trans = ::bliss::transform::identity<Key>,
+      unsigned int Bits = 16>
+  class prefix_index {
+      static_assert(::bliss::common::is_kmer<Key>::value, "prefix_index requires kmer keys.");
+      static_assert(::std::is_same<Less, ::std::less<Key> >::value, "prefix_index requires kmers sorted by std::less.");
+      static_assert(Bits > 0 && Bits <= 24, "prefix_index supports 1 to 24 prefix bits.");
+
+    public:
+      /// number of prefix bits used.
+      static constexpr unsigned int bits = (Bits < Key::nBits) ? Bits : Key::nBits;
+      /// number of queries interleaved in a batch lookup.
+      static constexpr size_t group_size = 16;
+
+    protected:
+      /// offsets[p] is the position of the first element with prefix >= p.  2^bits + 1 entries.
+      ::std::vector<size_t> offsets;
+      /// number of elements in the indexed array
+      size_t n;
+
+      Less less;
+      Trans trans;
+
+      /// top bits of a transformed kmer.  words are little endian, so the top bits are in the last bytes.
+      static inline size_t prefix(Key const & k) {
+        constexpr unsigned int nBytes = Key::nWords * sizeof(typename Key::KmerWordType);
+        constexpr unsigned int s = Key::nBits - bits;
+
+        uint8_t const * bytes = reinterpret_cast<uint8_t const *>(k.getData());
+        uint64_t v = 0;
+        for (unsigned int j = 0; (j < 4) && ((s >> 3) + j < nBytes); ++j) {
+          v |= static_cast<uint64_t>(bytes[(s >> 3) + j]) << (8 * j);
+        }
+        return (v >> (s & 0x7)) & ((static_cast<uint64_t>(1) << bits) - 1);
+      }
+
+    public:
+      prefix_index() : n(0) {}
+
+      /// index the sorted range [first, last).  replaces any previous index.
+      template <typename Iter>
+      void build(Iter first, Iter last) {
+        clear();
+        n = ::std::distance(first, last);
+        if (n == 0) return;
+
+        const size_t entries = static_cast<size_t>(1) << bits;
+        offsets.resize(entries + 1);
+
+        // one pass:  fill entries up to the prefix of each element with its position.
+        size_t p = 0;
+        offsets[0] = 0;
+        size_t i = 0;
+        for (Iter it = first; it != last; ++it, ++i) {
+          size_t q = prefix(trans(::fsc::detail::get_key(*it)));
+          while (p < q) offsets[++p] = i;
+        }
+        while (p < entries) offsets[++p] = n;
+      }
+
+      void clear() {
+        ::std::vector<size_t>().swap(offsets);
+        n = 0;
+      }
+
+      bool empty() const {
+        return n == 0;
+      }
+
+      /// number of elements in the indexed array.
+      size_t size() const {
+        return n;
+      }
+
+      /// bytes used by the index.
+      size_t memory() const {
+        return offsets.capacity() * sizeof(size_t);
+      }
+
+      /**
+       * @brief  positions of the lower bounds of count queries in the indexed range starting at first.
+       * @param first    beginning of the same range given to build.
+       * @param queries  keys or (key, value) pairs, not transformed.  need not be sorted.
+       * @param out      count offsets from first.  n if the query is larger than all elements.
+       */
+      template <typename Iter, typename QueryIter>
+      void lower_bound(Iter first, QueryIter queries, size_t count, size_t * out) const {
+        if (n == 0) {
+          for (size_t i = 0; i < count; ++i) out[i] = 0;
+          return;
+        }
+
+        using V = typename ::std::iterator_traits<Iter>::value_type;
+        Less const & lt = less;
+        Trans const & tr = trans;
+        auto comp = [&lt, &tr](V const & x, Key const & y) {
+          return lt(tr(::fsc::detail::get_key(x)), y);
+        };
+
+        Key keys[group_size];
+        size_t p[group_size];
+        size_t hi[group_size];
+
+        for (size_t g = 0; g < count; g += group_size) {
+          size_t gn = ::std::min(group_size, count - g);
+
+          for (size_t i = 0; i < gn; ++i) {
+            keys[i] = trans(::fsc::detail::get_key(*(queries + (g + i))));
+            p[i] = prefix(keys[i]);
+            __builtin_prefetch(offsets.data() + p[i]);
+          }
+          for (size_t i = 0; i < gn; ++i) {
+            out[g + i] = offsets[p[i]];
+            hi[i] = offsets[p[i] + 1];
+            if (out[g + i] < hi[i]) __builtin_prefetch(&(*(first + out[g + i])));
+          }
+
+          // binary search within the range of the prefix.
+          for (size_t i = 0; i < gn; ++i) {
+            if (out[g + i] < hi[i])
+              out[g + i] = ::std::distance(first, ::std::lower_bound(first + out[g + i], first + hi[i], keys[i], comp));
+          }
+        }
+      }
+
+  };
+
+  template <typename Key, typename Less, typename Trans, unsigned int Bits>
+  constexpr unsigned int prefix_index<Key, Less, Trans, Bits>::bits;
+  template <typename Key, typename Less, typename Trans, unsigned int Bits>
+  constexpr size_t prefix_index<Key, Less, Trans, Bits>::group_size;
+
+}  // namespace fsc
+
+#endif /* SRC_CONTAINERS_FSC_SORTED_INDEX_HPP_ */
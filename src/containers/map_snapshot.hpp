@@ -0,0 +1,362 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    map_snapshot.hpp
+ * @ingroup containers
+ * @author  tpan
+ * @brief   binary snapshot files for the distributed maps.
+ * @details each rank writes its local elements to <path>.<rank>, as a fixed header followed by the raw
+ *          std::pair<Key, T> elements.  the header records the communicator size, a hash of the map type
+ *          (Key, T, MapParams and local container), and 2 user tags (the kmer index stores k and the alphabet).
+ *          keys are assigned to ranks by the distribution function, so a snapshot can only be loaded with
+ *          the same number of ranks and the same map type.
+ *
+ *          the payload starts at a page aligned offset so it can be memory mapped.
+ *
+ *          save and load are collective.  an error on one rank is reported on all ranks.
+ */
+#ifndef SRC_CONTAINERS_MAP_SNAPSHOT_HPP_
+#define SRC_CONTAINERS_MAP_SNAPSHOT_HPP_
+
+#include <string>
+#include <vector>
+#include <utility>     // pair
+#include <cstring>      // memcpy, strerror, memcmp
+#include <cstdint>
+#include <cerrno>
+#include <sstream>
+#include <stdexcept>
+#include <exception>    // exception_ptr
+#include <type_traits>
+#include <typeinfo>
+#include <algorithm>    // min
+#include <unistd.h>     // pread, pwrite, sysconf, close
+#include <fcntl.h>      // open
+#include <sys/mman.h>   // mmap
+
+#include <mxx/comm.hpp>
+#include <mxx/reduction.hpp>
+
+#include "io/io_exception.hpp"
+#include "utils/exception_handling.hpp"
+
+namespace dsc
+{
+  namespace snapshot
+  {
+
+    /// snapshot file header.  fixed size, written at the start of each rank's file.
+    struct header {
+        char magic[8];            ///< "BLSMAPS" + version byte
+        int32_t comm_size;        ///< number of ranks that wrote the snapshot.
+        int32_t rank;             ///< rank that wrote this file.
+        uint64_t flags;           ///< container specific, e.g. sortedness of sorted_map.
+        uint64_t value_bytes;     ///< sizeof(std::pair<Key, T>)
+        uint64_t type_hash;       ///< hash of the map's type name.
+        uint64_t tags[2];         ///< user metadata, checked on load.
+        uint64_t count;           ///< number of elements in the payload.
+        uint64_t payload_offset;  ///< page aligned byte offset of the first element.
+    };
+
+    static constexpr char magic_string[8] = {'B', 'L', 'S', 'M', 'A', 'P', 'S', 1};
+
+    /// default tags, for maps saved without user metadata.
+    static constexpr uint64_t no_tags[2] = {0, 0};
+
+    /// FNV-1a hash of a type name.  type names are stable for the same binary and compiler.
+    inline uint64_t hash_name(const char * name) {
+      uint64_t h = 14695981039346656037ULL;
+      for (; *name != 0; ++name) {
+        h ^= static_cast<unsigned char>(*name);
+        h *= 1099511628211ULL;
+      }
+      return h;
+    }
+
+    /// hash of the map type.
+    template <typename MapType>
+    inline uint64_t type_hash() {
+      return hash_name(typeid(MapType).name());
+    }
+
+    /// name of the file for the specified rank.
+    inline std::string get_filename(std::string const & path, int rank) {
+      std::stringstream ss;
+      ss << path << "." << rank;
+      return ss.str();
+    }
+
+    /// run a local operation and make the failure of any rank visible on all ranks.
+    template <typename Op>
+    void collective(Op const & op, const mxx::comm & comm) {
+      std::exception_ptr err;
+      try {
+        op();
+      } catch (...) {
+        err = std::current_exception();
+      }
+
+      bool ok = mxx::all_of(!err, comm);
+      if (err) std::rethrow_exception(err);
+      if (!ok) throw ::bliss::utils::make_exception<::bliss::io::IOException>("ERROR: snapshot: failed on another rank.");
+    }
+
+    /**
+     * @brief  whether V can be written and read back as raw bytes.
+     * @details  trivially copyable types qualify.  so do standard layout types with a trivial destructor, such as
+     *           Kmer and SequenceId, whose user-provided copy operations only copy members and which are sent
+     *           bitwise as mxx datatypes already.  std::pair is checked by its members.  types owning memory,
+     *           e.g. std::string or std::vector, are rejected.  specialize for other types as needed.
+     */
+    template <typename V>
+    struct is_bitwise_serializable : public std::integral_constant<bool,
+      std::is_trivially_copyable<V>::value ||
+      (std::is_standard_layout<V>::value && std::is_trivially_destructible<V>::value)> {};
+
+    template <typename A, typename B>
+    struct is_bitwise_serializable<std::pair<A, B> > : public std::integral_constant<bool,
+      is_bitwise_serializable<A>::value && is_bitwise_serializable<B>::value> {};
+
+    namespace detail {
+
+      inline size_t page_size() {
+        return sysconf(_SC_PAGE_SIZE);
+      }
+
+      inline void throw_errno(std::string const & op, std::string const & filename) {
+        std::stringstream ss;
+        ss << "ERROR: snapshot: " << op << " " << filename << " error " << errno << ": " << strerror(errno);
+        throw ::bliss::utils::make_exception<::bliss::io::IOException>(ss.str());
+      }
+
+      inline void write_all(int fd, const void * data, size_t bytes, size_t offset, std::string const & filename) {
+        const char * ptr = reinterpret_cast<const char *>(data);
+        while (bytes > 0) {
+          ssize_t n = pwrite(fd, ptr, bytes, offset);
+          if (n < 0) {
+            if (errno == EINTR) continue;
+            throw_errno("write", filename);
+          }
+          ptr += n;  offset += n;  bytes -= n;
+        }
+      }
+
+      inline void read_all(int fd, void * data, size_t bytes, size_t offset, std::string const & filename) {
+        char * ptr = reinterpret_cast<char *>(data);
+        while (bytes > 0) {
+          ssize_t n = pread(fd, ptr, bytes, offset);
+          if (n < 0) {
+            if (errno == EINTR) continue;
+            throw_errno("read", filename);
+          }
+          if (n == 0) throw ::bliss::utils::make_exception<::bliss::io::IOException>("ERROR: snapshot: truncated file " + filename);
+          ptr += n;  offset += n;  bytes -= n;
+        }
+      }
+
+      inline header make_header(const mxx::comm & comm, uint64_t map_hash, uint64_t const (&tags)[2],
+                                uint64_t flags, size_t value_bytes, size_t count) {
+        header h;
+        memset(&h, 0, sizeof(header));
+        memcpy(h.magic, magic_string, sizeof(magic_string));
+        h.comm_size = comm.size();
+        h.rank = comm.rank();
+        h.flags = flags;
+        h.value_bytes = value_bytes;
+        h.type_hash = map_hash;
+        h.tags[0] = tags[0];
+        h.tags[1] = tags[1];
+        h.count = count;
+        h.payload_offset = page_size();
+        return h;
+      }
+
+      /// closes the file descriptor on scope exit.
+      struct fd_guard {
+          int fd;
+          fd_guard(int _fd) : fd(_fd) {}
+          ~fd_guard() { if (fd >= 0) close(fd); }
+      };
+
+    }  // namespace detail
+
+    /**
+     * @brief  writes a rank's elements.  collective.
+     * @details  elements are converted to V and written in chunks, so the iterator may be over pair<const Key, T>.
+     * @tparam V    on-disk element type, i.e. std::pair<Key, T>.  written bitwise, as in the mxx datatypes used for communication.
+     */
+    template <typename V, typename Iter>
+    void save(std::string const & path, const mxx::comm & comm, uint64_t map_hash, uint64_t const (&tags)[2],
+              uint64_t flags, size_t count, Iter first, Iter last) {
+      static_assert(is_bitwise_serializable<V>::value, "snapshot elements are written as raw bytes. V must not own memory.");
+
+      collective([&](){
+        std::string filename = get_filename(path, comm.rank());
+
+        int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) detail::throw_errno("open", filename);
+        detail::fd_guard guard(fd);
+
+        header h = detail::make_header(comm, map_hash, tags, flags, sizeof(V), count);
+        detail::write_all(fd, &h, sizeof(header), 0, filename);
+
+        // elements, in chunks.
+        std::vector<V> buffer;
+        size_t chunk = std::max(static_cast<size_t>(1), (static_cast<size_t>(1) << 20) / sizeof(V));
+        buffer.reserve(std::min(chunk, count));
+        size_t offset = h.payload_offset;
+        size_t written = 0;
+        for (auto it = first; it != last; ++it) {
+          buffer.emplace_back(*it);
+          if (buffer.size() == chunk) {
+            detail::write_all(fd, buffer.data(), buffer.size() * sizeof(V), offset, filename);
+            offset += buffer.size() * sizeof(V);
+            written += buffer.size();
+            buffer.clear();
+          }
+        }
+        if (buffer.size() > 0) {
+          detail::write_all(fd, buffer.data(), buffer.size() * sizeof(V), offset, filename);
+          written += buffer.size();
+        }
+
+        if (written != count) throw std::logic_error("ERROR: snapshot: element count does not match the range.");
+        // make sure the file covers the payload offset even when empty.
+        if (ftruncate(fd, h.payload_offset + count * sizeof(V)) < 0) detail::throw_errno("truncate", filename);
+      }, comm);
+    }
+
+    /// write a contiguous array of elements directly.  collective.
+    template <typename V>
+    void save(std::string const & path, const mxx::comm & comm, uint64_t map_hash, uint64_t const (&tags)[2],
+              uint64_t flags, V const * data, size_t count) {
+      static_assert(is_bitwise_serializable<V>::value, "snapshot elements are written as raw bytes. V must not own memory.");
+
+      collective([&](){
+        std::string filename = get_filename(path, comm.rank());
+
+        int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) detail::throw_errno("open", filename);
+        detail::fd_guard guard(fd);
+
+        header h = detail::make_header(comm, map_hash, tags, flags, sizeof(V), count);
+        detail::write_all(fd, &h, sizeof(header), 0, filename);
+        if (count > 0) detail::write_all(fd, data, count * sizeof(V), h.payload_offset, filename);
+        if (ftruncate(fd, h.payload_offset + count * sizeof(V)) < 0) detail::throw_errno("truncate", filename);
+      }, comm);
+    }
+
+    /**
+     * @brief  open a rank's file and validate the header against the loading map.  local.
+     * @return file descriptor.  header is returned in h.
+     * @throw  std::invalid_argument if the snapshot was written by a different map type, tags, or number of ranks.
+     */
+    template <typename V>
+    int open_validated(std::string const & filename, const mxx::comm & comm, uint64_t map_hash, uint64_t const (&tags)[2], header & h) {
+      int fd = open(filename.c_str(), O_RDONLY);
+      if (fd < 0) detail::throw_errno("open", filename);
+      detail::fd_guard guard(fd);
+
+      detail::read_all(fd, &h, sizeof(header), 0, filename);
+
+      if (memcmp(h.magic, magic_string, sizeof(magic_string)) != 0)
+        throw std::invalid_argument("ERROR: snapshot: " + filename + " is not a map snapshot or has a different version.");
+      if ((h.comm_size != comm.size()) || (h.rank != comm.rank())) {
+        std::stringstream ss;
+        ss << "ERROR: snapshot: " << filename << " was saved by rank " << h.rank << " of " << h.comm_size <<
+            ", loading with rank " << comm.rank() << " of " << comm.size();
+        throw std::invalid_argument(ss.str());
+      }
+      if ((h.value_bytes != sizeof(V)) || (h.type_hash != map_hash))
+        throw std::invalid_argument("ERROR: snapshot: " + filename + " was saved by a different map type.");
+      if ((h.tags[0] != tags[0]) || (h.tags[1] != tags[1]))
+        throw std::invalid_argument("ERROR: snapshot: " + filename + " was saved with different metadata (e.g. k or alphabet).");
+      if ((h.payload_offset % detail::page_size()) != 0)
+        throw std::invalid_argument("ERROR: snapshot: " + filename + " payload is not page aligned.");
+
+      guard.fd = -1;  // hand over to caller.
+      return fd;
+    }
+
+    /**
+     * @brief  read a rank's elements in chunks, calling op(std::vector<V>&) for each.  collective.
+     * @details  for hash based maps, which insert each chunk into the local container.  count is reported first via pre(count).
+     * @return header of the local file.
+     */
+    template <typename V, typename Pre, typename Op>
+    header load(std::string const & path, const mxx::comm & comm, uint64_t map_hash, uint64_t const (&tags)[2],
+                Pre const & pre, Op const & op) {
+      static_assert(is_bitwise_serializable<V>::value, "snapshot elements are written as raw bytes. V must not own memory.");
+
+      header h;
+      collective([&](){
+        std::string filename = get_filename(path, comm.rank());
+        int fd = open_validated<V>(filename, comm, map_hash, tags, h);
+        detail::fd_guard guard(fd);
+
+        pre(h.count);
+
+        size_t chunk = std::max(static_cast<size_t>(1), (static_cast<size_t>(1) << 20) / sizeof(V));
+        std::vector<V> buffer;
+        size_t offset = h.payload_offset;
+        for (size_t i = 0; i < h.count; i += chunk) {
+          buffer.resize(std::min(chunk, static_cast<size_t>(h.count - i)));
+          detail::read_all(fd, buffer.data(), buffer.size() * sizeof(V), offset, filename);
+          offset += buffer.size() * sizeof(V);
+          op(buffer);
+        }
+      }, comm);
+      return h;
+    }
+
+    /**
+     * @brief  map a rank's payload and copy it into a vector.  collective.
+     * @details  the payload is page aligned, so it is mapped read only and copied once, without the
+     *           intermediate buffers of read().
+     * @return header of the local file.
+     */
+    template <typename V, typename A>
+    header load(std::string const & path, const mxx::comm & comm, uint64_t map_hash, uint64_t const (&tags)[2],
+                std::vector<V, A> & output) {
+      static_assert(is_bitwise_serializable<V>::value, "snapshot elements are written as raw bytes. V must not own memory.");
+
+      header h;
+      collective([&](){
+        std::string filename = get_filename(path, comm.rank());
+        int fd = open_validated<V>(filename, comm, map_hash, tags, h);
+        detail::fd_guard guard(fd);
+
+        output.clear();
+        if (h.count == 0) return;
+
+        size_t bytes = h.count * sizeof(V);
+        void * ptr = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, h.payload_offset);
+        if (ptr == MAP_FAILED) detail::throw_errno("mmap", filename);
+        madvise(ptr, bytes, MADV_SEQUENTIAL);
+
+        V const * data = reinterpret_cast<V const *>(ptr);
+        output.assign(data, data + h.count);
+
+        munmap(ptr, bytes);
+      }, comm);
+      return h;
+    }
+
+  }  // namespace snapshot
+}  // namespace dsc
+
+#endif /* SRC_CONTAINERS_MAP_SNAPSHOT_HPP_ */
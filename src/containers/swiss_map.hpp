@@ -0,0 +1,646 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    swiss_map.hpp
+ * @ingroup fsc::containers
+ * @author  tpan
+ * @brief   open addressing hash map with a control byte per slot, probed 16 slots at a time.
+ * @details google dense_hash_map needs an empty and a deleted key, which is why fsc::densehash_map splits the key space
+ *          into 2 maps.  this map keeps the slot state in a separate control byte array instead, so any key can be
+ *          stored, and no splitter is needed:
+ *
+ *            empty    0x80
+ *            deleted  0xFE
+ *            full     0 .. 127, the low 7 bits of the slot's hash.
+ *
+ *          the slots are in groups of 16.  a lookup starts at the group selected by the high bits of the hash, and
+ *          compares the 7 bit tag against all 16 control bytes of the group at once (SSE2 when available).  keys are only
+ *          compared for matching tags.  the lookup stops at the first group with an empty slot.  groups are visited in
+ *          triangular order, which covers all groups for a power of 2 group count.
+ *
+ *          an erase marks the slot empty if its group has an empty slot, since no probe sequence has passed such a group,
+ *          or deleted otherwise.  deleted slots are reused by inserts, and dropped when the table is rehashed.
+ *
+ *          the probe sequences stay short at high load, so the default max load factor is 0.875.
+ *
+ *          value_type is std::pair<Key, T>, not std::pair<const Key, T>:  the key must not be changed through an
+ *          iterator.  Key and T need to be default constructible.  iterators are invalidated by inserts that rehash.
+ *
+ *          the interface is the subset of std::unordered_map used by the dsc:: hash maps, so this can be their Container.
+ *          insert, find, count and prefetch also take the key's hash, hash_function()(key), for callers that already have
+ *          it:  the dsc:: maps' single hash mode sends the hash with each key, and picks the rank from its high bits.  the
+ *          table takes the tag and the group from the low bits of the mixed hash, which are not biased by the rank bits.
+ *
+ *          for tables much larger than the cache, nearly every lookup misses to DRAM.  the range insert, find and count
+ *          process the keys in batches of batch_size (group prefetching):  hash all keys of the batch and prefetch their
+ *          home groups, then match the tags and prefetch the matching slots, then resolve the keys.  the misses within
+ *          a batch overlap instead of being taken one at a time.  prefetch(key) exposes the first stage to callers that
+ *          pipeline their own lookups.
+ */
+#ifndef SRC_CONTAINERS_SWISS_MAP_HPP_
+#define SRC_CONTAINERS_SWISS_MAP_HPP_
+
+#include <vector>
+#include <utility>  // pair
+#include <functional>  // hash, equal_to
+#include <iterator>
+#include <memory>  // allocator_traits
+#include <algorithm>  // fill, max
+#include <type_traits>
+#include <cmath>  // ceil
+#include <cstdint>
+#include <cstddef>  // ptrdiff_t
+#include <stdexcept>  // out_of_range, invalid_argument
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+namespace fsc {  // fast standard container
+
+  template <typename Key, typename T, typename Hash, typename Equal, typename Alloc>
+  class swiss_map;
+
+  namespace swiss {
+
+    /// control byte of an empty slot.
+    constexpr int8_t empty = -128;
+    /// control byte of an erased slot.
+    constexpr int8_t deleted = -2;
+    /// slots per group.
+    constexpr size_t group_size = 16;
+
+    /// 16 control bytes.  each match returns a bit mask, with bit i set for a matching byte i.
+    struct group {
+        int8_t const * ctrl;
+
+        explicit group(int8_t const * _ctrl) : ctrl(_ctrl) {}
+
+#if defined(__SSE2__)
+        inline uint32_t match(int8_t tag) const {
+          __m128i c = _mm_loadu_si128(reinterpret_cast<__m128i const *>(ctrl));
+          return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), c)));
+        }
+        inline uint32_t match_empty() const {
+          return match(empty);
+        }
+        /// empty and deleted are the only negative control bytes.
+        inline uint32_t match_free() const {
+          __m128i c = _mm_loadu_si128(reinterpret_cast<__m128i const *>(ctrl));
+          return static_cast<uint32_t>(_mm_movemask_epi8(c));
+        }
+#else
+        inline uint32_t match(int8_t tag) const {
+          uint32_t m = 0;
+          for (size_t i = 0; i < group_size; ++i) m |= static_cast<uint32_t>(ctrl[i] == tag) << i;
+          return m;
+        }
+        inline uint32_t match_empty() const {
+          return match(empty);
+        }
+        inline uint32_t match_free() const {
+          uint32_t m = 0;
+          for (size_t i = 0; i < group_size; ++i) m |= static_cast<uint32_t>(ctrl[i] < 0) << i;
+          return m;
+        }
+#endif
+    };
+
+    /// forward iterator over the full slots.
+    template <typename V>
+    class slot_iterator {
+        template <typename W> friend class slot_iterator;
+        template <typename K, typename M, typename H, typename E, typename A> friend class ::fsc::swiss_map;
+
+        int8_t const * ctrl;
+        int8_t const * ctrl_end;
+        V * slot;
+
+        inline void skip() {
+          while ((ctrl != ctrl_end) && (*ctrl < 0)) {
+            ++ctrl;
+            ++slot;
+          }
+        }
+
+      public:
+        using iterator_category = ::std::forward_iterator_tag;
+        using value_type = typename ::std::remove_const<V>::type;
+        using difference_type = ::std::ptrdiff_t;
+        using pointer = V *;
+        using reference = V &;
+
+        slot_iterator() : ctrl(nullptr), ctrl_end(nullptr), slot(nullptr) {}
+        slot_iterator(int8_t const * _ctrl, int8_t const * _ctrl_end, V * _slot) :
+          ctrl(_ctrl), ctrl_end(_ctrl_end), slot(_slot) {}
+
+        /// iterator to const_iterator.
+        template <typename W, typename = typename ::std::enable_if<::std::is_convertible<W *, V *>::value>::type>
+        slot_iterator(slot_iterator<W> const & other) :
+          ctrl(other.ctrl), ctrl_end(other.ctrl_end), slot(other.slot) {}
+
+        reference operator*() const { return *slot; }
+        pointer operator->() const { return slot; }
+
+        slot_iterator & operator++() {
+          ++ctrl;
+          ++slot;
+          skip();
+          return *this;
+        }
+        slot_iterator operator++(int) {
+          slot_iterator out(*this);
+          ++(*this);
+          return out;
+        }
+
+        template <typename W>
+        bool operator==(slot_iterator<W> const & other) const { return ctrl == other.ctrl; }
+        template <typename W>
+        bool operator!=(slot_iterator<W> const & other) const { return ctrl != other.ctrl; }
+    };
+
+  }  // namespace swiss
+
+
+  /**
+   * @brief  hash map with control bytes and group probing.  see file description.
+   * @tparam Alloc  rebound to value_type for the slot storage.
+   */
+  template <typename Key, typename T, typename Hash = ::std::hash<Key>, typename Equal = ::std::equal_to<Key>,
+            typename Alloc = ::std::allocator<::std::pair<const Key, T> > >
+  class swiss_map {
+
+    public:
+      using key_type              = Key;
+      using mapped_type           = T;
+      using value_type            = ::std::pair<Key, T>;
+      using hasher                = Hash;
+      using key_equal             = Equal;
+      using allocator_type        = typename ::std::allocator_traits<Alloc>::template rebind_alloc<value_type>;
+      using reference             = value_type &;
+      using const_reference       = value_type const &;
+      using pointer               = value_type *;
+      using const_pointer         = value_type const *;
+      using iterator              = ::fsc::swiss::slot_iterator<value_type>;
+      using const_iterator        = ::fsc::swiss::slot_iterator<value_type const>;
+      using size_type             = size_t;
+      using difference_type       = ::std::ptrdiff_t;
+
+    protected:
+      static constexpr size_t npos = ~(static_cast<size_t>(0));
+
+      Hash hash;
+      Equal eq;
+
+      /// one control byte per slot.
+      ::std::vector<int8_t> ctrl;
+      ::std::vector<value_type, allocator_type> slots;
+      /// number of groups - 1.  the number of groups is a power of 2.
+      size_t mask;
+      /// full slots.
+      size_t n;
+      /// inserts into empty slots before the next rehash.
+      size_t growth_left;
+      float max_load;
+
+      /// 64 bit finalizer from murmur3.  the low 7 bits are the tag and the rest select the group, so the hash is mixed.
+      static inline uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+      }
+
+      static inline int8_t tag_of(uint64_t h) { return static_cast<int8_t>(h & 0x7F); }
+      inline size_t group_of(uint64_t h) const { return static_cast<size_t>(h >> 7) & mask; }
+
+      static inline size_t lowest(uint32_t m) { return static_cast<size_t>(__builtin_ctz(m)); }
+
+      /// inserts into empty slots allowed at this capacity.  at least 1 slot stays empty, so probing terminates.
+      size_t growth_limit(size_t capacity) const {
+        return ::std::min(capacity - 1, static_cast<size_t>(static_cast<double>(capacity) * max_load));
+      }
+
+      /// slot of key, or npos.
+      size_t find_index(Key const & key, uint64_t h) const {
+        int8_t tag = tag_of(h);
+        size_t g = group_of(h);
+        for (size_t i = 1; ; ++i) {
+          ::fsc::swiss::group grp(ctrl.data() + g * ::fsc::swiss::group_size);
+          for (uint32_t m = grp.match(tag); m != 0; m &= m - 1) {
+            size_t pos = g * ::fsc::swiss::group_size + lowest(m);
+            if (eq(slots[pos].first, key)) return pos;
+          }
+          if (grp.match_empty() != 0) return npos;
+          g = (g + i) & mask;
+        }
+      }
+
+      /// first empty or deleted slot on the probe sequence of hash h.
+      size_t find_free(uint64_t h) const {
+        size_t g = group_of(h);
+        for (size_t i = 1; ; ++i) {
+          uint32_t m = ::fsc::swiss::group(ctrl.data() + g * ::fsc::swiss::group_size).match_free();
+          if (m != 0) return g * ::fsc::swiss::group_size + lowest(m);
+          g = (g + i) & mask;
+        }
+      }
+
+      /// move all elements to a table with capacity slots.  capacity is a power of 2, at least group_size.
+      void resize(size_t capacity) {
+        ::std::vector<int8_t> old_ctrl(capacity, ::fsc::swiss::empty);
+        ::std::vector<value_type, allocator_type> old_slots(capacity, value_type(), slots.get_allocator());
+        old_ctrl.swap(ctrl);
+        old_slots.swap(slots);
+        mask = capacity / ::fsc::swiss::group_size - 1;
+
+        for (size_t i = 0; i < old_ctrl.size(); ++i) {
+          if (old_ctrl[i] < 0) continue;
+          uint64_t h = mix(static_cast<uint64_t>(hash(old_slots[i].first)));
+          size_t pos = find_free(h);
+          ctrl[pos] = tag_of(h);
+          slots[pos] = ::std::move(old_slots[i]);
+        }
+        growth_left = growth_limit(capacity) - n;
+      }
+
+      /// drop the deleted slots, and grow if the table is more than half full.
+      void rehash_and_grow() {
+        size_t capacity = ctrl.size();
+        if (n * 2 >= growth_limit(capacity)) capacity <<= 1;
+        resize(capacity);
+      }
+
+      /// smallest power of 2 capacity of at least count slots, holding n elements under the max load factor.
+      size_t capacity_for(size_t count) const {
+        size_t needed = ::std::max(count, static_cast<size_t>(::std::ceil(static_cast<double>(n) / max_load)) + 1);
+        size_t capacity = ::fsc::swiss::group_size;
+        while (capacity < needed) capacity <<= 1;
+        return capacity;
+      }
+
+      /// slot of key with hash h, inserting a new one if it is not there.  the new slot's value has to be assigned by the caller.
+      ::std::pair<size_t, bool> find_or_prepare(Key const & key, uint64_t h) {
+        size_t pos = find_index(key, h);
+        if (pos != npos) return ::std::make_pair(pos, false);
+
+        pos = find_free(h);
+        if ((growth_left == 0) && (ctrl[pos] != ::fsc::swiss::deleted)) {
+          rehash_and_grow();
+          pos = find_free(h);
+        }
+        if (ctrl[pos] == ::fsc::swiss::empty) --growth_left;
+        ctrl[pos] = tag_of(h);
+        ++n;
+        return ::std::make_pair(pos, true);
+      }
+      ::std::pair<size_t, bool> find_or_prepare(Key const & key) {
+        return find_or_prepare(key, mix(static_cast<uint64_t>(hash(key))));
+      }
+
+      /// first stage of a batch:  prefetch the control bytes and the first slots of the home group.
+      inline void prefetch_group(uint64_t h) const {
+        size_t pos = group_of(h) * ::fsc::swiss::group_size;
+        __builtin_prefetch(ctrl.data() + pos);
+        __builtin_prefetch(slots.data() + pos);
+      }
+      /// second stage:  prefetch the slot of the first tag match in the home group, which is usually the key's.
+      inline void prefetch_match(uint64_t h) const {
+        size_t pos = group_of(h) * ::fsc::swiss::group_size;
+        uint32_t m = ::fsc::swiss::group(ctrl.data() + pos).match(tag_of(h));
+        if (m != 0) __builtin_prefetch(slots.data() + pos + lowest(m));
+      }
+
+      /// hash the b keys starting at first into hs, and run the 2 prefetch stages on them.
+      template <class Iter>
+      void prefetch_batch(Iter first, size_t b, uint64_t * hs) const {
+        for (size_t i = 0; i < b; ++i, ++first) {
+          hs[i] = mix(static_cast<uint64_t>(hash(key_of(*first))));
+          prefetch_group(hs[i]);
+        }
+        for (size_t i = 0; i < b; ++i) prefetch_match(hs[i]);
+      }
+
+      static inline Key const & key_of(Key const & x) { return x; }
+      template <typename V>
+      static inline Key const & key_of(::std::pair<Key, V> const & x) { return x.first; }
+      template <typename V>
+      static inline Key const & key_of(::std::pair<const Key, V> const & x) { return x.first; }
+
+      template <class InputIterator>
+      void insert_range(InputIterator first, InputIterator last, ::std::input_iterator_tag const &) {
+        for (; first != last; ++first) emplace(*first);
+      }
+      template <class ForwardIterator>
+      void insert_range(ForwardIterator first, ForwardIterator last, ::std::forward_iterator_tag const &) {
+        uint64_t hs[batch_size];
+        while (first != last) {
+          size_t b = 0;
+          for (ForwardIterator it = first; (it != last) && (b < batch_size); ++it) ++b;
+          prefetch_batch(first, b, hs);
+
+          // a rehash within the batch only wastes the prefetches.  the hashes stay valid.
+          for (size_t i = 0; i < b; ++i, ++first) {
+            auto res = find_or_prepare(key_of(*first), hs[i]);
+            if (res.second) slots[res.first] = *first;
+          }
+        }
+      }
+
+      void erase_at(size_t pos) {
+        --n;
+        size_t g = pos / ::fsc::swiss::group_size;
+        if (::fsc::swiss::group(ctrl.data() + g * ::fsc::swiss::group_size).match_empty() != 0) {
+          ctrl[pos] = ::fsc::swiss::empty;
+          ++growth_left;
+        } else {
+          ctrl[pos] = ::fsc::swiss::deleted;
+        }
+        slots[pos] = value_type();
+      }
+
+      iterator make_iterator(size_t pos) {
+        return iterator(ctrl.data() + pos, ctrl.data() + ctrl.size(), slots.data() + pos);
+      }
+      const_iterator make_iterator(size_t pos) const {
+        return const_iterator(ctrl.data() + pos, ctrl.data() + ctrl.size(), slots.data() + pos);
+      }
+
+    public:
+      /// keys per batch in the range insert, find and count.  enough independent misses to cover the memory latency.
+      static constexpr size_t batch_size = 16;
+
+      /// @param bucket_count  initial number of slots.
+      explicit swiss_map(size_t bucket_count = 0, Hash const & _hash = Hash(), Equal const & _eq = Equal(),
+                         allocator_type const & alloc = allocator_type()) :
+        hash(_hash), eq(_eq), slots(alloc), mask(0), n(0), growth_left(0), max_load(0.875f) {
+        resize(capacity_for(bucket_count));
+      }
+
+      template <class InputIterator>
+      swiss_map(InputIterator first, InputIterator last, size_t bucket_count = 0,
+                Hash const & _hash = Hash(), Equal const & _eq = Equal(),
+                allocator_type const & alloc = allocator_type()) :
+        swiss_map(bucket_count, _hash, _eq, alloc) {
+        insert(first, last);
+      }
+
+      swiss_map(swiss_map const & other) = default;
+      swiss_map(swiss_map && other) = default;
+      swiss_map & operator=(swiss_map const & other) = default;
+      swiss_map & operator=(swiss_map && other) = default;
+
+      void swap(swiss_map & other) {
+        ::std::swap(hash, other.hash);
+        ::std::swap(eq, other.eq);
+        ctrl.swap(other.ctrl);
+        slots.swap(other.slots);
+        ::std::swap(mask, other.mask);
+        ::std::swap(n, other.n);
+        ::std::swap(growth_left, other.growth_left);
+        ::std::swap(max_load, other.max_load);
+      }
+
+      // ============= iterators
+
+      iterator begin() {
+        iterator it = make_iterator(0);
+        it.skip();
+        return it;
+      }
+      const_iterator begin() const { return cbegin(); }
+      const_iterator cbegin() const {
+        const_iterator it = make_iterator(0);
+        it.skip();
+        return it;
+      }
+      iterator end() { return make_iterator(ctrl.size()); }
+      const_iterator end() const { return cend(); }
+      const_iterator cend() const { return make_iterator(ctrl.size()); }
+
+      // ============= capacity
+
+      size_t size() const { return n; }
+      bool empty() const { return n == 0; }
+      size_t max_size() const { return slots.max_size(); }
+
+      /// number of slots.
+      size_t bucket_count() const { return ctrl.size(); }
+      float load_factor() const { return static_cast<float>(n) / static_cast<float>(ctrl.size()); }
+      float max_load_factor() const { return max_load; }
+      /// @throw std::invalid_argument unless 0 < ml < 1.  at least 1 slot has to stay empty.
+      void max_load_factor(float ml) {
+        if ((ml <= 0.0f) || (ml >= 1.0f)) throw ::std::invalid_argument("swiss_map max load factor must be in (0, 1).");
+        max_load = ml;
+        resize(capacity_for(ctrl.size()));
+      }
+
+      /// use at least count slots.  does not shrink below the current size.
+      void rehash(size_t count) {
+        size_t capacity = capacity_for(count);
+        if (capacity != ctrl.size()) resize(capacity);
+      }
+      /// room for count elements without rehashing.
+      void reserve(size_t count) {
+        rehash(static_cast<size_t>(::std::ceil(static_cast<double>(count) / max_load)));
+      }
+
+      /// bytes used by the table.
+      size_t memory() const {
+        return ctrl.size() * (sizeof(int8_t) + sizeof(value_type));
+      }
+
+      // ============= modifiers
+
+      void clear() {
+        if (n == 0) return;
+        ::std::fill(ctrl.begin(), ctrl.end(), ::fsc::swiss::empty);
+        ::std::fill(slots.begin(), slots.end(), value_type());
+        n = 0;
+        growth_left = growth_limit(ctrl.size());
+      }
+
+      template <class... Args>
+      ::std::pair<iterator, bool> emplace(Args &&... args) {
+        value_type v(::std::forward<Args>(args)...);
+        auto res = find_or_prepare(v.first);
+        if (res.second) slots[res.first] = ::std::move(v);
+        return ::std::make_pair(make_iterator(res.first), res.second);
+      }
+
+      ::std::pair<iterator, bool> insert(value_type const & v) {
+        auto res = find_or_prepare(v.first);
+        if (res.second) slots[res.first] = v;
+        return ::std::make_pair(make_iterator(res.first), res.second);
+      }
+      /// insert with the key's hash hv = hash_function()(v.first) precomputed, e.g. by a caller that used it to pick the rank.
+      ::std::pair<iterator, bool> insert(value_type const & v, uint64_t hv) {
+        auto res = find_or_prepare(v.first, mix(hv));
+        if (res.second) slots[res.first] = v;
+        return ::std::make_pair(make_iterator(res.first), res.second);
+      }
+
+      /// insert a range, in batches if the iterators are forward iterators.
+      template <class InputIterator>
+      void insert(InputIterator first, InputIterator last) {
+        insert_range(first, last, typename ::std::iterator_traits<InputIterator>::iterator_category());
+      }
+
+      T & operator[](Key const & key) {
+        auto res = find_or_prepare(key);
+        if (res.second) slots[res.first] = value_type(key, T());
+        return slots[res.first].second;
+      }
+
+      size_t erase(Key const & key) {
+        size_t pos = find_index(key, mix(static_cast<uint64_t>(hash(key))));
+        if (pos == npos) return 0;
+        erase_at(pos);
+        return 1;
+      }
+
+      /// erase the element at pos.  returns the iterator to the next element.
+      iterator erase(const_iterator pos) {
+        size_t i = static_cast<size_t>(pos.ctrl - ctrl.data());
+        erase_at(i);
+        iterator it = make_iterator(i);
+        ++it;
+        return it;
+      }
+
+      // ============= lookup
+
+      iterator find(Key const & key) {
+        size_t pos = find_index(key, mix(static_cast<uint64_t>(hash(key))));
+        return (pos == npos) ? end() : make_iterator(pos);
+      }
+      const_iterator find(Key const & key) const {
+        size_t pos = find_index(key, mix(static_cast<uint64_t>(hash(key))));
+        return (pos == npos) ? cend() : make_iterator(pos);
+      }
+
+      size_t count(Key const & key) const {
+        return (find_index(key, mix(static_cast<uint64_t>(hash(key)))) == npos) ? 0 : 1;
+      }
+
+      /// hint that key will be looked up soon.  for pipelining lookups that are not batched by the range calls.
+      void prefetch(Key const & key) const {
+        prefetch_group(mix(static_cast<uint64_t>(hash(key))));
+      }
+
+      // lookups with the key's hash hv = hash_function()(key) precomputed.  the key is not hashed again.
+      iterator find(Key const & key, uint64_t hv) {
+        size_t pos = find_index(key, mix(hv));
+        return (pos == npos) ? end() : make_iterator(pos);
+      }
+      const_iterator find(Key const & key, uint64_t hv) const {
+        size_t pos = find_index(key, mix(hv));
+        return (pos == npos) ? cend() : make_iterator(pos);
+      }
+      size_t count(Key const & key, uint64_t hv) const {
+        return (find_index(key, mix(hv)) == npos) ? 0 : 1;
+      }
+      void prefetch(Key const &, uint64_t hv) const {
+        prefetch_group(mix(hv));
+      }
+
+      /**
+       * @brief batched find.  the elements of the keys in [first, last) that are present are written to out, in order.
+       * @return out after the last element written.
+       */
+      template <class ForwardIterator, class OutputIterator>
+      OutputIterator find(ForwardIterator first, ForwardIterator last, OutputIterator out) const {
+        uint64_t hs[batch_size];
+        while (first != last) {
+          size_t b = 0;
+          for (ForwardIterator it = first; (it != last) && (b < batch_size); ++it) ++b;
+          prefetch_batch(first, b, hs);
+
+          for (size_t i = 0; i < b; ++i, ++first) {
+            size_t pos = find_index(*first, hs[i]);
+            if (pos != npos) {
+              *out = slots[pos];
+              ++out;
+            }
+          }
+        }
+        return out;
+      }
+
+      /**
+       * @brief batched count.  a (key, count) pair is written to out for each key in [first, last), in order.
+       * @return out after the last pair written.
+       */
+      template <class ForwardIterator, class OutputIterator>
+      OutputIterator count(ForwardIterator first, ForwardIterator last, OutputIterator out) const {
+        uint64_t hs[batch_size];
+        while (first != last) {
+          size_t b = 0;
+          for (ForwardIterator it = first; (it != last) && (b < batch_size); ++it) ++b;
+          prefetch_batch(first, b, hs);
+
+          for (size_t i = 0; i < b; ++i, ++first, ++out) {
+            *out = ::std::make_pair(*first, (find_index(*first, hs[i]) == npos) ? static_cast<size_t>(0) : static_cast<size_t>(1));
+          }
+        }
+        return out;
+      }
+
+      ::std::pair<iterator, iterator> equal_range(Key const & key) {
+        iterator it = find(key);
+        if (it == end()) return ::std::make_pair(it, it);
+        iterator next = make_iterator(static_cast<size_t>(it.ctrl - ctrl.data()) + 1);
+        next.skip();
+        return ::std::make_pair(it, next);
+      }
+      ::std::pair<const_iterator, const_iterator> equal_range(Key const & key) const {
+        const_iterator it = find(key);
+        if (it == cend()) return ::std::make_pair(it, it);
+        const_iterator next = make_iterator(static_cast<size_t>(it.ctrl - ctrl.data()) + 1);
+        next.skip();
+        return ::std::make_pair(it, next);
+      }
+
+      /// @throw std::out_of_range if key is not present.
+      T & at(Key const & key) {
+        size_t pos = find_index(key, mix(static_cast<uint64_t>(hash(key))));
+        if (pos == npos) throw ::std::out_of_range("swiss_map::at key not found.");
+        return slots[pos].second;
+      }
+      T const & at(Key const & key) const {
+        size_t pos = find_index(key, mix(static_cast<uint64_t>(hash(key))));
+        if (pos == npos) throw ::std::out_of_range("swiss_map::at key not found.");
+        return slots[pos].second;
+      }
+
+      hasher hash_function() const { return hash; }
+      key_equal key_eq() const { return eq; }
+      allocator_type get_allocator() const { return slots.get_allocator(); }
+  };
+
+  template <typename Key, typename T, typename Hash, typename Equal, typename Alloc>
+  constexpr size_t swiss_map<Key, T, Hash, Equal, Alloc>::npos;
+  template <typename Key, typename T, typename Hash, typename Equal, typename Alloc>
+  constexpr size_t swiss_map<Key, T, Hash, Equal, Alloc>::batch_size;
+
+}  // namespace fsc
+
+#endif /* SRC_CONTAINERS_SWISS_MAP_HPP_ */
@@ -0,0 +1,252 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * mpi_test_distributed_counting_map.cpp
+ *   tests the distributed counting hash map against counts computed on the gathered input:
+ *   local combiner inserts, blocking and pipelined, table sizing, and solid key builds.
+ */
+
+// include google test
+#include <gtest/gtest.h>
+#include "bliss-config.hpp"
+
+#if defined(USE_MPI)
+#include "mxx/env.hpp"
+#include "mxx/comm.hpp"
+#include "mxx/collective.hpp"
+
+#include <map>
+#include <random>
+#include <algorithm>  // for sort.
+#include <cstdint>  // uint32_t
+#include <utility>  // pair
+#include <vector>
+
+// include files to test
+#include "utils/logging.h"
+#include "utils/transform_utils.hpp"
+#include "common/kmer.hpp"
+#include "common/alphabets.hpp"
+#include "index/kmer_hash.hpp"
+#include "iterators/transform_iterator.hpp"
+#include "containers/distributed_unordered_map.hpp"
+
+
+template <typename KM>
+using CountDistHash = ::bliss::kmer::hash::farm<KM, true>;
+template <typename KM>
+using CountStoreHash = ::bliss::kmer::hash::farm<KM, false>;
+
+template <typename Key>
+using CountMapParams = ::dsc::HashMapParams<Key,
+    ::bliss::transform::identity, ::bliss::transform::identity, CountDistHash, ::std::equal_to,
+    ::bliss::transform::identity, CountStoreHash, ::std::equal_to>;
+
+
+/*
+ * test class holding some information.  Also, needed for the typed tests
+ */
+template<typename Kmer>
+class DistributedCountingMapTest : public ::testing::Test
+{
+  protected:
+    using MapType = ::dsc::counting_unordered_map<Kmer, uint32_t, CountMapParams>;
+
+    ::mxx::comm comm;
+
+    /// distinct random kmers, the same on all ranks.
+    ::std::vector<Kmer> pool;
+    /// this rank's input:  pool entries drawn with repeats, so some kmers occur once overall and some many times.
+    ::std::vector<Kmer> input;
+    /// occurrences of each kmer in the input of all ranks.
+    ::std::map<Kmer, size_t> gold;
+
+    static Kmer random_kmer(::std::mt19937_64 & gen) {
+      Kmer km;
+      for (unsigned int j = 0; j < Kmer::size; ++j) km.nextFromChar(gen() % 4);
+      return km;
+    }
+
+    virtual void SetUp() {
+      ::std::mt19937_64 gen(23);
+      ::std::map<Kmer, bool> seen;
+      while (pool.size() < 4000) {
+        Kmer km = random_kmer(gen);
+        if (seen.emplace(km, true).second) pool.emplace_back(km);
+      }
+
+      ::std::mt19937_64 local(comm.rank() + 1);
+      for (size_t i = 0; i < 30000; ++i) {
+        // skew the draw toward the front of the pool, so the local combiner has duplicates to reduce.
+        size_t r = local() % pool.size();
+        input.emplace_back(pool[(i % 3 == 0) ? r : (r % 200)]);
+      }
+
+      ::std::vector<Kmer> all = ::mxx::allgatherv(input, comm);
+      for (auto const & k : all) ++gold[k];
+    }
+
+    /// the entries must be the gold counts times the number of inserts, restricted to the keys at least min_count.
+    ::testing::AssertionResult check_entries(MapType const & map, size_t times, size_t min_count = 0) {
+      ::std::vector<::std::pair<Kmer, uint32_t> > local;
+      map.to_vector(local);
+      ::std::vector<::std::pair<Kmer, uint32_t> > all = ::mxx::allgatherv(local, comm);
+      ::std::sort(all.begin(), all.end());
+
+      ::std::vector<::std::pair<Kmer, uint32_t> > expected;
+      for (auto const & x : gold)
+        if (x.second >= min_count) expected.emplace_back(x.first, x.second * times);
+
+      if (all.size() != expected.size())
+        return ::testing::AssertionFailure() << "map has " << all.size() << " entries, expected " << expected.size();
+      for (size_t i = 0; i < all.size(); ++i) {
+        if (!(all[i] == expected[i]))
+          return ::testing::AssertionFailure() << "entry " << i << " has count " << all[i].second << ", expected " << expected[i].second;
+      }
+      return ::testing::AssertionSuccess();
+    }
+};
+
+// indicate this is a typed test
+TYPED_TEST_CASE_P(DistributedCountingMapTest);
+
+
+TYPED_TEST_P(DistributedCountingMapTest, local_combiner)
+{
+  for (size_t capacity : {0UL, 16UL, 4096UL}) {
+    typename TestFixture::MapType map(this->comm);
+    map.set_local_combiner(capacity);
+
+    // the second insert reduces into existing entries.
+    ::std::vector<TypeParam> in = this->input;
+    map.insert(in);
+    in = this->input;
+    map.insert(in);
+
+    EXPECT_TRUE(this->check_entries(map, 2)) << "combiner capacity " << capacity;
+  }
+}
+
+
+TYPED_TEST_P(DistributedCountingMapTest, local_combiner_async)
+{
+  for (size_t capacity : {0UL, 16UL, 4096UL}) {
+    typename TestFixture::MapType map(this->comm);
+    map.set_local_combiner(capacity);
+
+    // chunks of the input, pipelined.  the combined pairs and the raw keys are flushed together.
+    for (size_t i = 0; i < this->input.size(); i += 7000) {
+      ::std::vector<TypeParam> in(this->input.begin() + i, this->input.begin() + ::std::min(i + 7000, this->input.size()));
+      map.insert_async(in);
+    }
+    map.insert_flush();
+
+    EXPECT_TRUE(this->check_entries(map, 1)) << "combiner capacity " << capacity;
+  }
+}
+
+
+TYPED_TEST_P(DistributedCountingMapTest, reserve)
+{
+  // each kmer occurs about 7 times in the input.  without the estimate the table is reserved for all the received keys,
+  // and with it for the estimated distinct keys.
+  size_t buckets[2] = {0, 0};
+  size_t needed = 0;
+  uint8_t precisions[2] = {0, 12};
+  for (int i = 0; i < 2; ++i) {
+    typename TestFixture::MapType map(this->comm);
+    map.set_reserve_estimation(precisions[i]);
+
+    ::std::vector<TypeParam> in = this->input;
+    map.insert(in);
+    EXPECT_TRUE(this->check_entries(map, 1)) << "precision " << static_cast<int>(precisions[i]);
+
+    buckets[i] = map.get_local_container().bucket_count();
+    needed = static_cast<size_t>(static_cast<double>(map.local_size()) / map.get_local_container().max_load_factor()) + 1;
+  }
+
+  // the estimate is within a few percent, and the bucket counts are rounded up.
+  EXPECT_LT(buckets[1], 2 * needed + 256) << "local size " << needed;
+  EXPECT_LT(buckets[1], buckets[0]);
+}
+
+
+TYPED_TEST_P(DistributedCountingMapTest, solid_build)
+{
+  typename TestFixture::MapType map(this->comm);
+  map.set_solid_filter(3, 1UL << 16);
+
+  // the sketch leaves the raw keys this rank owns in input, inserted locally.
+  ::std::vector<TypeParam> in = this->input;
+  map.sketch(in);
+  map.insert_sketched(in);
+  map.solid_finish();
+
+  // the counting filter has no false negatives, and solid_finish erases its false positives.
+  EXPECT_TRUE(this->check_entries(map, 1, 3));
+}
+
+
+TYPED_TEST_P(DistributedCountingMapTest, solid_build_combined)
+{
+  for (size_t capacity : {0UL, 4096UL}) {
+    typename TestFixture::MapType map(this->comm);
+    map.set_local_combiner(capacity);
+    map.set_solid_filter(3, 1UL << 16);
+
+    // the sketch leaves the owned raw keys in input and the owned combined counts in counts, inserted locally.
+    ::std::vector<TypeParam> in = this->input;
+    ::std::vector<::std::pair<TypeParam, uint32_t> > counts;
+    map.sketch(in, counts);
+    map.insert_sketched(in, counts);
+    map.solid_finish();
+
+    // the counting filter has no false negatives, and solid_finish erases its false positives.
+    EXPECT_TRUE(this->check_entries(map, 1, 3)) << "combiner capacity " << capacity;
+  }
+}
+
+
+// now register the test cases
+REGISTER_TYPED_TEST_CASE_P(DistributedCountingMapTest, local_combiner, local_combiner_async, reserve, solid_build, solid_build_combined);
+
+
+typedef ::testing::Types<
+    ::bliss::common::Kmer<21, ::bliss::common::DNA, uint64_t>,
+    ::bliss::common::Kmer<31, ::bliss::common::DNA, uint64_t>
+  > DistributedCountingMapTestTypes;
+INSTANTIATE_TYPED_TEST_CASE_P(Bliss, DistributedCountingMapTest, DistributedCountingMapTestTypes);
+
+#endif
+
+int main(int argc, char* argv[])
+{
+  int result = 0;
+
+  ::testing::InitGoogleTest(&argc, argv);
+
+#if defined(USE_MPI)
+  ::mxx::env e(argc, argv);
+  ::mxx::comm comm;
+
+  result = RUN_ALL_TESTS();
+
+  comm.barrier();
+#endif
+
+  return result;
+}
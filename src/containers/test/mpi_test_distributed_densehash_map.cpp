@@ -0,0 +1,259 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * mpi_test_distributed_densehash_map.cpp
+ *   tests the distributed densehash maps against counts computed on the gathered input:
+ *   find and count through the query pipeline, erase, and snapshots.
+ *   the 32-mer type fills its word, so it also covers the split (lower/upper) local container.
+ */
+
+// include google test
+#include <gtest/gtest.h>
+#include "bliss-config.hpp"
+
+#if defined(USE_MPI)
+#include "mxx/env.hpp"
+#include "mxx/comm.hpp"
+#include "mxx/collective.hpp"
+
+#include <cstdio>    // std::remove
+#include <map>
+#include <random>
+#include <string>
+#include <algorithm>  // for sort.
+#include <cstdint>  // uint32_t
+#include <utility>  // pair
+#include <vector>
+
+// include files to test
+#include "utils/logging.h"
+#include "utils/transform_utils.hpp"
+#include "common/kmer.hpp"
+#include "common/alphabets.hpp"
+#include "index/kmer_hash.hpp"
+#include "iterators/transform_iterator.hpp"
+#include "containers/distributed_densehash_map.hpp"
+#include "containers/map_snapshot.hpp"
+
+
+template <typename KM>
+using DenseDistHash = ::bliss::kmer::hash::farm<KM, true>;
+template <typename KM>
+using DenseStoreHash = ::bliss::kmer::hash::farm<KM, false>;
+
+template <typename Key>
+using DenseMapParams = ::dsc::HashMapParams<Key,
+    ::bliss::transform::identity, ::bliss::transform::identity, DenseDistHash, ::std::equal_to,
+    ::bliss::transform::identity, DenseStoreHash, ::std::equal_to>;
+
+
+/*
+ * test class holding some information.  Also, needed for the typed tests
+ */
+template<typename Kmer>
+class DistributedDenseHashMapTest : public ::testing::Test
+{
+  protected:
+    using MapType = ::dsc::counting_densehash_map<Kmer, uint32_t, DenseMapParams,
+        ::bliss::kmer::hash::sparsehash::special_keys<Kmer, false> >;
+
+    ::mxx::comm comm;
+
+    /// distinct random kmers, the same on all ranks.
+    ::std::vector<Kmer> pool;
+    /// this rank's input:  pool entries drawn with repeats, so some kmers occur once overall and some many times.
+    ::std::vector<Kmer> input;
+    /// kmers not in the pool.
+    ::std::vector<Kmer> absent;
+    /// occurrences of each kmer in the input of all ranks.
+    ::std::map<Kmer, size_t> gold;
+
+    static Kmer random_kmer(::std::mt19937_64 & gen) {
+      Kmer km;
+      for (unsigned int j = 0; j < Kmer::size; ++j) km.nextFromChar(gen() % 4);
+      return km;
+    }
+
+    virtual void SetUp() {
+      ::std::mt19937_64 gen(23);
+      ::std::map<Kmer, bool> seen;
+      while (pool.size() < 4000) {
+        Kmer km = random_kmer(gen);
+        if (seen.emplace(km, true).second) pool.emplace_back(km);
+      }
+      while (absent.size() < 500) {
+        Kmer km = random_kmer(gen);
+        if (seen.emplace(km, true).second) absent.emplace_back(km);
+      }
+
+      ::std::mt19937_64 local(comm.rank() + 1);
+      for (size_t i = 0; i < 30000; ++i) {
+        // skew the draw toward the front of the pool, so the local combiner has duplicates to reduce.
+        size_t r = local() % pool.size();
+        input.emplace_back(pool[(i % 3 == 0) ? r : (r % 200)]);
+      }
+
+      ::std::vector<Kmer> all = ::mxx::allgatherv(input, comm);
+      for (auto const & k : all) ++gold[k];
+    }
+
+    /// queries:  a slice of the pool, different on each rank, plus kmers that are not in the map.
+    ::std::vector<Kmer> queries() const {
+      ::std::vector<Kmer> q(pool.begin() + comm.rank() * 100, pool.begin() + comm.rank() * 100 + 2000);
+      q.insert(q.end(), absent.begin(), absent.end());
+      return q;
+    }
+
+    /// the local entries must be the gold counts times the number of inserts, restricted to the keys at least min_count.
+    ::testing::AssertionResult check_entries(MapType const & map, size_t times, size_t min_count = 0) {
+      ::std::vector<::std::pair<Kmer, uint32_t> > local;
+      map.to_vector(local);
+      ::std::vector<::std::pair<Kmer, uint32_t> > all = ::mxx::allgatherv(local, comm);
+      ::std::sort(all.begin(), all.end());
+
+      ::std::vector<::std::pair<Kmer, uint32_t> > expected;
+      for (auto const & x : gold)
+        if (x.second >= min_count) expected.emplace_back(x.first, x.second * times);
+
+      if (all.size() != expected.size())
+        return ::testing::AssertionFailure() << "map has " << all.size() << " entries, expected " << expected.size();
+      for (size_t i = 0; i < all.size(); ++i) {
+        if (!(all[i] == expected[i]))
+          return ::testing::AssertionFailure() << "entry " << i << " has count " << all[i].second << ", expected " << expected[i].second;
+      }
+      return ::testing::AssertionSuccess();
+    }
+};
+
+// indicate this is a typed test
+TYPED_TEST_CASE_P(DistributedDenseHashMapTest);
+
+
+TYPED_TEST_P(DistributedDenseHashMapTest, find_count_pipeline)
+{
+  typename TestFixture::MapType map(this->comm);
+  ::std::vector<TypeParam> in = this->input;
+  map.insert(in);
+  EXPECT_TRUE(this->check_entries(map, 1));
+
+  // 1 slot is the blocking exchange.  the byte cap forces several rounds with fewer slots.
+  for (size_t slots : {1UL, 2UL, 4UL}) {
+    for (size_t max_bytes : {0UL, 4096UL}) {
+      map.set_query_pipeline(slots, max_bytes);
+
+      ::std::vector<TypeParam> q = this->queries();
+      auto found = map.find(q);
+      size_t expected_found = 0;
+      for (auto const & k : this->queries()) expected_found += (this->gold.count(k) > 0);
+      EXPECT_EQ(expected_found, found.size()) << "slots " << slots << " max_bytes " << max_bytes;
+      for (auto const & x : found) {
+        EXPECT_EQ(this->gold[x.first], x.second) << "slots " << slots << " max_bytes " << max_bytes;
+      }
+
+      q = this->queries();
+      auto counted = map.count(q);
+      EXPECT_EQ(this->queries().size(), counted.size()) << "slots " << slots << " max_bytes " << max_bytes;
+      for (auto const & x : counted) {
+        EXPECT_EQ(this->gold.count(x.first), x.second) << "slots " << slots << " max_bytes " << max_bytes;
+      }
+    }
+  }
+}
+
+
+TYPED_TEST_P(DistributedDenseHashMapTest, erase)
+{
+  typename TestFixture::MapType map(this->comm);
+  ::std::vector<TypeParam> in = this->input;
+  map.insert(in);
+
+  // erase the front of the pool, which holds the frequent kmers, then count them again.
+  ::std::vector<TypeParam> keys(this->pool.begin(), this->pool.begin() + 300);
+  map.erase(keys);
+
+  ::std::vector<TypeParam> q(this->pool.begin(), this->pool.begin() + 600);
+  auto counted = map.count(q);
+  for (auto const & x : counted) {
+    size_t i = ::std::find(this->pool.begin(), this->pool.end(), x.first) - this->pool.begin();
+    EXPECT_EQ((i < 300) ? 0UL : this->gold.count(x.first), x.second);
+  }
+
+  // reinserting after erase reuses the deleted slots.
+  in = this->input;
+  map.insert(in);
+  q.assign(this->pool.begin(), this->pool.begin() + 300);
+  auto found = map.find(q);
+  for (auto const & x : found) {
+    EXPECT_EQ(this->gold[x.first], x.second);
+  }
+}
+
+
+TYPED_TEST_P(DistributedDenseHashMapTest, save_load)
+{
+  ::std::string path("densehash_snapshot_test");
+
+  typename TestFixture::MapType map(this->comm);
+  ::std::vector<TypeParam> in = this->input;
+  map.insert(in);
+  map.save(path);
+
+  typename TestFixture::MapType loaded(this->comm);
+  loaded.load(path);
+  EXPECT_TRUE(this->check_entries(loaded, 1));
+
+  // the loaded map's special keys are set:  insert and erase still work.
+  in = this->input;
+  loaded.insert(in);
+  EXPECT_TRUE(this->check_entries(loaded, 2));
+  ::std::vector<TypeParam> keys = this->pool;
+  loaded.erase(keys);
+  EXPECT_EQ(0UL, loaded.size());
+
+  ::std::remove(::dsc::snapshot::get_filename(path, this->comm.rank()).c_str());
+}
+
+
+// now register the test cases
+REGISTER_TYPED_TEST_CASE_P(DistributedDenseHashMapTest, find_count_pipeline, erase, save_load);
+
+
+typedef ::testing::Types<
+    ::bliss::common::Kmer<21, ::bliss::common::DNA, uint64_t>,
+    ::bliss::common::Kmer<32, ::bliss::common::DNA, uint64_t>
+  > DistributedDenseHashMapTestTypes;
+INSTANTIATE_TYPED_TEST_CASE_P(Bliss, DistributedDenseHashMapTest, DistributedDenseHashMapTestTypes);
+
+#endif
+
+int main(int argc, char* argv[])
+{
+  int result = 0;
+
+  ::testing::InitGoogleTest(&argc, argv);
+
+#if defined(USE_MPI)
+  ::mxx::env e(argc, argv);
+  ::mxx::comm comm;
+
+  result = RUN_ALL_TESTS();
+
+  comm.barrier();
+#endif
+
+  return result;
+}
@@ -0,0 +1,255 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * mpi_test_distributed_hot_keys.cpp
+ *   tests skew mitigation of the distributed hash maps on input dominated by a few hot keys:  blocking and chunked
+ *   pipelined builds must give the same counts as without mitigation, and spread the hot keys' elements.
+ */
+
+// include google test
+#include <gtest/gtest.h>
+#include "bliss-config.hpp"
+
+#if defined(USE_MPI)
+#include "mxx/env.hpp"
+#include "mxx/comm.hpp"
+#include "mxx/collective.hpp"
+
+#include <map>
+#include <random>
+#include <algorithm>  // for sort.
+#include <cstdint>  // uint32_t
+#include <utility>  // pair
+#include <vector>
+
+// include files to test
+#include "utils/logging.h"
+#include "utils/transform_utils.hpp"
+#include "common/kmer.hpp"
+#include "common/alphabets.hpp"
+#include "index/kmer_hash.hpp"
+#include "iterators/transform_iterator.hpp"
+#include "containers/distributed_unordered_map.hpp"
+
+
+template <typename KM>
+using HotDistHash = ::bliss::kmer::hash::farm<KM, true>;
+template <typename KM>
+using HotStoreHash = ::bliss::kmer::hash::farm<KM, false>;
+
+template <typename Key>
+using HotMapParams = ::dsc::HashMapParams<Key,
+    ::bliss::transform::identity, ::bliss::transform::identity, HotDistHash, ::std::equal_to,
+    ::bliss::transform::identity, HotStoreHash, ::std::equal_to>;
+
+
+/*
+ * test class holding some information.  Also, needed for the typed tests
+ */
+template<typename Kmer>
+class DistributedHotKeysTest : public ::testing::Test
+{
+  protected:
+    using CountMapType = ::dsc::counting_unordered_map<Kmer, uint32_t, HotMapParams>;
+    using MapType = ::dsc::unordered_map<Kmer, uint32_t, HotMapParams>;
+    using MultimapType = ::dsc::unordered_multimap<Kmer, uint32_t, HotMapParams>;
+
+    /// the hot key ratio for set_skew_mitigation.
+    static constexpr double ratio = 0.5;
+    /// elements per insert_async chunk.
+    static constexpr size_t chunk = 5000;
+
+    ::mxx::comm comm;
+
+    /// distinct random kmers, the same on all ranks.
+    ::std::vector<Kmer> pool;
+    /// this rank's input:  pool[0] is about 1/4 of it and pool[1] about 1/10, the rest is drawn from the whole pool.
+    ::std::vector<Kmer> input;
+    /// occurrences of each kmer in the input of all ranks.
+    ::std::map<Kmer, size_t> gold;
+
+    static Kmer random_kmer(::std::mt19937_64 & gen) {
+      Kmer km;
+      for (unsigned int j = 0; j < Kmer::size; ++j) km.nextFromChar(gen() % 4);
+      return km;
+    }
+
+    virtual void SetUp() {
+      ::std::mt19937_64 gen(31);
+      ::std::map<Kmer, bool> seen;
+      while (pool.size() < 2000) {
+        Kmer km = random_kmer(gen);
+        if (seen.emplace(km, true).second) pool.emplace_back(km);
+      }
+
+      ::std::mt19937_64 local(comm.rank() + 1);
+      for (size_t i = 0; i < 20000; ++i) {
+        size_t r = local() % 20;
+        input.emplace_back((r < 5) ? pool[0] : ((r < 7) ? pool[1] : pool[local() % pool.size()]));
+      }
+
+      ::std::vector<Kmer> all = ::mxx::allgatherv(input, comm);
+      for (auto const & k : all) ++gold[k];
+    }
+
+    /// the element pairs of the input, valued by position.
+    ::std::vector<::std::pair<Kmer, uint32_t> > pairs() const {
+      ::std::vector<::std::pair<Kmer, uint32_t> > kv;
+      for (size_t i = 0; i < input.size(); ++i) kv.emplace_back(input[i], static_cast<uint32_t>(i));
+      return kv;
+    }
+
+    /// insert in, blocking or in chunks with insert_async.
+    template <typename M, typename V>
+    void build(M & map, ::std::vector<V> const & in, bool async) {
+      if (!async) {
+        ::std::vector<V> a = in;
+        map.insert(a);
+        return;
+      }
+      for (size_t i = 0; i < in.size(); i += chunk) {
+        ::std::vector<V> a(in.begin() + i, in.begin() + ::std::min(i + chunk, in.size()));
+        map.insert_async(a);
+      }
+      map.insert_flush();
+    }
+
+    /// the counting map's entries must be the gold counts.
+    ::testing::AssertionResult check_counts(CountMapType const & map) {
+      ::std::vector<::std::pair<Kmer, uint32_t> > local;
+      map.to_vector(local);
+      ::std::vector<::std::pair<Kmer, uint32_t> > all = ::mxx::allgatherv(local, comm);
+      ::std::sort(all.begin(), all.end());
+
+      if (all.size() != gold.size())
+        return ::testing::AssertionFailure() << "map has " << all.size() << " entries, expected " << gold.size();
+      size_t i = 0;
+      for (auto const & x : gold) {
+        if (!(all[i].first == x.first) || (all[i].second != x.second))
+          return ::testing::AssertionFailure() << "entry " << i << " has count " << all[i].second << ", expected " << x.second;
+        ++i;
+      }
+      return ::testing::AssertionSuccess();
+    }
+
+    /// count queries for the whole pool must return the gold counts.
+    template <typename M>
+    ::testing::AssertionResult check_query_counts(M & map, bool multi) {
+      ::std::vector<Kmer> q = pool;
+      auto counts = map.count(q);
+      ::std::vector<::std::pair<Kmer, size_t> > all = ::mxx::allgatherv(counts, comm);
+      ::std::map<Kmer, size_t> found;
+      for (auto const & x : all) found[x.first] += x.second;
+
+      for (auto const & x : gold) {
+        size_t expected = multi ? x.second * comm.size() : comm.size();
+        if (found[x.first] != expected)
+          return ::testing::AssertionFailure() << "count " << found[x.first] << ", expected " << expected;
+      }
+      return ::testing::AssertionSuccess();
+    }
+};
+
+// indicate this is a typed test
+TYPED_TEST_CASE_P(DistributedHotKeysTest);
+
+
+TYPED_TEST_P(DistributedHotKeysTest, counting_map)
+{
+  for (bool async : {false, true}) {
+    typename TestFixture::CountMapType plain(this->comm);
+    this->build(plain, this->input, async);
+    EXPECT_TRUE(this->check_counts(plain)) << "async " << async;
+    double plain_imbalance = plain.get_recv_imbalance();
+
+    typename TestFixture::CountMapType map(this->comm);
+    map.set_skew_mitigation(TestFixture::ratio);
+    this->build(map, this->input, async);
+    EXPECT_TRUE(this->check_counts(map)) << "async " << async;
+
+    // the hot keys are counted before sending, so their owners no longer receive most of the input.
+    if (this->comm.size() > 1) EXPECT_LT(map.get_recv_imbalance(), plain_imbalance) << "async " << async;
+  }
+}
+
+
+TYPED_TEST_P(DistributedHotKeysTest, map)
+{
+  for (bool async : {false, true}) {
+    typename TestFixture::MapType map(this->comm);
+    map.set_skew_mitigation(TestFixture::ratio);
+    this->build(map, this->pairs(), async);
+
+    EXPECT_EQ(this->gold.size(), map.size()) << "async " << async;
+    EXPECT_TRUE(this->check_query_counts(map, false)) << "async " << async;
+  }
+}
+
+
+TYPED_TEST_P(DistributedHotKeysTest, multimap)
+{
+  for (bool async : {false, true}) {
+    typename TestFixture::MultimapType plain(this->comm);
+    this->build(plain, this->pairs(), async);
+    double plain_imbalance = plain.get_recv_imbalance();
+
+    typename TestFixture::MultimapType map(this->comm);
+    map.set_skew_mitigation(TestFixture::ratio);
+    this->build(map, this->pairs(), async);
+
+    EXPECT_EQ(this->input.size() * this->comm.size(), map.size()) << "async " << async;
+    EXPECT_EQ(this->gold.size(), map.unique_size()) << "async " << async;
+    EXPECT_TRUE(this->check_query_counts(map, true)) << "async " << async;
+
+    // the hot keys' elements are spread over all ranks.
+    if (this->comm.size() > 1) {
+      EXPECT_LE(1UL, map.hot_key_count()) << "async " << async;
+      EXPECT_LT(map.get_recv_imbalance(), plain_imbalance) << "async " << async;
+    }
+  }
+}
+
+
+// now register the test cases
+REGISTER_TYPED_TEST_CASE_P(DistributedHotKeysTest, counting_map, map, multimap);
+
+
+typedef ::testing::Types<
+    ::bliss::common::Kmer<21, ::bliss::common::DNA, uint64_t>,
+    ::bliss::common::Kmer<31, ::bliss::common::DNA, uint64_t>
+  > DistributedHotKeysTestTypes;
+INSTANTIATE_TYPED_TEST_CASE_P(Bliss, DistributedHotKeysTest, DistributedHotKeysTestTypes);
+
+#endif
+
+int main(int argc, char* argv[])
+{
+  int result = 0;
+
+  ::testing::InitGoogleTest(&argc, argv);
+
+#if defined(USE_MPI)
+  ::mxx::env e(argc, argv);
+  ::mxx::comm comm;
+
+  result = RUN_ALL_TESTS();
+
+  comm.barrier();
+#endif
+
+  return result;
+}
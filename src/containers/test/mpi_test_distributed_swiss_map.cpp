@@ -0,0 +1,287 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * mpi_test_distributed_swiss_map.cpp
+ *   tests the dsc hash maps with fsc::swiss_map local storage against the same maps with the default
+ *   std::unordered_map storage.  swiss_map has prefetch, so its maps take the batched insert and query paths.
+ */
+
+// include google test
+#include <gtest/gtest.h>
+#include "bliss-config.hpp"
+
+#if defined(USE_MPI)
+#include "mxx/env.hpp"
+#include "mxx/comm.hpp"
+#include "mxx/collective.hpp"
+#include "mxx/reduction.hpp"
+
+#include <random>
+#include <algorithm>  // for sort.
+#include <cstdint>  // uint32_t
+#include <utility>  // pair
+#include <vector>
+
+// include files to test
+#include "utils/logging.h"
+#include "utils/transform_utils.hpp"
+#include "common/kmer.hpp"
+#include "common/alphabets.hpp"
+#include "index/kmer_hash.hpp"
+#include "iterators/transform_iterator.hpp"
+#include "containers/distributed_unordered_map.hpp"
+#include "containers/swiss_map.hpp"
+
+
+template <typename KM>
+using SwissDistHash = ::bliss::kmer::hash::farm<KM, true>;
+template <typename KM>
+using SwissStoreHash = ::bliss::kmer::hash::farm<KM, false>;
+
+template <typename Key>
+using SwissMapParams = ::dsc::HashMapParams<Key,
+    ::bliss::transform::identity, ::bliss::transform::identity, SwissDistHash, ::std::equal_to,
+    ::bliss::transform::identity, SwissStoreHash, ::std::equal_to>;
+
+static_assert(::fsc::has_prefetch<::fsc::swiss_map<uint64_t, uint32_t> >::value, "swiss_map should take the prefetching paths.");
+
+
+/*
+ * test class holding some information.  Also, needed for the typed tests
+ */
+template<typename Kmer>
+class DistributedSwissMapTest : public ::testing::Test
+{
+  protected:
+    using Alloc = ::std::allocator<::std::pair<const Kmer, uint32_t> >;
+    using CountMapType = ::dsc::counting_unordered_map<Kmer, uint32_t, SwissMapParams>;
+    using SwissCountMapType = ::dsc::counting_unordered_map<Kmer, uint32_t, SwissMapParams, Alloc, ::fsc::swiss_map>;
+    using MapType = ::dsc::unordered_map<Kmer, uint32_t, SwissMapParams>;
+    using SwissMapType = ::dsc::unordered_map<Kmer, uint32_t, SwissMapParams, Alloc, ::fsc::swiss_map>;
+
+    ::mxx::comm comm;
+
+    /// this rank's keys, drawn with repeats from a pool that is the same on all ranks.
+    ::std::vector<Kmer> input;
+    /// pool kmers, queried on all ranks, plus kmers that were not inserted.
+    ::std::vector<Kmer> query;
+
+    static Kmer random_kmer(::std::mt19937_64 & gen) {
+      Kmer km;
+      for (unsigned int j = 0; j < Kmer::size; ++j) km.nextFromChar(gen() % 4);
+      return km;
+    }
+
+    virtual void SetUp() {
+      ::std::mt19937_64 gen(29);
+      ::std::vector<Kmer> pool;
+      for (size_t i = 0; i < 5000; ++i) pool.emplace_back(random_kmer(gen));
+
+      ::std::mt19937_64 local(comm.rank() + 1);
+      for (size_t i = 0; i < 20000; ++i) input.emplace_back(pool[local() % pool.size()]);
+
+      query.assign(pool.begin() + comm.rank() * 50, pool.begin() + comm.rank() * 50 + 3000);
+      for (size_t i = 0; i < 500; ++i) query.emplace_back(random_kmer(local));
+    }
+
+    /// all entries of a map, gathered and sorted.
+    template <typename M>
+    ::std::vector<::std::pair<Kmer, uint32_t> > entries(M const & map) {
+      ::std::vector<::std::pair<Kmer, uint32_t> > local;
+      map.to_vector(local);
+      ::std::vector<::std::pair<Kmer, uint32_t> > all = ::mxx::allgatherv(local, comm);
+      ::std::sort(all.begin(), all.end());
+      return all;
+    }
+
+    template <typename V>
+    static ::std::vector<V> sorted(::std::vector<V> x) {
+      ::std::sort(x.begin(), x.end());
+      return x;
+    }
+
+    /// single hash mode, which sends the storage hash with each element, on the map under test.
+    template <typename M>
+    struct SingleHash : public M {
+        SingleHash(::mxx::comm const & _comm) : M(_comm) {
+          this->set_single_hash(true);
+        }
+    };
+
+    /// insert, find, count and erase on the 2 maps must give the same results.  the key-value inserts of a map
+    /// keep one value per key, which may depend on the arrival order, so only the keys are compared there.
+    template <typename Gold, typename Test, typename Input>
+    void compare(Input const & in, bool compare_values) {
+      Gold gold(comm);
+      Test test(comm);
+
+      // insert twice.  the second insert finds existing entries.
+      for (int r = 0; r < 2; ++r) {
+        Input a = in;
+        gold.insert(a);
+        Input b = in;
+        test.insert(b);
+      }
+      EXPECT_EQ(gold.size(), test.size());
+      auto ge = entries(gold), te = entries(test);
+      ASSERT_EQ(ge.size(), te.size());
+      for (size_t i = 0; i < ge.size(); ++i) {
+        EXPECT_TRUE(ge[i].first == te[i].first);
+        if (compare_values) EXPECT_EQ(ge[i].second, te[i].second);
+      }
+
+      ::std::vector<Kmer> q = query;
+      auto gc = sorted(gold.count(q));
+      q = query;
+      auto tc = sorted(test.count(q));
+      EXPECT_TRUE(gc == tc);
+
+      q = query;
+      auto gf = sorted(gold.find(q));
+      q = query;
+      auto tf = sorted(test.find(q));
+      ASSERT_EQ(gf.size(), tf.size());
+      for (size_t i = 0; i < gf.size(); ++i) {
+        EXPECT_TRUE(gf[i].first == tf[i].first);
+        if (compare_values) EXPECT_EQ(gf[i].second, tf[i].second);
+      }
+
+      // erase half of the queries, including some that are absent, then count all of them again.
+      q.assign(query.begin(), query.begin() + query.size() / 2);
+      size_t gerased = gold.erase(q);
+      q.assign(query.begin(), query.begin() + query.size() / 2);
+      size_t terased = test.erase(q);
+      // erase returns the local count, which depends on the key to rank mapping.
+      EXPECT_EQ(::mxx::allreduce(gerased, comm), ::mxx::allreduce(terased, comm));
+      EXPECT_EQ(gold.size(), test.size());
+
+      q = query;
+      gc = sorted(gold.count(q));
+      q = query;
+      tc = sorted(test.count(q));
+      EXPECT_TRUE(gc == tc);
+    }
+
+    /// a pipelined insert in chunks must build the same map as a blocking insert of all the input.
+    template <typename Gold, typename Test, typename Input>
+    void compare_async(Input const & in, size_t chunk, bool compare_values) {
+      Gold gold(comm);
+      Input a = in;
+      gold.insert(a);
+
+      Test test(comm);
+      for (size_t i = 0; i < in.size(); i += chunk) {
+        Input b(in.begin() + i, in.begin() + ::std::min(i + chunk, in.size()));
+        test.insert_async(b);
+      }
+      test.insert_flush();
+
+      EXPECT_EQ(gold.size(), test.size());
+      auto ge = entries(gold), te = entries(test);
+      ASSERT_EQ(ge.size(), te.size());
+      for (size_t i = 0; i < ge.size(); ++i) {
+        EXPECT_TRUE(ge[i].first == te[i].first);
+        if (compare_values) EXPECT_EQ(ge[i].second, te[i].second);
+      }
+    }
+};
+
+// indicate this is a typed test
+TYPED_TEST_CASE_P(DistributedSwissMapTest);
+
+
+TYPED_TEST_P(DistributedSwissMapTest, counting_map)
+{
+  this->template compare<typename TestFixture::CountMapType, typename TestFixture::SwissCountMapType>(this->input, true);
+}
+
+TYPED_TEST_P(DistributedSwissMapTest, map)
+{
+  ::std::vector<::std::pair<TypeParam, uint32_t> > kv;
+  for (size_t i = 0; i < this->input.size(); ++i) kv.emplace_back(this->input[i], static_cast<uint32_t>(i));
+
+  this->template compare<typename TestFixture::MapType, typename TestFixture::SwissMapType>(kv, false);
+}
+
+
+TYPED_TEST_P(DistributedSwissMapTest, insert_async)
+{
+  this->template compare_async<typename TestFixture::CountMapType, typename TestFixture::SwissCountMapType>(this->input, 3000, true);
+
+  ::std::vector<::std::pair<TypeParam, uint32_t> > kv;
+  for (size_t i = 0; i < this->input.size(); ++i) kv.emplace_back(this->input[i], static_cast<uint32_t>(i));
+  this->template compare_async<typename TestFixture::MapType, typename TestFixture::SwissMapType>(kv, 3000, false);
+}
+
+TYPED_TEST_P(DistributedSwissMapTest, single_hash)
+{
+  using SingleCountMapType = typename TestFixture::template SingleHash<typename TestFixture::SwissCountMapType>;
+  using SingleMapType = typename TestFixture::template SingleHash<typename TestFixture::SwissMapType>;
+
+  this->template compare<typename TestFixture::CountMapType, SingleCountMapType>(this->input, true);
+  this->template compare_async<typename TestFixture::CountMapType, SingleCountMapType>(this->input, 3000, true);
+
+  ::std::vector<::std::pair<TypeParam, uint32_t> > kv;
+  for (size_t i = 0; i < this->input.size(); ++i) kv.emplace_back(this->input[i], static_cast<uint32_t>(i));
+  this->template compare<typename TestFixture::MapType, SingleMapType>(kv, false);
+
+  // the local combiner sends (key, count) pairs next to the raw keys.
+  SingleCountMapType combined(this->comm);
+  combined.set_local_combiner(1024);
+  ::std::vector<TypeParam> in = this->input;
+  combined.insert(in);
+  typename TestFixture::CountMapType gold(this->comm);
+  in = this->input;
+  gold.insert(in);
+  EXPECT_TRUE(this->entries(gold) == this->entries(combined));
+
+  // std::unordered_map local storage cannot take the hashes.
+  typename TestFixture::CountMapType plain(this->comm);
+  EXPECT_THROW(plain.set_single_hash(true), std::invalid_argument);
+}
+
+
+// now register the test cases
+REGISTER_TYPED_TEST_CASE_P(DistributedSwissMapTest, counting_map, map, insert_async, single_hash);
+
+
+typedef ::testing::Types<
+    ::bliss::common::Kmer<21, ::bliss::common::DNA, uint64_t>,
+    ::bliss::common::Kmer<31, ::bliss::common::DNA, uint64_t>,
+    ::bliss::common::Kmer<40, ::bliss::common::DNA, uint64_t>
+  > DistributedSwissMapTestTypes;
+INSTANTIATE_TYPED_TEST_CASE_P(Bliss, DistributedSwissMapTest, DistributedSwissMapTestTypes);
+
+#endif
+
+int main(int argc, char* argv[])
+{
+  int result = 0;
+
+  ::testing::InitGoogleTest(&argc, argv);
+
+#if defined(USE_MPI)
+  ::mxx::env e(argc, argv);
+  ::mxx::comm comm;
+
+  result = RUN_ALL_TESTS();
+
+  comm.barrier();
+#endif
+
+  return result;
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * mpi_test_map_snapshot.cpp
+ *   tests save and load of the distributed unordered and sorted maps:  a loaded map has the same local
+ *   entries as the saved one, answers queries the same way, and accepts further inserts.
+ *   snapshots with different tags are rejected.
+ */
+
+// include google test
+#include <gtest/gtest.h>
+#include "bliss-config.hpp"
+
+#if defined(USE_MPI)
+#include "mxx/env.hpp"
+#include "mxx/comm.hpp"
+#include "mxx/collective.hpp"
+
+#include <cstdio>    // std::remove
+#include <map>
+#include <random>
+#include <string>
+#include <stdexcept>  // invalid_argument
+#include <algorithm>  // for sort.
+#include <cstdint>  // uint32_t
+#include <utility>  // pair
+#include <vector>
+
+// include files to test
+#include "utils/logging.h"
+#include "utils/transform_utils.hpp"
+#include "common/kmer.hpp"
+#include "common/alphabets.hpp"
+#include "index/kmer_hash.hpp"
+#include "iterators/transform_iterator.hpp"
+#include "containers/distributed_unordered_map.hpp"
+#include "containers/distributed_sorted_map.hpp"
+#include "containers/map_snapshot.hpp"
+
+
+template <typename KM>
+using SnapDistHash = ::bliss::kmer::hash::farm<KM, true>;
+template <typename KM>
+using SnapStoreHash = ::bliss::kmer::hash::farm<KM, false>;
+
+template <typename Key>
+using SnapHashMapParams = ::dsc::HashMapParams<Key,
+    ::bliss::transform::identity, ::bliss::transform::identity, SnapDistHash, ::std::equal_to,
+    ::bliss::transform::identity, SnapStoreHash, ::std::equal_to>;
+
+template <typename Key>
+using SnapSortedMapParams = ::dsc::SortedMapParams<Key,
+    ::bliss::transform::identity, ::bliss::transform::identity, ::std::less, ::std::equal_to>;
+
+
+/*
+ * test class holding some information.  Also, needed for the typed tests
+ */
+template<typename MapType>
+class MapSnapshotTest : public ::testing::Test
+{
+  protected:
+    using Kmer = typename MapType::key_type;
+    using Entries = ::std::vector<::std::pair<Kmer, uint32_t> >;
+
+    ::mxx::comm comm;
+
+    /// this rank's input:  random kmers drawn with repeats.
+    ::std::vector<Kmer> input;
+    /// kmers queried after load, some present and some not.
+    ::std::vector<Kmer> queries;
+
+    ::std::string path;
+
+    static Kmer random_kmer(::std::mt19937_64 & gen) {
+      Kmer km;
+      for (unsigned int j = 0; j < Kmer::size; ++j) km.nextFromChar(gen() % 4);
+      return km;
+    }
+
+    virtual void SetUp() {
+      ::std::mt19937_64 gen(31);
+      ::std::vector<Kmer> pool;
+      for (size_t i = 0; i < 3000; ++i) pool.emplace_back(random_kmer(gen));
+
+      ::std::mt19937_64 local(comm.rank() + 1);
+      for (size_t i = 0; i < 20000; ++i) input.emplace_back(pool[local() % pool.size()]);
+
+      queries.assign(pool.begin() + comm.rank() * 100, pool.begin() + comm.rank() * 100 + 1000);
+      for (size_t i = 0; i < 200; ++i) queries.emplace_back(random_kmer(local));
+
+      path = "map_snapshot_test";
+    }
+
+    virtual void TearDown() {
+      ::std::remove(::dsc::snapshot::get_filename(path, comm.rank()).c_str());
+    }
+
+    /// this rank's entries, sorted.
+    static Entries local_entries(MapType const & map) {
+      Entries local;
+      map.to_vector(local);
+      ::std::sort(local.begin(), local.end());
+      return local;
+    }
+
+    /// found entries for the queries, sorted.
+    Entries found(MapType & map) const {
+      ::std::vector<Kmer> q = queries;
+      Entries res = map.find(q);
+      ::std::sort(res.begin(), res.end());
+      return res;
+    }
+};
+
+// indicate this is a typed test
+TYPED_TEST_CASE_P(MapSnapshotTest);
+
+
+TYPED_TEST_P(MapSnapshotTest, save_load)
+{
+  TypeParam map(this->comm);
+  ::std::vector<typename TestFixture::Kmer> in = this->input;
+  map.insert(in);
+  map.save(this->path);
+
+  TypeParam loaded(this->comm);
+  loaded.load(this->path);
+
+  // same entries on each rank, so the distribution is unchanged.
+  EXPECT_EQ(map.local_size(), loaded.local_size());
+  EXPECT_TRUE(this->local_entries(map) == this->local_entries(loaded));
+  EXPECT_TRUE(this->found(map) == this->found(loaded));
+
+  // the loaded map keeps counting.
+  in = this->input;
+  map.insert(in);
+  in = this->input;
+  loaded.insert(in);
+  EXPECT_TRUE(this->local_entries(map) == this->local_entries(loaded));
+  EXPECT_TRUE(this->found(map) == this->found(loaded));
+}
+
+
+TYPED_TEST_P(MapSnapshotTest, load_replaces_content)
+{
+  TypeParam map(this->comm);
+  ::std::vector<typename TestFixture::Kmer> in = this->input;
+  map.insert(in);
+  map.save(this->path);
+
+  // a map with content is cleared by load.
+  TypeParam loaded(this->comm);
+  in = this->input;
+  loaded.insert(in);
+  in = this->input;
+  loaded.insert(in);
+  loaded.load(this->path);
+
+  EXPECT_TRUE(this->local_entries(map) == this->local_entries(loaded));
+}
+
+
+TYPED_TEST_P(MapSnapshotTest, tags)
+{
+  uint64_t tags[2] = {31, 4};
+  uint64_t other[2] = {21, 4};
+
+  TypeParam map(this->comm);
+  ::std::vector<typename TestFixture::Kmer> in = this->input;
+  map.insert(in);
+  map.save(this->path, tags);
+
+  TypeParam loaded(this->comm);
+  EXPECT_THROW(loaded.load(this->path, other), ::std::invalid_argument);
+  EXPECT_THROW(loaded.load(this->path), ::std::invalid_argument);
+
+  loaded.load(this->path, tags);
+  EXPECT_TRUE(this->local_entries(map) == this->local_entries(loaded));
+}
+
+
+// now register the test cases
+REGISTER_TYPED_TEST_CASE_P(MapSnapshotTest, save_load, load_replaces_content, tags);
+
+
+typedef ::testing::Types<
+    ::dsc::counting_unordered_map<::bliss::common::Kmer<21, ::bliss::common::DNA, uint64_t>, uint32_t, SnapHashMapParams>,
+    ::dsc::counting_unordered_map<::bliss::common::Kmer<31, ::bliss::common::DNA, uint64_t>, uint32_t, SnapHashMapParams>,
+    ::dsc::counting_sorted_map<::bliss::common::Kmer<21, ::bliss::common::DNA, uint64_t>, uint32_t, SnapSortedMapParams>,
+    ::dsc::counting_sorted_map<::bliss::common::Kmer<31, ::bliss::common::DNA, uint64_t>, uint32_t, SnapSortedMapParams>
+  > MapSnapshotTestTypes;
+INSTANTIATE_TYPED_TEST_CASE_P(Bliss, MapSnapshotTest, MapSnapshotTestTypes);
+
+#endif
+
+int main(int argc, char* argv[])
+{
+  int result = 0;
+
+  ::testing::InitGoogleTest(&argc, argv);
+
+#if defined(USE_MPI)
+  ::mxx::env e(argc, argv);
+  ::mxx::comm comm;
+
+  result = RUN_ALL_TESTS();
+
+  comm.barrier();
+#endif
+
+  return result;
+}
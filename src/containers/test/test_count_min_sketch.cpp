@@ -0,0 +1,128 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// include google test
+#include <gtest/gtest.h>
+#include "containers/fsc_count_min_sketch.hpp"
+
+#include <unordered_map>
+#include <random>
+#include <vector>
+#include <stdexcept>
+
+// include files to test
+#include "utils/logging.h"
+
+/*
+ * test class holding some information.  Also, needed for the typed tests
+ */
+template<typename T>
+class CountMinSketchTest : public ::testing::Test
+{
+  protected:
+    ::std::vector<T> input;
+    ::std::unordered_map<T, size_t> gold;
+
+    /// zipf-like input:  key i appears about count / (i + 1) times.
+    void generate(size_t count, size_t distinct) {
+      std::default_random_engine generator;
+      std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+      input.clear();
+      gold.clear();
+      for (size_t i = 0; i < count; ++i) {
+        T key = static_cast<T>(static_cast<double>(distinct) * distribution(generator) * distribution(generator));
+        input.emplace_back(key);
+        ++gold[key];
+      }
+    }
+};
+
+// indicate this is a typed test
+TYPED_TEST_CASE_P(CountMinSketchTest);
+
+TYPED_TEST_P(CountMinSketchTest, bounds)
+{
+  this->generate(100000, 10000);
+
+  ::fsc::count_min_sketch<TypeParam> sketch(4096);
+  EXPECT_EQ(4096UL, sketch.width());
+  for (auto x : this->input) sketch.update(x);
+
+  // never undercounts, and overcounts by little.
+  size_t under = 0;
+  size_t over = 0;
+  for (auto x : this->gold) {
+    size_t est = sketch.estimate(x.first);
+    if (est < x.second) ++under;
+    if (est > x.second + 3 * this->input.size() / sketch.width()) ++over;
+  }
+  EXPECT_EQ(0UL, under);
+  EXPECT_GT(this->gold.size() / 100, over);
+}
+
+TYPED_TEST_P(CountMinSketchTest, threshold)
+{
+  this->generate(100000, 1000);
+
+  // each update raises the estimate by 1, so a key reaches a threshold exactly once.
+  ::fsc::count_min_sketch<TypeParam> sketch(4096);
+  ::std::unordered_map<TypeParam, size_t> crossed;
+  for (auto x : this->input) {
+    if (sketch.update(x) == 200) ++crossed[x];
+  }
+
+  size_t mismatches = 0;
+  for (auto x : this->gold) {
+    if ((x.second >= 200) && (crossed.count(x.first) == 0)) ++mismatches;
+  }
+  for (auto x : crossed) {
+    if (x.second != 1) ++mismatches;
+  }
+  EXPECT_EQ(0UL, mismatches);
+  EXPECT_LT(0UL, crossed.size());
+}
+
+TYPED_TEST_P(CountMinSketchTest, clear)
+{
+  ::fsc::count_min_sketch<TypeParam> sketch(1000, 3);
+  EXPECT_EQ(1024UL, sketch.width());
+  EXPECT_EQ(3UL, sketch.rows());
+  EXPECT_EQ(3 * 1024 * sizeof(uint32_t), sketch.memory());
+
+  EXPECT_EQ(1U, sketch.update(5));
+  EXPECT_EQ(2U, sketch.update(5));
+  EXPECT_EQ(2U, sketch.estimate(5));
+
+  sketch.clear();
+  EXPECT_EQ(0U, sketch.estimate(5));
+
+  EXPECT_THROW(::fsc::count_min_sketch<TypeParam>(0), ::std::invalid_argument);
+  EXPECT_THROW(::fsc::count_min_sketch<TypeParam>(16, 0), ::std::invalid_argument);
+}
+
+
+// now register the test cases
+REGISTER_TYPED_TEST_CASE_P(CountMinSketchTest, bounds, threshold, clear);
+
+//////////////////// RUN the tests with different types.
+
+typedef ::testing::Types<
+    uint32_t,
+    uint64_t
+> CountMinSketchTestTypes;
+INSTANTIATE_TYPED_TEST_CASE_P(Bliss, CountMinSketchTest, CountMinSketchTestTypes);
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// include google test
+#include <gtest/gtest.h>
+#include "containers/fsc_counting_bloom_filter.hpp"
+
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
+
+// include files to test
+#include "utils/logging.h"
+
+/*
+ * test class holding some information.  Also, needed for the typed tests
+ */
+template<typename T>
+class CountingBloomFilterTest : public ::testing::Test
+{
+  protected:
+    /// key i occurs (i % 4) + 1 times.
+    size_t distinct = 100000;
+
+    T key(size_t i) { return static_cast<T>(i * 2654435761UL); }
+    size_t occurrences(size_t i) { return (i % 4) + 1; }
+};
+
+// indicate this is a typed test
+TYPED_TEST_CASE_P(CountingBloomFilterTest);
+
+TYPED_TEST_P(CountingBloomFilterTest, estimate)
+{
+  ::fsc::counting_bloom_filter<TypeParam> filter(8 * this->distinct);
+  EXPECT_EQ(1048576UL, filter.counter_count());
+  EXPECT_EQ(524288UL, filter.memory());
+
+  // interleaved, so each key's count grows in steps.
+  for (size_t r = 0; r < 4; ++r) {
+    for (size_t i = 0; i < this->distinct; ++i) {
+      if (r < this->occurrences(i)) filter.update(this->key(i));
+    }
+  }
+
+  // never under, and rarely over.
+  size_t under = 0, over = 0;
+  for (size_t i = 0; i < this->distinct; ++i) {
+    uint8_t est = filter.estimate(this->key(i));
+    if (est < this->occurrences(i)) ++under;
+    else if (est > this->occurrences(i)) ++over;
+  }
+  EXPECT_EQ(0UL, under);
+  EXPECT_GT(this->distinct / 50, over);
+
+  // absent keys mostly read below threshold 2.
+  size_t solid = 0;
+  for (size_t i = this->distinct; i < 2 * this->distinct; ++i) {
+    if (filter.estimate(this->key(i)) >= 2) ++solid;
+  }
+  EXPECT_GT(this->distinct / 50, solid);
+
+  filter.clear();
+  EXPECT_EQ(0, filter.estimate(this->key(3)));
+}
+
+TYPED_TEST_P(CountingBloomFilterTest, saturate)
+{
+  ::fsc::counting_bloom_filter<TypeParam> filter(1024, 4);
+
+  // bulk counts, capped at max_count.
+  EXPECT_EQ(3, filter.update(this->key(1), 3));
+  EXPECT_EQ(10, filter.update(this->key(1), 7));
+  EXPECT_EQ(15, filter.update(this->key(1), 100));
+  EXPECT_EQ(15, filter.update(this->key(1)));
+  EXPECT_EQ(15, filter.estimate(this->key(1)));
+
+  // both counters of a byte.
+  for (size_t i = 2; i < 200; ++i) filter.update(this->key(i), i % 16);
+  for (size_t i = 2; i < 200; ++i) EXPECT_LE(i % 16, filter.estimate(this->key(i)));
+
+  ::fsc::counting_bloom_filter<TypeParam> empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(0UL, empty.counter_count());
+  empty.resize(3);
+  EXPECT_EQ(4UL, empty.counter_count());
+  EXPECT_EQ(2UL, empty.memory());
+
+  EXPECT_THROW(::fsc::counting_bloom_filter<TypeParam>(16, 0), ::std::invalid_argument);
+  EXPECT_THROW(::fsc::counting_bloom_filter<TypeParam>(16, 17), ::std::invalid_argument);
+}
+
+
+// now register the test cases
+REGISTER_TYPED_TEST_CASE_P(CountingBloomFilterTest, estimate, saturate);
+
+//////////////////// RUN the tests with different types.
+
+typedef ::testing::Types<
+    uint32_t,
+    uint64_t
+> CountingBloomFilterTestTypes;
+INSTANTIATE_TYPED_TEST_CASE_P(Bliss, CountingBloomFilterTest, CountingBloomFilterTestTypes);
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// include google test
+#include <gtest/gtest.h>
+#include "containers/fsc_hyperloglog.hpp"
+
+#include <cmath>
+#include <vector>
+#include <stdexcept>
+
+// include files to test
+#include "utils/logging.h"
+
+/*
+ * test class holding some information.  Also, needed for the typed tests
+ */
+template<typename T>
+class HyperLogLogTest : public ::testing::Test
+{
+  protected:
+    /// relative error of est against the true count.
+    double rel_error(double est, size_t count) {
+      return ::std::abs(est - static_cast<double>(count)) / static_cast<double>(count);
+    }
+};
+
+// indicate this is a typed test
+TYPED_TEST_CASE_P(HyperLogLogTest);
+
+TYPED_TEST_P(HyperLogLogTest, estimate)
+{
+  ::fsc::hyperloglog<TypeParam> sketch(14);
+  EXPECT_EQ(16384UL, sketch.register_count());
+  EXPECT_EQ(0.0, sketch.estimate());
+
+  // small range, then large range.  each key is added 3 times.
+  size_t checks[] = {100, 1000, 10000, 100000, 1000000};
+  size_t added = 0;
+  for (size_t c : checks) {
+    for (; added < c; ++added) {
+      for (size_t r = 0; r < 3; ++r) sketch.update(static_cast<TypeParam>(added * 2654435761UL));
+    }
+    // 4 standard errors.
+    EXPECT_GT(4.0 * sketch.error(), this->rel_error(sketch.estimate(), c)) << "distinct " << c;
+  }
+}
+
+TYPED_TEST_P(HyperLogLogTest, merge)
+{
+  // 2 overlapping halves.
+  ::fsc::hyperloglog<TypeParam> a(12), b(12);
+  for (size_t i = 0; i < 60000; ++i) a.update(static_cast<TypeParam>(i));
+  for (size_t i = 40000; i < 100000; ++i) b.update(static_cast<TypeParam>(i));
+
+  a.merge(b);
+  EXPECT_GT(4.0 * a.error(), this->rel_error(a.estimate(), 100000));
+
+  a.clear();
+  EXPECT_EQ(0.0, a.estimate());
+
+  ::fsc::hyperloglog<TypeParam> c(10);
+  EXPECT_THROW(a.merge(c), ::std::invalid_argument);
+  EXPECT_THROW(::fsc::hyperloglog<TypeParam>(2), ::std::invalid_argument);
+  EXPECT_THROW(::fsc::hyperloglog<TypeParam>(20), ::std::invalid_argument);
+}
+
+
+// now register the test cases
+REGISTER_TYPED_TEST_CASE_P(HyperLogLogTest, estimate, merge);
+
+//////////////////// RUN the tests with different types.
+
+typedef ::testing::Types<
+    uint32_t,
+    uint64_t
+> HyperLogLogTestTypes;
+INSTANTIATE_TYPED_TEST_CASE_P(Bliss, HyperLogLogTest, HyperLogLogTestTypes);
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// include google test
+#include <gtest/gtest.h>
+#include "containers/dsc_local_combiner.hpp"
+
+#include <unordered_map>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+// include files to test
+#include "utils/logging.h"
+
+/*
+ * test class holding some information.  Also, needed for the typed tests
+ */
+template<typename T>
+class LocalCombinerTest : public ::testing::Test
+{
+  protected:
+    ::std::vector<T> input;
+    ::std::unordered_map<T, size_t> gold;
+
+    /// count keys, distinct values, each repeated about count / distinct times, interleaved.
+    void generate(size_t count, size_t distinct) {
+      input.clear();
+      gold.clear();
+      for (size_t i = 0; i < count; ++i) {
+        T key = static_cast<T>((i * 7919) % distinct);
+        input.emplace_back(key);
+        ++gold[key];
+      }
+    }
+
+    /// pairs and raw keys together have to give the gold counts.
+    template <typename C>
+    bool check(::std::vector<::std::pair<T, C> > const & pairs, ::std::vector<T> const & raw) {
+      ::std::unordered_map<T, size_t> counts;
+      for (auto x : pairs) counts[x.first] += x.second;
+      for (auto x : raw) ++counts[x];
+      return counts == gold;
+    }
+};
+
+// indicate this is a typed test
+TYPED_TEST_CASE_P(LocalCombinerTest);
+
+TYPED_TEST_P(LocalCombinerTest, duplicated)
+{
+  this->generate(100000, 1000);
+
+  ::dsc::local_combiner<TypeParam, uint32_t> combiner(4096);
+  ::std::vector<::std::pair<TypeParam, uint32_t> > pairs;
+  ::std::vector<TypeParam> raw;
+  combiner.combine(this->input.begin(), this->input.end(), pairs, ::std::back_inserter(raw));
+
+  // only the first chunk, sampled into an empty table, may be passed through.
+  EXPECT_TRUE(this->check(pairs, raw));
+  EXPECT_GE(1UL, combiner.raw_chunk_count());
+  EXPECT_GT(4096UL, raw.size());
+  EXPECT_EQ(this->input.size(), combiner.input_count());
+  EXPECT_LT(10.0, combiner.reduction());
+}
+
+TYPED_TEST_P(LocalCombinerTest, unique)
+{
+  this->generate(100000, 100000);
+
+  // every chunk is passed through after its sample.
+  ::dsc::local_combiner<TypeParam, uint32_t> combiner(4096);
+  ::std::vector<::std::pair<TypeParam, uint32_t> > pairs;
+  ::std::vector<TypeParam> raw;
+  combiner.combine(this->input.begin(), this->input.end(), pairs, ::std::back_inserter(raw));
+
+  EXPECT_TRUE(this->check(pairs, raw));
+  EXPECT_EQ(0UL, combiner.combined_chunk_count());
+  size_t n = this->input.size();
+  EXPECT_EQ((n / 4096) * 512 + ::std::min(n % 4096, static_cast<size_t>(512)), pairs.size());
+  EXPECT_EQ(this->input.size(), pairs.size() + raw.size());
+}
+
+TYPED_TEST_P(LocalCombinerTest, in_place)
+{
+  this->generate(50000, 200);
+  // append a unique part that is not worth combining.
+  for (size_t i = 0; i < 50000; ++i) {
+    TypeParam key = static_cast<TypeParam>(1000 + i);
+    this->input.emplace_back(key);
+    ++this->gold[key];
+  }
+
+  ::dsc::local_combiner<TypeParam, uint32_t> combiner(4096);
+  ::std::vector<::std::pair<TypeParam, uint32_t> > pairs;
+  size_t n = this->input.size();
+  size_t combined = combiner.combine(this->input, pairs);
+
+  EXPECT_EQ(n, combined + this->input.size());
+  EXPECT_TRUE(this->check(pairs, this->input));
+  EXPECT_LT(0UL, combiner.combined_chunk_count());
+  EXPECT_LT(0UL, combiner.raw_chunk_count());
+}
+
+TYPED_TEST_P(LocalCombinerTest, saturate)
+{
+  this->generate(10000, 3);
+
+  // counts overflow uint8_t, and are emitted in parts.
+  ::dsc::local_combiner<TypeParam, uint8_t> combiner(16, 1.0);
+  ::std::vector<::std::pair<TypeParam, uint8_t> > pairs;
+  ::std::vector<TypeParam> raw;
+  combiner.combine(this->input.begin(), this->input.end(), pairs, ::std::back_inserter(raw));
+
+  EXPECT_TRUE(this->check(pairs, raw));
+  EXPECT_EQ(0UL, raw.size());
+
+  EXPECT_THROW((::dsc::local_combiner<TypeParam, uint8_t>(8)), ::std::invalid_argument);
+}
+
+
+// now register the test cases
+REGISTER_TYPED_TEST_CASE_P(LocalCombinerTest, duplicated, unique, in_place, saturate);
+
+//////////////////// RUN the tests with different types.
+
+typedef ::testing::Types<
+    uint32_t,
+    uint64_t
+> LocalCombinerTestTypes;
+INSTANTIATE_TYPED_TEST_CASE_P(Bliss, LocalCombinerTest, LocalCombinerTestTypes);
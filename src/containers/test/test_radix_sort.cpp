@@ -0,0 +1,148 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// include google test
+#include <gtest/gtest.h>
+#include "containers/fsc_container_utils.hpp"
+#include "common/kmer.hpp"
+#include "common/alphabets.hpp"
+#include "common/kmer_transform.hpp"
+
+#include <random>
+#include <vector>
+#include <algorithm>  // for sort.
+
+// include files to test
+#include "utils/logging.h"
+
+/*
+ * test class holding some information.  Also, needed for the typed tests
+ */
+template<typename T>
+class RadixSortTest : public ::testing::Test
+{
+  protected:
+    ::std::vector<::std::pair<T, uint32_t> > input;
+
+    void generate(size_t count, size_t distinct) {
+      std::default_random_engine generator;
+      std::uniform_int_distribution<size_t> distribution(0, distinct - 1);
+
+      // a pool of random kmers, so there are duplicates.
+      std::vector<T> pool(distinct);
+      T kmer;
+      for (size_t i = 0; i < distinct; ++i) {
+        for (size_t j = 0; j < T::size; ++j) kmer.nextFromChar(generator() % T::KmerAlphabet::SIZE);
+        pool[i] = kmer;
+      }
+
+      input.clear();
+      for (size_t i = 0; i < count; ++i) {
+        input.emplace_back(pool[distribution(generator)], i);
+      }
+    }
+
+    /// radix sorted keys should be in the same order as std::sort.  values are permuted along with keys.
+    template <typename Less>
+    void check(Less const & less, int nthreads) {
+      auto gold = input;
+      ::std::sort(gold.begin(), gold.end(), less);
+
+      auto result = input;
+      ::fsc::radix_sort(result.begin(), result.end(), less, nthreads);
+
+      ASSERT_EQ(gold.size(), result.size());
+      size_t misordered = 0;
+      for (size_t i = 0; i < gold.size(); ++i) {
+        if (less(gold[i], result[i]) || less(result[i], gold[i])) ++misordered;
+      }
+      EXPECT_EQ(0UL, misordered);
+
+      ::std::sort(gold.begin(), gold.end());
+      ::std::sort(result.begin(), result.end());
+      EXPECT_TRUE(gold == result);
+    }
+
+};
+
+// indicate this is a typed test
+TYPED_TEST_CASE_P(RadixSortTest);
+
+TYPED_TEST_P(RadixSortTest, identity)
+{
+  ::fsc::TransformedComparator<TypeParam, ::std::less, ::bliss::transform::identity> less;
+
+  for (size_t count : {0UL, 1UL, 50UL, 1000UL, 200000UL}) {
+    this->generate(count, 5000);
+    this->check(less, 1);
+    this->check(less, 4);
+  }
+}
+
+TYPED_TEST_P(RadixSortTest, lex_less)
+{
+  ::fsc::TransformedComparator<TypeParam, ::std::less, ::bliss::kmer::transform::lex_less> less;
+
+  for (size_t count : {1000UL, 200000UL}) {
+    this->generate(count, 5000);
+    this->check(less, 1);
+    this->check(less, 4);
+  }
+}
+
+TYPED_TEST_P(RadixSortTest, dispatch)
+{
+  ::fsc::TransformedComparator<TypeParam, ::std::less, ::bliss::transform::identity> less;
+  this->generate(10000, 20000);
+
+  std::vector<TypeParam> keys;
+  for (auto & x : this->input) keys.emplace_back(x.first);
+  auto gold = keys;
+  ::std::sort(gold.begin(), gold.end());
+
+  bool sorted = false;
+  ::fsc::sort(keys, sorted, ::std::less<TypeParam>());
+  EXPECT_TRUE(sorted);
+  EXPECT_TRUE(gold == keys);
+
+  sorted = false;
+  ::fsc::sorted_unique(this->input, sorted, less, ::fsc::TransformedComparator<TypeParam, ::std::equal_to, ::bliss::transform::identity>());
+  gold.erase(::std::unique(gold.begin(), gold.end()), gold.end());
+  ASSERT_EQ(gold.size(), this->input.size());
+  size_t mismatches = 0;
+  for (size_t i = 0; i < gold.size(); ++i) {
+    if (!(gold[i] == this->input[i].first)) ++mismatches;
+  }
+  EXPECT_EQ(0UL, mismatches);
+}
+
+
+// now register the test cases
+REGISTER_TYPED_TEST_CASE_P(RadixSortTest, identity, lex_less, dispatch);
+
+//////////////////// RUN the tests with different types.
+
+typedef ::testing::Types<
+    ::bliss::common::Kmer< 3, bliss::common::DNA,   uint8_t>,
+    ::bliss::common::Kmer<21, bliss::common::DNA,   uint64_t>,
+    ::bliss::common::Kmer<31, bliss::common::DNA,   uint64_t>,
+    ::bliss::common::Kmer<32, bliss::common::DNA,   uint64_t>,
+    ::bliss::common::Kmer<31, bliss::common::DNA5,  uint64_t>,
+    ::bliss::common::Kmer<63, bliss::common::DNA,   uint16_t>,
+    ::bliss::common::Kmer<95, bliss::common::DNA16, uint64_t>
+> RadixSortTestTypes;
+INSTANTIATE_TYPED_TEST_CASE_P(Bliss, RadixSortTest, RadixSortTestTypes);
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// include google test
+#include <gtest/gtest.h>
+#include "containers/fsc_sorted_index.hpp"
+#include "common/kmer.hpp"
+#include "common/alphabets.hpp"
+#include "common/kmer_transform.hpp"
+
+#include <random>
+#include <vector>
+#include <algorithm>  // for sort, lower_bound
+
+// include files to test
+#include "utils/logging.h"
+
+/*
+ * test class holding some information.  Also, needed for the typed tests
+ */
+template<typename T>
+class SortedIndexTest : public ::testing::Test
+{
+  protected:
+    ::std::vector<::std::pair<T, uint32_t> > input;
+    ::std::vector<T> queries;
+
+    void generate(size_t count, size_t distinct) {
+      std::default_random_engine generator;
+      std::uniform_int_distribution<size_t> distribution(0, distinct - 1);
+
+      // a pool of random kmers, so there are duplicates.
+      std::vector<T> pool(distinct);
+      T kmer;
+      for (size_t i = 0; i < distinct; ++i) {
+        for (size_t j = 0; j < T::size; ++j) kmer.nextFromChar(generator() % T::KmerAlphabet::SIZE);
+        pool[i] = kmer;
+      }
+
+      input.clear();
+      for (size_t i = 0; i < count; ++i) {
+        input.emplace_back(pool[distribution(generator)], i);
+      }
+
+      // half the queries are present (if there is any input), half are random.
+      queries.clear();
+      for (size_t i = 0; i < 1000; ++i) {
+        if ((count > 0) && (i % 2 == 0)) queries.emplace_back(input[distribution(generator) % count].first);
+        else {
+          for (size_t j = 0; j < T::size; ++j) kmer.nextFromChar(generator() % T::KmerAlphabet::SIZE);
+          queries.emplace_back(kmer);
+        }
+      }
+    }
+
+    /// index lower bounds should be the same as std::lower_bound.
+    template <template <typename> class Trans, typename Index = ::fsc::eytzinger_index<T, ::std::less<T>, Trans<T> > >
+    void check() {
+      ::fsc::TransformedComparator<T, ::std::less, Trans> less;
+      ::std::sort(input.begin(), input.end(), less);
+
+      Index index;
+      index.build(input.begin(), input.end());
+      EXPECT_EQ(input.size(), index.size());
+
+      ::std::vector<size_t> pos(queries.size());
+      index.lower_bound(input.begin(), queries.begin(), queries.size(), pos.data());
+
+      size_t mismatches = 0;
+      for (size_t i = 0; i < queries.size(); ++i) {
+        size_t gold = ::std::distance(input.begin(), ::std::lower_bound(input.begin(), input.end(), queries[i], less));
+        if (gold != pos[i]) ++mismatches;
+      }
+      EXPECT_EQ(0UL, mismatches);
+    }
+
+};
+
+// indicate this is a typed test
+TYPED_TEST_CASE_P(SortedIndexTest);
+
+TYPED_TEST_P(SortedIndexTest, identity)
+{
+  for (size_t count : {0UL, 1UL, 15UL, 16UL, 17UL, 1000UL, 100000UL}) {
+    this->generate(count, 5000);
+    this->template check<::bliss::transform::identity>();
+  }
+}
+
+TYPED_TEST_P(SortedIndexTest, lex_less)
+{
+  for (size_t count : {33UL, 100000UL}) {
+    this->generate(count, 5000);
+    this->template check<::bliss::kmer::transform::lex_less>();
+  }
+}
+
+TYPED_TEST_P(SortedIndexTest, duplicates)
+{
+  // few distinct keys, so blocks are full of equal keys.
+  this->generate(10000, 20);
+  this->template check<::bliss::transform::identity>();
+}
+
+TYPED_TEST_P(SortedIndexTest, prefix)
+{
+  using iden = ::bliss::transform::identity<TypeParam>;
+  using lex = ::bliss::kmer::transform::lex_less<TypeParam>;
+
+  for (size_t count : {0UL, 1UL, 17UL, 1000UL, 100000UL}) {
+    this->generate(count, 5000);
+    this->template check<::bliss::transform::identity, ::fsc::prefix_index<TypeParam, ::std::less<TypeParam>, iden> >();
+    this->template check<::bliss::transform::identity, ::fsc::prefix_index<TypeParam, ::std::less<TypeParam>, iden, 4> >();
+    this->template check<::bliss::kmer::transform::lex_less, ::fsc::prefix_index<TypeParam, ::std::less<TypeParam>, lex, 20> >();
+  }
+
+  // few distinct keys
+  this->generate(10000, 20);
+  this->template check<::bliss::transform::identity, ::fsc::prefix_index<TypeParam, ::std::less<TypeParam>, iden> >();
+
+  // fixed size table
+  ::fsc::prefix_index<TypeParam> index;
+  ::std::sort(this->input.begin(), this->input.end());
+  index.build(this->input.begin(), this->input.end());
+  EXPECT_EQ(((1UL << ::fsc::prefix_index<TypeParam>::bits) + 1) * sizeof(size_t), index.memory());
+}
+
+TYPED_TEST_P(SortedIndexTest, clear)
+{
+  this->generate(1000, 500);
+  ::fsc::eytzinger_index<TypeParam> index;
+  EXPECT_TRUE(index.empty());
+
+  ::std::sort(this->input.begin(), this->input.end());
+  index.build(this->input.begin(), this->input.end());
+  EXPECT_FALSE(index.empty());
+  EXPECT_LT(0UL, index.memory());
+
+  index.clear();
+  EXPECT_TRUE(index.empty());
+  EXPECT_EQ(0UL, index.memory());
+}
+
+
+// now register the test cases
+REGISTER_TYPED_TEST_CASE_P(SortedIndexTest, identity, lex_less, duplicates, prefix, clear);
+
+//////////////////// RUN the tests with different types.
+
+typedef ::testing::Types<
+    ::bliss::common::Kmer< 3, bliss::common::DNA,   uint8_t>,
+    ::bliss::common::Kmer<21, bliss::common::DNA,   uint64_t>,
+    ::bliss::common::Kmer<31, bliss::common::DNA5,  uint64_t>,
+    ::bliss::common::Kmer<63, bliss::common::DNA,   uint16_t>,
+    ::bliss::common::Kmer<95, bliss::common::DNA16, uint64_t>
+> SortedIndexTestTypes;
+INSTANTIATE_TYPED_TEST_CASE_P(Bliss, SortedIndexTest, SortedIndexTestTypes);
@@ -0,0 +1,258 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// include google test
+#include <gtest/gtest.h>
+#include "containers/swiss_map.hpp"
+
+#include <unordered_map>
+#include <random>
+#include <algorithm>  // sort
+#include <limits>
+#include <utility>  // pair
+#include <vector>
+#include <stdexcept>
+
+// include files to test
+#include "utils/logging.h"
+
+/*
+ * test class holding some information.  Also, needed for the typed tests
+ */
+template<typename T>
+class SwissMapTest : public ::testing::Test
+{
+    static_assert(std::is_integral<T>::value, "only supporting integral types in tests right now.");
+  protected:
+
+    ::std::unordered_map<T, T> gold;
+    ::std::vector<std::pair<T, T>> temp;
+
+    size_t iters = 100000;
+
+    virtual void SetUp()
+    {
+      // full key range:  no key is reserved.
+      std::default_random_engine generator;
+      std::uniform_int_distribution<T> distribution(::std::numeric_limits<T>::min(), ::std::numeric_limits<T>::max());
+
+      temp.emplace_back(0, 1);
+      temp.emplace_back(::std::numeric_limits<T>::max(), 2);
+      for (size_t i = 0; i < iters; ++i) {
+        T key = distribution(generator);
+        temp.emplace_back(key, distribution(generator));
+        if (i % 10 == 0) temp.emplace_back(key, distribution(generator));  // a repeat
+      }
+      for (auto x : temp) gold.emplace(x);
+    }
+
+    template <typename MAP>
+    bool same(MAP const & test) {
+      ::std::vector<::std::pair<T, T> > test_vals(test.begin(), test.end());
+      ::std::vector<::std::pair<T, T> > gold_vals(gold.begin(), gold.end());
+      ::std::sort(test_vals.begin(), test_vals.end());
+      ::std::sort(gold_vals.begin(), gold_vals.end());
+      return (test.size() == gold.size()) && (test_vals == gold_vals);
+    }
+};
+
+// indicate this is a typed test
+TYPED_TEST_CASE_P(SwissMapTest);
+
+TYPED_TEST_P(SwissMapTest, insert)
+{
+  ::fsc::swiss_map<TypeParam, TypeParam> test(this->temp.begin(), this->temp.end());
+  EXPECT_TRUE(this->same(test));
+
+  // emplace keeps the first value.
+  auto res = test.emplace(this->temp[0].first, 7);
+  EXPECT_FALSE(res.second);
+  EXPECT_EQ(this->temp[0].second, res.first->second);
+}
+
+TYPED_TEST_P(SwissMapTest, find)
+{
+  ::fsc::swiss_map<TypeParam, TypeParam> test(this->temp.begin(), this->temp.end());
+
+  size_t mismatches = 0;
+  for (auto x : this->gold) {
+    auto it = test.find(x.first);
+    if ((it == test.end()) || (it->second != x.second)) ++mismatches;
+    if (test.count(x.first) != 1) ++mismatches;
+    if (test.at(x.first) != x.second) ++mismatches;
+    auto range = test.equal_range(x.first);
+    if ((range.first != it) || (::std::distance(range.first, range.second) != 1)) ++mismatches;
+  }
+  EXPECT_EQ(0UL, mismatches);
+
+  // absent keys.
+  size_t found = 0;
+  for (TypeParam i = 1; i < 10000; ++i) {
+    if ((this->gold.count(i) == 0) && (test.count(i) != 0)) ++found;
+  }
+  EXPECT_EQ(0UL, found);
+  EXPECT_THROW(test.at(::std::numeric_limits<TypeParam>::max() - 1), ::std::out_of_range);
+}
+
+TYPED_TEST_P(SwissMapTest, erase)
+{
+  ::fsc::swiss_map<TypeParam, TypeParam> test(this->temp.begin(), this->temp.end());
+
+  // erase half by key, then reinsert some of them, so deleted slots get reused.
+  size_t i = 0;
+  ::std::vector<::std::pair<TypeParam, TypeParam> > erased;
+  for (auto it = this->gold.begin(); it != this->gold.end(); ++i) {
+    if (i % 2 == 0) {
+      EXPECT_EQ(1UL, test.erase(it->first));
+      erased.emplace_back(*it);
+      it = this->gold.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  EXPECT_EQ(0UL, test.erase(erased[0].first));
+  EXPECT_TRUE(this->same(test));
+
+  for (size_t j = 0; j < erased.size(); j += 3) {
+    test.insert(erased[j]);
+    this->gold.insert(erased[j]);
+  }
+  EXPECT_TRUE(this->same(test));
+
+  // erase by iterator.
+  size_t count = 0;
+  for (auto it = test.begin(); it != test.end(); ) {
+    if (it->first % 3 == 0) {
+      this->gold.erase(it->first);
+      it = test.erase(it);
+      ++count;
+    } else {
+      ++it;
+    }
+  }
+  EXPECT_LT(0UL, count);
+  EXPECT_TRUE(this->same(test));
+
+  test.clear();
+  EXPECT_EQ(0UL, test.size());
+  EXPECT_TRUE(test.begin() == test.end());
+}
+
+TYPED_TEST_P(SwissMapTest, load)
+{
+  // fill to the reserved size without rehashing, at the default load of 0.875.
+  ::fsc::swiss_map<TypeParam, TypeParam> test;
+  test.reserve(this->gold.size());
+  size_t buckets = test.bucket_count();
+  test.insert(this->gold.begin(), this->gold.end());
+  EXPECT_EQ(buckets, test.bucket_count());
+  EXPECT_TRUE(this->same(test));
+
+  // higher load
+  ::fsc::swiss_map<TypeParam, TypeParam> dense;
+  dense.max_load_factor(0.95f);
+  dense.rehash(131072);
+  for (auto x : this->gold) dense.emplace(x);
+  EXPECT_EQ(131072UL, dense.bucket_count());
+  EXPECT_LT(0.75f, dense.load_factor());
+  EXPECT_TRUE(this->same(dense));
+
+  // churn:  repeated erase and insert at high load rehashes in place instead of growing.
+  for (size_t r = 0; r < 4; ++r) {
+    for (auto x : this->gold) dense.erase(x.first);
+    for (auto x : this->gold) dense.emplace(x);
+  }
+  EXPECT_EQ(131072UL, dense.bucket_count());
+  EXPECT_TRUE(this->same(dense));
+
+  EXPECT_THROW(dense.max_load_factor(1.0f), ::std::invalid_argument);
+
+  // operator[] and swap.
+  ::fsc::swiss_map<TypeParam, TypeParam> other;
+  other[3] = 5;
+  other[3] += 1;
+  other.swap(dense);
+  EXPECT_EQ(1UL, dense.size());
+  EXPECT_EQ(6, dense.at(3));
+  EXPECT_TRUE(this->same(other));
+}
+
+TYPED_TEST_P(SwissMapTest, batch)
+{
+  ::fsc::swiss_map<TypeParam, TypeParam> test(this->temp.begin(), this->temp.end());
+
+  // queries:  every key, then absent ones.  not a multiple of the batch size.
+  ::std::vector<TypeParam> query;
+  for (auto x : this->gold) query.emplace_back(x.first);
+  for (TypeParam i = 1; i < 1001; ++i) {
+    if (this->gold.count(i) == 0) query.emplace_back(i);
+  }
+
+  ::std::vector<::std::pair<TypeParam, TypeParam> > found;
+  test.find(query.begin(), query.end(), ::std::back_inserter(found));
+  ::std::vector<::std::pair<TypeParam, TypeParam> > gold_found(this->gold.begin(), this->gold.end());
+  EXPECT_TRUE(found == gold_found);
+
+  ::std::vector<::std::pair<TypeParam, size_t> > counts;
+  test.count(query.begin(), query.end(), ::std::back_inserter(counts));
+  ASSERT_EQ(query.size(), counts.size());
+  size_t mismatches = 0;
+  for (size_t i = 0; i < query.size(); ++i) {
+    if ((counts[i].first != query[i]) || (counts[i].second != this->gold.count(query[i]))) ++mismatches;
+  }
+  EXPECT_EQ(0UL, mismatches);
+
+  // batched insert that rehashes mid-batch, with repeats in the batch.
+  ::fsc::swiss_map<TypeParam, TypeParam> small;
+  small.insert(this->temp.begin(), this->temp.end());
+  EXPECT_TRUE(this->same(small));
+}
+
+TYPED_TEST_P(SwissMapTest, hashed)
+{
+  // insert with precomputed hashes, then look up with and without them.
+  ::fsc::swiss_map<TypeParam, TypeParam> test;
+  auto h = test.hash_function();
+  for (auto x : this->temp) test.insert(x, h(x.first));
+  EXPECT_TRUE(this->same(test));
+
+  size_t mismatches = 0;
+  for (auto x : this->gold) {
+    test.prefetch(x.first, h(x.first));
+    auto it = test.find(x.first, h(x.first));
+    if ((it == test.end()) || (it->second != x.second) || (test.count(x.first, h(x.first)) != 1)) ++mismatches;
+    if (test.find(x.first) != it) ++mismatches;
+  }
+  for (TypeParam i = 1; i < 1001; ++i) {
+    if (this->gold.count(i) == 0) {
+      if ((test.find(i, h(i)) != test.end()) || (test.count(i, h(i)) != 0)) ++mismatches;
+    }
+  }
+  EXPECT_EQ(0UL, mismatches);
+}
+
+
+// now register the test cases
+REGISTER_TYPED_TEST_CASE_P(SwissMapTest, insert, find, erase, load, batch, hashed);
+
+//////////////////// RUN the tests with different types.
+
+typedef ::testing::Types<
+    uint32_t,
+    uint64_t
+> SwissMapTestTypes;
+INSTANTIATE_TYPED_TEST_CASE_P(Bliss, SwissMapTest, SwissMapTestTypes);
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// include google test
+#include <gtest/gtest.h>
+#include "containers/thread_partitioned_map.hpp"
+
+#include <unordered_map>
+#include <random>
+#include <vector>
+#include <algorithm>  // for sort.
+
+// include files to test
+#include "utils/logging.h"
+
+/*
+ * test class holding some information.  Also, needed for the typed tests
+ */
+template<typename T>
+class ThreadPartitionedMapTest : public ::testing::Test
+{
+  protected:
+    ::std::unordered_multimap<T, T> gold;
+    ::std::vector<::std::pair<T, T> > input;
+
+    size_t iters = 100000;
+
+    virtual void SetUp()
+    { // generate some inputs
+      std::default_random_engine generator;
+      std::uniform_int_distribution<T> distribution(0,99);
+
+      for (size_t i=0; i< iters; ++i) {
+        T key = distribution(generator);
+        T val = distribution(generator);
+        input.emplace_back(key, val);
+        gold.emplace(key, val);
+      }
+    }
+
+    template <typename Iter>
+    static ::std::vector<::std::pair<T, T> > sorted(Iter b, Iter e) {
+      ::std::vector<::std::pair<T, T> > vals(b, e);
+      ::std::sort(vals.begin(), vals.end());
+      return vals;
+    }
+
+    struct Count {
+      template <typename DB, typename Q, typename OutputIter>
+      size_t operator()(DB & db, Q const & q, OutputIter & output) const {
+        *output = ::std::make_pair(q, static_cast<T>(db.count(q)));
+        ++output;
+        return 1;
+      }
+    };
+    struct Erase {
+      template <typename DB, typename Q, typename OutputIter>
+      size_t operator()(DB & db, Q const & q, OutputIter &) const {
+        return db.erase(q);
+      }
+    };
+};
+
+// indicate this is a typed test
+TYPED_TEST_CASE_P(ThreadPartitionedMapTest);
+
+
+TYPED_TEST_P(ThreadPartitionedMapTest, insert)
+{
+  for (size_t p = 1; p <= 8; p *= 2) {
+    ::fsc::thread_partitioned_map<TypeParam, TypeParam, ::std::unordered_multimap> test(0, p);
+    test.insert(this->input.begin(), this->input.end());
+
+    EXPECT_EQ(p, test.num_partitions());
+    EXPECT_EQ(this->gold.size(), test.size());
+
+    auto test_vals = this->sorted(test.begin(), test.end());
+    auto gold_vals = this->sorted(this->gold.begin(), this->gold.end());
+    EXPECT_TRUE(::std::equal(test_vals.begin(), test_vals.end(), gold_vals.begin()));
+
+    // each key lives in exactly 1 sub-map.
+    for (size_t i = 0; i < test.num_partitions(); ++i) {
+      for (auto it = test.partition(i).begin(); it != test.partition(i).end(); ++it) {
+        EXPECT_EQ(i, test.partition_of(it->first));
+      }
+    }
+  }
+}
+
+
+TYPED_TEST_P(ThreadPartitionedMapTest, find_count)
+{
+  ::fsc::thread_partitioned_map<TypeParam, TypeParam, ::std::unordered_map> test(0, 4);
+  ::std::unordered_map<TypeParam, TypeParam> gold(this->input.begin(), this->input.end());
+  test.insert(this->input.begin(), this->input.end());
+
+  EXPECT_EQ(gold.size(), test.size());
+
+  for (int i = 0; i < 128; ++i) {
+    TypeParam k = i;
+    EXPECT_EQ(gold.count(k), test.count(k));
+
+    auto git = gold.find(k);
+    auto tit = test.find(k);
+    EXPECT_EQ(git == gold.end(), tit == test.end());
+    if (git != gold.end()) {
+      EXPECT_EQ(git->second, tit->second);
+      EXPECT_EQ(gold.at(k), test.at(k));
+    }
+  }
+}
+
+
+TYPED_TEST_P(ThreadPartitionedMapTest, apply)
+{
+  ::fsc::thread_partitioned_map<TypeParam, TypeParam, ::std::unordered_multimap> test(0, 8);
+  test.insert(this->input.begin(), this->input.end());
+
+  ::std::vector<TypeParam> queries;
+  for (int i = 0; i < 128; ++i) queries.push_back(i);
+
+  // count, in parallel.  output is grouped by sub-map, so sort before compare.
+  ::std::vector<::std::pair<TypeParam, TypeParam> > counts;
+  ::fsc::back_emplace_iterator<::std::vector<::std::pair<TypeParam, TypeParam> > > emplace_iter(counts);
+  typename TestFixture::Count count_op;
+  EXPECT_EQ(queries.size(), test.apply(queries.begin(), queries.end(), emplace_iter, count_op));
+  ::std::sort(counts.begin(), counts.end());
+
+  ASSERT_EQ(queries.size(), counts.size());
+  for (size_t i = 0; i < counts.size(); ++i) {
+    EXPECT_EQ(queries[i], counts[i].first);
+    EXPECT_EQ(this->gold.count(queries[i]), static_cast<size_t>(counts[i].second));
+  }
+
+  // erase half, in parallel.
+  ::std::vector<TypeParam> evens;
+  size_t expected = 0;
+  for (int i = 0; i < 100; i += 2) {
+    evens.push_back(i);
+    expected += this->gold.count(i);
+  }
+  typename TestFixture::Erase erase_op;
+  EXPECT_EQ(expected, test.apply(evens.begin(), evens.end(), emplace_iter, erase_op));
+  EXPECT_EQ(this->gold.size() - expected, test.size());
+  for (auto k : evens) {
+    EXPECT_EQ(0UL, test.count(k));
+  }
+}
+
+
+REGISTER_TYPED_TEST_CASE_P(ThreadPartitionedMapTest, insert, find_count, apply);
+
+//////////////////// RUN the tests with different types.
+
+typedef ::testing::Types<int16_t, int32_t, int64_t, uint16_t, uint32_t, uint64_t> ThreadPartitionedMapTestTypes;
+INSTANTIATE_TYPED_TEST_CASE_P(Bliss, ThreadPartitionedMapTest, ThreadPartitionedMapTestTypes);
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// include google test
+#include <gtest/gtest.h>
+#include "containers/unordered_csr_multimap.hpp"
+#include "common/sequence.hpp"
+
+#include <unordered_map>
+#include <random>
+#include <vector>
+#include <algorithm>  // for sort.
+
+// include files to test
+#include "utils/logging.h"
+
+/*
+ * test class holding some information.  Also, needed for the typed tests
+ */
+template<typename Values>
+class UnorderedCSRMultimapTest : public ::testing::Test
+{
+  protected:
+    using V = decltype(::std::declval<Values>().get(::std::declval<typename Values::cursor>()));
+    using MapType = ::fsc::unordered_csr_multimap<uint32_t, V, ::std::hash<uint32_t>, ::std::equal_to<uint32_t>,
+        ::std::allocator<::std::pair<const uint32_t, V> >, Values>;
+
+    ::std::unordered_multimap<uint32_t, V> gold;
+    MapType test;
+
+    size_t iters = 100000;
+
+    void generate(size_t count, unsigned int seed) {
+      std::default_random_engine generator(seed);
+      std::uniform_int_distribution<uint32_t> distribution(0, 999);
+      std::uniform_int_distribution<uint64_t> values(0, 1UL << 50);
+
+      for (size_t i = 0; i < count; ++i) {
+        uint32_t key = distribution(generator);
+        V val = ::fsc::csr::integer_value<V>::make(values(generator));
+        test.emplace(::std::make_pair(key, val));
+        gold.emplace(key, val);
+      }
+    }
+
+    static ::std::vector<::std::pair<uint32_t, V> > sorted(::std::vector<::std::pair<uint32_t, V> > v) {
+      ::std::sort(v.begin(), v.end(), [](::std::pair<uint32_t, V> const & x, ::std::pair<uint32_t, V> const &y) {
+        return (x.first == y.first) ? (x.second < y.second) : (x.first < y.first);
+      } );
+      return v;
+    }
+
+    void check() {
+      EXPECT_EQ(gold.size(), test.size());
+
+      ::std::vector<::std::pair<uint32_t, V> > test_vals(test.begin(), test.end());
+      ::std::vector<::std::pair<uint32_t, V> > gold_vals(gold.begin(), gold.end());
+      EXPECT_TRUE(sorted(gold_vals) == sorted(test_vals));
+
+      size_t mismatches = 0;
+      for (uint32_t k = 0; k < 1010; ++k) {
+        if (gold.count(k) != test.count(k)) ++mismatches;
+
+        auto g = gold.equal_range(k);
+        auto t = test.equal_range(k);
+        if (!(sorted(::std::vector<::std::pair<uint32_t, V> >(g.first, g.second)) ==
+              sorted(::std::vector<::std::pair<uint32_t, V> >(t.first, t.second)))) ++mismatches;
+      }
+      EXPECT_EQ(0UL, mismatches);
+    }
+};
+
+// indicate this is a typed test
+TYPED_TEST_CASE_P(UnorderedCSRMultimapTest);
+
+TYPED_TEST_P(UnorderedCSRMultimapTest, insert)
+{
+  EXPECT_TRUE(this->test.empty());
+  this->check();
+
+  this->generate(this->iters, 1);
+  this->check();
+  EXPECT_EQ(1000UL, this->test.unique_size());
+
+  // insert after the layout is built.
+  this->generate(this->iters / 2, 2);
+  this->check();
+}
+
+TYPED_TEST_P(UnorderedCSRMultimapTest, erase)
+{
+  this->generate(this->iters, 1);
+
+  size_t mismatches = 0;
+  for (uint32_t k = 0; k < 1010; k += 3) {
+    if (this->gold.erase(k) != this->test.erase(k)) ++mismatches;
+  }
+  EXPECT_EQ(0UL, mismatches);
+  this->check();
+
+  // erased keys are dropped at the next rebuild.
+  this->generate(this->iters / 2, 2);
+  this->check();
+
+  this->test.clear();
+  this->gold.clear();
+  this->check();
+}
+
+TYPED_TEST_P(UnorderedCSRMultimapTest, erase_iterator)
+{
+  this->generate(this->iters, 1);
+
+  // erase odd values of some keys, as the distributed erase with predicate does.
+  for (uint32_t k = 0; k < 1010; k += 7) {
+    auto g = this->gold.equal_range(k);
+    for (auto it = g.first; it != g.second; ) {
+      if (::fsc::csr::integer_value<typename TestFixture::V>::get(it->second) & 1) it = this->gold.erase(it);
+      else ++it;
+    }
+
+    auto t = this->test.equal_range(k);
+    for (auto it = t.first; it != t.second; ) {
+      auto tmp = it;
+      ++it;
+      if (::fsc::csr::integer_value<typename TestFixture::V>::get((*tmp).second) & 1) this->test.erase(tmp);
+    }
+  }
+  this->check();
+}
+
+TYPED_TEST_P(UnorderedCSRMultimapTest, merge)
+{
+  // each batch is merged into the built layout, together with the erased keys and elements of the previous one.
+  for (unsigned int batch = 1; batch <= 6; ++batch) {
+    this->generate(this->iters / 4, batch);
+    this->check();
+
+    for (uint32_t k = batch; k < 1010; k += 5) {
+      if (this->gold.erase(k) != this->test.erase(k)) ADD_FAILURE() << "erase count differs for key " << k;
+    }
+
+    for (uint32_t k = batch + 2; k < 1010; k += 11) {
+      auto g = this->gold.equal_range(k);
+      for (auto it = g.first; it != g.second; ) {
+        if (::fsc::csr::integer_value<typename TestFixture::V>::get(it->second) & 1) it = this->gold.erase(it);
+        else ++it;
+      }
+
+      auto t = this->test.equal_range(k);
+      for (auto it = t.first; it != t.second; ) {
+        auto tmp = it;
+        ++it;
+        if (::fsc::csr::integer_value<typename TestFixture::V>::get((*tmp).second) & 1) this->test.erase(tmp);
+      }
+    }
+  }
+  this->check();
+}
+
+TYPED_TEST_P(UnorderedCSRMultimapTest, memory)
+{
+  this->generate(this->iters, 1);
+  this->test.shrink_to_fit();
+
+  // keys are stored once, so smaller than 1 pair per element.
+  EXPECT_GT(this->iters * sizeof(::std::pair<uint32_t, typename TestFixture::V>), this->test.memory());
+}
+
+
+// now register the test cases
+REGISTER_TYPED_TEST_CASE_P(UnorderedCSRMultimapTest, insert, erase, erase_iterator, merge, memory);
+
+/// maps 8 keys to each hash value.
+struct colliding_hash {
+    size_t operator()(uint32_t const & x) const { return x >> 3; }
+};
+
+TEST(UnorderedCSRMultimapCollisionTest, merge)
+{
+  ::fsc::unordered_csr_multimap<uint32_t, uint64_t, colliding_hash> test;
+  ::std::unordered_multimap<uint32_t, uint64_t> gold;
+
+  std::default_random_engine generator(3);
+  std::uniform_int_distribution<uint32_t> distribution(0, 999);
+  for (int batch = 0; batch < 3; ++batch) {
+    for (uint64_t i = 0; i < 20000; ++i) {
+      uint32_t key = distribution(generator);
+      test.emplace(key, i);
+      gold.emplace(key, i);
+    }
+
+    EXPECT_EQ(gold.size(), test.size());
+    size_t mismatches = 0;
+    for (uint32_t k = 0; k < 1010; ++k) {
+      if (gold.count(k) != test.count(k)) ++mismatches;
+    }
+    EXPECT_EQ(0UL, mismatches);
+    EXPECT_EQ(1000UL, test.unique_size());
+  }
+}
+
+//////////////////// RUN the tests with different types.
+
+typedef ::testing::Types<
+    ::fsc::csr::raw_values<uint64_t>,
+    ::fsc::csr::delta_varint_values<uint64_t>,
+    ::fsc::csr::raw_values<::bliss::common::LongSequenceKmerId>,
+    ::fsc::csr::delta_varint_values<::bliss::common::LongSequenceKmerId>,
+    ::fsc::csr::delta_varint_values<::bliss::common::ShortSequenceKmerId>
+> UnorderedCSRMultimapTestTypes;
+INSTANTIATE_TYPED_TEST_CASE_P(Bliss, UnorderedCSRMultimapTest, UnorderedCSRMultimapTestTypes);
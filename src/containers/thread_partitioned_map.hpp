@@ -0,0 +1,574 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    thread_partitioned_map.hpp
+ * @ingroup fsc::containers
+ * @author  tpan
+ * @brief   hash map made of T independent sub-maps, 1 per thread, for hybrid MPI + OpenMP.
+ * @details  a key is assigned to a sub-map by the "infix" bits of its storage hash:  the hash is
+ *          mixed with a multiplicative (fibonacci) hash and the top log2(T) bits are used.  this keeps the
+ *          partition choice independent of the MPI rank assignment (top bits of the distribution hash)
+ *          and of the bucket choice in the sub-maps (low bits / modulo of the storage hash).
+ *
+ *          since a key always goes to the same sub-map, bulk operations can be done in parallel without locks:
+ *          the input is grouped by sub-map, and each thread owns whole sub-maps.
+ *
+ *          interface follows std::unordered_map (or multimap, depending on SubContainer) for the
+ *          single element operations used by dsc::unordered_map_base.  equal_range and emplace return the
+ *          sub-map's iterators, same as fsc::densehash_map.
+ *
+ *          number of sub-maps defaults to omp_get_max_threads(), rounded up to power of 2, and is 1 without OpenMP.
+ */
+#ifndef THREAD_PARTITIONED_MAP_HPP_
+#define THREAD_PARTITIONED_MAP_HPP_
+
+#include "bliss-config.hpp"
+
+#if defined(USE_OPENMP)
+#include "omp.h"
+#endif
+
+#include <vector>
+#include <functional>  // hash, equal_to, etc
+#include <utility>   // pair
+#include <iterator>
+#include <type_traits>
+#include <algorithm>
+#include <cmath>   // ceil
+#include <cstdint>
+#include <memory>  // allocator
+#include <stdexcept>
+
+#include "containers/fsc_container_utils.hpp"
+
+
+namespace fsc {  // fast standard container
+
+  /**
+   * @brief forward iterator over all sub-maps of a thread_partitioned_map, in sub-map order.
+   * @tparam Parts        vector of sub-maps, const qualified for const_iterator.
+   * @tparam SubIterator  sub-map iterator type.
+   */
+  template <typename Parts, typename SubIterator>
+  class partition_iterator :
+    public ::std::iterator<::std::forward_iterator_tag,
+                           typename ::std::iterator_traits<SubIterator>::value_type,
+                           typename ::std::iterator_traits<SubIterator>::difference_type,
+                           typename ::std::iterator_traits<SubIterator>::pointer,
+                           typename ::std::iterator_traits<SubIterator>::reference>
+  {
+      template <typename P, typename S>
+      friend class partition_iterator;
+
+    protected:
+      Parts * parts;
+      size_t part;
+      SubIterator curr;
+
+      /// move past empty sub-maps, stop at end of last sub-map.
+      void skip_empty() {
+        while ((curr == (*parts)[part].end()) && ((part + 1) < parts->size())) {
+          ++part;
+          curr = (*parts)[part].begin();
+        }
+      }
+
+    public:
+      partition_iterator() : parts(nullptr), part(0), curr() {}
+
+      partition_iterator(Parts & _parts, size_t const & _part, SubIterator const & _curr) :
+        parts(&_parts), part(_part), curr(_curr) {
+        skip_empty();
+      }
+
+      /// conversion from non-const iterator.
+      template <typename P, typename S,
+          typename = typename ::std::enable_if<::std::is_convertible<S, SubIterator>::value>::type>
+      partition_iterator(partition_iterator<P, S> const & other) :
+        parts(other.parts), part(other.part), curr(other.curr) {}
+
+      partition_iterator & operator++() {
+        ++curr;
+        skip_empty();
+        return *this;
+      }
+
+      partition_iterator operator++(int) {
+        partition_iterator out(*this);
+        this->operator++();
+        return out;
+      }
+
+      template <typename P, typename S>
+      bool operator==(partition_iterator<P, S> const & other) const {
+        return (part == other.part) && (curr == other.curr);
+      }
+      template <typename P, typename S>
+      bool operator!=(partition_iterator<P, S> const & other) const {
+        return !(this->operator==(other));
+      }
+
+      typename ::std::iterator_traits<SubIterator>::reference operator*() const {
+        return *curr;
+      }
+      typename ::std::iterator_traits<SubIterator>::pointer operator->() const {
+        return &(*curr);
+      }
+
+      /// the sub-map iterator this points to.
+      SubIterator const & getBaseIterator() const { return curr; }
+  };
+
+
+  /**
+   * @brief  hash map partitioned into T independent sub-maps so bulk operations can run in parallel without locks.
+   * @details  see file description.
+   * @tparam SubContainer   the sub-map type, std::unordered_map or std::unordered_multimap
+   */
+  template <typename Key, typename T,
+      template <typename, typename, typename, typename, typename...> class SubContainer,
+      typename Hash = ::std::hash<Key>,
+      typename Equal = ::std::equal_to<Key>,
+      typename Allocator = ::std::allocator<::std::pair<const Key, T> > >
+  class thread_partitioned_map {
+
+    public:
+      using subcontainer_type     = SubContainer<Key, T, Hash, Equal, Allocator>;
+
+    protected:
+      using parts_type = ::std::vector<subcontainer_type>;
+
+      /// fibonacci hashing constant, 2^64 / golden ratio.
+      static constexpr uint64_t golden = 0x9E3779B97F4A7C15ULL;
+
+      parts_type parts;
+
+      /// log2 of number of sub-maps.
+      unsigned int part_bits;
+
+      Hash hash;
+
+      static unsigned int get_part_bits(size_t const & nparts) {
+        unsigned int bits = 0;
+        while ((static_cast<size_t>(1) << bits) < nparts) ++bits;
+        return bits;
+      }
+
+      /// sub-map indices of n elements starting at first.  batched if the hash function has a batch interface.
+      template <typename Iter>
+      void get_partitions(Iter first, size_t const & n, uint32_t * pids, ::std::true_type const &) const {
+        if (part_bits == 0) {
+          ::std::fill(pids, pids + n, 0);
+          return;
+        }
+
+        constexpr size_t batch = ::fsc::hash_batch_size<Hash>::value;
+        Key keys[batch];
+        uint64_t h[batch];
+        for (size_t i = 0; i < n; i += batch) {
+          size_t count = ::std::min(batch, n - i);
+          for (size_t j = 0; j < count; ++j) keys[j] = ::fsc::detail::get_key(*(first + i + j));
+          hash(static_cast<Key const *>(keys), count, h);
+          for (size_t j = 0; j < count; ++j)
+            pids[i + j] = (h[j] * golden) >> (64 - part_bits);
+        }
+      }
+      template <typename Iter>
+      void get_partitions(Iter first, size_t const & n, uint32_t * pids, ::std::false_type const &) const {
+        for (size_t i = 0; i < n; ++i, ++first) {
+          pids[i] = partition_of(*first);
+        }
+      }
+
+      /// group the positions [0, n) by sub-map.  returns the offsets of each sub-map's group in perm.
+      template <typename Iter>
+      ::std::vector<size_t> group_by_partition(Iter first, size_t const & n, ::std::vector<size_t> & perm) const {
+        size_t nparts = parts.size();
+        ::std::vector<size_t> offsets(nparts + 1, 0);
+
+        ::std::vector<uint32_t> pids(n);
+        this->get_partitions(first, n, pids.data(),
+                             ::std::integral_constant<bool, (::fsc::hash_batch_size<Hash>::value > 1)>());
+        for (size_t i = 0; i < n; ++i) {
+          ++offsets[pids[i] + 1];
+        }
+        for (size_t p = 1; p <= nparts; ++p) {
+          offsets[p] += offsets[p - 1];
+        }
+
+        perm.resize(n);
+        ::std::vector<size_t> pos(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < n; ++i) {
+          perm[pos[pids[i]]++] = i;
+        }
+        return offsets;
+      }
+
+      /// serial version of apply, for non-random access queries or single sub-map
+      template <typename DB, typename QueryIter, typename OutputIter, typename Operator, typename... Args>
+      static size_t apply_serial(DB & db, QueryIter query_begin, QueryIter query_end,
+                                 OutputIter & output, Operator & op, Args const & ... args) {
+        size_t count = 0;
+        for (auto it = query_begin; it != query_end; ++it) {
+          count += op(db.parts[db.partition_of(*it)], *it, output, args...);
+        }
+        return count;
+      }
+
+      /// apply op to queries, grouped by sub-map, with sub-maps processed in parallel.  shared between const and non-const.
+      template <typename DB, typename QueryIter, typename OutputIter, typename Operator, typename... Args>
+      static size_t apply_parallel(DB & db, QueryIter query_begin, QueryIter query_end,
+                                   OutputIter & output, Operator & op, Args const & ... args) {
+        if (query_begin == query_end) return 0;
+
+        if ((db.parts.size() == 1) ||
+            !::std::is_same<typename ::std::iterator_traits<QueryIter>::iterator_category, ::std::random_access_iterator_tag>::value)
+          return apply_serial(db, query_begin, query_end, output, op, args...);
+
+        using OutputType = typename ::std::iterator_traits<OutputIter>::value_type;
+
+        size_t n = ::std::distance(query_begin, query_end);
+        size_t nparts = db.parts.size();
+
+        ::std::vector<size_t> perm;
+        ::std::vector<size_t> offsets = db.group_by_partition(query_begin, n, perm);
+
+        ::std::vector<::std::vector<OutputType> > results(nparts);
+        ::std::vector<size_t> counts(nparts, 0);
+
+#if defined(USE_OPENMP)
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (size_t p = 0; p < nparts; ++p) {
+          if (offsets[p] == offsets[p + 1]) continue;
+
+          Operator local_op(op);
+          results[p].reserve(offsets[p + 1] - offsets[p]);
+          ::fsc::back_emplace_iterator<::std::vector<OutputType> > emplace_iter(results[p]);
+
+          auto & part = db.parts[p];
+          for (size_t i = offsets[p]; i < offsets[p + 1]; ++i) {
+            counts[p] += local_op(part, *(query_begin + perm[i]), emplace_iter, args...);
+          }
+        }
+
+        // concatenate in sub-map order.
+        size_t count = 0;
+        for (size_t p = 0; p < nparts; ++p) {
+          for (auto & x : results[p]) {
+            *output = ::std::move(x);
+            ++output;
+          }
+          ::std::vector<OutputType>().swap(results[p]);
+          count += counts[p];
+        }
+        return count;
+      }
+
+
+    public:
+      using key_type              = Key;
+      using mapped_type           = T;
+      using value_type            = ::std::pair<const Key, T>;
+      using hasher                = Hash;
+      using key_equal             = Equal;
+      using allocator_type        = Allocator;
+      using reference             = value_type&;
+      using const_reference       = const value_type&;
+      using pointer               = typename ::std::allocator_traits<Allocator>::pointer;
+      using const_pointer         = typename ::std::allocator_traits<Allocator>::const_pointer;
+      using iterator              = partition_iterator<parts_type, typename subcontainer_type::iterator>;
+      using const_iterator        = partition_iterator<const parts_type, typename subcontainer_type::const_iterator>;
+      using size_type             = size_t;
+      using difference_type       = ptrdiff_t;
+
+      /// default number of sub-maps:  1 per OpenMP thread.
+      static size_t default_partitions() {
+#if defined(USE_OPENMP)
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+      }
+
+      /**
+       * @brief construct with nparts sub-maps.
+       * @param bucket_count  total number of buckets, same as std::unordered_map's constructor.
+       * @param nparts        number of sub-maps, rounded up to a power of 2.
+       */
+      explicit thread_partitioned_map(size_type bucket_count = 0, size_t const & nparts = default_partitions()) :
+        parts(static_cast<size_t>(1) << get_part_bits(::std::max(nparts, static_cast<size_t>(1)))),
+        part_bits(get_part_bits(::std::max(nparts, static_cast<size_t>(1)))) {
+        if (part_bits > 16) throw ::std::invalid_argument("thread_partitioned_map supports at most 65536 sub-maps.");
+        if (bucket_count > 0) this->rehash(bucket_count);
+      }
+
+      virtual ~thread_partitioned_map() {};
+
+      //======= partition access
+
+      /// sub-map index for a key.
+      inline size_t partition_of(Key const & k) const {
+        return (part_bits == 0) ? 0 :
+            static_cast<size_t>((static_cast<uint64_t>(hash(k)) * golden) >> (64 - part_bits));
+      }
+      template <typename V>
+      inline size_t partition_of(::std::pair<Key, V> const & x) const {
+        return partition_of(x.first);
+      }
+      template <typename V>
+      inline size_t partition_of(::std::pair<const Key, V> const & x) const {
+        return partition_of(x.first);
+      }
+
+      size_t num_partitions() const { return parts.size(); }
+
+      subcontainer_type & partition(size_t const & i) { return parts[i]; }
+      subcontainer_type const & partition(size_t const & i) const { return parts[i]; }
+
+      //======= iterators
+
+      iterator begin() {
+        return iterator(parts, 0, parts[0].begin());
+      }
+      const_iterator begin() const {
+        return cbegin();
+      }
+      const_iterator cbegin() const {
+        return const_iterator(parts, 0, parts[0].cbegin());
+      }
+
+      iterator end() {
+        return iterator(parts, parts.size() - 1, parts.back().end());
+      }
+      const_iterator end() const {
+        return cend();
+      }
+      const_iterator cend() const {
+        return const_iterator(parts, parts.size() - 1, parts.back().cend());
+      }
+
+      //======= capacity
+
+      bool empty() const {
+        for (auto const & part : parts) {
+          if (!part.empty()) return false;
+        }
+        return true;
+      }
+
+      size_type size() const {
+        size_type s = 0;
+        for (auto const & part : parts) s += part.size();
+        return s;
+      }
+
+      void clear() {
+#if defined(USE_OPENMP)
+#pragma omp parallel for
+#endif
+        for (size_t p = 0; p < parts.size(); ++p) parts[p].clear();
+      }
+
+      void swap(thread_partitioned_map & other) {
+        parts.swap(other.parts);
+        ::std::swap(part_bits, other.part_bits);
+        ::std::swap(hash, other.hash);
+      }
+
+      /// rehash for new count number of BUCKETS, split evenly between sub-maps.
+      void rehash(size_type count) {
+        size_type per_part = (count + parts.size() - 1) / parts.size();
+#if defined(USE_OPENMP)
+#pragma omp parallel for
+#endif
+        for (size_t p = 0; p < parts.size(); ++p) parts[p].rehash(per_part);
+      }
+
+      void reserve(size_type count) {
+        this->rehash(::std::ceil(static_cast<float>(count) / this->max_load_factor()));
+      }
+
+      /// total bucket count of all sub-maps.
+      size_type bucket_count() const {
+        size_type s = 0;
+        for (auto const & part : parts) s += part.bucket_count();
+        return s;
+      }
+
+      float max_load_factor() const {
+        return parts[0].max_load_factor();
+      }
+      void max_load_factor(float ml) {
+        for (auto & part : parts) part.max_load_factor(ml);
+      }
+
+      float load_factor() const {
+        return static_cast<float>(size()) / static_cast<float>(bucket_count());
+      }
+
+      //======= modifiers
+
+      template <typename V>
+      auto emplace(V && x) -> decltype(::std::declval<subcontainer_type &>().emplace(::std::forward<V>(x))) {
+        return parts[partition_of(x)].emplace(::std::forward<V>(x));
+      }
+
+      template <typename K, typename V>
+      auto emplace(K && k, V && v) -> decltype(::std::declval<subcontainer_type &>().emplace(::std::forward<K>(k), ::std::forward<V>(v))) {
+        size_t p = partition_of(k);
+        return parts[p].emplace(::std::forward<K>(k), ::std::forward<V>(v));
+      }
+
+      template <typename V>
+      auto insert(V && x) -> decltype(::std::declval<subcontainer_type &>().insert(::std::forward<V>(x))) {
+        return parts[partition_of(x)].insert(::std::forward<V>(x));
+      }
+
+      /**
+       * @brief bulk insert.  input is grouped by sub-map, and the sub-maps are filled in parallel.
+       * @param op   op(sub-map, value) inserts 1 value into a sub-map.  allows reduction maps to merge values.
+       */
+      template <class InputIt, class InsertOp>
+      void insert(InputIt first, InputIt last, InsertOp const & op) {
+        if (first == last) return;
+
+        if ((parts.size() == 1) ||
+            !::std::is_same<typename ::std::iterator_traits<InputIt>::iterator_category, ::std::random_access_iterator_tag>::value) {
+          for (auto it = first; it != last; ++it) {
+            op(parts[partition_of(*it)], *it);
+          }
+          return;
+        }
+
+        size_t n = ::std::distance(first, last);
+        ::std::vector<size_t> perm;
+        ::std::vector<size_t> offsets = group_by_partition(first, n, perm);
+
+#if defined(USE_OPENMP)
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (size_t p = 0; p < parts.size(); ++p) {
+          auto & part = parts[p];
+          for (size_t i = offsets[p]; i < offsets[p + 1]; ++i) {
+            op(part, *(first + perm[i]));
+          }
+        }
+      }
+
+      /// bulk insert, with emplace.
+      template <class InputIt>
+      void insert(InputIt first, InputIt last) {
+        this->insert(first, last, [](subcontainer_type & part, typename ::std::iterator_traits<InputIt>::value_type const & x){
+          part.emplace(x);
+        });
+      }
+
+      size_type erase(Key const & key) {
+        return parts[partition_of(key)].erase(key);
+      }
+
+      /// erase using a sub-map iterator, e.g. from equal_range.
+      typename subcontainer_type::iterator erase(typename subcontainer_type::const_iterator pos) {
+        return parts[partition_of(pos->first)].erase(pos);
+      }
+
+      //======= lookup
+
+      size_type count(Key const & key) const {
+        return parts[partition_of(key)].count(key);
+      }
+
+      iterator find(Key const & key) {
+        size_t p = partition_of(key);
+        auto it = parts[p].find(key);
+        return (it == parts[p].end()) ? end() : iterator(parts, p, it);
+      }
+
+      const_iterator find(Key const & key) const {
+        size_t p = partition_of(key);
+        auto it = parts[p].find(key);
+        return (it == parts[p].end()) ? cend() : const_iterator(parts, p, it);
+      }
+
+      T & at(Key const & key) {
+        return parts[partition_of(key)].at(key);
+      }
+      T const & at(Key const & key) const {
+        return parts[partition_of(key)].at(key);
+      }
+
+      ::std::pair<typename subcontainer_type::iterator, typename subcontainer_type::iterator>
+      equal_range(Key const & key) {
+        return parts[partition_of(key)].equal_range(key);
+      }
+      ::std::pair<typename subcontainer_type::const_iterator, typename subcontainer_type::const_iterator>
+      equal_range(Key const & key) const {
+        return parts[partition_of(key)].equal_range(key);
+      }
+
+      //======= bulk query
+
+      /**
+       * @brief apply op(sub-map, query, output_iter) for each query, grouped by sub-map, with sub-maps in parallel.
+       * @details  each thread writes to its own buffer, which are then appended to output in sub-map order.
+       *          so the output order is NOT the query order.
+       *          op may modify the sub-map (e.g. erase), since each sub-map is touched by 1 thread only.
+       * @return  sum of op's return values.
+       */
+      template <typename QueryIter, typename OutputIter, typename Operator, typename... Args>
+      size_t apply(QueryIter query_begin, QueryIter query_end, OutputIter & output, Operator & op, Args const & ... args) {
+        return apply_parallel(*this, query_begin, query_end, output, op, args...);
+      }
+      template <typename QueryIter, typename OutputIter, typename Operator, typename... Args>
+      size_t apply(QueryIter query_begin, QueryIter query_end, OutputIter & output, Operator & op, Args const & ... args) const {
+        return apply_parallel(*this, query_begin, query_end, output, op, args...);
+      }
+
+  };
+
+  template <typename Key, typename T,
+      template <typename, typename, typename, typename, typename...> class SubContainer,
+      typename Hash, typename Equal, typename Allocator>
+  constexpr uint64_t thread_partitioned_map<Key, T, SubContainer, Hash, Equal, Allocator>::golden;
+
+
+  /**
+   * @brief adapter so that thread_partitioned_map can be used as the Container template template parameter of dsc maps.
+   * @details e.g. ::fsc::thread_partitioned<::std::unordered_map>::template type
+   */
+  template <template <typename, typename, typename, typename, typename...> class SubContainer>
+  struct thread_partitioned {
+      template <typename Key, typename T, typename Hash, typename Equal, typename Allocator>
+      using type = thread_partitioned_map<Key, T, SubContainer, Hash, Equal, Allocator>;
+  };
+
+
+  /// type trait to check if a container is a thread_partitioned_map.
+  template <typename C>
+  struct is_thread_partitioned : public ::std::false_type {};
+
+  template <typename Key, typename T,
+      template <typename, typename, typename, typename, typename...> class SubContainer,
+      typename Hash, typename Equal, typename Allocator>
+  struct is_thread_partitioned<thread_partitioned_map<Key, T, SubContainer, Hash, Equal, Allocator> > : public ::std::true_type {};
+
+
+} // end namespace fsc
+
+
+#endif /* THREAD_PARTITIONED_MAP_HPP_ */
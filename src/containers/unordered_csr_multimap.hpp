@@ -0,0 +1,745 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    unordered_csr_multimap.hpp
+ * @ingroup fsc::containers
+ * @author  tpan
+ * @brief   compact multimap in compressed sparse row (CSR) layout, for position indices.
+ * @details std::unordered_multimap and the sorted vector store a (key, value) pair per occurrence, so the key is
+ *          repeated for each occurrence.  this container stores each unique key once:
+ *            keys     unique keys, grouped by hash bucket
+ *            buckets  offset of the first key of each bucket.  about 1 bucket per unique key.
+ *            offsets  offset of the first value of each key.
+ *            values   all values, grouped by key.  optionally delta + varint coded within each key's run.
+ *
+ *          memory:  N * sizeof(T) (or less, compressed) + U * (sizeof(Key) + 16) bytes for N elements and U unique keys,
+ *          compared to N * sizeof(pair<Key, T>) + hash table overhead.
+ *
+ *          the layout is static.  inserted elements are appended to a staging vector, and the layout is rebuilt on the
+ *          next lookup or iteration, so bulk insert followed by queries is the intended use.  erase of a key only
+ *          marks it, and the space is reclaimed at the next rebuild.  erase of a single element (by iterator) also
+ *          marks it, but forces a rebuild at the next lookup, so it is slow.
+ *
+ *          keys are kept in the order of their bit-reversed hash, and the top bits of that order are the bucket.
+ *          the order is then the bucket order for any power of 2 bucket count.  a rebuild sorts the staging vector
+ *          in place in that order and merges its runs into the layout in one pass.  runs of keys without new
+ *          elements are copied as is, so the layout is not unpacked.
+ *
+ *          interface follows std::unordered_multimap for the operations used by dsc::unordered_multimap, so it can be
+ *          used as its local Container.  iterators are forward, const, and dereference to a value_type by value.
+ */
+#ifndef UNORDERED_CSR_MULTIMAP_HPP_
+#define UNORDERED_CSR_MULTIMAP_HPP_
+
+#include <vector>
+#include <functional>  // hash, equal_to, etc
+#include <utility>   // pair
+#include <iterator>
+#include <type_traits>
+#include <algorithm>
+#include <cmath>   // ceil
+#include <cstdint>
+#include <memory>  // allocator
+
+
+namespace fsc {  // fast standard container
+
+  namespace csr {
+
+    template <typename T>
+    struct always_void {
+        using type = void;
+    };
+
+    /// 64 bit integer view of a value, for delta coding.  defined for integers and for ids with a 64 bit id member.
+    template <typename T, typename = void>
+    struct integer_value;
+
+    template <typename T>
+    struct integer_value<T, typename ::std::enable_if<::std::is_integral<T>::value>::type> {
+        static inline uint64_t get(T const & x) { return static_cast<uint64_t>(x); }
+        static inline T make(uint64_t v) { return static_cast<T>(v); }
+    };
+
+    /// bliss::common::ShortSequenceKmerId and LongSequenceKmerId.
+    template <typename T>
+    struct integer_value<T, typename always_void<decltype(::std::declval<T>().id)>::type> {
+        static inline uint64_t get(T const & x) { return static_cast<uint64_t>(x.id); }
+        static inline T make(uint64_t v) {
+          T x;
+          x.id = v;
+          return x;
+        }
+    };
+
+
+    /// values stored as is.
+    template <typename T>
+    class raw_values {
+      protected:
+        ::std::vector<T> data;
+
+      public:
+        /// position of the current value.
+        using cursor = size_t;
+
+        /// start an empty layout for the given number of runs and values.  runs are then appended in order.
+        void reserve(size_t runs, size_t n) {
+          (void)runs;
+          data.reserve(n);
+        }
+
+        /// append run i of src, which starts at element e and has n elements, as is.
+        void append_run(raw_values const & src, size_t i, size_t e, size_t n) {
+          (void)i;
+          data.insert(data.end(), src.data.begin() + e, src.data.begin() + e + n);
+        }
+
+        /// append a new run.  the values may be reordered.
+        template <typename It>
+        void append_run(It first, It last) {
+          data.insert(data.end(), first, last);
+        }
+
+        /// end of the layout.
+        void finish() {}
+
+        void clear() {
+          ::std::vector<T>().swap(data);
+        }
+
+        size_t memory() const {
+          return data.capacity() * sizeof(T);
+        }
+
+        /// cursor at element e, which is the first element of run i.
+        inline cursor begin(size_t i, size_t e) const {
+          (void)i;
+          return e;
+        }
+        inline T get(cursor const & c) const {
+          return data[c];
+        }
+        inline void next(cursor & c) const {
+          ++c;
+        }
+
+        void swap(raw_values & other) {
+          data.swap(other.data);
+        }
+    };
+
+
+    /// values sorted within each key's run, then stored as LEB128 varint of the differences.  suits position ids.
+    template <typename T>
+    class delta_varint_values {
+      protected:
+        ::std::vector<uint8_t> data;
+        /// byte offset of each run.
+        ::std::vector<size_t> starts;
+        /// scratch for coding a run.
+        ::std::vector<uint64_t> run;
+
+        static inline void write(::std::vector<uint8_t> & out, uint64_t v) {
+          while (v >= 0x80) {
+            out.push_back(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+          }
+          out.push_back(static_cast<uint8_t>(v));
+        }
+        inline uint64_t read(size_t & pos) const {
+          uint64_t v = 0;
+          unsigned int shift = 0;
+          uint8_t b;
+          do {
+            b = data[pos++];
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            shift += 7;
+          } while (b & 0x80);
+          return v;
+        }
+
+      public:
+        /// byte position after the current value, and the current value.
+        struct cursor {
+            size_t pos;
+            uint64_t v;
+        };
+
+        /// start an empty layout for the given number of runs and values.  runs are then appended in order.
+        void reserve(size_t runs, size_t n) {
+          data.reserve(n * 2);
+          starts.reserve(runs + 1);
+        }
+
+        /// append run i of src as is.  the coded bytes are copied without decoding.
+        void append_run(delta_varint_values const & src, size_t i, size_t e, size_t n) {
+          (void)e;
+          (void)n;
+          starts.emplace_back(data.size());
+          data.insert(data.end(), src.data.begin() + src.starts[i], src.data.begin() + src.starts[i + 1]);
+        }
+
+        /// append a new run.  the values are sorted and coded.
+        template <typename It>
+        void append_run(It first, It last) {
+          starts.emplace_back(data.size());
+
+          run.clear();
+          for (; first != last; ++first) run.emplace_back(integer_value<T>::get(*first));
+          ::std::sort(run.begin(), run.end());
+
+          uint64_t prev = 0;
+          for (auto v : run) {
+            write(data, v - prev);
+            prev = v;
+          }
+        }
+
+        /// end of the layout.
+        void finish() {
+          starts.emplace_back(data.size());
+          data.shrink_to_fit();
+          ::std::vector<uint64_t>().swap(run);
+        }
+
+        void clear() {
+          ::std::vector<uint8_t>().swap(data);
+          ::std::vector<size_t>().swap(starts);
+          ::std::vector<uint64_t>().swap(run);
+        }
+
+        size_t memory() const {
+          return data.capacity() + starts.capacity() * sizeof(size_t);
+        }
+
+        /// cursor at element e, which is the first element of run i.
+        inline cursor begin(size_t i, size_t e) const {
+          (void)e;
+          cursor c;
+          c.pos = starts[i];
+          c.v = read(c.pos);
+          return c;
+        }
+        inline T get(cursor const & c) const {
+          return integer_value<T>::make(c.v);
+        }
+        /// only called when there is a next element in the run.
+        inline void next(cursor & c) const {
+          c.v += read(c.pos);
+        }
+
+        void swap(delta_varint_values & other) {
+          data.swap(other.data);
+          starts.swap(other.starts);
+          run.swap(other.run);
+        }
+    };
+
+  }  // namespace csr
+
+
+  /**
+   * @brief  multimap with each unique key stored once, and its values stored contiguously.  see file description.
+   * @tparam Values  value storage, csr::raw_values<T> or csr::delta_varint_values<T>.
+   */
+  template <typename Key, typename T, typename Hash = ::std::hash<Key>, typename Equal = ::std::equal_to<Key>,
+      typename Allocator = ::std::allocator<::std::pair<const Key, T> >,
+      typename Values = ::fsc::csr::raw_values<T> >
+  class unordered_csr_multimap {
+
+    public:
+      using key_type              = Key;
+      using mapped_type           = T;
+      using value_type            = ::std::pair<const Key, T>;
+      using hasher                = Hash;
+      using key_equal             = Equal;
+      using allocator_type        = Allocator;
+      using reference             = value_type;
+      using const_reference       = value_type;
+      using pointer               = value_type const *;
+      using const_pointer         = value_type const *;
+      using size_type             = size_t;
+      using difference_type       = ::std::ptrdiff_t;
+
+      /// forward iterator over the compacted elements.  dereferences to a value_type by value.
+      class const_iterator :
+        public ::std::iterator<::std::forward_iterator_tag, value_type, difference_type, value_type const *, value_type>
+      {
+          friend class unordered_csr_multimap;
+
+        protected:
+          unordered_csr_multimap const * map;
+          /// current key
+          size_t i;
+          /// current element
+          size_t e;
+          /// end element
+          size_t limit;
+          typename Values::cursor cur;
+
+          /// move past erased keys.  runs are never empty.
+          void skip_erased() {
+            while ((e < limit) && map->is_erased(i)) {
+              e = map->offsets[i + 1];
+              ++i;
+            }
+            if (e < limit) cur = map->values.begin(i, e);
+          }
+
+          const_iterator(unordered_csr_multimap const * _map, size_t _i, size_t _e, size_t _limit) :
+            map(_map), i(_i), e(_e), limit(_limit), cur() {
+            skip_erased();
+          }
+
+        public:
+          /// proxy for operator->, since elements are constructed on dereference.
+          struct arrow {
+              value_type v;
+              value_type const * operator->() const { return &v; }
+          };
+
+          const_iterator() : map(nullptr), i(0), e(0), limit(0), cur() {}
+
+          const_iterator & operator++() {
+            ++e;
+            if (e == limit) return *this;
+            if (e == map->offsets[i + 1]) {
+              ++i;
+              skip_erased();
+            } else {
+              map->values.next(cur);
+            }
+            return *this;
+          }
+
+          const_iterator operator++(int) {
+            const_iterator out(*this);
+            this->operator++();
+            return out;
+          }
+
+          bool operator==(const_iterator const & other) const {
+            return e == other.e;
+          }
+          bool operator!=(const_iterator const & other) const {
+            return e != other.e;
+          }
+
+          value_type operator*() const {
+            return value_type(map->keys[i], map->values.get(cur));
+          }
+          arrow operator->() const {
+            return arrow{this->operator*()};
+          }
+      };
+      using iterator = const_iterator;
+
+    protected:
+      Hash hash;
+      Equal eq;
+      float lf;
+
+      // compacted layout.  mutable, since lookups rebuild it after inserts.
+      mutable ::std::vector<Key> keys;
+      mutable ::std::vector<size_t> buckets;
+      mutable ::std::vector<size_t> offsets;
+      mutable Values values;
+      /// marks erased keys.  empty if none.
+      mutable ::std::vector<bool> erased;
+      /// number of elements of erased keys.
+      mutable size_t erased_count;
+      /// marks elements erased individually.  empty if none.
+      mutable ::std::vector<bool> removed;
+      mutable size_t removed_count;
+
+      /// 64 - log2 of the bucket count.
+      mutable unsigned int bucket_shift;
+
+      /// elements inserted since the last rebuild.
+      mutable ::std::vector<::std::pair<Key, T> > pending;
+
+      inline bool is_erased(size_t i) const {
+        return !erased.empty() && erased[i];
+      }
+
+      inline size_t compacted_size() const {
+        return offsets.empty() ? 0 : offsets.back();
+      }
+
+      /// position of a key in the layout order:  its hash with the bits reversed, so the low bits of the hash pick the bucket.
+      inline uint64_t order_of(Key const & k) const {
+        uint64_t h = static_cast<uint64_t>(hash(k));
+        h = ((h >> 1) & 0x5555555555555555UL) | ((h & 0x5555555555555555UL) << 1);
+        h = ((h >> 2) & 0x3333333333333333UL) | ((h & 0x3333333333333333UL) << 2);
+        h = ((h >> 4) & 0x0F0F0F0F0F0F0F0FUL) | ((h & 0x0F0F0F0F0F0F0F0FUL) << 4);
+        return __builtin_bswap64(h);
+      }
+
+      inline size_t bucket_of(Key const & k) const {
+        return order_of(k) >> bucket_shift;
+      }
+
+      /// position of key k in keys, or keys.size() if absent or erased.
+      size_t find_key(Key const & k) const {
+        compact();
+        if (keys.empty()) return 0;
+
+        size_t b = bucket_of(k);
+        for (size_t i = buckets[b]; i < buckets[b + 1]; ++i) {
+          if (eq(keys[i], k)) return is_erased(i) ? keys.size() : i;
+        }
+        return keys.size();
+      }
+
+      /// end of the run of equal keys in pending that starts at r.  runs end at or before t.
+      size_t pending_run_end(size_t r, size_t t) const {
+        size_t e = r + 1;
+        while ((e < t) && eq(pending[e].first, pending[r].first)) ++e;
+        return e;
+      }
+
+      /// sort pending in place in layout order, with equal keys adjacent.
+      void sort_pending() const {
+        ::std::sort(pending.begin(), pending.end(), [this](::std::pair<Key, T> const & x, ::std::pair<Key, T> const & y) {
+          return this->order_of(x.first) < this->order_of(y.first);
+        });
+
+        // equal orders hold equal keys, except on hash collisions.  group the keys of such a range.
+        size_t t;
+        for (size_t s = 0; s < pending.size(); s = t) {
+          uint64_t o = order_of(pending[s].first);
+          bool mixed = false;
+          for (t = s + 1; (t < pending.size()) && (order_of(pending[t].first) == o); ++t) {
+            mixed |= !eq(pending[t].first, pending[s].first);
+          }
+          if (!mixed) continue;
+
+          for (size_t g = s, m; g < t; g = m) {
+            m = g + 1;
+            for (size_t x = g + 1; x < t; ++x) {
+              if (eq(pending[x].first, pending[g].first)) ::std::swap(pending[x], pending[m++]);
+            }
+          }
+        }
+      }
+
+      /**
+       * @brief rebuild the layout with the pending elements, and drop erased elements.  erased keys alone do not
+       *        need a rebuild, unless forced.
+       * @details  pending is sorted in layout order, then merged with the current layout in one pass.  a key's run is
+       *           copied as is unless it gets new elements or lost some to erase by iterator.  the keys are hashed
+       *           once, and no per-element structure is built for the current layout.
+       */
+      void compact(bool force = false) const {
+        if (pending.empty() && (removed_count == 0) && !(force && (erased_count > 0))) return;
+
+        sort_pending();
+
+        size_t nold = keys.size();
+        size_t npending = pending.size();
+
+        ::std::vector<Key> new_keys;
+        ::std::vector<size_t> new_offsets;
+        Values new_values;
+        new_keys.reserve(nold + npending);
+        new_offsets.reserve(nold + npending + 1);
+        new_values.reserve(nold + npending, compacted_size() - erased_count - removed_count + npending);
+        new_offsets.emplace_back(0);
+
+        // values of a run that is not copied as is.
+        ::std::vector<T> run_vals;
+        // starts of the pending runs merged into a current key, for the current order.
+        ::std::vector<size_t> merged;
+
+        size_t i = 0, j = 0;
+        uint64_t oi = (nold > 0) ? order_of(keys[0]) : 0;
+        uint64_t oj = (npending > 0) ? order_of(pending[0].first) : 0;
+        while ((i < nold) || (j < npending)) {
+          uint64_t o = (i == nold) ? oj : ((j == npending) ? oi : ::std::min(oi, oj));
+
+          // the current keys and pending runs with order o.  usually at most 1 of each.
+          size_t i_end = i;
+          while ((i_end < nold) && (oi == o)) {
+            ++i_end;
+            if (i_end < nold) oi = order_of(keys[i_end]);
+          }
+          size_t j_end = j;
+          while ((j_end < npending) && (oj == o)) {
+            ++j_end;
+            if (j_end < npending) oj = order_of(pending[j_end].first);
+          }
+
+          // current keys, with the pending run of the same key appended.  erased keys are dropped, so a pending
+          // run of an erased key becomes a new key below.
+          merged.clear();
+          for (; i < i_end; ++i) {
+            if (is_erased(i)) continue;
+
+            size_t rs = j_end, re = j_end;
+            for (size_t r = j; r < j_end; r = pending_run_end(r, j_end)) {
+              if (eq(pending[r].first, keys[i])) {
+                rs = r;
+                re = pending_run_end(r, j_end);
+                merged.emplace_back(r);
+                break;
+              }
+            }
+
+            size_t e = offsets[i];
+            size_t n = offsets[i + 1] - e;
+            bool pruned = (removed_count > 0) &&
+                (::std::find(removed.begin() + e, removed.begin() + e + n, true) != removed.begin() + e + n);
+
+            if (!pruned && (rs == re)) {
+              new_values.append_run(values, i, e, n);
+            } else {
+              run_vals.clear();
+              typename Values::cursor c = values.begin(i, e);
+              for (size_t x = e; x < e + n; ++x) {
+                if (x > e) values.next(c);
+                if ((removed_count == 0) || !removed[x]) run_vals.emplace_back(values.get(c));
+              }
+              for (size_t r = rs; r < re; ++r) run_vals.emplace_back(pending[r].second);
+              if (run_vals.empty()) continue;
+
+              n = run_vals.size();
+              new_values.append_run(run_vals.begin(), run_vals.end());
+            }
+            new_keys.emplace_back(keys[i]);
+            new_offsets.emplace_back(new_offsets.back() + n);
+          }
+
+          // pending runs of new keys.
+          for (size_t r = j, re; r < j_end; r = re) {
+            re = pending_run_end(r, j_end);
+            if (::std::find(merged.begin(), merged.end(), r) != merged.end()) continue;
+
+            run_vals.clear();
+            for (size_t x = r; x < re; ++x) run_vals.emplace_back(pending[x].second);
+            new_values.append_run(run_vals.begin(), run_vals.end());
+            new_keys.emplace_back(pending[r].first);
+            new_offsets.emplace_back(new_offsets.back() + (re - r));
+          }
+          j = j_end;
+        }
+        new_values.finish();
+        ::std::vector<::std::pair<Key, T> >().swap(pending);
+
+        keys.swap(new_keys);
+        offsets.swap(new_offsets);
+        values.swap(new_values);
+        ::std::vector<bool>().swap(erased);
+        ::std::vector<bool>().swap(removed);
+        erased_count = 0;
+        removed_count = 0;
+        keys.shrink_to_fit();
+        offsets.shrink_to_fit();
+
+        if (keys.empty()) {
+          ::std::vector<size_t>().swap(buckets);
+          ::std::vector<size_t>().swap(offsets);
+          values.clear();
+          return;
+        }
+
+        // power of 2 buckets, about 1 per key.  keys are in bucket order already.
+        size_t nbuckets = 2;
+        bucket_shift = 63;
+        while (static_cast<float>(nbuckets) * lf < static_cast<float>(keys.size())) {
+          nbuckets <<= 1;
+          --bucket_shift;
+        }
+        buckets.assign(nbuckets + 1, 0);
+        for (auto const & k : keys) ++buckets[bucket_of(k) + 1];
+        for (size_t b = 0; b < nbuckets; ++b) buckets[b + 1] += buckets[b];
+      }
+
+      /// iterators over the current layout, without rebuilding.
+      const_iterator cbegin_compacted() const {
+        return const_iterator(this, 0, 0, compacted_size());
+      }
+      const_iterator cend_compacted() const {
+        return const_iterator(this, keys.size(), compacted_size(), compacted_size());
+      }
+
+    public:
+
+      unordered_csr_multimap(size_type bucket_count = 0,
+                             Hash const & _hash = Hash(),
+                             Equal const & _equal = Equal(),
+                             Allocator const & alloc = Allocator()) :
+                               hash(_hash), eq(_equal), lf(1.0f), erased_count(0), removed_count(0), bucket_shift(63) {
+        (void)alloc;
+        reserve(bucket_count);
+      }
+
+      const_iterator begin() const {
+        compact();
+        return cbegin_compacted();
+      }
+      const_iterator cbegin() const {
+        return begin();
+      }
+      const_iterator end() const {
+        compact();
+        return cend_compacted();
+      }
+      const_iterator cend() const {
+        return end();
+      }
+
+      bool empty() const {
+        return size() == 0;
+      }
+
+      size_type size() const {
+        return compacted_size() - erased_count - removed_count + pending.size();
+      }
+
+      /// number of unique keys.
+      size_type unique_size() const {
+        compact();
+        return keys.size();
+      }
+
+      void clear() noexcept {
+        ::std::vector<Key>().swap(keys);
+        ::std::vector<size_t>().swap(buckets);
+        ::std::vector<size_t>().swap(offsets);
+        ::std::vector<bool>().swap(erased);
+        ::std::vector<bool>().swap(removed);
+        values.clear();
+        erased_count = 0;
+        removed_count = 0;
+        ::std::vector<::std::pair<Key, T> >().swap(pending);
+      }
+
+      void swap(unordered_csr_multimap & other) noexcept {
+        ::std::swap(hash, other.hash);
+        ::std::swap(eq, other.eq);
+        ::std::swap(lf, other.lf);
+        keys.swap(other.keys);
+        buckets.swap(other.buckets);
+        offsets.swap(other.offsets);
+        values.swap(other.values);
+        erased.swap(other.erased);
+        ::std::swap(erased_count, other.erased_count);
+        removed.swap(other.removed);
+        ::std::swap(removed_count, other.removed_count);
+        ::std::swap(bucket_shift, other.bucket_shift);
+        pending.swap(other.pending);
+      }
+
+      /// bytes used by the compacted layout and the pending elements.
+      size_t memory() const {
+        return keys.capacity() * sizeof(Key) + (buckets.capacity() + offsets.capacity()) * sizeof(size_t) +
+            values.memory() + (erased.capacity() + removed.capacity()) / 8 +
+            pending.capacity() * sizeof(::std::pair<Key, T>);
+      }
+
+      /// buckets of the layout, or enough for the reserved elements.
+      size_type bucket_count() const {
+        size_t reserved = static_cast<size_t>(::std::ceil(static_cast<float>(compacted_size() + pending.capacity()) / lf));
+        return ::std::max(buckets.empty() ? 0 : buckets.size() - 1, reserved);
+      }
+
+      float max_load_factor() const {
+        return lf;
+      }
+      void max_load_factor(float ml) {
+        lf = ml;
+      }
+
+      /// room for count elements.  only the staging vector is reserved.
+      void reserve(size_type count) {
+        if (count > size()) pending.reserve(pending.size() + count - size());
+      }
+      void rehash(size_type count) {
+        reserve(static_cast<size_type>(static_cast<float>(count) * lf));
+      }
+
+      /// staged until the next lookup, so no iterator is returned.
+      template <typename V>
+      void emplace(V && x) {
+        pending.emplace_back(::std::forward<V>(x));
+      }
+      void emplace(Key const & k, T const & v) {
+        pending.emplace_back(k, v);
+      }
+      template <typename V>
+      void insert(V && x) {
+        pending.emplace_back(::std::forward<V>(x));
+      }
+      template <class InputIt>
+      void insert(InputIt first, InputIt last) {
+        pending.insert(pending.end(), first, last);
+      }
+
+      /// remove all values of key.  the space is reclaimed at the next rebuild.
+      size_type erase(Key const & key) {
+        size_t i = find_key(key);
+        if (i == keys.size()) return 0;
+
+        if (erased.empty()) erased.resize(keys.size(), false);
+        erased[i] = true;
+        size_t n = offsets[i + 1] - offsets[i];
+        erased_count += n;
+        return n;
+      }
+
+      /// remove 1 element.  other iterators stay valid until the next lookup, which rebuilds the layout.
+      const_iterator erase(const_iterator pos) {
+        const_iterator next = pos;
+        ++next;
+
+        if (removed.empty()) removed.resize(compacted_size(), false);
+        if (!removed[pos.e]) {
+          removed[pos.e] = true;
+          ++removed_count;
+        }
+        return next;
+      }
+
+      /// rebuild now, and release unused memory.
+      void shrink_to_fit() {
+        compact(true);
+        pending.shrink_to_fit();
+      }
+
+      size_type count(Key const & key) const {
+        size_t i = find_key(key);
+        return (i == keys.size()) ? 0 : (offsets[i + 1] - offsets[i]);
+      }
+
+      ::std::pair<const_iterator, const_iterator> equal_range(Key const & key) const {
+        size_t i = find_key(key);
+        if (i == keys.size()) return ::std::make_pair(cend_compacted(), cend_compacted());
+        return ::std::make_pair(const_iterator(this, i, offsets[i], offsets[i + 1]),
+                                const_iterator(this, i + 1, offsets[i + 1], offsets[i + 1]));
+      }
+  };
+
+
+  /// unordered_csr_multimap with delta + varint coded values, as a Container for dsc::unordered_multimap.
+  template <typename Key, typename T, typename Hash, typename Equal, typename Allocator>
+  using unordered_csr_delta_multimap =
+      unordered_csr_multimap<Key, T, Hash, Equal, Allocator, ::fsc::csr::delta_varint_values<T> >;
+
+}  // namespace fsc
+
+#endif /* UNORDERED_CSR_MULTIMAP_HPP_ */
@@ -66,6 +66,10 @@
 
 #include "utils/transform_utils.hpp"
 
+#if defined(__AVX2__)
+#include <x86intrin.h>   // all intrinsics.  will be enabled based on compiler flag such as __AVX2__ internally.
+#endif
+
 // includ the murmurhash code.
 #ifndef _MURMURHASH3_H_
 #include <smhasher/MurmurHash3.cpp>
@@ -148,6 +152,61 @@ namespace bliss {
     namespace hash
     {
 
+#if defined(__AVX2__)
+      /// 4-way AVX2 helpers for the batched hash functions.  AVX2 has no 64 bit multiply, so it is composed from 32 bit multiplies.
+      namespace avx2 {
+
+        /// low 64 bits of a * b, per 64 bit lane.
+        inline __m256i mullo64(__m256i a, __m256i b) {
+          __m256i lo = _mm256_mul_epu32(a, b);
+          __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                                           _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+          return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+        }
+
+        template <int R>
+        inline __m256i rotl64(__m256i x) {
+          return _mm256_or_si256(_mm256_slli_epi64(x, R), _mm256_srli_epi64(x, 64 - R));
+        }
+
+        template <int R>
+        inline __m256i rotr64(__m256i x) {
+          return _mm256_or_si256(_mm256_srli_epi64(x, R), _mm256_slli_epi64(x, 64 - R));
+        }
+
+        template <int R>
+        inline __m256i shift_mix(__m256i x) {
+          return _mm256_xor_si256(x, _mm256_srli_epi64(x, R));
+        }
+
+        /// mask for the lowest nbytes bytes of a 64 bit word.
+        constexpr uint64_t byte_mask(unsigned int nbytes) {
+          return (nbytes >= 8) ? ~(0x0ULL) : ((0x1ULL << (8 * nbytes)) - 1);
+        }
+
+        /// load the words of 4 consecutive 1 or 2 word kmers, transposed so that w0 and w1 hold word 0 and word 1 of each kmer.
+        template <typename KMER>
+        inline void load4(KMER const * keys, __m256i & w0, __m256i & w1) {
+          if (KMER::nWords == 1) {
+            w0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys));
+            w1 = _mm256_setzero_si256();
+          } else {
+            __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys));      // k0w0 k0w1 k1w0 k1w1
+            __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + 2));  // k2w0 k2w1 k3w0 k3w1
+            w0 = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(v0, v1), 0xD8);
+            w1 = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(v0, v1), 0xD8);
+          }
+        }
+
+        /// kmers that the AVX2 kernels support:  1 or 2 64-bit words, stored contiguously.
+        template <typename KMER>
+        struct is_supported {
+            static constexpr bool value = (sizeof(typename KMER::KmerWordType) == 8) && (KMER::nWords <= 2) &&
+                (sizeof(KMER) == KMER::nWords * 8);
+        };
+      }
+#endif
+
 
       /**
        * @brief  Kmer hash, returns the least significant NumBits directly as identity hash.
@@ -198,6 +257,11 @@ namespace bliss {
               return h;  // suffix.  just return the whole thing.
           }
 
+          /// batch interface.  hash count kmers into out.
+          inline void operator()(KMER const * keys, size_t count, uint64_t * out) const {
+            for (size_t i = 0; i < count; ++i) out[i] = this->operator()(keys[i]);
+          }
+
       };
       template<typename KMER, bool Prefix>
       constexpr uint8_t cpp_std<KMER, Prefix>::batch_size;
@@ -229,6 +293,11 @@ namespace bliss {
               // get the whole thing
               return kmer.getSuffix(suffix_bits);
           }
+
+          /// batch interface.  hash count kmers into out.
+          inline void operator()(KMER const * keys, size_t count, uint64_t * out) const {
+            for (size_t i = 0; i < count; ++i) out[i] = this->operator()(keys[i]);
+          }
       };
       template<typename KMER, bool Prefix>
       constexpr uint8_t identity<KMER, Prefix>::batch_size;
@@ -247,8 +316,70 @@ namespace bliss {
           static constexpr unsigned int nBytes = (KMER::nBits + 7) / 8;
           uint32_t seed;
 
+#if defined(__AVX2__)
+          static constexpr bool use_avx2 = avx2::is_supported<KMER>::value && (sizeof(void*) == 8);
+
+          /// MurmurHash3_x64_128 for 4 kmers of at most 16 bytes.  same result as the scalar version.
+          inline void hash4(KMER const * keys, uint64_t * out) const {
+            const __m256i c1 = _mm256_set1_epi64x(0x87c37b91114253d5ULL);
+            const __m256i c2 = _mm256_set1_epi64x(0x4cf5ad432745937fULL);
+
+            __m256i k1, k2;
+            avx2::load4(keys, k1, k2);
+
+            __m256i h1 = _mm256_set1_epi64x(seed);
+            __m256i h2 = h1;
+
+            if (nBytes == 16) {
+              // 1 block, no tail.
+              k1 = avx2::mullo64(avx2::rotl64<31>(avx2::mullo64(k1, c1)), c2);
+              h1 = _mm256_xor_si256(h1, k1);
+              h1 = _mm256_add_epi64(avx2::rotl64<27>(h1), h2);
+              h1 = _mm256_add_epi64(_mm256_add_epi64(_mm256_slli_epi64(h1, 2), h1), _mm256_set1_epi64x(0x52dce729));
+
+              k2 = avx2::mullo64(avx2::rotl64<33>(avx2::mullo64(k2, c2)), c1);
+              h2 = _mm256_xor_si256(h2, k2);
+              h2 = _mm256_add_epi64(avx2::rotl64<31>(h2), h1);
+              h2 = _mm256_add_epi64(_mm256_add_epi64(_mm256_slli_epi64(h2, 2), h2), _mm256_set1_epi64x(0x38495ab5));
+            } else {
+              // tail only.
+              if (nBytes > 8) {
+                k2 = _mm256_and_si256(k2, _mm256_set1_epi64x(avx2::byte_mask(nBytes - 8)));
+                k2 = avx2::mullo64(avx2::rotl64<33>(avx2::mullo64(k2, c2)), c1);
+                h2 = _mm256_xor_si256(h2, k2);
+              }
+              k1 = _mm256_and_si256(k1, _mm256_set1_epi64x(avx2::byte_mask(nBytes)));
+              k1 = avx2::mullo64(avx2::rotl64<31>(avx2::mullo64(k1, c1)), c2);
+              h1 = _mm256_xor_si256(h1, k1);
+            }
+
+            // finalization
+            const __m256i len = _mm256_set1_epi64x(nBytes);
+            h1 = _mm256_xor_si256(h1, len);
+            h2 = _mm256_xor_si256(h2, len);
+            h1 = _mm256_add_epi64(h1, h2);
+            h2 = _mm256_add_epi64(h2, h1);
+
+            const __m256i m1 = _mm256_set1_epi64x(0xff51afd7ed558ccdULL);
+            const __m256i m2 = _mm256_set1_epi64x(0xc4ceb9fe1a85ec53ULL);
+            h1 = avx2::shift_mix<33>(avx2::mullo64(avx2::shift_mix<33>(avx2::mullo64(avx2::shift_mix<33>(h1), m1)), m2));
+            h2 = avx2::shift_mix<33>(avx2::mullo64(avx2::shift_mix<33>(avx2::mullo64(avx2::shift_mix<33>(h2), m1)), m2));
+
+            h1 = _mm256_add_epi64(h1, h2);
+            if (Prefix) {
+              h2 = _mm256_add_epi64(h2, h1);
+              _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), h2);
+            } else {
+              _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), h1);
+            }
+          }
+#else
+          static constexpr bool use_avx2 = false;
+#endif
+
         public:
-          static constexpr uint8_t batch_size = 1;
+          /// number of kmers the batch interface processes at a time.
+          static constexpr uint8_t batch_size = use_avx2 ? 4 : 1;
 
           static const unsigned int default_init_value = 24U;  // allow 16M processors.  but it's ignored here.
 
@@ -273,6 +404,17 @@ namespace bliss {
               return h[0];
           }
 
+          /// batch interface.  hash count kmers into out, 4 at a time with AVX2 for 1 and 2 word kmers.
+          inline void operator()(KMER const * keys, size_t count, uint64_t * out) const {
+            size_t i = 0;
+#if defined(__AVX2__)
+            if (use_avx2) {
+              for (; i + 4 <= count; i += 4) hash4(keys + i, out + i);
+            }
+#endif
+            for (; i < count; ++i) out[i] = this->operator()(keys[i]);
+          }
+
       };
       template<typename KMER, bool Prefix>
       constexpr uint8_t murmur<KMER, Prefix>::batch_size;
@@ -292,8 +434,60 @@ namespace bliss {
           size_t shift;
           uint32_t seed;
 
+#if defined(__AVX2__)
+          static constexpr bool use_avx2 = avx2::is_supported<KMER>::value && (nBytes >= 4);
+          // byte offsets of the last 8 (or 4) bytes, as shifts.  clamped so that unused branches stay valid.
+          static constexpr int lo_shift = ((nBytes > 8) && (nBytes < 16)) ? 8 * (nBytes - 8) : 8;
+          static constexpr int short_shift = ((nBytes >= 4) && (nBytes < 8)) ? 8 * (nBytes - 4) : 0;
+
+          /// farmhashna::Hash64WithSeed for 4 kmers of 4 to 16 bytes.  same result as the scalar version.
+          inline void hash4(KMER const * keys, uint64_t * out, uint64_t s) const {
+            const uint64_t k2 = 0x9ae16a3b2f90404fULL;
+            const __m256i mul = _mm256_set1_epi64x(k2 + nBytes * 2);
+
+            __m256i w0, w1;
+            avx2::load4(keys, w0, w1);
+
+            // HashLen0to16 then HashLen16(u, v, mul)
+            __m256i u, v;
+            if (nBytes >= 8) {
+              __m256i a = _mm256_add_epi64(w0, _mm256_set1_epi64x(k2));
+              // b = Fetch64(s + nBytes - 8)
+              __m256i b;
+              if (nBytes == 8) b = w0;
+              else if (nBytes == 16) b = w1;
+              else b = _mm256_or_si256(_mm256_srli_epi64(w0, lo_shift),
+                                       _mm256_slli_epi64(_mm256_and_si256(w1, _mm256_set1_epi64x(avx2::byte_mask(nBytes - 8))), 64 - lo_shift));
+              u = _mm256_add_epi64(avx2::mullo64(avx2::rotr64<37>(b), mul), a);
+              v = avx2::mullo64(_mm256_add_epi64(avx2::rotr64<25>(a), b), mul);
+            } else {
+              // a = Fetch32(s), b = Fetch32(s + nBytes - 4)
+              __m256i w = _mm256_and_si256(w0, _mm256_set1_epi64x(avx2::byte_mask(nBytes)));
+              __m256i a = _mm256_and_si256(w, _mm256_set1_epi64x(0xFFFFFFFFULL));
+              u = _mm256_add_epi64(_mm256_set1_epi64x(nBytes), _mm256_slli_epi64(a, 3));
+              v = _mm256_srli_epi64(w, short_shift);
+            }
+            __m256i x = avx2::shift_mix<47>(avx2::mullo64(_mm256_xor_si256(u, v), mul));
+            __m256i h = avx2::mullo64(avx2::shift_mix<47>(avx2::mullo64(_mm256_xor_si256(v, x), mul)), mul);
+
+            // Hash64WithSeeds:  HashLen16(h - k2, seed), i.e. Hash128to64
+            const __m256i kmul = _mm256_set1_epi64x(0x9ddfea08eb382d69ULL);
+            const __m256i hi = _mm256_set1_epi64x(s);
+            x = avx2::shift_mix<47>(avx2::mullo64(_mm256_xor_si256(_mm256_sub_epi64(h, _mm256_set1_epi64x(k2)), hi), kmul));
+            h = avx2::mullo64(avx2::shift_mix<47>(avx2::mullo64(_mm256_xor_si256(hi, x), kmul)), kmul);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), h);
+#if FARMHASH_DEBUG
+            for (int i = 0; i < 4; ++i) out[i] = ::util::DebugTweak(out[i]);
+#endif
+          }
+#else
+          static constexpr bool use_avx2 = false;
+#endif
+
         public:
-          static constexpr uint8_t batch_size = 1;
+          /// number of kmers the batch interface processes at a time.
+          static constexpr uint8_t batch_size = use_avx2 ? 4 : 1;
 
           static const unsigned int default_init_value = 24U;   // this allows 16M processors.
 
@@ -308,6 +502,18 @@ namespace bliss {
               return ::util::Hash64WithSeed(reinterpret_cast<const char*>(kmer.getData()), nBytes, seed);
           }
 
+          /// batch interface.  hash count kmers into out, 4 at a time with AVX2 for 1 and 2 word kmers.
+          inline void operator()(KMER const * keys, size_t count, uint64_t * out) const {
+            size_t i = 0;
+#if defined(__AVX2__)
+            if (use_avx2) {
+              uint64_t s = Prefix ? ((seed << 1) - 1) : seed;
+              for (; i + 4 <= count; i += 4) hash4(keys + i, out + i, s);
+            }
+#endif
+            for (; i < count; ++i) out[i] = this->operator()(keys[i]);
+          }
+
       };
       template<typename KMER, bool Prefix>
       constexpr uint8_t farm<KMER, Prefix>::batch_size;
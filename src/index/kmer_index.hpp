@@ -91,6 +91,28 @@ namespace index
 namespace kmer
 {
 
+/// detect whether a distributed map supports pipelined insert (insert_async / insert_flush) for input vectors of V.
+template <typename MapType, typename V>
+struct has_insert_async {
+  template <typename M>
+  static auto test(int) -> decltype(::std::declval<M&>().insert_async(::std::declval<::std::vector<V>&>()), ::std::true_type());
+  template <typename M>
+  static ::std::false_type test(...);
+
+  static constexpr bool value = decltype(test<MapType>(0))::value;
+};
+
+/// detect whether a distributed map supports a solid kmer build (set_solid_filter, sketch, solid_finish) for input vectors of V.
+template <typename MapType, typename V>
+struct has_sketch {
+  template <typename M>
+  static auto test(int) -> decltype(::std::declval<M&>().sketch(::std::declval<::std::vector<V>&>()), ::std::true_type());
+  template <typename M>
+  static ::std::false_type test(...);
+
+  static constexpr bool value = decltype(test<MapType>(0))::value;
+};
+
 /**
  * @tparam MapType  	container type
  * @tparam KmerParser		functor to generate kmer (tuple) from input.  specified here so we specialize for different index.  note KmerParser needs to be supplied with a data type.
@@ -103,6 +125,11 @@ protected:
 
 	const mxx::comm& comm;
 
+	/// solid kmer build:  minimum occurrences.  0 or 1 for a normal build.
+	uint8_t solid_threshold = 0;
+	/// solid kmer build:  filter counters per rank.  0 sizes the filter from the input.
+	size_t solid_counters = 0;
+
 public:
 	using KmerType = typename MapType::key_type;
 	// TODO: make this consistent with map data type conventions?
@@ -112,6 +139,11 @@ public:
 
 	using KmerParserType = KmerParser;
 
+	// set_parsed_input turns the map's InputTransform off for canonical parser output, so it must be the canonical transform.
+	static_assert(!::bliss::index::kmer::is_canonical_parser<KmerParser>::value ||
+	              ::std::is_same<typename MapType::InputTransform, ::bliss::kmer::transform::lex_less<KmerType> >::value,
+	              "canonical kmer parsers need a map with the lex_less InputTransform, e.g. Canonical*MapParams.");
+
 	Index(const mxx::comm& _comm) : map(_comm), comm(_comm) {
 	}
 
@@ -133,6 +165,11 @@ public:
 		-> decltype(::std::declval<MapType>().find(::std::declval<std::vector<KmerType> &>())) {
 		return map.find(query);
 	}
+	/// find, with results passed to visitor(src_rank, first, last) as they arrive instead of returned.  unordered maps only.
+	template <typename Visitor>
+	size_t find_stream(std::vector<KmerType> &query, Visitor & visitor) const {
+		return map.find_stream(query, visitor);
+	}
 //	std::vector<TupleType> find_collective(std::vector<KmerType> &query) const {
 //		return map.find_collective(query);
 //	}
@@ -193,9 +230,140 @@ public:
 		map.erase(pred);
 	}
 
+	/**
+	 * @brief save the built index to per-rank files <path>.<rank>.  collective.
+	 * @details  the files record k and the alphabet, and load() checks them along with the map type and number of ranks.
+	 */
+	void save(std::string const & path) const {
+		uint64_t tags[2] = {KmerType::size, ::dsc::snapshot::hash_name(typeid(Alphabet).name())};
+		this->map.save(path, tags);
+	}
+
+	/// load an index saved with save(), with the same index type and number of ranks, instead of rebuilding it.  collective.
+	void load(std::string const & path) {
+		uint64_t tags[2] = {KmerType::size, ::dsc::snapshot::hash_name(typeid(Alphabet).name())};
+		this->map.load(path, tags);
+	}
+
+
+	/**
+	 * @brief  solid kmer build:  the build functions keep only the kmers that occur at least threshold times.  counting maps only.
+	 * @details  2 passes.  the first counts the kmers into a counting Bloom filter on each kmer's owner, and the second
+	 *          inserts only the kmers that the filter counted at least threshold times, so singleton (error) kmers never
+	 *          reach the map.  false positives are erased at the end.  streaming builds read the file twice.
+	 *          see counting_unordered_map::set_solid_filter.
+	 * @param threshold  minimum occurrences, at most 15.  0 or 1 for a normal build.
+	 * @param counters   filter counters per rank.  0 for 4 per kmer, or for streaming builds, 2 per byte of the (decompressed) file, divided by the number of ranks.
+	 */
+	void set_solid_build(uint8_t threshold, size_t counters = 0) {
+		if (threshold > 15) throw std::invalid_argument("solid kmer threshold must be at most 15.");
+		this->solid_threshold = threshold;
+		this->solid_counters = counters;
+	}
+
+protected:
+	using solid_capable = ::std::integral_constant<bool, has_sketch<MapType, typename KmerParser::value_type>::value>;
+
+	/// start the first pass of a solid build, with a filter of counters per rank.  COLLECTIVE
+	void solid_start(size_t counters, ::std::true_type) {
+		this->map.set_solid_filter(this->solid_threshold, ::std::max(counters, static_cast<size_t>(1024)));
+	}
+	void solid_start(size_t, ::std::false_type) {
+		throw std::invalid_argument("solid kmer build needs a counting map.");
+	}
+	/// (key, count) pairs of the raw kmers that the map's sketch combined.
+	using SketchCountsType = ::std::vector<::std::pair<typename MapType::key_type, typename MapType::mapped_type> >;
+	/// raw kmers are combined before sending.  on return, chunk holds the kmers this rank owns, and counts the combined ones.
+	template <typename T>
+	void map_sketch(std::vector<T> & chunk, SketchCountsType & counts, ::std::true_type) {
+		this->map.sketch(chunk, counts);
+	}
+	template <typename T>
+	void map_sketch(std::vector<T> & chunk, SketchCountsType &, ::std::false_type) {
+		this->map.sketch(chunk);
+	}
+	template <typename T>
+	void map_insert_sketched(std::vector<T> & chunk, SketchCountsType & counts, ::std::true_type) {
+		this->map.insert_sketched(chunk, counts);
+	}
+	template <typename T>
+	void map_insert_sketched(std::vector<T> & chunk, SketchCountsType &, ::std::false_type) {
+		this->map.insert_sketched(chunk);
+	}
+
+	/// first pass over 1 chunk:  count it into the filter.  COLLECTIVE
+	template <typename T>
+	void sketch_chunk(std::vector<T> & chunk, ::std::true_type) {
+		parsed_input_guard parsed(*this);
+		SketchCountsType counts;
+		this->map_sketch(chunk, counts, ::std::is_same<T, typename MapType::key_type>());
+	}
+	template <typename T>
+	void sketch_chunk(std::vector<T> &, ::std::false_type) {}
+	/// first pass over all of the input, then the second:  the sketch leaves each kmer on its owner, so it is inserted locally.  COLLECTIVE
+	template <typename T>
+	void sketch_insert_chunk(std::vector<T> & chunk, ::std::true_type) {
+		parsed_input_guard parsed(*this);
+		SketchCountsType counts;
+		this->map_sketch(chunk, counts, ::std::is_same<T, typename MapType::key_type>());
+		this->map_insert_sketched(chunk, counts, ::std::is_same<T, typename MapType::key_type>());
+	}
+	template <typename T>
+	void sketch_insert_chunk(std::vector<T> &, ::std::false_type) {}
+	/// erase the filter's false positives and free the filter.  COLLECTIVE
+	void solid_finish(::std::true_type) {
+		this->map.solid_finish();
+	}
+	void solid_finish(::std::false_type) {}
 
+	/**
+	 * @brief insert the whole parsed input.  a solid build counts all of it into the filter first, then inserts the
+	 *        solid kmers locally, since the sketch already sent each kmer to its owner.  a normal insert otherwise.
+	 * @note  COLLECTIVE.  temp is consumed.
+	 */
+	template <typename T>
+	void sketch_insert(std::vector<T> & temp) {
+		if (this->solid_threshold < 2) {
+			this->insert(temp);
+			return;
+		}
+
+		size_t counters = this->solid_counters;
+		if (counters == 0) counters = 4 * (::mxx::allreduce(temp.size(), this->comm) / this->comm.size());
+		this->solid_start(counters, solid_capable());
+		this->sketch_insert_chunk(temp, solid_capable());
+
+		auto result = this->map.get_multiplicity();
+		BLISS_UNUSED(result);
+	}
+	/// end a solid build.  no-op for a normal build.  COLLECTIVE
+	void solid_finish() {
+		if (this->solid_threshold < 2) return;
+		this->solid_finish(solid_capable());
+	}
+
+	/// canonical parser output does not need the map's InputTransform (lex_less) pass.  no-op for other parsers.
+	void set_parsed_input(bool parsed) {
+		this->set_parsed_input(parsed, ::bliss::index::kmer::is_canonical_parser<KmerParser>());
+	}
+	void set_parsed_input(bool parsed, ::std::true_type) {
+		this->map.set_input_pretransformed(parsed);
+	}
+	void set_parsed_input(bool, ::std::false_type) {}
+
+	/// marks the map's input as parser output for the guard's lifetime, so the flag is cleared even if the insert throws.
+	struct parsed_input_guard {
+		Index & index;
+		parsed_input_guard(Index & _index) : index(_index) { index.set_parsed_input(true); }
+		~parsed_input_guard() { index.set_parsed_input(false); }
+		parsed_input_guard(parsed_input_guard const &) = delete;
+		parsed_input_guard & operator=(parsed_input_guard const &) = delete;
+	};
+
+public:
 	/**
 	 * @tparam T 	input type may not be same as map's value types, so map need to provide overloads (and potentially with transform operators)
+	 * @note  temp is treated as output of KmerParser.  if the parser is canonical, the map's input transform is skipped.
 	 */
 	 template <typename T>
 	void insert(std::vector<T> &temp) {
@@ -208,7 +376,10 @@ public:
 
 		// distribute
 		BL_BENCH_START(insert);
-		this->map.insert(temp);  // COLLECTIVE CALL...
+		{
+			parsed_input_guard parsed(*this);
+			this->map.insert(temp);  // COLLECTIVE CALL...
+		}
 		BL_BENCH_END(insert, "map_insert", this->map.local_size());
 
 #if (BL_BENCHMARK == 1)
@@ -235,12 +406,12 @@ public:
 	 //	Output type of KmerParserType may not match Map value type, in which case the map needs to do its own transform.
 	 //     since Kmer template parameter is not explicitly known, we can't hard code the return types of KmerParserType.
 
-	 /// convenience function for building index.
+	 /// convenience function for building index.  chunk_bytes > 0 turns on streaming (bounded kmer memory) build, see build_chunked.  nthreads != 1 parses with OpenMP threads.
 	 template <template <typename> class SeqParser, template <typename, template <typename> class> class SeqIterType>
-	 void build_mpiio(const std::string & filename, MPI_Comm comm) {
+	 void build_mpiio(const std::string & filename, MPI_Comm comm, size_t const & chunk_bytes = 0, int const & nthreads = 1) {
 
 		 // file extension determines SeqParserType
-		 std::string extension = ::bliss::utils::file::get_file_extension(filename);
+		 std::string extension = ::bliss::utils::file::get_sequence_file_extension(filename);
 		 std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
 		 if ((extension.compare("fastq") != 0) && (extension.compare("fasta") != 0) && (extension.compare("fa") != 0)) {
 			 throw std::invalid_argument("input filename extension is not supported.");
@@ -252,12 +423,23 @@ public:
 		 } else if (((extension.compare("fasta") == 0) || (extension.compare("fa") == 0)) && (!std::is_same<SeqParser<char*>, ::bliss::io::FASTAParser<char*> >::value)) {
 			 throw std::invalid_argument("Specified File Parser template parameter does not support files with fasta extension.");
 		 }
+     // compressed input is read through the gzip reader.
+     if (::bliss::utils::file::is_gzip_file(filename)) {
+       this->template build_gzip<SeqParser, SeqIterType>(filename, comm, chunk_bytes, nthreads);
+       return;
+     }
+     // bounded kmer memory: generate and insert kmers a chunk at a time.
+     if (chunk_bytes > 0) {
+       this->template build_chunked<::bliss::io::parallel::mpiio_file<SeqParser >, SeqParser, SeqIterType>(filename, chunk_bytes, comm, nthreads);
+       return;
+     }
+
      BL_BENCH_INIT(build);
 
 		 // proceed
      BL_BENCH_START(build);
 		 ::std::vector<typename KmerParser::value_type> temp;
-		 bliss::io::KmerFileHelper::template read_file_mpiio<KmerParser, SeqParser, SeqIterType>(filename, temp, comm);
+		 bliss::io::KmerFileHelper::template read_file_mpiio<KmerParser, SeqParser, SeqIterType>(filename, temp, comm, nthreads);
      BL_BENCH_END(build, "read", temp.size());
 
 
@@ -270,22 +452,27 @@ public:
 		 //         }
 		 //         ofs.close();
 
+     // solid kmer build:  count first, then insert only the solid kmers.
      BL_BENCH_START(build);
-		 this->insert(temp);
+		 this->sketch_insert(temp);
      BL_BENCH_END(build, "insert", temp.size());
 
+     BL_BENCH_START(build);
+     this->solid_finish();
+     BL_BENCH_END(build, "solid_finish", this->map.local_size());
+
 
      BL_BENCH_REPORT_MPI_NAMED(build, "index:build_mpiio", this->comm);
 
 	 }
 
 
-	  /// convenience function for building index.
+	  /// convenience function for building index.  chunk_bytes > 0 turns on streaming (bounded kmer memory) build, see build_chunked.  nthreads != 1 parses with OpenMP threads.
 	   template <template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType>
-	   void build_mmap(const std::string & filename, MPI_Comm comm) {
+	   void build_mmap(const std::string & filename, MPI_Comm comm, size_t const & chunk_bytes = 0, int const & nthreads = 1) {
 
 	     // file extension determines SeqParserType
-	     std::string extension = ::bliss::utils::file::get_file_extension(filename);
+	     std::string extension = ::bliss::utils::file::get_sequence_file_extension(filename);
 	     std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
 	     if ((extension.compare("fastq") != 0) && (extension.compare("fasta") != 0) && (extension.compare("fa") != 0)) {
 	       throw std::invalid_argument("input filename extension is not supported.");
@@ -297,12 +484,23 @@ public:
 	     } else if (((extension.compare("fasta") == 0) || (extension.compare("fa") == 0)) && (!std::is_same<SeqParser<char*>, ::bliss::io::FASTAParser<char*> >::value)) {
 	       throw std::invalid_argument("Specified File Parser template parameter does not support files with fasta extension.");
 	     }
+	     // compressed input is read through the gzip reader.
+	     if (::bliss::utils::file::is_gzip_file(filename)) {
+	       this->template build_gzip<SeqParser, SeqIterType>(filename, comm, chunk_bytes, nthreads);
+	       return;
+	     }
+	     // bounded kmer memory: generate and insert kmers a chunk at a time.
+	     if (chunk_bytes > 0) {
+	       this->template build_chunked<::bliss::io::parallel::partitioned_file<::bliss::io::mmap_file, SeqParser >, SeqParser, SeqIterType>(filename, chunk_bytes, comm, nthreads);
+	       return;
+	     }
+
 	     BL_BENCH_INIT(build);
 
 	     // proceed
 	     BL_BENCH_START(build);
 	     ::std::vector<typename KmerParser::value_type> temp;
-	     bliss::io::KmerFileHelper::template read_file_mmap<KmerParser, SeqParser, SeqIterType>(filename, temp, comm);
+	     bliss::io::KmerFileHelper::template read_file_mmap<KmerParser, SeqParser, SeqIterType>(filename, temp, comm, nthreads);
 	      BL_BENCH_END(build, "read", temp.size());
 
 
@@ -315,10 +513,15 @@ public:
 	     //         }
 	     //         ofs.close();
 
+	     // solid kmer build:  count first, then insert only the solid kmers.
 	     BL_BENCH_START(build);
-	     this->insert(temp);
+	     this->sketch_insert(temp);
 	      BL_BENCH_END(build, "insert", temp.size());
 
+	     BL_BENCH_START(build);
+	     this->solid_finish();
+	     BL_BENCH_END(build, "solid_finish", this->map.local_size());
+
 
 	     BL_BENCH_REPORT_MPI_NAMED(build, "index:build_mmap", this->comm);
 
@@ -327,12 +530,12 @@ public:
 
 
 
-		 /// convenience function for building index.
+		 /// convenience function for building index.  chunk_bytes > 0 turns on streaming (bounded kmer memory) build, see build_chunked.  nthreads != 1 parses with OpenMP threads.
 		 template <template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType>
-		 void build_posix(const std::string & filename, MPI_Comm comm) {
+		 void build_posix(const std::string & filename, MPI_Comm comm, size_t const & chunk_bytes = 0, int const & nthreads = 1) {
 
 			 // file extension determines SeqParserType
-			 std::string extension = ::bliss::utils::file::get_file_extension(filename);
+			 std::string extension = ::bliss::utils::file::get_sequence_file_extension(filename);
 			 std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
 			 if ((extension.compare("fastq") != 0) && (extension.compare("fasta") != 0) && (extension.compare("fa") != 0)) {
 				 throw std::invalid_argument("input filename extension is not supported.");
@@ -344,12 +547,23 @@ public:
 			 } else if (((extension.compare("fasta") == 0) || (extension.compare("fa") == 0)) && (!std::is_same<SeqParser<char*>, ::bliss::io::FASTAParser<char*> >::value)) {
 				 throw std::invalid_argument("Specified File Parser template parameter does not support files with fasta extension.");
 			 }
+	     // compressed input is read through the gzip reader.
+	     if (::bliss::utils::file::is_gzip_file(filename)) {
+	       this->template build_gzip<SeqParser, SeqIterType>(filename, comm, chunk_bytes, nthreads);
+	       return;
+	     }
+	     // bounded kmer memory: generate and insert kmers a chunk at a time.
+	     if (chunk_bytes > 0) {
+	       this->template build_chunked<::bliss::io::parallel::partitioned_file<::bliss::io::posix_file, SeqParser >, SeqParser, SeqIterType>(filename, chunk_bytes, comm, nthreads);
+	       return;
+	     }
+
 	     BL_BENCH_INIT(build);
 
 			 // proceed
 	     BL_BENCH_START(build);
 			 ::std::vector<typename KmerParser::value_type> temp;
-			 bliss::io::KmerFileHelper::template read_file_posix<KmerParser, SeqParser, SeqIterType>(filename, temp, comm);
+			 bliss::io::KmerFileHelper::template read_file_posix<KmerParser, SeqParser, SeqIterType>(filename, temp, comm, nthreads);
 	     BL_BENCH_END(build, "read", temp.size());
 
 
@@ -362,17 +576,160 @@ public:
 			 //         }
 			 //         ofs.close();
 
+	     // solid kmer build:  count first, then insert only the solid kmers.
 	     BL_BENCH_START(build);
-			 this->insert(temp);
+			 this->sketch_insert(temp);
 	     BL_BENCH_END(build, "insert", temp.size());
 
+	     BL_BENCH_START(build);
+	     this->solid_finish();
+	     BL_BENCH_END(build, "solid_finish", this->map.local_size());
+
 
 	     BL_BENCH_REPORT_MPI_NAMED(build, "index:build_posix", this->comm);
 
 		 }
 
 
+	   /**
+	    * @brief convenience function for building index from a gzip or BGZF compressed file.
+	    * @details  BGZF files are split by block, so each rank decompresses only its own partition.
+	    *           plain gzip is supported but decompressed on rank 0 and scattered.  see gzip_file.
+	    *           chunk_bytes > 0 turns on streaming (bounded kmer memory) build, see build_chunked.  nthreads != 1 parses with OpenMP threads.
+	    */
+	   template <template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType>
+	   void build_gzip(const std::string & filename, MPI_Comm comm, size_t const & chunk_bytes = 0, int const & nthreads = 1) {
+#if defined(USE_ZLIB)
+	     // file extension determines SeqParserType
+	     std::string extension = ::bliss::utils::file::get_sequence_file_extension(filename);
+	     std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	     if ((extension.compare("fastq") != 0) && (extension.compare("fasta") != 0) && (extension.compare("fa") != 0)) {
+	       throw std::invalid_argument("input filename extension is not supported.");
+	     }
+
+	     // check to make sure that the file parser will work
+	     if ((extension.compare("fastq") == 0) && (!std::is_same<SeqParser<char*>, ::bliss::io::FASTQParser<char*> >::value)) {
+	       throw std::invalid_argument("Specified File Parser template parameter does not support files with fastq extension.");
+	     } else if (((extension.compare("fasta") == 0) || (extension.compare("fa") == 0)) && (!std::is_same<SeqParser<char*>, ::bliss::io::FASTAParser<char*> >::value)) {
+	       throw std::invalid_argument("Specified File Parser template parameter does not support files with fasta extension.");
+	     }
+	     // bounded kmer memory: generate and insert kmers a chunk at a time.
+	     if (chunk_bytes > 0) {
+	       this->template build_chunked<::bliss::io::parallel::partitioned_gzip_file<SeqParser >, SeqParser, SeqIterType>(filename, chunk_bytes, comm, nthreads);
+	       return;
+	     }
+
+	     BL_BENCH_INIT(build);
+
+	     BL_BENCH_START(build);
+	     ::std::vector<typename KmerParser::value_type> temp;
+	     bliss::io::KmerFileHelper::template read_file_gzip<KmerParser, SeqParser, SeqIterType>(filename, temp, comm, nthreads);
+	     BL_BENCH_END(build, "read", temp.size());
+
+	     // solid kmer build:  count first, then insert only the solid kmers.
+	     BL_BENCH_START(build);
+	     this->sketch_insert(temp);
+	     BL_BENCH_END(build, "insert", temp.size());
+
+	     BL_BENCH_START(build);
+	     this->solid_finish();
+	     BL_BENCH_END(build, "solid_finish", this->map.local_size());
+
+	     BL_BENCH_REPORT_MPI_NAMED(build, "index:build_gzip", this->comm);
+#else
+	     throw std::invalid_argument("gzip/BGZF compressed input requires building with USE_ZLIB.");
+#endif
+	   }
+
+
+
+
+
+protected:
+	 /// insert 1 chunk, pipelined.  COLLECTIVE
+	 template <typename T>
+	 void insert_chunk(std::vector<T> & chunk, ::std::true_type) {
+		 parsed_input_guard parsed(*this);
+		 this->map.insert_async(chunk);
+	 }
+	 /// insert 1 chunk, synchronous.  COLLECTIVE
+	 template <typename T>
+	 void insert_chunk(std::vector<T> & chunk, ::std::false_type) {
+		 parsed_input_guard parsed(*this);
+		 this->map.insert(chunk);
+	 }
+	 /// drain the pipeline.  COLLECTIVE
+	 void insert_chunks_finish(::std::true_type) {
+		 this->map.insert_flush();
+	 }
+	 void insert_chunks_finish(::std::false_type) {}
+
+public:
+	 /**
+	  * @brief  streaming build.  kmers are generated from the rank's partition and inserted into the map in chunks.
+	  * @details  peak transient kmer memory is bounded by chunk_bytes (plus the distribute buffers for 1 chunk) instead of
+	  *          the full kmer list of the partition.  FASTQ input is read in windows of about the same size; FASTA and
+	  *          compressed input load the rank's raw partition whole, see KmerFileHelper::read_file_chunked.
+	  *          every rank performs the same number of (collective) map inserts.
+	  *          if the map supports insert_async, communication of each chunk overlaps with parsing and local insertion.
+	  *          a solid kmer build (set_solid_build) reads the file twice.
+	  * @note   COLLECTIVE.  multiplicity is computed once at the end, not per chunk.
+	  * @param chunk_bytes  soft cap on bytes of parsed kmers (tuples) held per rank at any time.
+	  * @param nthreads     threads per rank for parsing each chunk, see KmerFileHelper::read_block_omp.
+	  */
+	 template <typename FileType, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType>
+	 void build_chunked(const std::string & filename, size_t const & chunk_bytes, MPI_Comm comm, int const & nthreads = 1) {
+		 BL_BENCH_INIT(build);
+
+		 // maps with insert_async get a pipelined insert: chunk i is in flight while chunk i-1 is inserted locally
+		 // and chunk i+1 is parsed.  others insert each chunk synchronously.
+		 using pipelined = ::std::integral_constant<bool, has_insert_async<MapType, typename KmerParser::value_type>::value>;
+
+		 // solid kmer build:  a first pass over the file counts the kmers, so the second inserts only the solid ones.
+		 if (this->solid_threshold > 1) {
+			 BL_BENCH_START(build);
+			 // size the filter from the file size the reader reports, i.e. decompressed bytes for gzip/BGZF input.
+			 auto starter = [this](::bliss::partition::range<size_t> const & file_range) {
+				 size_t counters = this->solid_counters;
+				 if (counters == 0) counters = 2 * file_range.size() / this->comm.size();
+				 this->solid_start(counters, solid_capable());  // COLLECTIVE CALL...
+			 };
+			 auto sketcher = [this](::std::vector<typename KmerParser::value_type> & chunk) {
+				 this->sketch_chunk(chunk, solid_capable());  // COLLECTIVE CALL...
+			 };
+			 auto sketched = bliss::io::KmerFileHelper::template read_file_chunked<FileType, KmerParser, SeqParser, SeqIterType>(filename, chunk_bytes, sketcher, starter, comm, nthreads);
+			 BL_BENCH_END(build, "read_sketch", sketched.second);
+			 BLISS_UNUSED(sketched);
+		 }
+
+		 BL_BENCH_START(build);
+		 auto inserter = [this](::std::vector<typename KmerParser::value_type> & chunk) {
+			 this->insert_chunk(chunk, pipelined());  // COLLECTIVE CALL...
+		 };
+		 auto read = bliss::io::KmerFileHelper::template read_file_chunked<FileType, KmerParser, SeqParser, SeqIterType>(filename, chunk_bytes, inserter, comm, nthreads);
+		 BL_BENCH_END(build, "read_insert", read.second);
+
+		 BL_BENCH_START(build);
+		 this->insert_chunks_finish(pipelined());
+		 BL_BENCH_END(build, "flush", this->map.local_size());
+
+		 BL_BENCH_START(build);
+		 this->solid_finish();
+		 BL_BENCH_END(build, "solid_finish", this->map.local_size());
 
+#if (BL_BENCHMARK == 1)
+		 BL_BENCH_START(build);
+		 size_t m = 0;  // here because sortmap needs it.
+		 m = this->map.get_multiplicity();
+		 BL_BENCH_END(build, "multiplicity", m);
+#else
+		 auto result = this->map.get_multiplicity();
+		 BLISS_UNUSED(result);
+		 BLISS_UNUSED(read);
+#endif
+
+		 BL_BENCH_REPORT_MPI_NAMED(build, "index:build_chunked", this->comm);
+	 }
 
    typename MapType::const_iterator cbegin() const
    {
@@ -410,6 +767,10 @@ using CountIndex = Index<MapType, KmerCountTupleParser<std::pair<typename MapTyp
 template <typename MapType>
 using CountIndex2 = Index<MapType, KmerParser<typename MapType::key_type> >;
 
+/// kmers are canonicalized during parsing.  MapType must use lex_less as InputTransform, e.g. CanonicalHashMapParams or CanonicalSortedMapParams.
+template <typename MapType>
+using CanonicalKmerIndex = Index<MapType, CanonicalKmerParser<typename MapType::key_type> >;
+
 // template aliases for hash to be used as distribution hash
 template <typename Key>
 using DistHashFarm = ::bliss::kmer::hash::farm<Key, true>;
@@ -560,6 +921,38 @@ using BimoleculeSortedMapParams = ::dsc::SortedMapParams<
 		    Less,
 		    ::std::equal_to
 		  >;
+
+
+/// sorted map params whose freeze() builds a 2^PrefixBits entry offset table on the top bits of the (canonical) kmer.
+template <typename Key, unsigned int PrefixBits = 16>
+using SingleStrandPrefixSortedMapParams = ::dsc::PrefixSortedMapParams<
+		Key,
+		::bliss::transform::identity,  // precanonalizer
+		   ::bliss::transform::identity,  // only one that makes sense given InputTransform
+		    ::std::less,
+		    ::std::equal_to,
+		    PrefixBits
+		  >;
+
+template <typename Key, unsigned int PrefixBits = 16>
+using CanonicalPrefixSortedMapParams = ::dsc::PrefixSortedMapParams<
+		Key,
+		::bliss::kmer::transform::lex_less,  // precanonalizer
+		 ::bliss::transform::identity,  // only one that makes sense given InputTransform
+		    ::std::less,
+		    ::std::equal_to,
+		    PrefixBits
+		  >;
+
+template <typename Key, unsigned int PrefixBits = 16>
+using BimoleculePrefixSortedMapParams = ::dsc::PrefixSortedMapParams<
+		Key,
+		::bliss::transform::identity,  // precanonalizer - only one that makes sense for bimole
+		 ::bliss::kmer::transform::lex_less,  // only one that makes sense for bimole
+		    ::std::less,
+		    ::std::equal_to,
+		    PrefixBits
+		  >;
 } /* namespace kmer */
 
 } /* namespace index */
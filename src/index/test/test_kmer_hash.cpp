@@ -107,6 +107,25 @@ class KmerHashTest : public ::testing::Test {
       EXPECT_TRUE(same);
 
     }
+
+    /// batch interface should give the same hash values as the per-kmer operator.  odd count to exercise the remainder.
+    template <template <typename, bool> class H, bool Prefix>
+    void hash_batch(std::string name) {
+      H<T, Prefix> op;
+
+      size_t count = this->iterations - 3;
+      std::vector<uint64_t> hashes(count);
+      op(this->kmers.data(), count, hashes.data());
+
+      size_t mismatches = 0;
+      for (size_t i = 0; i < count; ++i) {
+        if (hashes[i] != static_cast<uint64_t>(op(this->kmers[i]))) ++mismatches;
+      }
+      if (mismatches > 0)
+        BL_DEBUGF("ERROR: hash %s prefix %d batch size %d: %lu batch hashes differ from scalar", name.c_str(), Prefix, H<T, Prefix>::batch_size, mismatches);
+
+      EXPECT_EQ(0UL, mismatches);
+    }
 };
 
 template <typename T>
@@ -129,12 +148,22 @@ TYPED_TEST_P(KmerHashTest, hash)
 	this->template hash_vector<bliss::kmer::hash::farm    >(std::string("farm"));
 }
 
+TYPED_TEST_P(KmerHashTest, batch)
+{
+	this->template hash_batch<bliss::kmer::hash::cpp_std, false>(std::string("cpp_std"));
+	this->template hash_batch<bliss::kmer::hash::identity, false>(std::string("identity"));
+	this->template hash_batch<bliss::kmer::hash::murmur, false>(std::string("murmur"));
+	this->template hash_batch<bliss::kmer::hash::murmur, true >(std::string("murmur"));
+	this->template hash_batch<bliss::kmer::hash::farm, false>(std::string("farm"));
+	this->template hash_batch<bliss::kmer::hash::farm, true >(std::string("farm"));
+}
+
 
 
 
 
 
-REGISTER_TYPED_TEST_CASE_P(KmerHashTest, hash);
+REGISTER_TYPED_TEST_CASE_P(KmerHashTest, hash, batch);
 
 //////////////////// RUN the tests with different types.
 
@@ -40,6 +40,7 @@
 
 #include <string>
 #include <cstring>      // memcpy, strerror
+#include <algorithm>    // min, max
 
 #include <ios>          // ios_base::failure
 #include <iostream>     // ios_base::failure
@@ -48,6 +49,7 @@
 #include <fcntl.h>      // for open64 and close
 #include <sstream>      // stringstream
 #include <exception>    // std exception
+#include <memory>       // unique_ptr
 
 #if defined(USE_MPI)
 #include <mpi.h>
@@ -221,6 +223,54 @@ struct file_data {
 };
 
 
+/**
+ * @brief a window of file data, parsed in place.  same ranges and accessors as file_data, but does not own the data.
+ * @details the data is held by the reader that loaded it (see base_file::read_window), and stays valid until that reader
+ *          loads the next window.
+ */
+struct file_window {
+  using iterator = unsigned char const *;
+  using const_iterator = unsigned char const *;
+
+  // type of ranges
+  using range_type = ::bliss::partition::range<size_t>;
+
+  // range from which the data came
+  range_type parent_range_bytes;
+
+  // range in memory.  INCLUDES OVERLAP
+  range_type in_mem_range_bytes;
+
+  // valid range for this.  EXCLUDES OVERLAP
+  range_type valid_range_bytes;
+
+  // start of the in memory range
+  unsigned char const * data = nullptr;
+
+  /// beginning of the valid range
+  const_iterator cbegin() const {
+    return data + (valid_range_bytes.start - in_mem_range_bytes.start);
+  }
+  /// end of valid range
+  const_iterator cend() const {
+    return data + (valid_range_bytes.end - in_mem_range_bytes.start);
+  }
+
+  /// start of inmem range
+  const_iterator in_mem_cbegin() const {
+    return data;
+  }
+  /// end of in mem range
+  const_iterator in_mem_cend() const {
+    return data + in_mem_range_bytes.size();
+  }
+
+  range_type getRange() const {
+    return valid_range_bytes;
+  }
+};
+
+
 
 /**
  * mmapped data.  wrapper for moving it around.
@@ -245,8 +295,9 @@ class mapped_data {
      * @brief   map the specified portion of the file to memory.
      * @note    AGNOSTIC of overlaps
      * @param range_bytes    range specifying the portion of the file to map.
+     * @param willneed       request read ahead for the whole range.  windowed readers set to false and call advise per window.
      */
-    mapped_data(int const & _fd, range_type const & target) :
+    mapped_data(int const & _fd, range_type const & target, bool const & willneed = true) :
       data(nullptr), range_bytes(0, 0),
       page_size(sysconf(_SC_PAGE_SIZE))
     {
@@ -288,7 +339,7 @@ class mapped_data {
 
       // set the madvice info.  SEQUENTIAL vs RANDOM does not appear to make a difference in running time.
       int madv_result = madvise(data, range_bytes.size(),
-          MADV_SEQUENTIAL | MADV_WILLNEED);
+          willneed ? (MADV_SEQUENTIAL | MADV_WILLNEED) : MADV_SEQUENTIAL);
       if ( madv_result == -1 ) {
         std::stringstream ss;
         int myerr = errno;
@@ -359,6 +410,27 @@ class mapped_data {
       return page_size;
     }
 
+    /**
+     * @brief   give the kernel advice for a portion of the mapping, e.g. MADV_WILLNEED to read ahead, MADV_DONTNEED to release.
+     * @param offset    byte offset from start of mapping.  rounded down to page boundary.
+     * @param len       number of bytes.  clipped to the mapping.
+     */
+    void advise(size_t const & offset, size_t const & len, int const & advice) const {
+      if ((data == nullptr) || (offset >= range_bytes.size()) || (len == 0)) return;
+
+      size_t start = offset - (offset % page_size);
+      size_t end = ::std::min(offset + len, range_bytes.size());
+
+      int madv_result = madvise(data + start, end - start, advice);
+      if ( madv_result == -1 ) {
+        std::stringstream ss;
+        int myerr = errno;
+        ss << "ERROR in madvise: " << myerr << ": " << strerror(myerr);
+
+        throw ::bliss::utils::make_exception<bliss::io::IOException>(ss.str());
+      }
+    }
+
 
 };
 
@@ -383,6 +455,9 @@ protected:
 	/// size of file in bytes
 	range_type file_range_bytes;
 
+	/// buffer for read_window.  reused between windows.
+	typename ::bliss::io::file_data::container window_buffer;
+
 	/// virtual function for computing the size of a file.
 	size_t get_file_size() {
 
@@ -487,6 +562,21 @@ public:
 	 */
 	virtual range_type read_range(typename ::bliss::io::file_data::container & output, range_type const & range_bytes) = 0;
 
+	/**
+	 * @brief  load a window of the file for in place parsing, replacing the previously loaded window.  NOT collective.
+	 * @details  copies the range into a buffer owned by this object, via read_range.  readers that can hand out their
+	 *          data without a copy override this, e.g. windowed_mmap_file.
+	 * @note   parallel files override this to read the range on the calling rank only, without partitioning it.
+	 * @param range_bytes   range to load, in bytes.
+	 * @param data          set to the start of the loaded range.  valid until the next call.
+	 * @return  the loaded range.
+	 */
+	virtual range_type read_window(range_type const & range_bytes, unsigned char const * & data) {
+		range_type loaded = this->read_range(window_buffer, range_bytes);
+		data = window_buffer.data();
+		return loaded;
+	}
+
 
 	/// flag to indicate read
 	/// flag to indicate write
@@ -602,7 +692,7 @@ public:
 		}
 
 		// resize output's capacity
-		if (output.capacity() < target.size()) output.resize(target.size());
+		output.resize(target.size());  // no reallocation if a reused buffer has the capacity.
 
 		// copy the data into memory.  vector is contiguous, so this is okay.
 		memmove(output.data(), md_data + (target.start - mapped_range.start), target.size());
@@ -655,6 +745,129 @@ public:
 
 };
 
+/**
+ * @brief  memmapped file whose windows are parsed in place, with read ahead and release.
+ * @details  read_window maps the file once, from the first requested window to the end of the file, and returns a pointer
+ *          into the mapping, so nothing is copied.  the windows are expected in file order, e.g. from
+ *          KmerFileHelper::read_file_chunked.  each call advises MADV_WILLNEED for the next prefetch_windows windows
+ *          (at the size of the current one), so the kernel reads ahead of the parser, and MADV_DONTNEED for the pages
+ *          before the current window, which the parser is done with.  the mapped pages stay at about
+ *          (prefetch_windows + 1) windows.  the mapping is also posix_fadvise'd as sequential so the kernel read ahead
+ *          window is enlarged.
+ *
+ *          read_range is the same as mmap_file's, i.e. it copies the range.
+ */
+class windowed_mmap_file : public ::bliss::io::mmap_file {
+
+protected:
+  /// BASE type
+  using BASE = ::bliss::io::mmap_file;
+
+  /// number of windows to advise ahead of the current one.
+  size_t prefetch_windows;
+
+  /// mapping that read_window hands out pointers into.
+  ::std::unique_ptr<mapped_data> window_map;
+
+  /// offsets from the mapping start up to which MADV_WILLNEED and MADV_DONTNEED have been advised.
+  size_t advised;
+  size_t released;
+
+public:
+  /// default prefetch distance, in windows.
+  static constexpr size_t default_prefetch_windows = 4;
+
+  // this is needed to prevent overload name hiding.  see http://stackoverflow.com/questions/888235/overriding-a-bases-overloaded-function-in-c/888337#888337
+  using BASE::read_range;
+
+  /**
+   * @brief  map a window of the file for in place parsing, with read ahead of the following windows and release of
+   *          the preceding ones.  NOT collective.
+   * @details  remaps only if the window is not in the current mapping, e.g. if windows are requested out of order.
+   * @param range_bytes   range to load, in bytes.
+   * @param data          set to the start of the window in the mapping.  valid until the next call.
+   * @return  the loaded range.
+   */
+  virtual typename BASE::range_type read_window(typename BASE::range_type const & range_bytes, unsigned char const * & data) {
+    typename BASE::range_type target = BASE::range_type::intersect(range_bytes, this->file_range_bytes);
+
+    if (target.size() == 0) {
+      data = nullptr;
+      return target;
+    }
+
+    if (!window_map || !window_map->get_range().contains(target)) {
+      // map to the end of file, without read ahead for the whole range.
+      window_map.reset(new mapped_data(this->fd, typename BASE::range_type(target.start, this->file_range_bytes.end), false));
+      if (window_map->get_data() == nullptr) {
+        throw std::logic_error("ERROR: mapped data is null, but mapped range size is larger than 0");
+      }
+
+      // larger kernel read ahead.  advisory only, so ignore errors.
+      posix_fadvise64(this->fd, window_map->get_range().start, window_map->size(), POSIX_FADV_SEQUENTIAL);
+
+      advised = released = 0;
+    }
+
+    // offsets relative to mapping start.
+    size_t const first = target.start - window_map->get_range().start;
+    size_t const last = target.end - window_map->get_range().start;
+
+    // request this window, if not yet requested, and the next prefetch_windows.
+    size_t ahead = ::std::max(advised, first);
+    size_t ahead_end = last + prefetch_windows * target.size();
+    if (ahead_end > ahead) {
+      window_map->advise(ahead, ahead_end - ahead, MADV_WILLNEED);
+      advised = ahead_end;
+    }
+
+    // release the pages before this window.
+    size_t release_end = first - (first % window_map->get_page_size());
+    if (release_end > released) {
+      window_map->advise(released, release_end - released, MADV_DONTNEED);
+      released = release_end;
+    }
+
+    data = window_map->get_data() + first;
+    return target;
+  }
+
+  /// set the prefetch distance, in windows.
+  void set_prefetch(size_t const & _prefetch_windows) {
+    prefetch_windows = _prefetch_windows;
+  }
+
+  /**
+   * initializes a file for reading via windowed memmap.  see set_prefetch to change the prefetch distance.
+   * @param _filename   name of file to open
+   */
+  windowed_mmap_file(std::string const & _filename) :
+    BASE(_filename), prefetch_windows(default_prefetch_windows), advised(0), released(0) {};
+
+  /**
+   * initializes a file for reading via windowed memmap.  for use by parallel file (composition)
+   * @param _filename   name of file to open
+   * @param _file_size  previously determined file size.
+   */
+  windowed_mmap_file(std::string const & _filename, size_t const & _file_size, size_t const & delay_ms) :
+    BASE(_filename, _file_size, delay_ms), prefetch_windows(default_prefetch_windows), advised(0), released(0) {}
+
+  /**
+   * initializes a file for reading via windowed memmap.  for use by parallel file (composition)
+   * @param _fd         previously opened file descriptor
+   * @param _file_size  previously determined file size.
+   */
+  windowed_mmap_file(int const & _fd, size_t const & _file_size) :
+    BASE(_fd, _file_size), prefetch_windows(default_prefetch_windows), advised(0), released(0) {}
+
+  /// default destructor
+  virtual ~windowed_mmap_file() {};
+
+  // this is needed to prevent overload name hiding.  see http://stackoverflow.com/questions/888235/overriding-a-bases-overloaded-function-in-c/888337#888337
+  using BASE::read_file;
+
+};
+
 /**
  * @brief    file wrapper that uses c stdio calls.  has buffering.
  */
@@ -739,7 +952,7 @@ public:
 //		std::cout << "curr pos in fd is " << ftell(this->fp) << std::endl;
 
 		// resize output's capacity
-		if (output.capacity() < target.size()) output.resize(target.size());
+		output.resize(target.size());  // no reallocation if a reused buffer has the capacity.
 
 		size_t read = fread_unlocked(output.data(), 1, target.size(), fp);
 
@@ -847,7 +1060,7 @@ public:
     //std::cout << "curr pos in fd is " << lseek64(this->fd, 0, SEEK_CUR) << ::std::endl;
 
     // resize output's capacity
-    if (output.capacity() < target.size()) output.resize(target.size());
+    output.resize(target.size());  // no reallocation if a reused buffer has the capacity.
 
     size_t s = 0;
     long count;
@@ -952,6 +1165,10 @@ protected:
      comm(_comm.copy()) {  // _comm could be a temporary constructed from MPI_Comm.
   };
 
+  /// called by partitioned_file with its reader, for bases that serve the reader's reads, e.g. gzip_base_file.  no-op here.
+  template <typename FileReader>
+  void attach_reader(FileReader &) {}
+
 
 public:
 
@@ -1166,6 +1383,15 @@ public:
 		return target;
 	}
 
+	/**
+	 * @brief  load a window of the file for in place parsing, on this rank only.  NOT collective, and the range is not partitioned.
+	 * @param range_bytes	range to load, in bytes
+	 * @param data			set to the start of the loaded range.  valid until the next call.
+	 */
+	virtual typename BASE::range_type read_window(typename BASE::range_type const & range_bytes, unsigned char const * & data) {
+		return reader.read_window(range_bytes, data);
+	}
+
 	/**
 	 * @brief constructor
 	 * @param _filename 		name of file to open
@@ -1173,7 +1399,9 @@ public:
 	 */
 	partitioned_file(std::string const & _filename, size_t const & _overlap = 0UL, ::mxx::comm const & _comm = ::mxx::comm()) :
 		BaseType(_filename, _comm),
-		 reader(this->fd, this->file_range_bytes.end), overlap(_overlap) {};
+		 reader(this->fd, this->file_range_bytes.end), overlap(_overlap) {
+		this->attach_reader(reader);
+	};
 
 	/// destructor
 	virtual ~partitioned_file() {};  // will call super's unmap.
@@ -1317,6 +1545,15 @@ public:
 		return target;
 	}
 
+	/**
+	 * @brief  load a window of the file for in place parsing, on this rank only.  NOT collective, and the range is not partitioned.
+	 * @param range_bytes	range to load, in bytes
+	 * @param data			set to the start of the loaded range.  valid until the next call.
+	 */
+	virtual typename BASE::range_type read_window(typename BASE::range_type const & range_bytes, unsigned char const * & data) {
+		return reader.read_window(range_bytes, data);
+	}
+
 	/**
 	 * @brief constructor
 	 * @param _filename 		name of file to open
@@ -1324,7 +1561,9 @@ public:
 	 */
 	partitioned_file(std::string const & _filename, size_t const & _overlap = 0UL, ::mxx::comm const & _comm = ::mxx::comm()) :
 		BaseType(_filename, _comm),
-		 reader(this->fd, this->file_range_bytes.end), overlap(0UL) {};
+		 reader(this->fd, this->file_range_bytes.end), overlap(0UL) {
+		this->attach_reader(reader);
+	};
 
 	/// destructor
 	virtual ~partitioned_file() {};  // will call super's unmap.
@@ -1539,6 +1778,15 @@ public:
 		return target;
 	}
 
+	/**
+	 * @brief  load a window of the file for in place parsing, on this rank only.  NOT collective, and the range is not partitioned.
+	 * @param range_bytes	range to load, in bytes
+	 * @param data			set to the start of the loaded range.  valid until the next call.
+	 */
+	virtual typename BASE::range_type read_window(typename BASE::range_type const & range_bytes, unsigned char const * & data) {
+		return reader.read_window(range_bytes, data);
+	}
+
 	/**
 	 * @brief constructor
 	 * @param _filename 		name of file to open
@@ -1546,7 +1794,9 @@ public:
 	 */
 	partitioned_file(std::string const & _filename, size_t const & _overlap = 0UL, ::mxx::comm const & _comm = ::mxx::comm()) :
 		BaseType(_filename, _comm),
-		 reader(this->fd, this->file_range_bytes.end), overlap(_overlap) {};
+		 reader(this->fd, this->file_range_bytes.end), overlap(_overlap) {
+		this->attach_reader(reader);
+	};
 
 	/// destructor
 	virtual ~partitioned_file() {};  // will call super's unmap.
@@ -1908,6 +2158,57 @@ public:
 		return target;
 	}
 
+	/**
+	 * @brief  load a window of the file for in place parsing, on this rank only.  NOT collective, and the range is not partitioned.
+	 * @note   independent reads (MPI_File_read_at), since ranks load different numbers of windows.
+	 * @param range_bytes	range to load, in bytes
+	 * @param data			set to the start of the loaded range.  valid until the next call.
+	 */
+	virtual range_type read_window(range_type const & range_bytes, unsigned char const * & data) {
+
+		if (fh == MPI_FILE_NULL) {
+			std::stringstream ss;
+			ss << "ERROR in mpiio: rank " << comm.rank() << " file " << this->filename << " not yet open " << std::endl;
+
+			throw ::bliss::utils::make_exception<::bliss::io::IOException>(ss.str());
+		}
+
+		range_type target =
+				BASE::range_type::intersect(range_bytes, this->file_range_bytes);
+
+		this->window_buffer.resize(target.size());
+		data = this->window_buffer.data();
+
+		// number of elements has type int, so read in 1GB steps, as in read_range.
+		size_t step_size = 1UL << 30;
+		size_t iter_step_size;
+		MPI_Status stat;
+		int count = 0;
+		int res = MPI_SUCCESS;
+
+		for (size_t offset = 0; offset < target.size(); offset += iter_step_size) {
+			iter_step_size = ::std::min(step_size, target.size() - offset);
+
+			res = MPI_File_read_at(fh, target.start + offset, this->window_buffer.data() + offset,
+			                       iter_step_size, MPI_BYTE, &stat);
+			if (res != MPI_SUCCESS)
+			  throw ::bliss::utils::make_exception<::bliss::io::IOException>(get_error_string("read", res, stat));
+
+			res = MPI_Get_count(&stat, MPI_BYTE, &count);
+			if (res != MPI_SUCCESS)
+			  throw ::bliss::utils::make_exception<::bliss::io::IOException>(get_error_string("read count", res, stat));
+
+			if (static_cast<size_t>(count) != iter_step_size) {
+				std::stringstream ss;
+				ss << "ERROR in mpiio: rank " << comm.rank() << " window read error. request " << iter_step_size << " bytes got " << count << " bytes" << std::endl;
+
+				throw ::bliss::utils::make_exception<::bliss::io::IOException>(ss.str());
+			}
+		}
+
+		return target;
+	}
+
 
 	mpiio_base_file(::std::string const & _filename, size_t const _overlap = 0UL,  ::mxx::comm const & _comm = ::mxx::comm()) :
 	  BASE(static_cast<int>(-1), static_cast<size_t>(0)),
@@ -0,0 +1,806 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    gzip_file.hpp
+ * @ingroup io
+ * @author  tpan
+ * @brief   readers for gzip and BGZF compressed sequence files.  all ranges are in decompressed bytes.
+ * @details BGZF (bgzip, samtools, htslib) is a series of gzip members, each holding at most 64KB of decompressed data.
+ *          the compressed size of each member is in its "BC" extra field and the decompressed size in its ISIZE trailer,
+ *          so the blocks are indexed by hopping over the headers without inflating anything.  a decompressed range is then read
+ *          by inflating only the blocks that overlap it, in parallel with OpenMP if enabled.  a partitioned_file over
+ *          gzip_file therefore splits the file by blocks and every rank decompresses only its own partition.
+ *
+ *          plain gzip has no block structure, and its decompressed size is only known after inflating the whole file.  the
+ *          data from that size pass is kept and handed to the first read.  in parallel, only rank 0 decompresses.  if the
+ *          decompressed file is at most gzip_base_file::max_cached_bytes, rank 0 keeps the size pass data and sends each
+ *          rank its partition, so the file is inflated once.  a larger file is inflated again at the read, and each
+ *          decompressed piece goes to the ranks whose partitions overlap it, so rank 0 holds only its own partition.
+ *          either way the decompression is serial:  recompress with bgzip for parallel reads.
+ *
+ *          the decompressed data goes through the same partitioned_file FASTQ/FASTA record boundary search as the
+ *          uncompressed readers.
+ */
+#ifndef GZIP_FILE_HPP_
+#define GZIP_FILE_HPP_
+
+#include "bliss-config.hpp"
+
+#if defined(USE_ZLIB)
+
+#include <zlib.h>
+
+#include <vector>
+#include <string>
+#include <limits>
+#include <sstream>
+#include <algorithm>  // upper_bound, lower_bound
+#include <cstring>    // memcpy
+#include <functional>  // function
+#include <climits>   // INT_MAX
+#include <exception>  // exception_ptr
+#include <stdexcept>  // invalid_argument
+#include <utility>    // move
+
+#include <sys/stat.h>  // fstat64
+#include <unistd.h>    // pread64
+
+#if defined(USE_OPENMP)
+#include <omp.h>
+#endif
+
+#include "io/io_exception.hpp"
+#include "io/file.hpp"
+#include "utils/exception_handling.hpp"
+
+
+namespace bliss {
+namespace io {
+
+/**
+ * @brief  gzip/BGZF compressed file.  file_range_bytes and read_range are in decompressed bytes.
+ * @note   the (fd, size) and (filename, size, delay) constructors expect the DECOMPRESSED size,
+ *          as computed by get_uncompressed_size, e.g. by parallel::gzip_base_file.
+ */
+class gzip_file : public ::bliss::io::base_file {
+
+protected:
+
+  using BASE = ::bliss::io::base_file;
+
+  /// maximum decompressed (and compressed) size of a BGZF block.
+  static constexpr size_t bgzf_max_block_bytes = 65536UL;
+
+  /// size of the input buffer for streaming inflate
+  static constexpr size_t stream_buffer_bytes = 1UL << 20;
+
+  /// compressed size of the file.
+  size_t compressed_bytes;
+
+  /// true once the blocks are indexed, or the index is set.  the parallel constructors index on first use, so a
+  /// parallel base can hand over its index instead.  see set_block_index
+  mutable bool indexed;
+
+  /// true if the file is BGZF.
+  mutable bool blocked;
+
+  /// compressed start offset of each BGZF block.  last entry is the compressed file size
+  mutable ::std::vector<size_t> block_coffsets;
+
+  /// decompressed start offset of each BGZF block.  last entry is the decompressed file size
+  mutable ::std::vector<size_t> block_uoffsets;
+
+  /// plain gzip:  decompressed file from the size pass, handed to the first read of the whole file, or copied from.
+  ::std::vector<unsigned char> inflated;
+
+  /// plain gzip:  if set, reads ranges in place of inflating the file, e.g. by receiving them from the rank that inflated it.
+  ::std::function<void(::bliss::io::file_data::container &, range_type const &)> stream_source;
+
+
+  /// pread until len bytes are read or end of file is reached.  returns number of bytes read, or -1 on error
+  static long pread_fully(int const & fd, unsigned char * buf, size_t const & len, size_t const & offset) {
+    size_t s = 0;
+    long count;
+    while (s < len) {
+      count = pread64(fd, buf + s, ::std::min(1UL << 30, len - s), static_cast<__off64_t>(offset + s));
+      if (count < 0) return -1;
+      if (count == 0) break;
+      s += count;
+    }
+    return s;
+  }
+
+  /// throw an IOException for the last errno.
+  static void throw_io_error(::std::string const & where) {
+    ::std::stringstream ss;
+    int myerr = errno;
+    ss << "ERROR: gzip_file " << where << " error " << myerr << ": " << strerror(myerr);
+    throw ::bliss::utils::make_exception<::bliss::io::IOException>(ss.str());
+  }
+
+  /// get compressed size of an open file
+  static size_t get_compressed_size(int const & fd) {
+    struct stat64 filestat;
+    if (fstat64(fd, &filestat) < 0) throw_io_error("fstat64");
+    return static_cast<size_t>(filestat.st_size);
+  }
+
+  /**
+   * @brief parse the gzip header at offset and look for the BGZF "BC" subfield.
+   * @param[out] header_bytes   size of the gzip header, including the extra field.
+   * @return  compressed size of the block (BSIZE + 1), or 0 if this is not a BGZF block.
+   */
+  static size_t read_bgzf_header(int const & fd, size_t const & offset, size_t const & file_bytes, size_t & header_bytes) {
+    // fixed header is 12 bytes, then XLEN bytes of extra field.  bgzip writes XLEN = 6.
+    unsigned char buf[12 + 256];
+    long count = pread_fully(fd, buf, 12 + 6, offset);
+    if (count < 0) throw_io_error("pread64");
+    if (count < 18) return 0;
+
+    // magic, deflate, FEXTRA
+    if ((buf[0] != 0x1f) || (buf[1] != 0x8b) || (buf[2] != 8) || ((buf[3] & 4) == 0)) return 0;
+
+    size_t xlen = buf[10] | (static_cast<size_t>(buf[11]) << 8);
+    if (xlen > 256) return 0;
+    if (xlen > 6) {
+      count = pread_fully(fd, buf + 18, xlen - 6, offset + 18);
+      if (count < static_cast<long>(xlen - 6)) return 0;
+    }
+    header_bytes = 12 + xlen;
+
+    // walk the subfields
+    size_t bsize = 0;
+    for (size_t i = 12; i + 4 <= header_bytes; ) {
+      size_t slen = buf[i + 2] | (static_cast<size_t>(buf[i + 3]) << 8);
+      if ((buf[i] == 'B') && (buf[i + 1] == 'C') && (slen == 2) && (i + 6 <= header_bytes)) {
+        bsize = (buf[i + 4] | (static_cast<size_t>(buf[i + 5]) << 8)) + 1;
+        break;
+      }
+      i += 4 + slen;
+    }
+
+    // block must hold the header and the 8 byte trailer, and be inside the file.
+    if ((bsize < header_bytes + 8) || (offset + bsize > file_bytes)) return 0;
+    return bsize;
+  }
+
+  /**
+   * @brief index the BGZF blocks by hopping over the block headers.  reads about 24 bytes per 64KB block.
+   * @return false if the file is not BGZF, in which case the offsets are cleared.
+   */
+  static bool index_blocks(int const & fd, size_t const & file_bytes,
+                           ::std::vector<size_t> & coffsets, ::std::vector<size_t> & uoffsets) {
+    coffsets.clear();
+    uoffsets.clear();
+
+    size_t coffset = 0, uoffset = 0, bsize, header_bytes = 0;
+    unsigned char isize[4];
+    while (coffset < file_bytes) {
+      bsize = read_bgzf_header(fd, coffset, file_bytes, header_bytes);
+      if (bsize == 0) {
+        coffsets.clear();
+        uoffsets.clear();
+        return false;
+      }
+
+      if (pread_fully(fd, isize, 4, coffset + bsize - 4) < 4) throw_io_error("pread64");
+
+      coffsets.emplace_back(coffset);
+      uoffsets.emplace_back(uoffset);
+
+      coffset += bsize;
+      uoffset += isize[0] | (static_cast<size_t>(isize[1]) << 8) |
+          (static_cast<size_t>(isize[2]) << 16) | (static_cast<size_t>(isize[3]) << 24);
+    }
+    // sentinels
+    coffsets.emplace_back(coffset);
+    uoffsets.emplace_back(uoffset);
+
+    return coffsets.size() > 1;
+  }
+
+  /**
+   * @brief inflate a (possibly multi-member) gzip stream from the start of the file, passing each decompressed piece to sink.
+   * @param sink      called as sink(data, produced), with produced the piece's range in decompressed bytes.
+   * @return  number of decompressed bytes seen.  stops at end.
+   */
+  template <typename Sink>
+  static size_t inflate_stream(int const & fd, size_t const & file_bytes, size_t const & end, Sink && sink) {
+    const size_t buf_bytes = stream_buffer_bytes;  // local copy, std::min takes references.
+    ::std::vector<unsigned char> in(buf_bytes);
+    ::std::vector<unsigned char> out(buf_bytes);
+
+    z_stream strm;
+    memset(&strm, 0, sizeof(z_stream));
+    if (inflateInit2(&strm, 15 + 16) != Z_OK) {
+      throw ::bliss::utils::make_exception<::bliss::io::IOException>("ERROR: gzip_file inflateInit2 failed");
+    }
+
+    size_t coffset = 0;   // compressed bytes consumed
+    size_t uoffset = 0;   // decompressed bytes produced
+    int ret = Z_OK;
+    long count;
+
+    while (uoffset < end) {
+      // refill input
+      if (strm.avail_in == 0) {
+        if (coffset >= file_bytes) break;
+        count = pread_fully(fd, in.data(), ::std::min(buf_bytes, file_bytes - coffset), coffset);
+        if (count < 0) {
+          inflateEnd(&strm);
+          throw_io_error("pread64");
+        }
+        if (count == 0) break;
+        coffset += count;
+        strm.next_in = in.data();
+        strm.avail_in = count;
+      }
+
+      strm.next_out = out.data();
+      strm.avail_out = buf_bytes;
+      ret = inflate(&strm, Z_NO_FLUSH);
+      if ((ret != Z_OK) && (ret != Z_STREAM_END) && (ret != Z_BUF_ERROR)) {
+        inflateEnd(&strm);
+        ::std::stringstream ss;
+        ss << "ERROR: gzip_file inflate failed at decompressed offset " << uoffset << ": " << (strm.msg ? strm.msg : "");
+        throw ::bliss::utils::make_exception<::bliss::io::IOException>(ss.str());
+      }
+
+      range_type produced(uoffset, uoffset + (buf_bytes - strm.avail_out));
+      if (produced.size() > 0) sink(out.data(), produced);
+      uoffset = produced.end;
+
+      if (ret == Z_STREAM_END) {
+        // next member, if any.  anything other than a gzip header after a member is treated as trailing garbage.
+        if ((strm.avail_in < 2) && (coffset < file_bytes)) {
+          size_t rem = strm.avail_in;
+          if (rem > 0) in[0] = strm.next_in[0];
+          count = pread_fully(fd, in.data() + rem, ::std::min(buf_bytes - rem, file_bytes - coffset), coffset);
+          if (count < 0) {
+            inflateEnd(&strm);
+            throw_io_error("pread64");
+          }
+          coffset += count;
+          strm.next_in = in.data();
+          strm.avail_in = rem + count;
+        }
+        if ((strm.avail_in < 2) || (strm.next_in[0] != 0x1f) || (strm.next_in[1] != 0x8b)) break;
+        inflateReset(&strm);
+      } else if ((ret == Z_BUF_ERROR) && (strm.avail_in > 0)) {
+        // no progress with input available:  corrupt stream.
+        inflateEnd(&strm);
+        throw ::bliss::utils::make_exception<::bliss::io::IOException>("ERROR: gzip_file inflate made no progress");
+      }
+    }
+    inflateEnd(&strm);
+
+    return ::std::min(uoffset, end);
+  }
+
+  /**
+   * @brief inflate from the start of the file, copying the decompressed bytes in range into output.
+   * @return  number of decompressed bytes seen.  stops at range.end.
+   */
+  static size_t inflate_range(int const & fd, size_t const & file_bytes,
+                              range_type const & range, unsigned char * output) {
+    return inflate_stream(fd, file_bytes, range.end,
+                          [&range, output](unsigned char const * data, range_type const & produced) {
+      range_type target = range_type::intersect(produced, range);
+      if (target.size() > 0)
+        memcpy(output + (target.start - range.start), data + (target.start - produced.start), target.size());
+    });
+  }
+
+  /**
+   * @brief inflate BGZF block i into out, which must have room for the decompressed block.
+   * @note  does not throw, so it can be called inside an OpenMP region.
+   * @return Z_OK on success, Z_ERRNO on read error, Z_DATA_ERROR if the block is corrupt.
+   */
+  int inflate_block(size_t const & i, unsigned char * cbuf, unsigned char * out, z_stream & strm) const {
+    size_t bsize = block_coffsets[i + 1] - block_coffsets[i];
+    size_t usize = block_uoffsets[i + 1] - block_uoffsets[i];
+
+    if (pread_fully(this->fd, cbuf, bsize, block_coffsets[i]) < static_cast<long>(bsize)) return Z_ERRNO;
+
+    // header size from XLEN.  raw deflate data is between the header and the 8 byte trailer.
+    size_t header_bytes = 12 + (cbuf[10] | (static_cast<size_t>(cbuf[11]) << 8));
+
+    if (inflateReset(&strm) != Z_OK) return Z_STREAM_ERROR;
+    strm.next_in = cbuf + header_bytes;
+    strm.avail_in = bsize - header_bytes - 8;
+    strm.next_out = out;
+    strm.avail_out = usize;
+    int ret = inflate(&strm, Z_FINISH);
+    if ((ret != Z_STREAM_END) || (strm.avail_out != 0)) return Z_DATA_ERROR;
+
+    // check crc
+    uint32_t crc = cbuf[bsize - 8] | (static_cast<uint32_t>(cbuf[bsize - 7]) << 8) |
+        (static_cast<uint32_t>(cbuf[bsize - 6]) << 16) | (static_cast<uint32_t>(cbuf[bsize - 5]) << 24);
+    if (crc32(crc32(0L, Z_NULL, 0), out, usize) != crc) return Z_DATA_ERROR;
+
+    return Z_OK;
+  }
+
+  /// index the file, if not yet indexed.
+  void init_index() const {
+    if (indexed) return;
+    blocked = index_blocks(this->fd, compressed_bytes, block_coffsets, block_uoffsets);
+    indexed = true;
+  }
+
+public:
+
+  // this is needed to prevent overload name hiding.  see http://stackoverflow.com/questions/888235/overriding-a-bases-overloaded-function-in-c/888337#888337
+  using BASE::read_range;
+
+  /**
+   * @brief get decompressed size of an open gzip or BGZF file.  for plain gzip this decompresses the whole file.
+   * @param output    if not nullptr, receives the decompressed plain gzip file, so it does not need to be inflated again.
+   *                  left empty for BGZF, and for plain gzip larger than max_output_bytes.
+   * @param max_output_bytes  largest decompressed file kept in output.  a larger one is dropped as soon as it exceeds this.
+   * @param coffsets  if not nullptr, receives the compressed BGZF block offsets, for set_block_index.  empty for plain gzip.
+   * @param uoffsets  if not nullptr, receives the decompressed BGZF block offsets, for set_block_index.  empty for plain gzip.
+   */
+  static size_t get_uncompressed_size(int const & fd, ::bliss::io::file_data::container * output = nullptr,
+                                      size_t const & max_output_bytes = ::std::numeric_limits<size_t>::max(),
+                                      ::std::vector<size_t> * coffsets = nullptr, ::std::vector<size_t> * uoffsets = nullptr) {
+    size_t cbytes = get_compressed_size(fd);
+    ::std::vector<size_t> cof, uof;
+    if (output != nullptr) output->clear();
+    bool is_bgzf = index_blocks(fd, cbytes, cof, uof);
+    size_t ubytes = is_bgzf ? uof.back() : 0;
+    if (coffsets != nullptr) coffsets->swap(cof);
+    if (uoffsets != nullptr) uoffsets->swap(uof);
+    if (is_bgzf) return ubytes;
+
+    bool keep = (output != nullptr);
+    return inflate_stream(fd, cbytes, ::std::numeric_limits<size_t>::max(),
+                          [&keep, output, &max_output_bytes](unsigned char const * data, range_type const & produced) {
+      if (!keep) return;
+      if (produced.end > max_output_bytes) {
+        keep = false;
+        ::bliss::io::file_data::container().swap(*output);
+        return;
+      }
+      output->insert(output->end(), data, data + produced.size());
+    });
+  }
+
+  /**
+   * @brief decompress a plain gzip file from the start up to end, passing each decompressed piece to sink.
+   * @details sink is called as sink(data, produced), with produced the piece's range in decompressed bytes.
+   *          pieces arrive in order and are at most stream_buffer_bytes, so nothing else is held in memory.
+   * @return  number of decompressed bytes, less than end if the file is shorter.
+   */
+  template <typename Sink>
+  static size_t inflate_pieces(int const & fd, size_t const & end, Sink && sink) {
+    return inflate_stream(fd, get_compressed_size(fd), end, ::std::forward<Sink>(sink));
+  }
+
+  /**
+   * @brief decompress a plain gzip file from the start up to end, replacing the content of output.
+   * @return  number of decompressed bytes, less than end if the file is shorter.
+   */
+  static size_t inflate_prefix(int const & fd, size_t const & end, ::bliss::io::file_data::container & output) {
+    output.clear();
+    return inflate_stream(fd, get_compressed_size(fd), end,
+                          [&output](unsigned char const * data, range_type const & produced) {
+      output.insert(output.end(), data, data + produced.size());
+    });
+  }
+
+  /**
+   * @brief  decompress a range of the file.
+   * @param range_bytes range to read, in decompressed bytes
+   * @param output    vector containing data as bytes.
+   * @return  the range for the read data.
+   */
+  virtual range_type read_range(typename ::bliss::io::file_data::container & output, range_type const & range_bytes) {
+    if (this->fd == -1) {
+      throw ::bliss::utils::make_exception<std::logic_error>("ERROR: read_range: file pointer is null");
+    }
+
+    typename BASE::range_type target =
+        BASE::range_type::intersect(this->file_range_bytes, range_bytes);
+
+    init_index();
+    if (!blocked) {
+      // a stream source may be collective, so it is called even for an empty range.
+      if (stream_source) {
+        stream_source(output, target);
+        return target;
+      }
+      if (target.size() == 0) {
+        output.clear();
+        return target;
+      }
+
+      // reuse the size pass.  the whole file is handed over, so the cache is released.
+      if (target.end <= inflated.size()) {
+        if ((target.start == 0) && (target.end == inflated.size())) {
+          output.swap(inflated);
+          ::std::vector<unsigned char>().swap(inflated);
+        } else {
+          output.assign(inflated.begin() + target.start, inflated.begin() + target.end);
+        }
+        return target;
+      }
+
+      output.resize(target.size());
+      size_t s = inflate_range(this->fd, compressed_bytes, target, output.data());
+      if (s != target.end) {
+        ::std::stringstream ss;
+        ss << "ERROR: gzip_file " << this->filename << " decompressed " << s << " less than range end " << target.end;
+        throw ::bliss::utils::make_exception<bliss::io::IOException>(ss.str());
+      }
+      return target;
+    }
+
+    if (target.size() == 0) {
+      output.clear();
+      return target;
+    }
+
+    output.resize(target.size());
+
+    // blocks overlapping target.  empty blocks (e.g. the EOF marker) share their uoffset with the next block.
+    size_t first = ::std::distance(block_uoffsets.begin(),
+                                   ::std::upper_bound(block_uoffsets.begin(), block_uoffsets.end(), target.start)) - 1;
+    size_t last = ::std::distance(block_uoffsets.begin(),
+                                  ::std::lower_bound(block_uoffsets.begin(), block_uoffsets.end(), target.end));
+
+    int err = Z_OK;
+
+#if defined(USE_OPENMP)
+#pragma omp parallel if (last - first > 1)
+#endif
+    {
+      ::std::vector<unsigned char> cbuf(bgzf_max_block_bytes);
+      ::std::vector<unsigned char> ubuf(bgzf_max_block_bytes);
+
+      z_stream strm;
+      memset(&strm, 0, sizeof(z_stream));
+      int ret = inflateInit2(&strm, -15);
+
+#if defined(USE_OPENMP)
+#pragma omp for schedule(dynamic)
+#endif
+      for (size_t i = first; i < last; ++i) {
+        if (ret != Z_OK) continue;
+
+        range_type block(block_uoffsets[i], block_uoffsets[i + 1]);
+        range_type part = range_type::intersect(block, target);
+        if (part.size() == 0) continue;
+
+        if (part.size() == block.size()) {
+          // whole block, inflate in place.
+          ret = inflate_block(i, cbuf.data(), output.data() + (block.start - target.start), strm);
+        } else {
+          ret = inflate_block(i, cbuf.data(), ubuf.data(), strm);
+          if (ret == Z_OK) memcpy(output.data() + (part.start - target.start), ubuf.data() + (part.start - block.start), part.size());
+        }
+      }
+      inflateEnd(&strm);
+
+      if (ret != Z_OK) {
+#if defined(USE_OPENMP)
+#pragma omp critical
+#endif
+        err = ret;
+      }
+    }
+
+    if (err == Z_ERRNO) {
+      throw_io_error("pread64");
+    } else if (err != Z_OK) {
+      ::std::stringstream ss;
+      ss << "ERROR: gzip_file " << this->filename << " corrupt BGZF block in range " << target << ". zlib error " << err;
+      throw ::bliss::utils::make_exception<bliss::io::IOException>(ss.str());
+    }
+
+    return target;
+  }
+
+  /**
+   * initializes a file for reading.  indexes the BGZF blocks, or decompresses the whole of a plain gzip file to get its size.
+   *  the decompressed plain gzip data is kept for the first read.
+   * @param _filename   name of file to open
+   */
+  gzip_file(std::string const & _filename) : ::bliss::io::base_file(_filename),
+    compressed_bytes(get_compressed_size(this->fd)), indexed(false), blocked(false) {
+    init_index();
+    this->file_range_bytes.end = blocked ? block_uoffsets.back() :
+        inflate_prefix(this->fd, ::std::numeric_limits<size_t>::max(), inflated);
+  };
+
+  /**
+   * initializes a file for reading.  for use by a parallel file (composition pattern)
+   * @details  the blocks are indexed at the first read, unless set_block_index supplies the index first.
+   * @param _filename   name of file to open
+   * @param _file_size  previously computed decompressed file size.
+   */
+  gzip_file(std::string const & _filename, size_t const & _file_size, size_t const & delay_ms) :
+    ::bliss::io::base_file(_filename, _file_size, delay_ms),
+    compressed_bytes(get_compressed_size(this->fd)), indexed(false), blocked(false) {
+  };
+
+  /**
+   * initializes a file for reading.  for use by a parallel file (composition pattern)
+   * @details  the blocks are indexed at the first read, unless set_block_index supplies the index first.
+   * @param _fd   previously opened file descriptor
+   * @param _file_size  previously computed decompressed file size.
+   */
+  gzip_file(int const & _fd, size_t const & _file_size) :
+    ::bliss::io::base_file(_fd, _file_size),
+    compressed_bytes(get_compressed_size(this->fd)), indexed(false), blocked(false) {
+  };
+
+  /// destructor
+  virtual ~gzip_file() {};
+
+  /// true if the file is BGZF, i.e. ranges are read by decompressing only the overlapping blocks.
+  bool is_blocked() const {
+    init_index();
+    return blocked;
+  }
+
+  /// number of BGZF blocks.  0 for plain gzip.
+  size_t num_blocks() const {
+    init_index();
+    return blocked ? block_coffsets.size() - 1 : 0;
+  }
+
+  /**
+   * @brief  use a block index from get_uncompressed_size instead of indexing the file again.
+   * @details  e.g. the index rank 0 built while computing the size, broadcast by parallel::gzip_base_file.
+   *           empty offsets mean plain gzip.
+   */
+  void set_block_index(::std::vector<size_t> coffsets, ::std::vector<size_t> uoffsets) {
+    if (coffsets.size() != uoffsets.size())
+      throw ::std::invalid_argument("ERROR: gzip_file: block index offsets have different lengths.");
+    blocked = (coffsets.size() > 1);
+    block_coffsets.swap(coffsets);
+    block_uoffsets.swap(uoffsets);
+    if (!blocked) {
+      block_coffsets.clear();
+      block_uoffsets.clear();
+    }
+    indexed = true;
+  }
+
+  /// compressed size of the file.
+  size_t compressed_size() const { return compressed_bytes; }
+
+  /// plain gzip:  read ranges with source(output, range) instead of inflating the file.  source may be collective.
+  void set_stream_source(::std::function<void(::bliss::io::file_data::container &, range_type const &)> const & source) {
+    stream_source = source;
+  }
+
+  // this is needed to prevent overload name hiding.  see http://stackoverflow.com/questions/888235/overriding-a-bases-overloaded-function-in-c/888337#888337
+  using BASE::read_file;
+
+};
+
+
+#ifdef USE_MPI
+
+namespace parallel {
+
+/**
+ * @brief  parallel base for gzip/BGZF files.  file_range_bytes is the decompressed size, so partitioned_file
+ *         block-partitions the decompressed data.  use as
+ *         partitioned_file<gzip_file, FileParser, gzip_base_file>.
+ * @note   rank 0 computes the decompressed size and the BGZF block index, and broadcasts both, so the ranks' readers do
+ *         not scan the file again.  for plain gzip the size takes a full decompression pass,
+ *         whose output rank 0 keeps, up to max_cached_bytes, and scatters to the ranks at the first read.
+ *         see scatter_range.
+ */
+class gzip_base_file : public ::bliss::io::parallel::base_file {
+protected:
+  using BASE = ::bliss::io::parallel::base_file;
+
+  /// largest point to point message, in bytes.  MPI counts are int.
+  static constexpr size_t max_message_bytes = static_cast<size_t>(INT_MAX);
+
+  /// plain gzip:  largest decompressed file that rank 0 keeps from the size pass.  larger files are inflated again at the
+  /// read and streamed to the ranks.
+  static constexpr size_t max_cached_bytes = 1UL << 30;
+
+  /// plain gzip, rank 0 only:  decompressed file from the size pass.  released after the first read.
+  ::std::vector<unsigned char> inflated;
+
+  /// BGZF block index from the size pass on rank 0, broadcast to all ranks and handed to the reader.  empty for plain gzip.
+  ::std::vector<size_t> block_coffsets;
+  ::std::vector<size_t> block_uoffsets;
+
+  /// compute decompressed size and BGZF block index (1 proc, then broadcast).  a failure on rank 0 throws on all ranks.
+  size_t get_file_size() {
+    const size_t failed = ::std::numeric_limits<size_t>::max();
+    const size_t cache_bytes = max_cached_bytes;  // local copy, passed by reference.
+    size_t sizes[2] = {0, 0};   // decompressed file size, block index entries
+    ::std::exception_ptr error;
+
+    if (this->comm.rank() == 0) {
+      try {
+        sizes[0] = ::bliss::io::gzip_file::get_uncompressed_size(this->fd, &inflated, cache_bytes,
+                                                                 &block_coffsets, &block_uoffsets);
+        sizes[1] = block_coffsets.size();
+      } catch (...) {
+        error = ::std::current_exception();
+        sizes[0] = failed;
+      }
+    }
+    if (this->comm.size() > 1)
+      MPI_Bcast(sizes, 2, MPI_UNSIGNED_LONG, 0, this->comm);
+
+    if (error) ::std::rethrow_exception(error);
+    if (sizes[0] == failed) {
+      ::std::stringstream ss;
+      ss << "ERROR: gzip_base_file " << this->filename << " could not be decompressed on rank 0";
+      throw ::bliss::utils::make_exception<bliss::io::IOException>(ss.str());
+    }
+
+    // about 16 bytes per 64KB block, so a single message.
+    if ((this->comm.size() > 1) && (sizes[1] > 0)) {
+      block_coffsets.resize(sizes[1]);
+      block_uoffsets.resize(sizes[1]);
+      MPI_Bcast(block_coffsets.data(), static_cast<int>(sizes[1]), MPI_UNSIGNED_LONG, 0, this->comm);
+      MPI_Bcast(block_uoffsets.data(), static_cast<int>(sizes[1]), MPI_UNSIGNED_LONG, 0, this->comm);
+    }
+    return sizes[0];
+  }
+
+  /**
+   * @brief  read a plain gzip range on every rank, decompressing only on rank 0.  COLLECTIVE
+   * @details rank 0 gathers the requested ranges.  if the size pass data covers them, each rank's range is sent from
+   *          there.  otherwise rank 0 inflates the file again up to the largest end and sends each decompressed piece to
+   *          the ranks whose ranges overlap it, so it holds only its own range.  the size pass data is released either way,
+   *          so a later read inflates again, once.
+   */
+  void scatter_range(::bliss::io::file_data::container & output, range_type const & range) {
+    const size_t msg_bytes = max_message_bytes;  // local copy, std::min takes references.
+    int p = this->comm.size();
+    int rank = this->comm.rank();
+
+    size_t req[2] = {range.start, range.end};
+    ::std::vector<size_t> reqs((rank == 0) ? 2 * p : 0);
+    MPI_Gather(req, 2, MPI_UNSIGNED_LONG, reqs.data(), 2, MPI_UNSIGNED_LONG, 0, this->comm);
+
+    int complete = 1;
+    ::std::exception_ptr error;
+
+    if (rank > 0) {
+      // pieces arrive in order.  an empty message means rank 0 could not decompress the rest of the range.
+      output.resize(range.size());
+      MPI_Status status;
+      int count = 1;
+      for (size_t s = 0; (s < output.size()) && (count > 0); s += count) {
+        MPI_Recv(output.data() + s, static_cast<int>(::std::min(msg_bytes, output.size() - s)), MPI_BYTE,
+                 0, 0, this->comm, &status);
+        MPI_Get_count(&status, MPI_BYTE, &count);
+      }
+    } else {
+      size_t end = 0;
+      for (int i = 0; i < p; ++i) end = ::std::max(end, reqs[2 * i + 1]);
+      ::std::vector<size_t> sent(p, 0);
+      size_t produced_bytes = 0;
+
+      try {
+        if (inflated.size() >= end) {
+          // ranks wait in their receives, so the sends go out in rank order.
+          for (int i = 1; i < p; ++i) {
+            range_type r(reqs[2 * i], reqs[2 * i + 1]);
+            for (size_t s = r.start; s < r.end; s += msg_bytes) {
+              MPI_Send(inflated.data() + s, static_cast<int>(::std::min(msg_bytes, r.end - s)), MPI_BYTE,
+                       i, 0, this->comm);
+            }
+            sent[i] = r.size();
+          }
+          produced_bytes = inflated.size();
+
+          if ((range.start == 0) && (range.end == inflated.size())) {
+            output.swap(inflated);
+          } else {
+            output.assign(inflated.begin() + range.start, inflated.begin() + range.end);
+          }
+        } else {
+          ::std::vector<unsigned char>().swap(inflated);
+          output.resize(range.size());
+
+          // pieces are at most stream_buffer_bytes, well below the MPI count limit.
+          produced_bytes = ::bliss::io::gzip_file::inflate_pieces(this->fd, end,
+              [this, p, &reqs, &sent, &range, &output](unsigned char const * data, range_type const & produced) {
+            range_type target = range_type::intersect(produced, range);
+            if (target.size() > 0)
+              memcpy(output.data() + (target.start - range.start), data + (target.start - produced.start), target.size());
+
+            for (int i = 1; i < p; ++i) {
+              target = range_type::intersect(produced, range_type(reqs[2 * i], reqs[2 * i + 1]));
+              if (target.size() == 0) continue;
+              MPI_Send(const_cast<unsigned char *>(data) + (target.start - produced.start),
+                       static_cast<int>(target.size()), MPI_BYTE, i, 0, this->comm);
+              sent[i] += target.size();
+            }
+          });
+        }
+      } catch (...) {
+        error = ::std::current_exception();
+      }
+      ::std::vector<unsigned char>().swap(inflated);
+
+      // truncated or corrupt file:  end the receives that still wait for data.
+      for (int i = 1; i < p; ++i) {
+        if (sent[i] < range_type(reqs[2 * i], reqs[2 * i + 1]).size())
+          MPI_Send(nullptr, 0, MPI_BYTE, i, 0, this->comm);
+      }
+      complete = !error && (produced_bytes >= end);
+    }
+
+    // a truncated file throws on every rank, instead of handing back a partial range.
+    MPI_Bcast(&complete, 1, MPI_INT, 0, this->comm);
+    if (error) ::std::rethrow_exception(error);
+    if (!complete) {
+      ::std::stringstream ss;
+      ss << "ERROR: gzip_base_file " << this->filename << " decompressed less than the requested ranges";
+      throw ::bliss::utils::make_exception<bliss::io::IOException>(ss.str());
+    }
+  }
+
+public:
+  /**
+   * @brief constructor
+   * @param _filename     name of file to open
+   * @param _comm       MPI communicator to use.
+   */
+  gzip_base_file(std::string const & _filename, ::mxx::comm const & _comm = ::mxx::comm()) :
+    BASE(_filename, _comm) {
+    this->file_range_bytes.end = this->get_file_size();
+  };
+
+  /// destructor
+  virtual ~gzip_base_file() {};
+
+  // this is needed to prevent overload name hiding.  see http://stackoverflow.com/questions/888235/overriding-a-bases-overloaded-function-in-c/888337#888337
+  using BASE::read_file;
+  using BASE::read_range;
+  using BASE::attach_reader;
+
+  /// hands the broadcast block index to the reader.  plain gzip reads go through scatter_range.
+  void attach_reader(::bliss::io::gzip_file & reader) {
+    reader.set_block_index(::std::move(block_coffsets), ::std::move(block_uoffsets));
+    reader.set_stream_source([this](::bliss::io::file_data::container & output, range_type const & range) {
+      this->scatter_range(output, range);
+    });
+  }
+};
+
+/// partitioned gzip/BGZF file.  ranks split BGZF files by block.  plain gzip is inflated once on rank 0 and scattered.
+/// FileParser supplies the record boundary search.
+template <template <typename> class FileParser = ::bliss::io::BaseFileParser>
+using partitioned_gzip_file = ::bliss::io::parallel::partitioned_file<::bliss::io::gzip_file, FileParser,
+    ::bliss::io::parallel::gzip_base_file>;
+
+}  // namespace parallel
+
+#endif  // USE_MPI
+
+}  // namespace io
+}  // namespace bliss
+
+#endif  // USE_ZLIB
+
+#endif /* GZIP_FILE_HPP_ */
@@ -70,6 +70,39 @@ namespace imxx
 
 
 
+    /**
+     * @brief   compute key_func for input[first, last) and call op(i, bucket id) for each element, in order.
+     * @details if key_func has a batch interface (batch_size > 1, e.g. KeyToRank with a SIMD kmer hash),
+     *          the bucket ids are computed batch_size elements at a time.
+     */
+    template <typename T, typename Func, typename Op>
+    inline void for_each_bucket_id(std::vector<T> const & input, Func const & key_func,
+                                   size_t first, size_t last, Op const & op, ::std::true_type const &) {
+      constexpr size_t batch = ::fsc::hash_batch_size<Func>::value;
+      size_t ids[batch];
+
+      size_t i = first;
+      for (; (i + batch) <= last; i += batch) {
+        key_func(input.begin() + i, batch, ids);
+        for (size_t j = 0; j < batch; ++j) op(i + j, ids[j]);
+      }
+      if (i < last) {
+        key_func(input.begin() + i, last - i, ids);
+        for (size_t j = 0; i < last; ++i, ++j) op(i, ids[j]);
+      }
+    }
+    template <typename T, typename Func, typename Op>
+    inline void for_each_bucket_id(std::vector<T> const & input, Func const & key_func,
+                                   size_t first, size_t last, Op const & op, ::std::false_type const &) {
+      for (size_t i = first; i < last; ++i) op(i, key_func(input[i]));
+    }
+    template <typename T, typename Func, typename Op>
+    inline void for_each_bucket_id(std::vector<T> const & input, Func const & key_func,
+                                   size_t first, size_t last, Op const & op) {
+      for_each_bucket_id(input, key_func, first, last, op,
+                         ::std::integral_constant<bool, (::fsc::hash_batch_size<Func>::value > 1)>());
+    }
+
     /**
      * @brief   implementation function for use by assign_and_bucket
      * @details uses the smallest data type (ASSIGN_TYPE) given the number of buckets.
@@ -118,15 +151,14 @@ namespace imxx
       i2o.reserve(len);
 
       // [1st pass]: compute bucket counts and input to bucket assignment.
-      ASSIGN_TYPE p;
-      for (size_t i = f; i < l; ++i) {
-          p = key_func(input[i]);
+      for_each_bucket_id(input, key_func, f, l, [&](size_t, size_t const & id) {
+          ASSIGN_TYPE p = id;
 
           assert(((0 <= p) && ((size_t)p < num_buckets)) && "assigned bucket id is not valid");
 
           i2o.emplace_back(p);
           ++bucket_sizes[p];
-      }
+      });
 
       // get offsets of where buckets start (= exclusive prefix sum)
       // use bucket_sizes temporarily.
@@ -202,15 +234,14 @@ namespace imxx
       i2o.reserve(len);
 
       // [1st pass]: compute bucket counts and input to bucket assignment.
-      ASSIGN_TYPE p;
-      for (size_t i = f; i < l; ++i) {
-          p = key_func(input[i]);
+      for_each_bucket_id(input, key_func, f, l, [&](size_t, size_t const & id) {
+          ASSIGN_TYPE p = id;
 
           assert(((0 <= p) && ((size_t)p < num_buckets)) && "assigned bucket id is not valid");
 
           i2o.emplace_back(p);
           ++bucket_sizes[p];
-      }
+      });
 
       // get offsets of where buckets start (= exclusive prefix sum)
       // use bucket_sizes temporarily.
@@ -308,15 +339,12 @@ namespace imxx
 
         // [1st pass]: compute bucket counts and input2bucket assignment.
         // store input2bucket assignment in i2o temporarily.
-        size_t p;
-        for (size_t i = f; i < l; ++i) {
-            p = key_func(input[i]);
-
+        for_each_bucket_id(input, key_func, f, l, [&](size_t i, size_t const & p) {
             assert(((0 <= p) && ((size_t)p < num_buckets)) && "assigned bucket id is not valid");
 
             i2o[i] = p;
             ++bucket_sizes[p];
-        }
+        });
 
     }
 
@@ -1172,6 +1200,194 @@ namespace imxx
 
   }
 
+
+  /**
+   * @brief handle for a non-blocking distribute (see idistribute).
+   * @details  owns the bucketed send buffer and the count/displacement arrays, which MPI requires to stay
+   *          untouched until the exchanges complete.  a transfer goes through 2 stages:  the count all2all that
+   *          idistribute posts, then the data all2allv that post() starts once the counts are in.
+   *          wait() must be called before the recv buffer is read.  destructor waits, so the buffers are never
+   *          released while in flight.
+   */
+  template <typename V>
+  class idistribute_request {
+    protected:
+      ::std::vector<V> send_buf;
+      /// per destination: element count, then 1 if this rank's send and recv totals fit in int.
+      ::std::vector<size_t> send_sizes;
+      ::std::vector<size_t> recv_sizes;
+      ::std::vector<int> send_counts;
+      ::std::vector<int> send_displs;
+      ::std::vector<int> recv_counts;
+      ::std::vector<int> recv_displs;
+      ::mxx::datatype dt;
+      ::mxx::datatype size_dt;
+      ::std::vector<V> * output;
+      ::mxx::comm const * comm;
+      MPI_Request req;
+      /// true while the count all2all is outstanding, i.e. post() has not started the data exchange yet.
+      bool counting;
+      bool active;
+
+      template <typename VV, typename ToRank>
+      friend void idistribute(::std::vector<VV>& input, ToRank const & to_rank,
+                              ::std::vector<VV>& output, idistribute_request<VV> & request,
+                              ::mxx::comm const &_comm);
+
+      void release() {
+        active = false;
+        ::std::vector<V>().swap(send_buf);
+      }
+
+    public:
+      idistribute_request() : output(nullptr), comm(nullptr), req(MPI_REQUEST_NULL), counting(false), active(false) {}
+
+      // in-flight buffers cannot be copied or moved safely.
+      idistribute_request(idistribute_request const & other) = delete;
+      idistribute_request& operator=(idistribute_request const & other) = delete;
+
+      ~idistribute_request() {
+        wait();
+      }
+
+      /// true if there is an exchange outstanding.
+      bool pending() const {
+        return counting || active;
+      }
+
+      /**
+       * @brief  finish the count exchange, size the output, and post the data all2allv.  no-op if already posted.
+       * @note  COLLECTIVE:  all ranks must call it, or wait(), at the same point, since it starts a collective.
+       */
+      void post() {
+        if (!counting) return;
+        MPI_Wait(&req, MPI_STATUS_IGNORE);
+        counting = false;
+
+        int p = comm->size();
+        std::vector<size_t> send_counts_sz(p), recv_counts_sz(p);
+        bool fits = true;
+        size_t total = 0;
+        for (int i = 0; i < p; ++i) {
+          send_counts_sz[i] = send_sizes[2 * i];
+          recv_counts_sz[i] = recv_sizes[2 * i];
+          total += recv_sizes[2 * i];
+          fits &= (recv_sizes[2 * i + 1] == 1);   // every rank's flag arrives, so all ranks agree.
+        }
+        if (output->capacity() < total) output->clear();
+        output->resize(total);
+
+        if (fits) {
+          send_counts.assign(send_counts_sz.begin(), send_counts_sz.end());
+          recv_counts.assign(recv_counts_sz.begin(), recv_counts_sz.end());
+          send_displs.resize(p);
+          recv_displs.resize(p);
+          send_displs[0] = 0;
+          recv_displs[0] = 0;
+          for (int i = 1; i < p; ++i) {
+            send_displs[i] = send_displs[i-1] + send_counts[i-1];
+            recv_displs[i] = recv_displs[i-1] + recv_counts[i-1];
+          }
+          dt = mxx::get_datatype<V>();
+
+          MPI_Ialltoallv(const_cast<V*>(send_buf.data()), send_counts.data(), send_displs.data(), dt.type(),
+                         output->data(), recv_counts.data(), recv_displs.data(), dt.type(),
+                         *comm, &req);
+          active = true;
+        } else {
+          mxx::all2allv(send_buf.data(), send_counts_sz, output->data(), recv_counts_sz, *comm);
+          release();
+        }
+      }
+
+      /// block until the exchange completes, then release the send buffer.  no-op if nothing is outstanding.  COLLECTIVE if post() has not been called.
+      void wait() {
+        post();
+        if (!active) return;
+        MPI_Wait(&req, MPI_STATUS_IGNORE);
+        release();
+      }
+
+      /// poll for completion.  calling this during local work also helps MPI implementations without a progress thread.
+      /// does not advance past the count exchange: only post() starts the data exchange, so all ranks start it in the same order.
+      bool test() {
+        if (!pending()) return true;
+        int flag = 0;
+        MPI_Test(&req, &flag, MPI_STATUS_IGNORE);
+        if (counting) {
+          // MPI_Test freed a completed request.  post() then waits on MPI_REQUEST_NULL, which returns immediately.
+          return false;
+        }
+        if (flag) release();
+        return !active;
+      }
+  };
+
+
+  /**
+   * @brief non-blocking distribute.  buckets input by to_rank, then posts the count all2all without waiting for it.
+   *        request.post() starts the data all2allv once the counts arrive, and request.wait() completes the transfer.
+   * @details  input is consumed (moved into the request's send buffer), output is sized to the number of incoming
+   *          entries by post() and is filled once request.wait() returns.  output must outlive the request's transfer.
+   *          meant for pipelining, where local work (e.g. inserting the previous chunk) proceeds while the counts are
+   *          in flight, and more local work (e.g. parsing the next chunk) while the data is.
+   *          multiple requests may be outstanding on the same communicator, as long as all ranks post them in the same order.
+   * @note  COLLECTIVE.  falls back to blocking exchanges if MPI < 3, and to blocking mxx::all2allv if counts do not fit in int.
+   */
+  template <typename V, typename ToRank>
+  void idistribute(::std::vector<V>& input, ToRank const & to_rank,
+                   ::std::vector<V>& output, idistribute_request<V> & request,
+                   ::mxx::comm const &_comm) {
+    // a request handle carries 1 transfer at a time.
+    request.wait();
+
+    BL_BENCH_INIT(idistribute);
+
+    BL_BENCH_START(idistribute);
+    std::vector<size_t> send_counts(_comm.size(), 0);
+    std::vector<size_t> i2o;
+    imxx::local::assign_to_buckets(input, to_rank, _comm.size(), send_counts, i2o, 0, input.size());
+    imxx::local::bucket_to_permutation(send_counts, i2o, 0, input.size());
+    BL_BENCH_END(idistribute, "bucket", input.size());
+
+    BL_BENCH_START(idistribute);
+    request.send_buf.resize(input.size());
+    imxx::local::permute(input.begin(), input.end(), i2o.begin(), request.send_buf.begin(), 0);
+    ::std::vector<V>().swap(input);
+    ::std::vector<size_t>().swap(i2o);
+    BL_BENCH_END(idistribute, "permute", request.send_buf.size());
+
+    BL_BENCH_START(idistribute);
+    // the fit flag travels with the counts, so the ranks agree on it without another collective.
+    // the recv total is not known yet, so it is bounded by what a rank may receive from any 1 sender.
+    int p = _comm.size();
+#if MPI_VERSION >= 3
+    size_t fits = (request.send_buf.size() < static_cast<size_t>(mxx::max_int) / p) ? 1 : 0;
+#else
+    size_t fits = 0;
+#endif
+    request.send_sizes.resize(2 * p);
+    request.recv_sizes.resize(2 * p);
+    for (int i = 0; i < p; ++i) {
+      request.send_sizes[2 * i] = send_counts[i];
+      request.send_sizes[2 * i + 1] = fits;
+    }
+    request.output = &output;
+    request.comm = &_comm;
+    request.counting = true;
+#if MPI_VERSION >= 3
+    request.size_dt = mxx::get_datatype<size_t>();
+    MPI_Ialltoall(request.send_sizes.data(), 2, request.size_dt.type(),
+                  request.recv_sizes.data(), 2, request.size_dt.type(), _comm, &(request.req));
+#else
+    mxx::all2all(request.send_sizes.data(), 2, request.recv_sizes.data(), _comm);
+    request.req = MPI_REQUEST_NULL;
+#endif
+    BL_BENCH_END(idistribute, "post_a2a_count", request.send_buf.size());
+
+    BL_BENCH_REPORT_MPI_NAMED(idistribute, "imxx:idistribute", _comm);
+  }
+
   template <typename V, typename SIZE>
   void undistribute(::std::vector<V> const & input,
                   ::std::vector<SIZE> const & recv_counts,
@@ -42,9 +42,9 @@
 #include "mpi.h"
 #endif
 
-//#if defined(USE_OPENMP)
-//#include "omp.h"
-//#endif
+#if defined(USE_OPENMP)
+#include "omp.h"
+#endif
 
 #include <unistd.h>     // sysconf
 #include <sys/stat.h>   // block size.
@@ -52,14 +52,15 @@
 #include <utility>      // pair and utility functions.
 #include <type_traits>
 #include <cctype>       // tolower.
+#include <algorithm>
+#include <numeric>      // accumulate
 
 #include "io/file.hpp"
+#include "io/gzip_file.hpp"
 #include "io/fastq_loader.hpp"
 #include "io/fasta_loader.hpp"
 //#include "io/fasta_iterator.hpp"
 
-#include "iterators/container_concatenating_iterator.hpp"
-
 #include "utils/logging.h"
 #include "utils/file_utils.hpp"
 #include "common/kmer.hpp"
@@ -72,6 +73,9 @@
 
 #include "io/kmer_parser.hpp"
 #include "io/mxx_support.hpp"
+#if defined(USE_MPI)
+#include <mxx/reduction.hpp>
+#endif
 
 #include "io/sequence_iterator.hpp"
 
@@ -97,6 +101,56 @@ namespace io
 struct KmerFileHelper {
 
 
+  /**
+   * @brief  generate the kmers of 1 sequence that start in valid, and append them to out.
+   * @details  the per-sequence step shared by read_block and read_block_omp.
+   *          empty sequences and sequences starting at or after valid.end produce nothing.  a FASTA sequence that continues past
+   *          valid.end is cut at most k-1 characters past it, so the overlap is scanned only as far as the last kmer needs.
+   * @tparam CharIterType   iterator type of the block, for the FASTA check.
+   * @param valid         range of the partition (or sub-partition) that owns the kmers.  kmer_parser should be restricted to the same range.
+   * @return  1 if the sequence is counted in valid, i.e. its data starts in valid, else 0.  a sequence split between partitions is
+   *          counted by the partition that has its start.
+   */
+  template <typename KmerParser, template <typename> class SeqParser, typename CharIterType, typename SeqType, typename OutIter>
+  static size_t parse_sequence(SeqType & seq, ::bliss::partition::range<size_t> const & valid,
+      KmerParser & kmer_parser, OutIter & out) {
+
+    size_t counted = valid.contains(seq.id.get_pos() + seq.seq_offset) ? 1 : 0;
+
+    if (seq.seq_size() == 0) return counted;
+
+    size_t start_offset = seq.seq_global_offset();
+
+    // if seq data starts outside of valid, then skip
+    if (start_offset >= valid.end) return counted;
+
+    // if FASTA seq data ends in overlap region, then go at most k-1 characters from end of valid range.
+    if (::std::is_same<SeqParser<CharIterType>, ::bliss::io::FASTAParser<CharIterType> >::value) {
+      if ((start_offset + seq.seq_size()) >= valid.end) {
+        ::bliss::utils::file::NotEOL not_eol;
+
+        // scan for k-1 characters, from the valid range end.
+        auto endd = seq.seq_begin + (valid.end - start_offset);
+        size_t steps = KmerParser::window_size - 1;
+        size_t count = 0;
+
+        while ((endd != seq.seq_end) && (count < steps)) {
+          if (not_eol(*endd)) {
+            ++count;
+          }
+
+          ++endd;
+        }
+
+        seq.seq_end = endd;
+      }
+    }
+
+    out = kmer_parser(seq, out);
+    return counted;
+  }
+
+
   /**
    * @brief  generate kmers or kmer tuples for 1 block of raw data.
    * @note   requires that SeqParser be passed in and operates on the Block's Iterators.
@@ -108,7 +162,7 @@ struct KmerFileHelper {
    * @param result        output vector.  should be pre allocated.
    */
   template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType, typename BlockType>
-  static std::pair<size_t, size_t> read_block_old(BlockType const & partition,
+  static std::pair<size_t, size_t> read_block(BlockType const & partition,
       SeqParser<typename BlockType::iterator> const &seq_parser,
       std::vector<typename KmerParser::value_type>& result) {
 
@@ -119,7 +173,6 @@ struct KmerFileHelper {
 
     //== sequence parser type
     KmerParser kmer_parser(partition.valid_range_bytes);
-    ::bliss::utils::file::NotEOL not_eol;
 
     //== process the chunk of data
 
@@ -132,163 +185,120 @@ struct KmerFileHelper {
     size_t before = result.size();
     size_t seqs = 0;
 
-    //== loop over the reads
+    //== single pass over the reads:  count the good ones and generate kmers in the same traversal, so record scanning is done once.
     for (; seqs_start != seqs_end; ++seqs_start)
     {
       auto seq = *seqs_start;
-      if (seq.seq_size() == 0) continue;
-      //      std::cout << "** seq: " << (*seqs_start).id.id << ", ";
-      //      ostream_iterator<typename std::iterator_traits<typename SeqType::IteratorType>::value_type> osi(std::cout);
-      //      std::copy((*seqs_start).seq_begin, (*seqs_start).seq_end, osi);
-      //      std::cout << std::endl;
-
-      size_t start_offset = seq.seq_global_offset();
-
-      // if seq data starts outside of valid, then skip
-      if (start_offset >= partition.valid_range_bytes.end) {
-        continue;
-      }
-
-      // check if last.  if yes, and seqParser is a FASTAParser, then inspect and change if needed
-      if (::std::is_same<SeqParser<CharIterType>, ::bliss::io::FASTAParser<CharIterType> >::value) {
-        // if seq data ends in overlap region, then go at most k-1 characters from end of valid range.
-        if ((start_offset + seq.seq_size()) >= partition.valid_range_bytes.end) {
-          // scan for k-1 characters, from the valid range end.
-          auto endd = seq.seq_begin + (partition.valid_range_bytes.end - start_offset);
-          size_t steps = KmerParser::window_size - 1;
-          size_t count = 0;
-
-          // iterate and find the windows size - 1 chars in overlap, starting from valid end.  should be less than current seq end.
-          while ((endd != seq.seq_end) && (count < steps)) {
-            if (not_eol(*endd)) {
-              ++count;
-            }
-
-            ++endd;
-          }
-
-
-          seq.seq_end = endd;
-        }
-      }
-
-      emplace_iter = kmer_parser(seq, emplace_iter);
-      if ((seq.seq_offset == seq.seq_begin_offset) ||
-          (start_offset >= partition.valid_range_bytes.start)) ++seqs;
-
-      //      std::cout << "Last: pos - kmer " << result.back() << std::endl;
-
+      seqs += parse_sequence<KmerParser, SeqParser, CharIterType>(seq, partition.valid_range_bytes, kmer_parser, emplace_iter);
     }
 
-    //std::cout << "number of sequences " << seqs << " number of total entries " << result.size() << " before insertion " << before << std::endl;
-
     return std::make_pair(seqs, result.size() - before);
   }
 
 
+  /**
+   * @brief  multithreaded read_block.  splits the block's valid range into nthreads sub-ranges, generates kmers for each in its own thread, then concatenates.
+   * @details  FASTQ sub-range boundaries are moved to record starts via find_first_record.  FASTA boundaries are left as is, since
+   *          the FASTAParser can start from any offset.  each thread uses a KmerParser restricted to its sub-range, so
+   *          a kmer is generated by exactly 1 thread (same as between MPI ranks), and the output is in the same order as read_block.
+   *          thread 0 writes directly into result; the other threads use their own buffers and are appended at the end.
+   * @note   falls back to read_block if not compiled with OpenMP, or if nthreads is 1.  nthreads = 0 means use omp_get_max_threads().
+   * @param nthreads      number of threads to use.
+   */
   template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType, typename BlockType>
-  static std::pair<size_t, size_t> read_block(BlockType const & partition,
+  static std::pair<size_t, size_t> read_block_omp(BlockType const & partition,
       SeqParser<typename BlockType::iterator> const &seq_parser,
-      std::vector<typename KmerParser::value_type>& result) {
+      std::vector<typename KmerParser::value_type>& result,
+      int const & nthreads) {
 
-    // from FileLoader type, get the block iter type and range type
-    using CharIterType = typename BlockType::const_iterator;
-
-    //using SeqIterType = ::bliss::io::SequencesIterator<CharIterType, SeqParser >;
+#if !defined(USE_OPENMP)
+    return read_block<KmerParser, SeqParser, SeqIterType>(partition, seq_parser, result);
+#else
+    int nt = (nthreads < 1) ? omp_get_max_threads() : nthreads;
 
-    //== sequence parser type
-    KmerParser kmer_parser(partition.valid_range_bytes);
+    // keep each thread's block reasonably large.  small partitions are not worth the overhead.
+    constexpr size_t min_block = 64 * 1024;
+    size_t valid_size = partition.valid_range_bytes.size();
+    nt = std::min(static_cast<size_t>(nt), std::max(valid_size / min_block, static_cast<size_t>(1)));
 
-    //== process the chunk of data
+    if (nt <= 1)
+      return read_block<KmerParser, SeqParser, SeqIterType>(partition, seq_parser, result);
 
-    //==  and wrap the chunk inside an uiterator that emits Reads.
-    SeqIterType<CharIterType, SeqParser> seqs_start(seq_parser, partition.cbegin(), partition.in_mem_cend(), partition.getRange().start);
-    SeqIterType<CharIterType, SeqParser> seqs_end(partition.in_mem_cend());
-
-    ::fsc::back_emplace_iterator<std::vector<typename KmerParser::value_type> > emplace_iter(result);
+    using CharIterType = typename BlockType::const_iterator;
+    using RangeType = ::bliss::partition::range<size_t>;
+
+    //== compute the thread boundaries.  serial, and only looks at a few lines per boundary.
+    SeqParser<CharIterType> boundary_parser(seq_parser);
+    std::vector<size_t> bounds(nt + 1, partition.valid_range_bytes.end);
+    bounds[0] = partition.valid_range_bytes.start;
+    size_t block = (valid_size + nt - 1) / nt;
+    for (int t = 1; t < nt; ++t) {
+      size_t b = std::min(partition.valid_range_bytes.start + t * block, partition.valid_range_bytes.end);
+      if (::std::is_same<SeqParser<CharIterType>, ::bliss::io::FASTQParser<CharIterType> >::value) {
+        b = boundary_parser.find_first_record(partition.in_mem_cbegin(), partition.parent_range_bytes, partition.in_mem_range_bytes,
+                                              RangeType(b, partition.in_mem_range_bytes.end));
+      }
+      bounds[t] = std::min(std::max(b, bounds[t - 1]), partition.valid_range_bytes.end);
+    }
 
+    std::vector<std::vector<typename KmerParser::value_type> > buffers(nt - 1);
+    std::vector<size_t> seqs(nt, 0);
     size_t before = result.size();
-    size_t seqs = 0;
+    size_t est = (result.capacity() - before) / nt;
 
-    //== loop over the reads and count the good ones.  TODO: DO WE REALLY NEED TO DO THIS? WHERE IS IT USED?
-    for (auto it = seqs_start; it != seqs_end; ++it)
+#pragma omp parallel num_threads(nt)
     {
-        auto seq = *it;
-
-        // if a sequence is chopped up, count only the starting ones, or the ones that starts after the partition's valid ranges
-//        if ((seq.seq_offset == seq.seq_begin_offset) ||
-//            (seq.seq_global_offset() > partition.valid_range_bytes.start)) ++seqs;
-//        	partition.valid_range_bytes.contains(seq.seq_global_offset()) ) ++seqs;
-        // if a sequence has starting position inside partition's valid range, count it.  note that seq record may start before a
-        // valid position but the actual data is in a different partition.  the record is assigned to the partitions that
-        // contain its data, not where the record first starts.
-        if (partition.valid_range_bytes.contains(seq.id.get_pos() + seq.seq_offset)) ++seqs;
-        else {
-        	std::cout << "DEBUG: seq does not start in partition: range " << partition.valid_range_bytes << " seq " << seq.id.get_pos() << ": " << seq << std::endl;
-        }
-    }
-
+      int tid = omp_get_thread_num();
 
-    // now make the concatenated iterators
-	using Iter = typename ::bliss::iterator::ContainerConcatenatingIterator<SeqIterType<CharIterType, SeqParser>, KmerParser>;
+      std::vector<typename KmerParser::value_type> & out = (tid == 0) ? result : buffers[tid - 1];
+      if (tid > 0) out.reserve(est);
 
-	Iter concat_start(kmer_parser, seqs_start, seqs_end);
-	Iter concat_end(kmer_parser, seqs_end);
+      RangeType sub(bounds[tid], bounds[tid + 1]);
+      KmerParser kmer_parser(sub);
 
-	std::copy(concat_start, concat_end, emplace_iter);
-
-    return std::make_pair(seqs, result.size() - before);
-  }
+      // thread 0 starts where read_block does.  the others start at their boundaries.
+      SeqIterType<CharIterType, SeqParser> seqs_start(seq_parser,
+          (tid == 0) ? partition.cbegin() : (partition.in_mem_cbegin() + (sub.start - partition.in_mem_range_bytes.start)),
+          partition.in_mem_cend(),
+          (tid == 0) ? partition.getRange().start : sub.start);
+      SeqIterType<CharIterType, SeqParser> seqs_end(partition.in_mem_cend());
 
+      ::fsc::back_emplace_iterator<std::vector<typename KmerParser::value_type> > emplace_iter(out);
 
-  /**
-   * @brief initialize the sequence parser, estimate capacity and reserver, and then call read_block to parse the actual data.
-   */
-  template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType, typename BlockType>
-  static std::pair<size_t, size_t> parse_file_data_old(const BlockType & partition,
-                         std::vector<typename KmerParser::value_type>& result) {
-      std::pair<size_t, size_t> read = {0, 0};
-
-     constexpr int kmer_size = KmerParser::window_size;
-
-      BL_BENCH_INIT(file);
+      for (; (sub.size() > 0) && (seqs_start != seqs_end); ++seqs_start)
       {
-        // not reusing the SeqParser in loader.  instead, reinitializing one.
-        BL_BENCH_START(file);
-        SeqParser<typename BlockType::const_iterator> seq_parser;
-        seq_parser.init_parser(partition.in_mem_cbegin(), partition.parent_range_bytes, partition.in_mem_range_bytes, partition.getRange());
-        BL_BENCH_END(file, "mark_seqs", partition.getRange().size());
+        auto seq = *seqs_start;
 
-        //== reserve
-        BL_BENCH_START(file);
-        // modifying the local index directly here causes a thread safety issue, since callback thread is already running.
-        // index reserve internally sends a message to itself.
+        // sequences are in file order, so everything after this belongs to the next thread.
+        if ((seq.seq_size() > 0) && (seq.seq_global_offset() >= sub.end)) break;
 
-        // call after getting first L1Block to ensure that file is loaded.  (rank 0 reads and broadcast)
-        size_t record_size = 0;
-        size_t seq_len = 0;
-        std::tie(record_size, seq_len) = seq_parser.get_record_size(partition.cbegin(), partition.parent_range_bytes, partition.getRange(), partition.getRange(), 10);
-        size_t est_size = (record_size == 0) ? 0 : (partition.getRange().size() + record_size - 1) / record_size;  // number of records
-        est_size *= (seq_len < kmer_size) ? 0 : (seq_len - kmer_size + 1) ;  // number of kmers in a record
-        result.reserve(result.size() + est_size + (est_size >> 4));
-        BL_BENCH_END(file, "reserve", est_size + (est_size >> 4));
-
-        BL_BENCH_START(file);
-        //=== copy into array
-        if (partition.getRange().size() > 0) {
-          read = read_block_old<KmerParser, SeqParser, SeqIterType>(partition, seq_parser, result);
-        }
-//        std::cout << "parse_file_data_old: seqs " << read.first << " kmers " << read.second << std::endl;
-
-        BL_BENCH_END(file, "read_seqs", read.first);
-        // std::cout << "Last: pos - kmer " << result.back() << std::endl;
+        // a FASTA sequence split at a thread boundary is counted by the thread that has its beginning.
+        seqs[tid] += parse_sequence<KmerParser, SeqParser, CharIterType>(seq, sub, kmer_parser, emplace_iter);
       }
+    }
 
-      BL_BENCH_REPORT_NAMED(file, "index:read_file_data");
-      return read;
+    //== concatenate in thread order.
+    std::vector<size_t> offsets(nt, result.size());
+    for (int t = 1; t < nt; ++t) {
+      offsets[t] = offsets[t - 1] + buffers[t - 1].size();
+    }
+    result.resize(offsets[nt - 1]);
 
+#pragma omp parallel for num_threads(nt - 1)
+    for (int t = 0; t < nt - 1; ++t) {
+      std::move(buffers[t].begin(), buffers[t].end(), result.begin() + offsets[t]);
+      std::vector<typename KmerParser::value_type>().swap(buffers[t]);
+    }
+
+    return std::make_pair(std::accumulate(seqs.begin(), seqs.end(), static_cast<size_t>(0)), result.size() - before);
+#endif
   }
 
+
+
+  /**
+   * @brief initialize the sequence parser, estimate capacity and reserver, and then call read_block to parse the actual data.
+   */
   template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType, typename BlockType>
   static std::pair<size_t, size_t> parse_file_data(const BlockType & partition,
                          std::vector<typename KmerParser::value_type>& result) {
@@ -324,6 +334,8 @@ struct KmerFileHelper {
           read = read_block<KmerParser, SeqParser, SeqIterType>(partition, seq_parser, result);
         }
         BL_BENCH_END(file, "read_seqs", read.first);
+        BL_BENCH_ADD_COUNT(file, "read_MB", static_cast<double>(partition.getRange().size()) / 1000000.0);
+        BL_BENCH_ADD_COUNT(file, "read_kmers", read.second);
         // std::cout << "Last: pos - kmer " << result.back() << std::endl;
       }
 
@@ -371,7 +383,7 @@ struct KmerFileHelper {
 
         // not reusing the SeqParser in loader.  instead, reinitializing one.
         BL_BENCH_START(file);
-        read = parse_file_data_old<KmerParser, SeqParser, SeqIterType>(partition, result);
+        read = parse_file_data<KmerParser, SeqParser, SeqIterType>(partition, result);
         BL_BENCH_END(file, "read_kmers", read.second);
         // std::cout << "Last: pos - kmer " << result.back() << std::endl;
       }
@@ -437,56 +449,12 @@ struct KmerFileHelper {
 
   /**
    * @brief initialize the sequence parser, estimate capacity and reserver, and then call read_block to parse the actual data.
-   */
-  template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType, typename BlockType>
-  static  ::std::pair<size_t, size_t> parse_file_data_old(const BlockType & partition,
-                         std::vector<typename KmerParser::value_type>& result, const mxx::comm & _comm) {
-      ::std::pair<size_t, size_t> read = {0,0};
-
-     constexpr int kmer_size = KmerParser::window_size;
-
-      BL_BENCH_INIT(file);
-      {
-        // not reusing the SeqParser in loader.  instead, reinitializing one.
-        BL_BENCH_START(file);
-        SeqParser<typename BlockType::const_iterator> seq_parser;
-        seq_parser.init_parser(partition.in_mem_cbegin(), partition.parent_range_bytes, partition.in_mem_range_bytes, partition.getRange(), _comm);
-        BL_BENCH_END(file, "mark_seqs", partition.getRange().size());
-
-        //== reserve
-        BL_BENCH_START(file);
-        // modifying the local index directly here causes a thread safety issue, since callback thread is already running.
-        // index reserve internally sends a message to itself.
-
-        // call after getting first L1Block to ensure that file is loaded.  (rank 0 reads and broadcast)
-        size_t record_size = 0;
-        size_t seq_len = 0;
-        std::tie(record_size, seq_len) = seq_parser.get_record_size(partition.cbegin(), partition.parent_range_bytes, partition.getRange(), partition.getRange(), _comm, 10);
-        size_t est_size = (record_size == 0) ? 0 : (partition.getRange().size() + record_size - 1) / record_size;  // number of records
-        est_size *= (seq_len < kmer_size) ? 0 : (seq_len - kmer_size + 1) ;  // number of kmers in a record
-        result.reserve(result.size() + est_size / 2);
-        BL_BENCH_END(file, "reserve", est_size);
-
-        BL_BENCH_START(file);
-        //=== copy into array
-        if (partition.getRange().size() > 0) {
-          read = read_block_old<KmerParser, SeqParser, SeqIterType>(partition, seq_parser, result);
-        }
-        BL_BENCH_END(file, "read_seqs", read.first);
-        // std::cout << "Last: pos - kmer " << result.back() << std::endl;
-      }
-
-      BL_BENCH_REPORT_MPI_NAMED(file, "index:read_file_data", _comm);
-      return read;
-
-  }
-
-  /**
-   * @brief initialize the sequence parser, estimate capacity and reserver, and then call read_block to parse the actual data.
+   * @param nthreads      threads for kmer generation.  1 = serial, 0 = omp_get_max_threads().  see read_block_omp.
    */
   template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType, typename BlockType>
   static  ::std::pair<size_t, size_t> parse_file_data(const BlockType & partition,
-                         std::vector<typename KmerParser::value_type>& result, const mxx::comm & _comm) {
+                         std::vector<typename KmerParser::value_type>& result, const mxx::comm & _comm,
+                         int const & nthreads = 1) {
       ::std::pair<size_t, size_t> read = {0,0};
 
      constexpr int kmer_size = KmerParser::window_size;
@@ -516,9 +484,14 @@ struct KmerFileHelper {
         BL_BENCH_START(file);
         //=== copy into array
         if (partition.getRange().size() > 0) {
-          read = read_block<KmerParser, SeqParser, SeqIterType>(partition, seq_parser, result);
+          if (nthreads == 1)
+            read = read_block<KmerParser, SeqParser, SeqIterType>(partition, seq_parser, result);
+          else
+            read = read_block_omp<KmerParser, SeqParser, SeqIterType>(partition, seq_parser, result, nthreads);
         }
         BL_BENCH_END(file, "read_seqs", read.first);
+        BL_BENCH_ADD_COUNT(file, "read_MB", static_cast<double>(partition.getRange().size()) / 1000000.0);
+        BL_BENCH_ADD_COUNT(file, "read_kmers", read.second);
         // std::cout << "Last: pos - kmer " << result.back() << std::endl;
       }
 
@@ -528,15 +501,36 @@ struct KmerFileHelper {
   }
 
 
+  /// true if FileType decompresses its input, i.e. is a gzip/BGZF reader.
   template <typename FileType>
-  static ::bliss::io::file_data open_file(const std::string & filename, const size_t overlap, const mxx::comm & _comm) {
+  struct decompresses : public ::std::integral_constant<bool,
+#if defined(USE_ZLIB)
+      ::std::is_base_of<::bliss::io::parallel::gzip_base_file, FileType>::value
+#else
+      false
+#endif
+      > {};
+
+  /// check that the file is a supported sequence file, and that FileType can read it.
+  template <typename FileType>
+  static void check_file(const std::string & filename) {
         // file extension determines SeqParserType
-        std::string extension = ::bliss::utils::file::get_file_extension(filename);
+        std::string extension = ::bliss::utils::file::get_sequence_file_extension(filename);
         std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
         if ((extension.compare("fastq") != 0) && (extension.compare("fasta") != 0)) {
           throw std::invalid_argument("input filename extension is not supported.");
         }
 
+        // compressed input needs a decompressing reader.
+        if (::bliss::utils::file::is_gzip_file(filename) && !decompresses<FileType>::value) {
+          throw std::invalid_argument("compressed input requires a gzip file reader, e.g. read_file_gzip.");
+        }
+  }
+
+  template <typename FileType>
+  static ::bliss::io::file_data open_file(const std::string & filename, const size_t overlap, const mxx::comm & _comm) {
+        check_file<FileType>(filename);
+
         FileType fobj(filename, overlap, _comm);
         return fobj.read_file();
   }
@@ -546,11 +540,12 @@ struct KmerFileHelper {
    * @note  static so can be used without instantiating a internal map.
    * @tparam SeqParser    parser type for extracting sequences.  supports FASTQ and FASTA.   template template parameter, param is iterator
    * @tparam KmerParser   parser type for generating Kmer.  supports kmer, kmer+pos, kmer+count, kmer+pos/qual.
+   * @param nthreads      threads per rank for kmer generation.  1 = serial, 0 = omp_get_max_threads().  see read_block_omp.
    */
   template <typename FileType, typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType>
   static  ::std::pair<size_t, size_t> read_file(const std::string & filename,
                          std::vector<typename KmerParser::value_type>& result,
-                         const mxx::comm & _comm) {
+                         const mxx::comm & _comm, int const & nthreads = 1) {
 
       ::std::pair<size_t, size_t> read = {0, 0};
 
@@ -568,7 +563,7 @@ struct KmerFileHelper {
 
         // not reusing the SeqParser in loader.  instead, reinitializing one.
         BL_BENCH_START(file);
-        read = parse_file_data_old<KmerParser, SeqParser, SeqIterType>(partition, result, _comm);
+        read = parse_file_data<KmerParser, SeqParser, SeqIterType>(partition, result, _comm, nthreads);
         BL_BENCH_END(file, "read_kmers", read.second);
         // std::cout << "Last: pos - kmer " << result.back() << std::endl;
       }
@@ -588,10 +583,10 @@ struct KmerFileHelper {
   template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType>
   static  ::std::pair<size_t, size_t> read_file_mpiio(const std::string & filename,
                          std::vector<typename KmerParser::value_type>& result,
-                         const mxx::comm & _comm) {
+                         const mxx::comm & _comm, int const & nthreads = 1) {
 
       return read_file<::bliss::io::parallel::mpiio_file<SeqParser >,
-          KmerParser, SeqParser, SeqIterType>(filename, result, _comm);
+          KmerParser, SeqParser, SeqIterType>(filename, result, _comm, nthreads);
   }
 
 
@@ -604,13 +599,30 @@ struct KmerFileHelper {
   template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType>
   static  ::std::pair<size_t, size_t> read_file_mmap(const std::string & filename,
                         std::vector<typename KmerParser::value_type>& result,
-                        const mxx::comm & _comm) {
+                        const mxx::comm & _comm, int const & nthreads = 1) {
 
       // partitioned file with mmap or posix is only slightly faster than mpiio and may result in more jitter when congested.
       return read_file<::bliss::io::parallel::partitioned_file<::bliss::io::mmap_file, SeqParser >,
-          KmerParser, SeqParser, SeqIterType>(filename, result, _comm);
+          KmerParser, SeqParser, SeqIterType>(filename, result, _comm, nthreads);
+
+  }
+
+#if defined(USE_ZLIB)
+  /**
+   * @brief read a gzip or BGZF compressed file's content and generate kmers.
+   * @note  BGZF files are split by block and each rank decompresses only its partition.  plain gzip files are
+   *        decompressed once on rank 0, which sends each rank its partition.  see gzip_file.
+   */
+  template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType>
+  static  ::std::pair<size_t, size_t> read_file_gzip(const std::string & filename,
+                        std::vector<typename KmerParser::value_type>& result,
+                        const mxx::comm & _comm, int const & nthreads = 1) {
+
+      return read_file<::bliss::io::parallel::partitioned_gzip_file<SeqParser >,
+          KmerParser, SeqParser, SeqIterType>(filename, result, _comm, nthreads);
 
   }
+#endif
 
 
   /**
@@ -622,15 +634,348 @@ struct KmerFileHelper {
   template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType>
   static ::std::pair<size_t, size_t> read_file_posix(const std::string & filename,
                          std::vector<typename KmerParser::value_type>& result,
-                         const mxx::comm & _comm) {
+                         const mxx::comm & _comm, int const & nthreads = 1) {
 
 
 
       // partitioned file with mmap or posix do not seem to be much faster than mpiio and may result in more jitter when congested.
       return read_file<::bliss::io::parallel::partitioned_file<::bliss::io::posix_file, SeqParser >,
-          KmerParser, SeqParser, SeqIterType>(filename, result, _comm);
+          KmerParser, SeqParser, SeqIterType>(filename, result, _comm, nthreads);
+
+  }
+
+
+  /**
+   * @brief  this rank's record aligned range of a FASTQ file, found without loading the rank's block partition.
+   * @details  a rank owns the records that start in its block partition (after the first line break), so its range runs from
+   *          its first record start to the next rank's.  the first record is found by reading a few KB at the block start,
+   *          doubling the read until it holds a complete record or reaches the end of the file.
+   *          ranks whose block holds no record start get an empty range.
+   * @note  COLLECTIVE.
+   */
+  template <template <typename> class SeqParser, typename FileType>
+  static ::bliss::partition::range<size_t> find_record_partition(FileType & fobj, const mxx::comm & _comm) {
+    using RangeType = ::bliss::partition::range<size_t>;
+
+    RangeType file_range(0, fobj.size());
+
+    // block partition, same as the partitioned readers.
+    RangeType block = file_range;
+    if (_comm.size() > 1) {
+      ::bliss::partition::BlockPartitioner<RangeType> partitioner;
+      partitioner.configure(file_range, _comm.size());
+      block = partitioner.getNext(_comm.rank());
+    }
+
+    SeqParser<unsigned char const *> parser;
+    unsigned char const * data = nullptr;
+    size_t start = file_range.end;
+    for (size_t probe = 64UL * 1024UL; block.start < file_range.end; probe *= 2) {
+      RangeType loaded = fobj.read_window(RangeType(block.start, block.start + ::std::min(probe, file_range.end - block.start)), data);
+      start = parser.find_first_record(data, file_range, loaded, loaded);
+      if ((start < loaded.end) || (loaded.end == file_range.end)) break;
+    }
+
+    // end at the next rank's first record.
+    RangeType valid(start, file_range.end);
+    if (_comm.size() > 1) {
+      if (_comm.rank() == (_comm.size() - 1))
+        (void) ::mxx::left_shift(start, _comm);
+      else
+        valid.end = ::mxx::left_shift(start, _comm);
+    }
+    return valid;
+  }
+
+  /**
+   * @brief  end of the whole FASTQ records in a window that stops inside a record, i.e. the start of a record near the window's end.
+   * @details  searches the last few KB of the window first, and doubles the search until a record start is found.
+   * @return  a record start after the window's first byte, or the window's end if no other record starts in the window.
+   */
+  template <template <typename> class SeqParser>
+  static size_t find_last_record(::bliss::io::file_window const & window) {
+    using RangeType = ::bliss::partition::range<size_t>;
+
+    RangeType const & in_mem = window.in_mem_range_bytes;
+    SeqParser<unsigned char const *> parser;
+    size_t from, start;
+    for (size_t tail = 4096; ; tail *= 2) {
+      from = (in_mem.size() > (tail + 1)) ? (in_mem.end - tail) : (in_mem.start + 1);
+      start = parser.find_first_record(window.data, window.parent_range_bytes, in_mem, RangeType(::std::min(from, in_mem.end), in_mem.end));
+      if (start < in_mem.end) return start;
+      if (from == (in_mem.start + 1)) return in_mem.end;
+    }
+  }
+
+  /**
+   * @brief  generate kmers one window at a time and hand each window's kmers to chunk_op.  shared loop of read_file_chunked.
+   * @note  COLLECTIVE.  chunk_op is called the same number of times on every rank.
+   * @tparam WindowOp  functor with signature size_t(size_t pos, file_window & window).  sets window to the next window, starting
+   *                   at pos, and returns the end of its valid range.
+   * @param valid      this rank's range.
+   */
+  template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType,
+    typename WindowOp, typename ChunkOp>
+  static  ::std::pair<size_t, size_t> parse_windows(::bliss::partition::range<size_t> const & valid,
+                         SeqParser<unsigned char const *> const & seq_parser,
+                         WindowOp && next_window, size_t const & max_count,
+                         ChunkOp && chunk_op,
+                         const mxx::comm & _comm, int const & nthreads) {
+
+      ::std::pair<size_t, size_t> read = {0, 0};
+      ::std::pair<size_t, size_t> chunk_read = {0, 0};
+
+      BL_BENCH_INIT(file);
+      {
+        BL_BENCH_LOOP_START(file, 0);
+        BL_BENCH_LOOP_START(file, 1);
+
+        ::bliss::io::file_window window;
+        ::std::vector<typename KmerParser::value_type> chunk;
+        chunk.reserve(max_count);
+        size_t pos = valid.start;
+        size_t iters = 0;
+
+        // loop until all ranks are done.  ranks that finish early still participate with empty chunks.
+        bool more = true;
+        while (more) {
+          BL_BENCH_LOOP_RESUME(file, 0);
+          chunk.clear();
+          if (pos < valid.end) {
+            pos = next_window(pos, window);
+            chunk_read = read_block_omp<KmerParser, SeqParser, SeqIterType>(window, seq_parser, chunk, nthreads);
+            read.first += chunk_read.first;
+            read.second += chunk_read.second;
+          }
+          BL_BENCH_LOOP_PAUSE(file, 0);
+
+          BL_BENCH_LOOP_RESUME(file, 1);
+          chunk_op(chunk);
+
+          more = ::mxx::any_of(pos < valid.end, _comm);
+          BL_BENCH_LOOP_PAUSE(file, 1);
+
+          ++iters;
+        }
+        BL_BENCH_LOOP_END(file, 0, "read_kmers", read.second);
+        BL_BENCH_LOOP_END(file, 1, "chunk_op", iters);
+      }
+
+      BL_BENCH_REPORT_MPI_NAMED(file, "io:parse_windows", _comm);
+      return read;
+  }
+
+  /**
+   * @brief read a file's content and generate kmers in chunks, handing each chunk to chunk_op.  bounded memory version of read_file.
+   * @details  kmers are generated 1 window of the rank's partition at a time.  a window holds about chunk_bytes / sizeof(kmer)
+   *          bytes of input, and each input byte yields at most 1 kmer, so a chunk stays within chunk_bytes unless a single
+   *          record is longer than the window, in which case that window is grown to hold it.
+   *          chunk_op is invoked the same number of times on every rank (possibly with an empty vector),
+   *          so it is allowed to make collective calls, e.g. a distributed map's insert.
+   *
+   *          FASTQ:  the rank's record aligned range is found by reading a few KB at its partition start (find_record_partition),
+   *          then the windows are read from the file with FileType::read_window.  a window ends at the last record start in it,
+   *          and the partial record after it is read again as the start of the next window, so raw memory is 1 window.
+   *          FASTA, and compressed input:  the partition is loaded whole, as in read_file, since the FASTA parser locates
+   *          the sequence headers over the whole partition, collectively, and compressed input cannot be read at an offset.
+   *          the windows are then slices of the partition.
+   * @note  COLLECTIVE.
+   * @tparam ChunkOp      functor with signature void(std::vector<typename KmerParser::value_type> &).  may modify the vector.
+   * @tparam OpenOp       functor with signature void(::bliss::partition::range<size_t> const &), called once on every rank
+   *                      with the file's range, after the file is opened and before the first chunk, e.g. to size per rank
+   *                      state from the file size (decompressed bytes for compressed input).  allowed to make collective calls.
+   * @param chunk_bytes   cap on the bytes of generated kmers (tuples) per chunk, per rank.
+   * @param nthreads      threads per rank for kmer generation in each window.  1 = serial, 0 = omp_get_max_threads().  see read_block_omp.
+   * @return  pair of number of sequences and total number of kmers generated on this rank.
+   */
+  template <typename FileType, typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType, typename ChunkOp, typename OpenOp>
+  static  ::std::pair<size_t, size_t> read_file_chunked(const std::string & filename,
+                         size_t const & chunk_bytes,
+                         ChunkOp && chunk_op,
+                         OpenOp && open_op,
+                         const mxx::comm & _comm, int const & nthreads = 1) {
+
+      // number of entries per chunk, and bytes per window.  at least 1 so that we make progress.
+      size_t max_count = ::std::max(chunk_bytes / sizeof(typename KmerParser::value_type), 1UL);
+
+      using streamed = ::std::integral_constant<bool,
+          ::std::is_same<SeqParser<unsigned char const *>, ::bliss::io::FASTQParser<unsigned char const *> >::value &&
+          !decompresses<FileType>::value>;
+
+      return read_file_chunked_impl<FileType, KmerParser, SeqParser, SeqIterType>(filename, max_count,
+          chunk_op, open_op, _comm, nthreads, streamed());
+  }
+
+  /// chunked read without a step after open.  see read_file_chunked above.  COLLECTIVE
+  template <typename FileType, typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType, typename ChunkOp>
+  static  ::std::pair<size_t, size_t> read_file_chunked(const std::string & filename,
+                         size_t const & chunk_bytes,
+                         ChunkOp && chunk_op,
+                         const mxx::comm & _comm, int const & nthreads = 1) {
+      return read_file_chunked<FileType, KmerParser, SeqParser, SeqIterType>(filename, chunk_bytes, chunk_op,
+          [](::bliss::partition::range<size_t> const &) {}, _comm, nthreads);
+  }
+
+  /// chunked read via mpiio.  see read_file_chunked.  COLLECTIVE
+  template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType, typename ChunkOp>
+  static  ::std::pair<size_t, size_t> read_file_mpiio_chunked(const std::string & filename,
+                         size_t const & chunk_bytes, ChunkOp && chunk_op,
+                         const mxx::comm & _comm, int const & nthreads = 1) {
+      return read_file_chunked<::bliss::io::parallel::mpiio_file<SeqParser >,
+          KmerParser, SeqParser, SeqIterType>(filename, chunk_bytes, chunk_op, _comm, nthreads);
+  }
+
+  /// chunked read via mmap.  see read_file_chunked.  COLLECTIVE
+  template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType, typename ChunkOp>
+  static  ::std::pair<size_t, size_t> read_file_mmap_chunked(const std::string & filename,
+                         size_t const & chunk_bytes, ChunkOp && chunk_op,
+                         const mxx::comm & _comm, int const & nthreads = 1) {
+      return read_file_chunked<::bliss::io::parallel::partitioned_file<::bliss::io::mmap_file, SeqParser >,
+          KmerParser, SeqParser, SeqIterType>(filename, chunk_bytes, chunk_op, _comm, nthreads);
+  }
+
+  /// chunked read via windowed mmap, FASTQ windows parsed in place in the mapping, with read ahead and release.  see windowed_mmap_file and read_file_chunked.  COLLECTIVE
+  template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType, typename ChunkOp>
+  static  ::std::pair<size_t, size_t> read_file_mmap_windowed_chunked(const std::string & filename,
+                         size_t const & chunk_bytes, ChunkOp && chunk_op,
+                         const mxx::comm & _comm, int const & nthreads = 1) {
+      return read_file_chunked<::bliss::io::parallel::partitioned_file<::bliss::io::windowed_mmap_file, SeqParser >,
+          KmerParser, SeqParser, SeqIterType>(filename, chunk_bytes, chunk_op, _comm, nthreads);
+  }
+
+  /// chunked read via posix.  see read_file_chunked.  COLLECTIVE
+  template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType, typename ChunkOp>
+  static  ::std::pair<size_t, size_t> read_file_posix_chunked(const std::string & filename,
+                         size_t const & chunk_bytes, ChunkOp && chunk_op,
+                         const mxx::comm & _comm, int const & nthreads = 1) {
+      return read_file_chunked<::bliss::io::parallel::partitioned_file<::bliss::io::posix_file, SeqParser >,
+          KmerParser, SeqParser, SeqIterType>(filename, chunk_bytes, chunk_op, _comm, nthreads);
+  }
+
+#if defined(USE_ZLIB)
+  /// chunked read of a gzip or BGZF compressed file.  see read_file_chunked.  COLLECTIVE
+  template <typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType, typename ChunkOp>
+  static  ::std::pair<size_t, size_t> read_file_gzip_chunked(const std::string & filename,
+                         size_t const & chunk_bytes, ChunkOp && chunk_op,
+                         const mxx::comm & _comm, int const & nthreads = 1) {
+      return read_file_chunked<::bliss::io::parallel::partitioned_gzip_file<SeqParser >,
+          KmerParser, SeqParser, SeqIterType>(filename, chunk_bytes, chunk_op, _comm, nthreads);
+  }
+#endif
+
+protected:
+  /// chunked read of a FASTQ file, windows read from the file.  see read_file_chunked.  COLLECTIVE
+  template <typename FileType, typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType, typename ChunkOp, typename OpenOp>
+  static  ::std::pair<size_t, size_t> read_file_chunked_impl(const std::string & filename,
+                         size_t const & window_bytes,
+                         ChunkOp && chunk_op,
+                         OpenOp && open_op,
+                         const mxx::comm & _comm, int const & nthreads, ::std::true_type) {
+      using RangeType = ::bliss::partition::range<size_t>;
+
+      ::std::pair<size_t, size_t> read = {0, 0};
+
+      BL_BENCH_INIT(file);
+      {  // ensure that the file is closed at the end.
+
+        BL_BENCH_START(file);
+        check_file<FileType>(filename);
+        FileType fobj(filename, KmerParser::window_size - 1, _comm);
+        RangeType file_range(0, fobj.size());
+        RangeType valid = find_record_partition<SeqParser>(fobj, _comm);
+        BL_BENCH_END(file, "open", valid.size());
+
+        open_op(file_range);
+
+        // next window:  up to window_bytes from pos, cut at the last record start in it.  the cut off partial record is
+        // the start of the following window.  grown if it does not hold a whole record.
+        auto next_window = [&fobj, &file_range, &valid, &window_bytes](size_t const & pos, ::bliss::io::file_window & window) {
+          window.parent_range_bytes = file_range;
+          for (size_t bytes = window_bytes; ; bytes *= 2) {
+            window.in_mem_range_bytes = fobj.read_window(RangeType(pos, pos + ::std::min(bytes, valid.end - pos)), window.data);
+            if (window.in_mem_range_bytes.end == valid.end) break;
+
+            size_t end = find_last_record<SeqParser>(window);
+            if (end < window.in_mem_range_bytes.end) {
+              window.in_mem_range_bytes.end = end;
+              break;
+            }
+          }
+          window.valid_range_bytes = window.in_mem_range_bytes;
+          return window.valid_range_bytes.end;
+        };
 
+        BL_BENCH_START(file);
+        SeqParser<unsigned char const *> seq_parser;
+        read = parse_windows<KmerParser, SeqParser, SeqIterType>(valid, seq_parser, next_window, window_bytes, chunk_op, _comm, nthreads);
+        BL_BENCH_END(file, "read_kmers", read.second);
+      }
+
+      BL_BENCH_REPORT_MPI_NAMED(file, "io:read_file_chunked", _comm);
+      return read;
   }
+
+  /// chunked read of a partition loaded whole (FASTA, compressed input).  windows are slices of the partition.  see read_file_chunked.  COLLECTIVE
+  template <typename FileType, typename KmerParser, template <typename> class SeqParser, template <typename,  template <typename> class> class SeqIterType, typename ChunkOp, typename OpenOp>
+  static  ::std::pair<size_t, size_t> read_file_chunked_impl(const std::string & filename,
+                         size_t const & window_bytes,
+                         ChunkOp && chunk_op,
+                         OpenOp && open_op,
+                         const mxx::comm & _comm, int const & nthreads, ::std::false_type) {
+      using RangeType = ::bliss::partition::range<size_t>;
+      using CharIterType = unsigned char const *;
+
+      ::std::pair<size_t, size_t> read = {0, 0};
+
+      constexpr int kmer_size = KmerParser::window_size;
+
+      BL_BENCH_INIT(file);
+      {  // ensure that fileloader is closed at the end.
+
+        BL_BENCH_START(file);
+        ::bliss::io::file_data partition = open_file<FileType>(filename, kmer_size - 1, _comm);
+        BL_BENCH_END(file, "open", partition.getRange().size());
+
+        open_op(partition.parent_range_bytes);
+
+        BL_BENCH_START(file);
+        SeqParser<CharIterType> seq_parser;
+        seq_parser.init_parser(partition.data.data(), partition.parent_range_bytes, partition.in_mem_range_bytes, partition.getRange(), _comm);
+        BL_BENCH_END(file, "mark_seqs", partition.getRange().size());
+
+        // next window:  window_bytes of the valid range from pos.  FASTQ windows end at a record start.
+        // FASTA windows keep k-1 characters past their end in memory, as the partition does, for the kmers that span the end.
+        auto next_window = [&partition, &seq_parser, &window_bytes](size_t const & pos, ::bliss::io::file_window & window) {
+          RangeType const & valid = partition.valid_range_bytes;
+
+          window.parent_range_bytes = partition.parent_range_bytes;
+          window.in_mem_range_bytes = partition.in_mem_range_bytes;
+          window.data = partition.data.data();
+
+          size_t end = pos + ::std::min(window_bytes, valid.end - pos);
+          if (::std::is_same<SeqParser<CharIterType>, ::bliss::io::FASTQParser<CharIterType> >::value) {
+            if (end < valid.end)
+              end = ::std::min(seq_parser.find_first_record(window.data, window.parent_range_bytes, window.in_mem_range_bytes,
+                                                            RangeType(end, window.in_mem_range_bytes.end)), valid.end);
+            window.in_mem_range_bytes.end = end;
+          } else {
+            window.in_mem_range_bytes.end = seq_parser.find_overlap_end(window.data, window.parent_range_bytes, window.in_mem_range_bytes,
+                                                                        end, kmer_size - 1);
+          }
+          window.valid_range_bytes = RangeType(pos, end);
+          return end;
+        };
+
+        BL_BENCH_START(file);
+        read = parse_windows<KmerParser, SeqParser, SeqIterType>(partition.getRange(), seq_parser, next_window, window_bytes, chunk_op, _comm, nthreads);
+        BL_BENCH_END(file, "read_kmers", read.second);
+      }
+
+      BL_BENCH_REPORT_MPI_NAMED(file, "io:read_file_chunked", _comm);
+      return read;
+  }
+
+public:
 #endif
 
 
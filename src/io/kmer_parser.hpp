@@ -61,6 +61,7 @@
 #include "io/sequence_id_iterator.hpp"
 #include "iterators/transform_iterator.hpp"
 #include "common/kmer_iterators.hpp"
+#include "common/bulk_kmer_gen.hpp"
 #include "iterators/zip_iterator.hpp"
 #include "iterators/unzip_iterator.hpp"
 #include "iterators/constant_iterator.hpp"
@@ -286,6 +287,30 @@ public:
 ////      else
 ////        return ::std::copy_if(start, end, output_iter, pred);
 //    }
+    return generate(read, output_iter,
+                    std::integral_constant<bool, ::bliss::common::is_contiguous_char_iterator<typename SeqType::IteratorType>::value>());
+  }
+
+protected:
+  /// contiguous char storage:  use the bulk translate and roll kernel.
+  template <typename SeqType, typename OutputIt>
+  OutputIt generate(SeqType const & read, OutputIt output_iter, std::true_type const &) {
+    typename SeqType::IteratorType seq_begin;
+    typename SeqType::IteratorType seq_end;
+    bool has_window = false;
+
+    std::tie(seq_begin, seq_end, has_window) =
+        ::bliss::index::kmer::KmerParser<kmer_type>::get_valid_iterator_range(read, valid_range, window_size);
+
+    if (!has_window) return output_iter;
+
+    return ::bliss::common::generate_kmers<kmer_type>(reinterpret_cast<uint8_t const *>(&(*seq_begin)),
+                                                      std::distance(seq_begin, seq_end), output_iter);
+  }
+
+  /// general iterators:  use the kmer generation iterator stack.
+  template <typename SeqType, typename OutputIt>
+  OutputIt generate(SeqType const & read, OutputIt output_iter, std::false_type const &) {
     iterator_type<SeqType> istart = begin(read, window_size);
     iterator_type<SeqType> iend = end(read, window_size);
 
@@ -297,6 +322,84 @@ template <typename KmerType>
 constexpr size_t KmerParser<KmerType>::window_size;
 
 
+/**
+ * @brief kmer parser that emits canonical kmers, i.e. lex_less of the kmer and its reverse complement.
+ * @details the reverse complement is rolled alongside the forward kmer, so no per-kmer reverse_complement is needed.
+ *          output can be inserted into a map with lex_less InputTransform without another transform pass.  see is_canonical_parser.
+ * @tparam KmerType       output value type of this parser.
+ */
+template <typename KmerType>
+class CanonicalKmerParser : public KmerParser<KmerType> {
+
+protected:
+  using BaseType = KmerParser<KmerType>;
+
+public:
+  using value_type = typename BaseType::value_type;
+  using kmer_type = typename BaseType::kmer_type;
+  static constexpr size_t window_size = BaseType::window_size;
+
+  CanonicalKmerParser(::bliss::partition::range<size_t> const & _valid_range) : BaseType(_valid_range) {};
+
+  /**
+   * @brief generate canonical kmers from 1 sequence.  result inserted into output_iter, which may be preallocated.
+   * @param read          sequence object, which has pointers to the raw byte array.
+   * @param output_iter   output iterator pointing to insertion point for underlying container.
+   * @return new position for output_iter
+   */
+  template <typename SeqType, typename OutputIt, typename Predicate = ::bliss::filter::TruePredicate>
+  OutputIt operator()(SeqType const & read, OutputIt output_iter, Predicate const & pred = Predicate()) {
+
+    static_assert(std::is_same<KmerType, typename ::std::iterator_traits<OutputIt>::value_type>::value,
+            "output type and output container value type are not the same");
+
+    typename SeqType::IteratorType seq_begin;
+    typename SeqType::IteratorType seq_end;
+    bool has_window = false;
+
+    std::tie(seq_begin, seq_end, has_window) =
+        BaseType::get_valid_iterator_range(read, this->valid_range, window_size);
+
+    if (!has_window) return output_iter;
+
+    return generate(seq_begin, seq_end, output_iter,
+                    std::integral_constant<bool, ::bliss::common::is_contiguous_char_iterator<typename SeqType::IteratorType>::value>());
+  }
+
+protected:
+  /// contiguous char storage:  use the bulk translate kernel.
+  template <typename Iter, typename OutputIt>
+  OutputIt generate(Iter seq_begin, Iter seq_end, OutputIt output_iter, std::true_type const &) {
+    return ::bliss::common::generate_canonical_kmers<kmer_type>(reinterpret_cast<uint8_t const *>(&(*seq_begin)),
+                                                                std::distance(seq_begin, seq_end), output_iter);
+  }
+
+  /// general iterators:  roll over the EOL-filtered, translated characters.
+  template <typename Iter, typename OutputIt>
+  OutputIt generate(Iter seq_begin, Iter seq_end, OutputIt output_iter, std::false_type const &) {
+    bliss::utils::file::NotEOL neol;
+    using CI = ::bliss::index::kmer::NonEOLIter<Iter>;
+    using BI = bliss::iterator::transform_iterator<CI, bliss::common::ASCII2<typename BaseType::Alphabet> >;
+
+    ::bliss::common::CanonicalKmerRoller<kmer_type> roller;
+    return roller(BI(CI(neol, seq_begin, seq_end), bliss::common::ASCII2<typename BaseType::Alphabet>()),
+                  BI(CI(neol, seq_end), bliss::common::ASCII2<typename BaseType::Alphabet>()),
+                  output_iter);
+  }
+};
+
+template <typename KmerType>
+constexpr size_t CanonicalKmerParser<KmerType>::window_size;
+
+
+/// trait to indicate that the parser output is already canonical (lex_less).
+template <typename Parser>
+struct is_canonical_parser : public ::std::false_type {};
+
+template <typename KmerType>
+struct is_canonical_parser<CanonicalKmerParser<KmerType> > : public ::std::true_type {};
+
+
 /**
  * @tparam TupleType       output value type of this parser.  not necessarily the same as the map's final storage type.
  */
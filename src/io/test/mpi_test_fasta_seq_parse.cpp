@@ -288,6 +288,46 @@ protected:
 
 	}
 
+
+	/// order independent checksum of kmers, for comparing kmer sets generated by different readers.
+	static size_t kmer_checksum(std::vector<KmerType> const & kmers) {
+		size_t sum = 0;
+		for (auto const & km : kmers) {
+			size_t h = 0;
+			for (unsigned int i = 0; i < KmerType::nWords; ++i) {
+				h = h * 1000003UL + km.getData()[i];
+			}
+			sum += h;
+		}
+		return sum;
+	}
+
+	/// the chunked reader should generate the same kmers and sequences as the whole partition reader.
+	template <typename FileType>
+	void parse_chunked(size_t const & chunk_bytes, int const & nthreads, mxx::comm const & comm) {
+		using KmerParserType = bliss::index::kmer::KmerParser<KmerType >;
+
+		std::vector<KmerType> gold;
+		auto gold_read = ::bliss::io::KmerFileHelper::template read_file<FileType, KmerParserType, bliss::io::FASTAParser,
+				::bliss::io::SequencesIterator>(this->fileName, gold, comm);
+
+		size_t checksum = 0, chunks = 0;
+		auto read = ::bliss::io::KmerFileHelper::template read_file_chunked<FileType, KmerParserType, bliss::io::FASTAParser,
+				::bliss::io::SequencesIterator>(this->fileName, chunk_bytes,
+				[&checksum, &chunks](std::vector<KmerType> & chunk) {
+					checksum += kmer_checksum(chunk);
+					++chunks;
+				}, comm, nthreads);
+
+		// the fixture checks the totals against the file's known counts.
+		this->seqCount = read.first;
+		this->kmerCount = read.second;
+
+		ASSERT_EQ(mxx::allreduce(read.first, comm), mxx::allreduce(gold_read.first, comm));
+		ASSERT_EQ(mxx::allreduce(read.second, comm), mxx::allreduce(gold.size(), comm));
+		ASSERT_EQ(mxx::allreduce(checksum, comm), mxx::allreduce(kmer_checksum(gold), comm));
+		ASSERT_TRUE(mxx::all_same(chunks, comm));
+	}
 };
 
 
@@ -389,6 +429,34 @@ TEST_P(FASTAParseTest, parse_mpiio_mpi)
 
 	  comm.barrier();
 }
+
+TEST_P(FASTAParseTest, parse_mmap_chunked)
+{
+	::mxx::comm comm;
+
+	// small chunks, so most files take several windows.
+	this->parse_chunked<::bliss::io::parallel::partitioned_file<::bliss::io::mmap_file, bliss::io::FASTAParser> >(16 * 1024, 1, comm);
+
+	comm.barrier();
+}
+
+TEST_P(FASTAParseTest, parse_posix_chunked)
+{
+	::mxx::comm comm;
+
+	this->parse_chunked<::bliss::io::parallel::partitioned_file<::bliss::io::posix_file, bliss::io::FASTAParser> >(16 * 1024, 2, comm);
+
+	comm.barrier();
+}
+
+TEST_P(FASTAParseTest, parse_mpiio_chunked)
+{
+	::mxx::comm comm;
+
+	this->parse_chunked<::bliss::io::parallel::mpiio_file<bliss::io::FASTAParser> >(16 * 1024, 1, comm);
+
+	comm.barrier();
+}
 #endif
 
 
@@ -137,6 +137,7 @@ REGISTER_TYPED_TEST_CASE_P(FileSequentialLoadTest,
 
 typedef ::testing::Types<
 		bliss::io::mmap_file,
+		bliss::io::windowed_mmap_file,
 		bliss::io::stdio_file,
 		bliss::io::posix_file
 > FileSequentialLoadTestTypes;
@@ -243,12 +244,14 @@ REGISTER_TYPED_TEST_CASE_P(FileMPILoadTest,
 
 typedef ::testing::Types<
 	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::mmap_file,  ::bliss::io::BaseFileParser >, std::integral_constant<size_t, 0> >,
+	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::windowed_mmap_file, ::bliss::io::BaseFileParser >, std::integral_constant<size_t, 0> >,
 	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::stdio_file, ::bliss::io::BaseFileParser >, std::integral_constant<size_t, 0> >,
 	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::posix_file, ::bliss::io::BaseFileParser >, std::integral_constant<size_t, 0> >,
 	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::mmap_file,  ::bliss::io::BaseFileParser , ::bliss::io::parallel::base_shared_fd_file>, std::integral_constant<size_t, 0> >,
 	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::posix_file, ::bliss::io::BaseFileParser , ::bliss::io::parallel::base_shared_fd_file>, std::integral_constant<size_t, 0> >,
 	std::pair<::bliss::io::parallel::mpiio_file<::bliss::io::BaseFileParser >, std::integral_constant<size_t, 0> >,
 	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::mmap_file,  ::bliss::io::FASTAParser >, std::integral_constant<size_t, 0> >,
+	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::windowed_mmap_file, ::bliss::io::FASTAParser >, std::integral_constant<size_t, 0> >,
 	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::stdio_file, ::bliss::io::FASTAParser >, std::integral_constant<size_t, 0> >,
 	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::posix_file, ::bliss::io::FASTAParser >, std::integral_constant<size_t, 0> >,
 	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::mmap_file,  ::bliss::io::FASTAParser , ::bliss::io::parallel::base_shared_fd_file>,  std::integral_constant<size_t, 0> >,
@@ -345,6 +348,7 @@ REGISTER_TYPED_TEST_CASE_P(FASTQMPILoadTest,
 
 typedef ::testing::Types<
 	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::mmap_file,  ::bliss::io::FASTQParser >, std::integral_constant<size_t, 0> >,
+	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::windowed_mmap_file, ::bliss::io::FASTQParser >, std::integral_constant<size_t, 0> >,
 	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::stdio_file, ::bliss::io::FASTQParser >, std::integral_constant<size_t, 0> >,
 	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::posix_file, ::bliss::io::FASTQParser >, std::integral_constant<size_t, 0> >,
 	std::pair<::bliss::io::parallel::partitioned_file<::bliss::io::mmap_file,  ::bliss::io::FASTQParser , ::bliss::io::parallel::base_shared_fd_file>, std::integral_constant<size_t, 0> >,
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    test_gzip_file.cpp
+ * @ingroup io
+ * @author  tpan
+ * @brief   compare decompressed ranges of gzip and BGZF copies of the test data with the uncompressed file.
+ * @details the compressed copies are written by the test.  the BGZF writer uses small blocks so that ranges span many blocks.
+ */
+
+#include "bliss-config.hpp"    // for location of data.
+
+// include google test
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdio>   // remove
+
+#include "io/file.hpp"
+#include "io/gzip_file.hpp"
+#include "utils/file_utils.hpp"
+
+TEST(GzipFile, extension) {
+  EXPECT_TRUE(::bliss::utils::file::is_gzip_file("reads.fastq.gz"));
+  EXPECT_TRUE(::bliss::utils::file::is_gzip_file("reads.fa.BGZ"));
+  EXPECT_FALSE(::bliss::utils::file::is_gzip_file("reads.fastq"));
+  EXPECT_EQ(std::string("fastq"), ::bliss::utils::file::get_sequence_file_extension("reads.fastq.gz"));
+  EXPECT_EQ(std::string("fasta"), ::bliss::utils::file::get_sequence_file_extension("reads.fasta"));
+}
+
+#if defined(USE_ZLIB)
+
+#include <zlib.h>
+
+/// write data as BGZF with blocks of at most block_bytes uncompressed bytes, followed by the EOF block.
+void write_bgzf(std::string const & filename, std::vector<unsigned char> const & data, size_t block_bytes) {
+  FILE * fp = fopen(filename.c_str(), "wb");
+  ASSERT_TRUE(fp != nullptr);
+
+  std::vector<unsigned char> cbuf(65536);
+  for (size_t s = 0; ; s += block_bytes) {
+    size_t len = (s < data.size()) ? std::min(block_bytes, data.size() - s) : 0;  // last iteration writes the empty EOF block.
+
+    z_stream strm;
+    memset(&strm, 0, sizeof(z_stream));
+    ASSERT_EQ(Z_OK, deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY));
+    strm.next_in = const_cast<unsigned char *>(data.data() + std::min(s, data.size()));
+    strm.avail_in = len;
+    strm.next_out = cbuf.data() + 18;
+    strm.avail_out = cbuf.size() - 26;
+    ASSERT_EQ(Z_STREAM_END, deflate(&strm, Z_FINISH));
+    size_t clen = strm.total_out;
+    deflateEnd(&strm);
+
+    size_t bsize = 18 + clen + 8;
+    unsigned char header[18] = {0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0,
+                                static_cast<unsigned char>((bsize - 1) & 0xFF), static_cast<unsigned char>((bsize - 1) >> 8)};
+    memcpy(cbuf.data(), header, 18);
+    uint32_t crc = crc32(crc32(0L, Z_NULL, 0), data.data() + std::min(s, data.size()), len);
+    uint32_t isize = len;
+    for (int i = 0; i < 4; ++i) {
+      cbuf[18 + clen + i] = (crc >> (8 * i)) & 0xFF;
+      cbuf[22 + clen + i] = (isize >> (8 * i)) & 0xFF;
+    }
+    ASSERT_EQ(bsize, fwrite(cbuf.data(), 1, bsize, fp));
+
+    if (len == 0) break;
+  }
+  fclose(fp);
+}
+
+/// write data as plain gzip, in 2 members.
+void write_gzip(std::string const & filename, std::vector<unsigned char> const & data) {
+  size_t half = data.size() / 2;
+
+  gzFile gz = gzopen(filename.c_str(), "wb");
+  ASSERT_TRUE(gz != nullptr);
+  ASSERT_EQ(static_cast<int>(half), gzwrite(gz, data.data(), half));
+  gzclose(gz);
+
+  gz = gzopen(filename.c_str(), "ab");
+  ASSERT_TRUE(gz != nullptr);
+  ASSERT_EQ(static_cast<int>(data.size() - half), gzwrite(gz, data.data() + half, data.size() - half));
+  gzclose(gz);
+}
+
+class GzipFileTest : public ::testing::TestWithParam<std::string> {
+  protected:
+    std::string filename;
+    std::vector<unsigned char> gold;
+
+    virtual void SetUp() {
+      filename.assign(PROJ_SRC_DIR);
+      filename.append(GetParam());
+
+      ::bliss::io::posix_file fobj(filename);
+      fobj.read_range(gold, ::bliss::partition::range<size_t>(0, fobj.size()));
+      ASSERT_EQ(fobj.size(), gold.size());
+    }
+
+    void check(std::string const & compressed, bool blocked) {
+      ::bliss::io::gzip_file fobj(compressed);
+      EXPECT_EQ(blocked, fobj.is_blocked());
+      ASSERT_EQ(gold.size(), fobj.size());
+
+      // whole file
+      ::bliss::io::file_data fdata = fobj.read_file();
+      ASSERT_EQ(gold.size(), fdata.data.size());
+      EXPECT_TRUE(std::equal(gold.begin(), gold.end(), fdata.data.begin()));
+
+      // random ranges, including ones that start and end inside blocks.
+      std::default_random_engine generator(11);
+      std::uniform_int_distribution<size_t> distribution(0, gold.size());
+      std::vector<unsigned char> out;
+      for (int i = 0; i < 50; ++i) {
+        size_t s = distribution(generator);
+        size_t e = distribution(generator);
+        if (s > e) std::swap(s, e);
+
+        ::bliss::partition::range<size_t> r = fobj.read_range(out, ::bliss::partition::range<size_t>(s, e));
+        ASSERT_EQ(s, r.start);
+        ASSERT_EQ(e, r.end);
+        ASSERT_EQ(e - s, out.size());
+        EXPECT_TRUE(std::equal(out.begin(), out.end(), gold.begin() + s));
+      }
+
+      // compressed size is the file size.
+      ::bliss::io::posix_file cobj(compressed);
+      EXPECT_EQ(cobj.size(), fobj.compressed_size());
+    }
+};
+
+TEST_P(GzipFileTest, bgzf) {
+  std::string compressed("test_gzip_file.bgzf.gz");
+  write_bgzf(compressed, gold, 1000);
+  check(compressed, true);
+
+  // full size blocks
+  write_bgzf(compressed, gold, 65280);
+  check(compressed, true);
+
+  std::remove(compressed.c_str());
+}
+
+TEST_P(GzipFileTest, gzip) {
+  std::string compressed("test_gzip_file.plain.gz");
+  write_gzip(compressed, gold);
+  check(compressed, false);
+
+  std::remove(compressed.c_str());
+}
+
+INSTANTIATE_TEST_CASE_P(Bliss, GzipFileTest, ::testing::Values(
+    std::string("/test/data/test.small.fastq"),
+    std::string("/test/data/natural.fasta"),
+    std::string("/test/data/test.medium.fasta")
+));
+
+#endif
@@ -29,23 +29,47 @@
 
 #include "utils/timer.hpp"
 #include "utils/memory_usage.hpp"
+#include "utils/telemetry.hpp"
 
 #if BL_BENCHMARK == 1
 
-  #define BL_BENCH_INIT(title)                            BL_TIMER_INIT(title);  BL_MEMUSE_INIT(title); do { BL_MEMUSE_MARK(title, "begin");  } while (0)
-  #define BL_BENCH_RESET(title)                           do { BL_TIMER_RESET(title); BL_MEMUSE_RESET(title); } while (0)
-  #define BL_BENCH_LOOP_START(title, id)                      do { BL_TIMER_LOOP_START(title, id); } while (0)
-  #define BL_BENCH_LOOP_RESUME(title, id)                     do { BL_TIMER_LOOP_RESUME(title, id); } while (0)
-  #define BL_BENCH_LOOP_PAUSE(title, id)                      do { BL_TIMER_LOOP_PAUSE(title, id); } while (0)
-  #define BL_BENCH_LOOP_END(title, id, name, n_elem)          do { BL_TIMER_LOOP_END(title, id, name, n_elem); BL_MEMUSE_MARK(title, name); } while (0)
-  #define BL_BENCH_START(title)                           do { BL_TIMER_START(title); } while (0)
-  #define BL_BENCH_COLLECTIVE_START(title, name, comm)    do { BL_TIMER_COLLECTIVE_START(title, name, comm); } while (0)
-  #define BL_BENCH_COLLECTIVE_END(title, name, n_elem, comm)    do { BL_TIMER_COLLECTIVE_END(title, name, n_elem, comm); BL_MEMUSE_MARK(title, name); } while (0)
-  #define BL_BENCH_END(title, name, n_elem)               do { BL_TIMER_END(title, name, n_elem); BL_MEMUSE_MARK(title, name); } while (0)
-  #define BL_BENCH_REPORT(title, rank)                    do { BL_TIMER_REPORT(title); BL_MEMUSE_REPORT(title); } while (0)
-  #define BL_BENCH_REPORT_MPI(title, rank, comm)          do { BL_TIMER_REPORT_MPI(title, comm); BL_MEMUSE_REPORT_MPI(title, comm); } while (0)
-  #define BL_BENCH_REPORT_NAMED(title, name)                    do { BL_TIMER_REPORT_NAMED(title, name); BL_MEMUSE_REPORT_NAMED(title, name); } while (0)
-  #define BL_BENCH_REPORT_MPI_NAMED(title, name, comm)          do { BL_TIMER_REPORT_MPI_NAMED(title, name, comm); BL_MEMUSE_REPORT_MPI_NAMED(title, name, comm); } while (0)
+  #define BL_BENCH_INIT(title)                            BL_TIMER_INIT(title);  BL_MEMUSE_INIT(title); BL_TELEMETRY_INIT(title); do { BL_MEMUSE_MARK(title, "begin");  } while (0)
+  #define BL_BENCH_RESET(title)                           do { BL_TIMER_RESET(title); BL_MEMUSE_RESET(title); BL_TELEMETRY_RESET(title); } while (0)
+  #define BL_BENCH_LOOP_START(title, id)                      do { BL_TIMER_LOOP_START(title, id); BL_TELEMETRY_LOOP_START(title, id); } while (0)
+  #define BL_BENCH_LOOP_RESUME(title, id)                     do { BL_TIMER_LOOP_RESUME(title, id); BL_TELEMETRY_LOOP_RESUME(title, id); } while (0)
+  #define BL_BENCH_LOOP_PAUSE(title, id)                      do { BL_TIMER_LOOP_PAUSE(title, id); BL_TELEMETRY_LOOP_PAUSE(title, id); } while (0)
+  #define BL_BENCH_LOOP_END(title, id, name, n_elem)          do { BL_TIMER_LOOP_END(title, id, name, n_elem); BL_TELEMETRY_LOOP_END(title, id, name, n_elem); BL_MEMUSE_MARK(title, name); } while (0)
+  #define BL_BENCH_START(title)                           do { BL_TIMER_START(title); BL_TELEMETRY_START(title); } while (0)
+  #define BL_BENCH_COLLECTIVE_START(title, name, comm)    do { BL_TIMER_COLLECTIVE_START(title, name, comm); BL_TELEMETRY_START(title); } while (0)
+  #define BL_BENCH_COLLECTIVE_END(title, name, n_elem, comm)    do { BL_TIMER_COLLECTIVE_END(title, name, n_elem, comm); BL_TELEMETRY_END(title, name, n_elem); BL_MEMUSE_MARK(title, name); } while (0)
+  #define BL_BENCH_END(title, name, n_elem)               do { BL_TIMER_END(title, name, n_elem); BL_TELEMETRY_END(title, name, n_elem); BL_MEMUSE_MARK(title, name); } while (0)
+  #define BL_BENCH_ADD_COUNT(title, name, n_elem)         do { BL_TIMER_ADD_COUNT(title, name, n_elem); BL_TELEMETRY_ADD_COUNT(title, name, n_elem); } while (0)
+  #define BL_BENCH_ADD_METRIC(title, name, value)         do { BL_TIMER_ADD_METRIC(title, name, value); BL_TELEMETRY_ADD_METRIC(title, name, value); } while (0)
+  #define BL_BENCH_REPORT(title, rank)                    do { BL_TIMER_REPORT(title); BL_MEMUSE_REPORT(title); BL_TELEMETRY_REPORT(title); } while (0)
+  #define BL_BENCH_REPORT_MPI(title, rank, comm)          do { BL_TIMER_REPORT_MPI(title, comm); BL_MEMUSE_REPORT_MPI(title, comm); BL_TELEMETRY_REPORT_MPI(title, comm); } while (0)
+  #define BL_BENCH_REPORT_NAMED(title, name)                    do { BL_TIMER_REPORT_NAMED(title, name); BL_MEMUSE_REPORT_NAMED(title, name); BL_TELEMETRY_REPORT_NAMED(title, name); } while (0)
+  #define BL_BENCH_REPORT_MPI_NAMED(title, name, comm)          do { BL_TIMER_REPORT_MPI_NAMED(title, name, comm); BL_MEMUSE_REPORT_MPI_NAMED(title, name, comm); BL_TELEMETRY_REPORT_MPI_NAMED(title, name, comm); } while (0)
+
+#elif BL_TELEMETRY == 1
+
+  // benchmarking is compiled out, but phases are still recorded if telemetry is enabled at runtime.
+  // the non-MPI reports write each process's own phases.
+  #define BL_BENCH_INIT(title)                            BL_TELEMETRY_INIT(title)
+  #define BL_BENCH_RESET(title)                           BL_TELEMETRY_RESET(title)
+  #define BL_BENCH_LOOP_START(title, id)                  BL_TELEMETRY_LOOP_START(title, id)
+  #define BL_BENCH_LOOP_RESUME(title, id)                 BL_TELEMETRY_LOOP_RESUME(title, id)
+  #define BL_BENCH_LOOP_PAUSE(title, id)                  BL_TELEMETRY_LOOP_PAUSE(title, id)
+  #define BL_BENCH_LOOP_END(title, id, name, n_elem)      BL_TELEMETRY_LOOP_END(title, id, name, n_elem)
+  #define BL_BENCH_START(title)                           BL_TELEMETRY_START(title)
+  #define BL_BENCH_COLLECTIVE_START(title, name, comm)    BL_TELEMETRY_COLLECTIVE_START(title, name, comm)
+  #define BL_BENCH_COLLECTIVE_END(title, name, n_elem, comm)    BL_TELEMETRY_COLLECTIVE_END(title, name, n_elem, comm)
+  #define BL_BENCH_END(title, name, n_elem)               BL_TELEMETRY_END(title, name, n_elem)
+  #define BL_BENCH_ADD_COUNT(title, name, n_elem)         BL_TELEMETRY_ADD_COUNT(title, name, n_elem)
+  #define BL_BENCH_ADD_METRIC(title, name, value)         BL_TELEMETRY_ADD_METRIC(title, name, value)
+  #define BL_BENCH_REPORT(title, rank)                    BL_TELEMETRY_REPORT(title)
+  #define BL_BENCH_REPORT_MPI(title, rank, comm)          BL_TELEMETRY_REPORT_MPI(title, comm)
+  #define BL_BENCH_REPORT_NAMED(title, name)              BL_TELEMETRY_REPORT_NAMED(title, name)
+  #define BL_BENCH_REPORT_MPI_NAMED(title, name, comm)    BL_TELEMETRY_REPORT_MPI_NAMED(title, name, comm)
 
 #else
 
@@ -59,6 +83,8 @@
   #define BL_BENCH_COLLECTIVE_START(title, name, comm)
   #define BL_BENCH_COLLECTIVE_END(title, name, n_elem, comm)
   #define BL_BENCH_END(title, name, n_elem)
+  #define BL_BENCH_ADD_COUNT(title, name, n_elem)
+  #define BL_BENCH_ADD_METRIC(title, name, value)
   #define BL_BENCH_REPORT(title, rank)
   #define BL_BENCH_REPORT_MPI(title, rank, comm)
   #define BL_BENCH_REPORT_NAMED(title, name)
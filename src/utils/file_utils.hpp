@@ -26,6 +26,8 @@
 #define SRC_UTILS_FILE_UTILS_HPP_
 
 #include <string>
+#include <cctype>  // tolower
+#include <sys/stat.h>  // stat
 
 namespace bliss {
   namespace utils {
@@ -40,6 +42,27 @@ namespace bliss {
           return filename.substr(pos + 1);  // from next char to end.
       }
 
+      /// check if the file name has a gzip or BGZF suffix (gz, bgz, bgzf, gzip).  case insensitive.
+      inline bool is_gzip_file(std::string const & filename) {
+        std::string ext = get_file_extension(filename);
+        for (size_t i = 0; i < ext.length(); ++i) ext[i] = tolower(ext[i]);
+        return (ext.compare("gz") == 0) || (ext.compare("bgz") == 0) ||
+            (ext.compare("bgzf") == 0) || (ext.compare("gzip") == 0);
+      }
+
+      /// get the extension of the sequence file, skipping a gzip/BGZF suffix.  e.g. "fastq" for reads.fastq.gz
+      inline std::string get_sequence_file_extension(std::string const & filename) {
+        if (!is_gzip_file(filename)) return get_file_extension(filename);
+        return get_file_extension(filename.substr(0, filename.find_last_of('.')));
+      }
+
+      /// size of the file on disk, in bytes.  0 if it cannot be read.
+      inline size_t get_file_size(std::string const & filename) {
+        struct stat filestat;
+        if (stat(filename.c_str(), &filestat) != 0) return 0;
+        return static_cast<size_t>(filestat.st_size);
+      }
+
       struct NotEOL {
         template <typename CharType>
         bool operator()(CharType const & x) {
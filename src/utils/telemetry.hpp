@@ -0,0 +1,407 @@
+/*
+ * Copyright 2015 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    telemetry.hpp
+ * @ingroup
+ * @author  tpan
+ * @brief   machine readable, runtime switchable phase telemetry.
+ * @details Timer and MemUsage are compiled in or out with BL_BENCHMARK and print tables for people.
+ *          Telemetry is compiled in with BL_TELEMETRY, and is off until enabled at runtime, either with
+ *          the BL_TELEMETRY environment variable or with Telemetry::configure(), using the same spec:
+ *
+ *            json            JSON lines to stdout
+ *            csv             CSV to stdout
+ *            json:<path>     JSON lines appended to <path>
+ *            csv:<path>      CSV appended to <path>.  header is written if the file is empty.
+ *            off, or unset   disabled.
+ *
+ *          each phase (start/end pair) records the duration, element count and change in resident set size.  add_count
+ *          and add_metric attach further values (e.g. bytes, or a ratio) to the last phase.  they are written in that phase's record, as min/max/mean
+ *          only:  an "extra" object in JSON, and name:min:max:mean entries separated by ';' in the last CSV column.
+ *          add_count values also get the min/max/mean of their per rank rate over the phase's duration:  rate_min, rate_max
+ *          and rate_mean in JSON, and :rate_min:rate_max:rate_mean appended to the CSV entry.
+ *          report(title, comm) aggregates them over the communicator and rank 0 writes one record per phase with
+ *          min/max/mean of time, count, per rank throughput and RSS delta, the aggregate throughput
+ *          (total count / max time), and the load imbalance ratios (max / mean) of time and count.
+ *          report(title) writes the calling process's own phases, with ranks = 1.
+ *
+ *          when disabled, each call is a test of a bool that is fixed at construction.  report(title, comm) is collective
+ *          when enabled, so the setting has to be the same on all ranks (e.g. mpirun -x BL_TELEMETRY).
+ */
+#ifndef SRC_UTILS_TELEMETRY_HPP_
+#define SRC_UTILS_TELEMETRY_HPP_
+
+#include "bliss-logger_config.hpp"
+
+#include <chrono>   // clock
+#include <cstdio>   // FILE, fopen
+#include <cstdlib>  // getenv
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <algorithm>  // std::min
+#include <sstream>
+#include <limits>
+
+#include <mxx/reduction.hpp>
+
+// note:  reports in bytes.
+#include "getRSS.h"
+
+namespace plog {
+
+class Telemetry {
+  public:
+    enum format_type { OFF = 0, JSON = 1, CSV = 2 };
+
+  protected:
+    /// process wide output setting.
+    struct config {
+      format_type format;
+      ::std::string path;
+      /// true once the csv header went to stdout.  files get theirs when empty.
+      bool stdout_header;
+
+      config() : format(OFF), path(), stdout_header(false) {
+        char const * spec = ::std::getenv("BL_TELEMETRY");
+        if (spec != nullptr) parse(spec);
+      }
+
+      void parse(::std::string const & spec) {
+        ::std::string fmt = spec.substr(0, spec.find(':'));
+        path = (fmt.length() < spec.length()) ? spec.substr(fmt.length() + 1) : ::std::string();
+
+        if (fmt == "json") format = JSON;
+        else if (fmt == "csv") format = CSV;
+        else format = OFF;
+      }
+    };
+
+    static config & get_config() {
+      static config conf;
+      return conf;
+    }
+
+    /// fixed at construction, so a phase is either fully recorded or not at all.
+    bool on;
+    format_type format;
+
+    std::chrono::steady_clock::time_point t1;
+    size_t rss1;
+    std::vector<std::string> names;
+    std::vector<double> durations;
+    std::vector<double> counts;
+    std::vector<double> rss_deltas;
+    /// values attached to a phase by add_count or add_metric:  phase index, name, value, and whether it has a rate.
+    std::vector<size_t> extra_phases;
+    std::vector<std::string> extra_names;
+    std::vector<double> extra_values;
+    std::vector<bool> extra_counts;
+
+    std::unordered_map<size_t, std::chrono::steady_clock::time_point> loop_t1;
+    std::unordered_map<size_t, std::chrono::duration<double> > loop_span;
+    std::unordered_map<size_t, size_t> loop_rss1;
+
+    void record(::std::string const & name, double const & duration, double const & n_elem, size_t const & rss_start) {
+      names.push_back(name);
+      durations.push_back(duration);
+      counts.push_back(n_elem);
+      rss_deltas.push_back(static_cast<double>(::getCurrentRSS()) - static_cast<double>(rss_start));
+    }
+
+    /// JSON string literal.  phase names are code literals, so only quotes and backslashes are escaped.
+    static ::std::string quote(::std::string const & s) {
+      ::std::string out("\"");
+      for (char c : s) {
+        if ((c == '"') || (c == '\\')) out.push_back('\\');
+        out.push_back(c);
+      }
+      out.push_back('"');
+      return out;
+    }
+
+  public:
+    Telemetry() : on(get_config().format != OFF), format(get_config().format) {
+      reset();
+    }
+
+    /// set the output for Telemetry objects constructed afterwards.  same spec as the BL_TELEMETRY environment variable.
+    static void configure(::std::string const & spec) {
+      get_config().parse(spec);
+    }
+
+    /// true if this object records phases.
+    inline bool enabled() const { return on; }
+
+    void reset() {
+      names.clear();
+      durations.clear();
+      counts.clear();
+      rss_deltas.clear();
+      extra_phases.clear();
+      extra_names.clear();
+      extra_values.clear();
+      extra_counts.clear();
+      loop_t1.clear();
+      loop_span.clear();
+      loop_rss1.clear();
+    }
+
+//=========== loop stuff.
+    void loop_start(size_t const & id) {
+      loop_span[id] = std::chrono::duration<double>::zero();
+      loop_rss1[id] = ::getCurrentRSS();
+      loop_t1[id] = std::chrono::steady_clock::now();
+    }
+    void loop_resume(size_t const & id) {
+      loop_t1[id] = std::chrono::steady_clock::now();
+    }
+    void loop_pause(size_t const & id) {
+      std::chrono::steady_clock::time_point lt2 = std::chrono::steady_clock::now();
+      loop_span[id] += (std::chrono::duration_cast<std::chrono::duration<double> >(lt2 - loop_t1[id]));
+    }
+    void loop_end(size_t const & id, ::std::string const & name, double const & n_elem) {
+      record(name, loop_span[id].count(), n_elem, loop_rss1[id]);
+
+      loop_span.erase(id);
+      loop_t1.erase(id);
+      loop_rss1.erase(id);
+    }
+
+//============ phase start/end
+    void start() {
+      rss1 = ::getCurrentRSS();
+      t1 = std::chrono::steady_clock::now();
+    }
+    void collective_start(::mxx::comm const & comm) {
+      comm.barrier();
+      start();
+    }
+    void end(::std::string const & name, double const & n_elem) {
+      std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+      record(name, (std::chrono::duration_cast<std::chrono::duration<double> >(t2 - t1)).count(), n_elem, rss1);
+    }
+    void collective_end(::std::string const & name, double const & n_elem, ::mxx::comm const & comm) {
+      comm.barrier();
+      end(name, n_elem);
+    }
+    /// attach a value that is not an element count (e.g. a ratio, or seconds spent waiting) to the most recently ended
+    /// phase.  ignored before the first phase ends.
+    void add_metric(::std::string const & name, double const & value) {
+      if (names.empty()) return;
+      extra_phases.push_back(names.size() - 1);
+      extra_names.push_back(name);
+      extra_values.push_back(value);
+      extra_counts.push_back(false);
+    }
+    /// attach another count (e.g. MB) to the most recently ended phase.  written as for add_metric, with its rate.
+    void add_count(::std::string const & name, double const & n_elem) {
+      add_metric(name, n_elem);
+      if (!extra_counts.empty()) extra_counts.back() = true;
+    }
+
+  protected:
+    /// per rank duration, count, rate and rss delta of each phase, then the extra values and their rates, in one vector.
+    std::vector<double> values() const {
+      size_t n = names.size();
+      std::vector<double> vals(4 * n, 0.0);
+      for (size_t i = 0; i < n; ++i) {
+        vals[i] = durations[i];
+        vals[n + i] = counts[i];
+        vals[2 * n + i] = (durations[i] > 0.0) ? (counts[i] / durations[i]) : 0.0;
+        vals[3 * n + i] = rss_deltas[i];
+      }
+      vals.insert(vals.end(), extra_values.begin(), extra_values.end());
+      for (size_t j = 0; j < extra_values.size(); ++j) {
+        double d = durations[extra_phases[j]];
+        vals.push_back((extra_counts[j] && (d > 0.0)) ? (extra_values[j] / d) : 0.0);
+      }
+      return vals;
+    }
+
+    /// write one record per phase, from the min, max and sum of values() over p ranks.
+    void write(::std::string const & title, int p,
+               std::vector<double> const & mins, std::vector<double> const & maxs, std::vector<double> const & sums) const {
+      size_t n = names.size();
+      // offsets of the extra values and of their rates in mins, maxs and sums.
+      size_t e = 4 * n;
+      size_t er = e + extra_values.size();
+
+      std::stringstream output;
+      output.precision(::std::numeric_limits<double>::digits10);
+
+      // field names, in output order.
+      static const char * fields[] = {
+        "time_min", "time_max", "time_mean", "time_imbalance",
+        "count_min", "count_max", "count_mean", "count_total", "count_imbalance",
+        "rate_min", "rate_max", "rate_mean", "rate_aggregate",
+        "rss_delta_min", "rss_delta_max", "rss_delta_mean"
+      };
+      static const size_t n_fields = sizeof(fields) / sizeof(fields[0]);
+
+      FILE * out = stdout;
+      if (!get_config().path.empty()) {
+        out = fopen(get_config().path.c_str(), "a");
+        if (out == nullptr) out = stdout;
+      }
+
+      // csv header, once on stdout or at the start of the output file.
+      bool header = (out == stdout) ? !get_config().stdout_header : ((fseek(out, 0, SEEK_END) == 0) && (ftell(out) == 0));
+      if ((format == CSV) && header) {
+        output << "title,phase,ranks";
+        for (size_t f = 0; f < n_fields; ++f) output << "," << fields[f];
+        output << ",extra" << std::endl;
+        if (out == stdout) get_config().stdout_header = true;
+      }
+
+      double v[n_fields];
+      for (size_t i = 0; i < n; ++i) {
+        double time_mean = sums[i] / p;
+        double count_mean = sums[n + i] / p;
+
+        v[0] = mins[i];
+        v[1] = maxs[i];
+        v[2] = time_mean;
+        v[3] = (time_mean > 0.0) ? (maxs[i] / time_mean) : 1.0;
+        v[4] = mins[n + i];
+        v[5] = maxs[n + i];
+        v[6] = count_mean;
+        v[7] = sums[n + i];
+        v[8] = (count_mean > 0.0) ? (maxs[n + i] / count_mean) : 1.0;
+        v[9] = mins[2 * n + i];
+        v[10] = maxs[2 * n + i];
+        v[11] = sums[2 * n + i] / p;
+        v[12] = (maxs[i] > 0.0) ? (sums[n + i] / maxs[i]) : 0.0;
+        v[13] = mins[3 * n + i];
+        v[14] = maxs[3 * n + i];
+        v[15] = sums[3 * n + i] / p;
+
+        if (format == JSON) {
+          output << "{\"title\":" << quote(title) << ",\"phase\":" << quote(names[i]) << ",\"ranks\":" << p;
+          for (size_t f = 0; f < n_fields; ++f) output << ",\"" << fields[f] << "\":" << v[f];
+          bool first = true;
+          for (size_t j = 0; j < extra_phases.size(); ++j) {
+            if (extra_phases[j] != i) continue;
+            output << (first ? ",\"extra\":{" : ",") << quote(extra_names[j]) << ":{\"min\":" << mins[e + j] <<
+                ",\"max\":" << maxs[e + j] << ",\"mean\":" << (sums[e + j] / p);
+            if (extra_counts[j])
+              output << ",\"rate_min\":" << mins[er + j] << ",\"rate_max\":" << maxs[er + j] << ",\"rate_mean\":" << (sums[er + j] / p);
+            output << "}";
+            first = false;
+          }
+          if (!first) output << "}";
+          output << "}" << std::endl;
+        } else {
+          output << title << "," << names[i] << "," << p;
+          for (size_t f = 0; f < n_fields; ++f) output << "," << v[f];
+          output << ",";
+          bool first = true;
+          for (size_t j = 0; j < extra_phases.size(); ++j) {
+            if (extra_phases[j] != i) continue;
+            output << (first ? "" : ";") << extra_names[j] << ":" << mins[e + j] << ":" << maxs[e + j] << ":" << (sums[e + j] / p);
+            if (extra_counts[j])
+              output << ":" << mins[er + j] << ":" << maxs[er + j] << ":" << (sums[er + j] / p);
+            first = false;
+          }
+          output << std::endl;
+        }
+      }
+
+      // print pending stuff, then print entire string at once (minimizes multiple threads/processes mixing output )
+      fflush(out);
+      fputs(output.str().c_str(), out);
+      fflush(out);
+      if (out != stdout) fclose(out);
+    }
+
+  public:
+    /**
+     * @brief aggregate the phases over comm, and write one record per phase from rank 0.  collective.
+     * @details  all ranks need to have recorded the same phases, as for Timer::report.
+     */
+    void report(::std::string const & title, ::mxx::comm const & comm) {
+      if (names.empty()) return;
+
+      // 3 reductions over all phases.
+      std::vector<double> vals = values();
+      std::vector<double> mins = ::mxx::reduce(vals, 0,
+          [](double const & x, double const & y) { return ::std::min(x, y); }, comm);
+      std::vector<double> maxs = ::mxx::reduce(vals, 0,
+          [](double const & x, double const & y) { return ::std::max(x, y); }, comm);
+      std::vector<double> sums = ::mxx::reduce(vals, 0, ::std::plus<double>(), comm);
+
+      if (comm.rank() == 0) write(title, comm.size(), mins, maxs, sums);
+      comm.barrier();
+    }
+
+    /// write this process's phases, with ranks = 1.  not collective:  every caller writes its own records.
+    void report(::std::string const & title) const {
+      if (names.empty()) return;
+
+      std::vector<double> vals = values();
+      write(title, 1, vals, vals, vals);
+    }
+
+};
+
+} // end namespace plog
+
+#if BL_TELEMETRY == 1
+
+// arguments are only evaluated when telemetry is enabled at runtime.
+#define BL_TELEMETRY_INIT(title)      ::plog::Telemetry title##_telemetry;
+#define BL_TELEMETRY_RESET(title)     do { if (title##_telemetry.enabled()) title##_telemetry.reset(); } while (0)
+
+#define BL_TELEMETRY_LOOP_START(title, id)     do { if (title##_telemetry.enabled()) title##_telemetry.loop_start(id); } while (0)
+#define BL_TELEMETRY_LOOP_RESUME(title, id)    do { if (title##_telemetry.enabled()) title##_telemetry.loop_resume(id); } while (0)
+#define BL_TELEMETRY_LOOP_PAUSE(title, id)     do { if (title##_telemetry.enabled()) title##_telemetry.loop_pause(id); } while (0)
+#define BL_TELEMETRY_LOOP_END(title, id, name, n_elem) do { if (title##_telemetry.enabled()) title##_telemetry.loop_end(id, name, n_elem); } while (0)
+
+#define BL_TELEMETRY_START(title)     do { if (title##_telemetry.enabled()) title##_telemetry.start(); } while (0)
+#define BL_TELEMETRY_END(title, name, n_elem) do { if (title##_telemetry.enabled()) title##_telemetry.end(name, n_elem); } while (0)
+#define BL_TELEMETRY_ADD_COUNT(title, name, n_elem) do { if (title##_telemetry.enabled()) title##_telemetry.add_count(name, n_elem); } while (0)
+#define BL_TELEMETRY_ADD_METRIC(title, name, value) do { if (title##_telemetry.enabled()) title##_telemetry.add_metric(name, value); } while (0)
+#define BL_TELEMETRY_COLLECTIVE_START(title, name, comm) do { if (title##_telemetry.enabled()) title##_telemetry.collective_start(comm); } while (0)
+#define BL_TELEMETRY_COLLECTIVE_END(title, name, n_elem, comm) do { if (title##_telemetry.enabled()) title##_telemetry.collective_end(name, n_elem, comm); } while (0)
+#define BL_TELEMETRY_REPORT(title)    do { if (title##_telemetry.enabled()) title##_telemetry.report(#title); } while (0)
+#define BL_TELEMETRY_REPORT_NAMED(title, name) do { if (title##_telemetry.enabled()) title##_telemetry.report(name); } while (0)
+#define BL_TELEMETRY_REPORT_MPI(title, comm) do { if (title##_telemetry.enabled()) title##_telemetry.report(#title, comm); } while (0)
+#define BL_TELEMETRY_REPORT_MPI_NAMED(title, name, comm) do { if (title##_telemetry.enabled()) title##_telemetry.report(name, comm); } while (0)
+
+#else
+
+#define BL_TELEMETRY_INIT(title)
+#define BL_TELEMETRY_RESET(title)
+#define BL_TELEMETRY_LOOP_START(title, id)
+#define BL_TELEMETRY_LOOP_RESUME(title, id)
+#define BL_TELEMETRY_LOOP_PAUSE(title, id)
+#define BL_TELEMETRY_LOOP_END(title, id, name, n_elem)
+#define BL_TELEMETRY_START(title)
+#define BL_TELEMETRY_END(title, name, n_elem)
+#define BL_TELEMETRY_ADD_COUNT(title, name, n_elem)
+#define BL_TELEMETRY_ADD_METRIC(title, name, value)
+#define BL_TELEMETRY_COLLECTIVE_START(title, name, comm)
+#define BL_TELEMETRY_COLLECTIVE_END(title, name, n_elem, comm)
+#define BL_TELEMETRY_REPORT(title)
+#define BL_TELEMETRY_REPORT_NAMED(title, name)
+#define BL_TELEMETRY_REPORT_MPI(title, comm)
+#define BL_TELEMETRY_REPORT_MPI_NAMED(title, name, comm)
+
+#endif
+
+
+#endif /* SRC_UTILS_TELEMETRY_HPP_ */
@@ -50,6 +50,11 @@ class Timer {
     std::vector<double> durations;
     std::vector<double> cumulative;
     std::vector<double> counts;
+    /// values attached to a phase by add_count or add_metric, labeled "phase:name".  not phases themselves.
+    std::vector<std::string> extra_names;
+    std::vector<double> extra_values;
+    /// duration of the phase an add_count value belongs to, for its rate.  0 for add_metric values, which have no rate.
+    std::vector<double> extra_durations;
     std::chrono::duration<double> time_span;
 
     std::unordered_map<size_t, std::chrono::steady_clock::time_point> loop_t1;
@@ -65,6 +70,9 @@ class Timer {
       durations.clear();
       cumulative.clear();
       counts.clear();
+      extra_names.clear();
+      extra_values.clear();
+      extra_durations.clear();
 
       first = std::chrono::steady_clock::now();
       loop_t1.clear();
@@ -129,6 +137,36 @@ class Timer {
 
 		end(name, n_elem);
     }
+    /// attach a value that is not an element count (e.g. a ratio, or seconds spent waiting) to the most recently ended
+    /// interval.  reported separately from the phases, without a rate.
+    void add_metric(::std::string const & name, double const & value) {
+      extra_names.push_back(names.empty() ? name : names.back() + ":" + name);
+      extra_values.push_back(value);
+      extra_durations.push_back(0.0);
+    }
+    /// attach another count (e.g. MB) to the most recently ended interval.  reported as for add_metric, with a rate
+    /// over that interval's duration.
+    void add_count(::std::string const & name, double const & n_elem) {
+      add_metric(name, n_elem);
+      if (!durations.empty()) extra_durations.back() = durations.back();
+    }
+
+    /// per entry throughput, count / duration.
+    std::vector<double> rates() const {
+      std::vector<double> r(counts.size(), 0.0);
+      for (size_t i = 0; i < counts.size(); ++i) {
+        if (durations[i] > 0.0) r[i] = counts[i] / durations[i];
+      }
+      return r;
+    }
+    /// throughput of the attached counts, count / duration of their interval.  0 for metrics.
+    std::vector<double> extra_rates() const {
+      std::vector<double> r(extra_values.size(), 0.0);
+      for (size_t i = 0; i < extra_values.size(); ++i) {
+        if (extra_durations[i] > 0.0) r[i] = extra_values[i] / extra_durations[i];
+      }
+      return r;
+    }
     void report(::std::string const & title) {
         std::stringstream output;
 
@@ -153,8 +191,31 @@ class Timer {
         output.precision(0);
         output << "[TIME] " << title << "\tcount\t[,";
         std::copy(counts.begin(), counts.end(), dit);
+        output << "]" << ::std::endl;
+
+        std::vector<double> rts = rates();
+        output.precision(2);
+        output << "[TIME] " << title << "\trate (/s)\t[,";
+        std::copy(rts.begin(), rts.end(), dit);
         output << "]";
 
+        if (extra_names.size() > 0) {
+          output.precision(9);
+          output << std::endl << "[TIME] " << title << "\textra\t[,";
+          std::copy(extra_names.begin(), extra_names.end(), nit);
+          output << "]" << std::endl;
+
+          output << "[TIME] " << title << "\textra_value\t[,";
+          std::copy(extra_values.begin(), extra_values.end(), dit);
+          output << "]" << std::endl;
+
+          std::vector<double> extra_rts = extra_rates();
+          output.precision(2);
+          output << "[TIME] " << title << "\textra_rate (/s)\t[,";
+          std::copy(extra_rts.begin(), extra_rts.end(), dit);
+          output << "]";
+        }
+
         // print pending stuff, then print entire string at once (minimizes multiple threads/processes mixing output )
         fflush(stdout);
         printf("%s\n", output.str().c_str());
@@ -266,11 +327,22 @@ class Timer {
       std::vector<double> dur_mins, dur_maxs, dur_means, dur_stdevs;
       std::vector<double> cum_mins, cum_maxs, cum_means, cum_stdevs;
       std::vector<double> cnt_mins, cnt_maxs, cnt_means, cnt_stdevs;
+      std::vector<double> rate_mins, rate_maxs, rate_means;
+      std::vector<double> extra_mins, extra_maxs, extra_means;
+      std::vector<double> extra_rate_mins, extra_rate_maxs, extra_rate_means;
       int p = comm.size();
       int rank = comm.rank();
 
       if (durations.size() > 0) {
 
+        // per rank throughput, before durations and counts are squared below.
+        std::vector<double> rts = rates();
+        rate_mins = ::mxx::reduce(rts, 0,
+            [](double const & x, double const & y) { return ::std::min(x, y); }, comm);
+        rate_maxs = ::mxx::reduce(rts, 0,
+            [](double const & x, double const & y) { return ::std::max(x, y); }, comm);
+        rate_means = ::mxx::reduce(rts, 0, ::std::plus<double>(), comm);
+
     	  dur_mins = ::mxx::reduce(durations, 0,
     			[](double const & x, double const & y) { return ::std::min(x, y); }, comm);
         dur_maxs = ::mxx::reduce(durations, 0,
@@ -297,6 +369,23 @@ class Timer {
         ::std::for_each(counts.begin(), counts.end(), [](double &x) { x = x*x; });
         cnt_stdevs = ::mxx::reduce(counts, 0, ::std::plus<double>(), comm);
 
+        // every rank attaches the same extra values, as for the phases.
+        if (extra_values.size() > 0) {
+          extra_mins = ::mxx::reduce(extra_values, 0,
+              [](double const & x, double const & y) { return ::std::min(x, y); }, comm);
+          extra_maxs = ::mxx::reduce(extra_values, 0,
+              [](double const & x, double const & y) { return ::std::max(x, y); }, comm);
+          extra_means = ::mxx::reduce(extra_values, 0, ::std::plus<double>(), comm);
+
+          // per rank throughput of the attached counts, as for the phases.
+          std::vector<double> extra_rts = extra_rates();
+          extra_rate_mins = ::mxx::reduce(extra_rts, 0,
+              [](double const & x, double const & y) { return ::std::min(x, y); }, comm);
+          extra_rate_maxs = ::mxx::reduce(extra_rts, 0,
+              [](double const & x, double const & y) { return ::std::max(x, y); }, comm);
+          extra_rate_means = ::mxx::reduce(extra_rts, 0, ::std::plus<double>(), comm);
+        }
+
         if (rank == 0) {
 
           ::std::for_each(dur_means.begin(), dur_means.end(), [&p](double & x) { x /= p; });
@@ -310,6 +399,10 @@ class Timer {
           ::std::for_each(cnt_means.begin(), cnt_means.end(), [&p](double & x) { x /= p; });
           ::std::transform(cnt_stdevs.begin(), cnt_stdevs.end(), cnt_means.begin(), cnt_stdevs.begin(),
                            [&p](double const & x, double const & y) { return ::std::sqrt(x / p - y * y); });
+
+          ::std::for_each(rate_means.begin(), rate_means.end(), [&p](double & x) { x /= p; });
+          ::std::for_each(extra_means.begin(), extra_means.end(), [&p](double & x) { x /= p; });
+          ::std::for_each(extra_rate_means.begin(), extra_rate_means.end(), [&p](double & x) { x /= p; });
         }
 
 
@@ -380,8 +473,52 @@ class Timer {
 
           output << "[TIME] " << title << "\tcnt_stdev\t[,";
           std::copy(cnt_stdevs.begin(), cnt_stdevs.end(), dit);
+          output << "]" << std::endl;
+
+          output << "[TIME] " << title << "\trate_min (/s)\t[,";
+          std::copy(rate_mins.begin(), rate_mins.end(), dit);
+          output << "]" << std::endl;
+
+          output << "[TIME] " << title << "\trate_max (/s)\t[,";
+          std::copy(rate_maxs.begin(), rate_maxs.end(), dit);
+          output << "]" << std::endl;
+
+          output << "[TIME] " << title << "\trate_mean (/s)\t[,";
+          std::copy(rate_means.begin(), rate_means.end(), dit);
           output << "]";
 
+          if (extra_names.size() > 0) {
+            output.precision(9);
+            output << std::endl << "[TIME] " << title << "\textra\t[,";
+            std::copy(extra_names.begin(), extra_names.end(), nit);
+            output << "]" << std::endl;
+
+            output << "[TIME] " << title << "\textra_min\t[,";
+            std::copy(extra_mins.begin(), extra_mins.end(), dit);
+            output << "]" << std::endl;
+
+            output << "[TIME] " << title << "\textra_max\t[,";
+            std::copy(extra_maxs.begin(), extra_maxs.end(), dit);
+            output << "]" << std::endl;
+
+            output << "[TIME] " << title << "\textra_mean\t[,";
+            std::copy(extra_means.begin(), extra_means.end(), dit);
+            output << "]" << std::endl;
+
+            output.precision(2);
+            output << "[TIME] " << title << "\textra_rate_min (/s)\t[,";
+            std::copy(extra_rate_mins.begin(), extra_rate_mins.end(), dit);
+            output << "]" << std::endl;
+
+            output << "[TIME] " << title << "\textra_rate_max (/s)\t[,";
+            std::copy(extra_rate_maxs.begin(), extra_rate_maxs.end(), dit);
+            output << "]" << std::endl;
+
+            output << "[TIME] " << title << "\textra_rate_mean (/s)\t[,";
+            std::copy(extra_rate_means.begin(), extra_rate_means.end(), dit);
+            output << "]";
+          }
+
           fflush(stdout);
           printf("%s\n", output.str().c_str());
           fflush(stdout);
@@ -405,6 +542,8 @@ class Timer {
 
 #define BL_TIMER_START(title)     do { title##_timer.start(); } while (0)
 #define BL_TIMER_END(title, name, n_elem) do { title##_timer.end(name, n_elem); } while (0)
+#define BL_TIMER_ADD_COUNT(title, name, n_elem) do { title##_timer.add_count(name, n_elem); } while (0)
+#define BL_TIMER_ADD_METRIC(title, name, value) do { title##_timer.add_metric(name, value); } while (0)
 #define BL_TIMER_COLLECTIVE_START(title, name, comm) do { title##_timer.collective_start(name, comm); } while (0)
 #define BL_TIMER_COLLECTIVE_END(title, name, n_elem, comm) do { title##_timer.collective_end(name, n_elem, comm); } while (0)
 #define BL_TIMER_REPORT(title) do { title##_timer.report(#title); } while (0)
@@ -429,6 +568,8 @@ class Timer {
 #define BL_TIMER_LOOP_END(title, id, name, n_elem)
 #define BL_TIMER_START(title)
 #define BL_TIMER_END(title, name, n_elem)
+#define BL_TIMER_ADD_COUNT(title, name, n_elem)
+#define BL_TIMER_ADD_METRIC(title, name, value)
 #define BL_TIMER_COLLECTIVE_START(title, name, comm)
 #define BL_TIMER_COLLECTIVE_END(title, name, n_elem, comm)
 #define BL_TIMER_REPORT(title)
@@ -17,6 +17,8 @@
 #include "containers/unordered_vecmap.hpp"
 //#include "containers/hashed_vecmap.hpp"
 #include "containers/densehash_map.hpp"
+#include "containers/swiss_map.hpp"
+#include "containers/fsc_container_utils.hpp"  // prefetch_for_each
 
 #include "common/kmer.hpp"
 #include "common/kmer_transform.hpp"
@@ -350,6 +352,100 @@ void benchmark_unordered_vecmap(size_t const count, size_t const query_frac, ::m
 //  BL_BENCH_REPORT_MPI_NAMED(map, "hashed_vecmap", comm);
 //}
 
+template <typename Kmer, typename Value>
+void benchmark_swiss_map(size_t const count, size_t const query_frac, ::mxx::comm const & comm, float max_load = 0.875f) {
+  BL_BENCH_INIT(map);
+
+  std::vector<Kmer> query;
+
+  BL_BENCH_START(map);
+  // no transform involved.  no special keys needed.
+  ::fsc::swiss_map<Kmer, Value, ::bliss::kmer::hash::farm<Kmer, false> > map;
+  map.max_load_factor(max_load);
+  map.reserve(count);
+  BL_BENCH_END(map, "reserve", map.bucket_count());
+
+  {
+    std::vector<::std::pair<Kmer, Value> > input(count);
+
+    generate_input(input, count);
+    query.resize(count / query_frac);
+    std::transform(input.begin(), input.begin() + input.size() / query_frac, query.begin(),
+                   [](::std::pair<Kmer, Value> const & x){
+      return x.first;
+    });
+
+    // one element at a time, then batched with prefetching, on a second table of the same size.
+    BL_BENCH_START(map);
+    for (auto it = input.begin(); it != input.end(); ++it) map.emplace(*it);
+    BL_BENCH_END(map, "insert", map.size());
+
+    ::fsc::swiss_map<Kmer, Value, ::bliss::kmer::hash::farm<Kmer, false> > batched;
+    batched.max_load_factor(max_load);
+    batched.reserve(count);
+
+    BL_BENCH_START(map);
+    batched.insert(input.begin(), input.end());
+    BL_BENCH_END(map, "insert_batch", batched.size());
+  }
+
+  BL_BENCH_START(map);
+  size_t result = 0;
+  for (size_t i = 0, max = count / query_frac; i < max; ++i) {
+    auto iters = map.equal_range(query[i]);
+    for (auto it = iters.first; it != iters.second; ++it)
+      result ^= it->second;
+  }
+  BL_BENCH_END(map, "find", result);
+
+  BL_BENCH_START(map);
+  {
+    std::vector<::std::pair<Kmer, Value> > found;
+    found.reserve(query.size());
+    map.find(query.begin(), query.end(), ::std::back_inserter(found));
+    result = 0;
+    for (auto it = found.begin(); it != found.end(); ++it) result ^= it->second;
+  }
+  BL_BENCH_END(map, "find_batch", result);
+
+  BL_BENCH_START(map);
+  result = 0;
+  for (size_t i = 0, max = count / query_frac; i < max; ++i) {
+    result += map.count(query[i]);
+  }
+  BL_BENCH_END(map, "count", result);
+
+  BL_BENCH_START(map);
+  {
+    std::vector<::std::pair<Kmer, size_t> > counts;
+    counts.reserve(query.size());
+    map.count(query.begin(), query.end(), ::std::back_inserter(counts));
+    result = 0;
+    for (auto it = counts.begin(); it != counts.end(); ++it) result += it->second;
+  }
+  BL_BENCH_END(map, "count_batch", result);
+
+  BL_BENCH_START(map);
+  {
+    // per-query lookups pipelined with the prefetch hint, as in the distributed maps' query processing.
+    result = 0;
+    ::fsc::prefetch_for_each(map, query.begin(), query.end(), [&map, &result](Kmer const & k) {
+      result += map.count(k);
+    });
+  }
+  BL_BENCH_END(map, "count_prefetch", result);
+
+  BL_BENCH_START(map);
+  result = 0;
+  for (size_t i = 0, max = count / query_frac; i < max; ++i) {
+    result += map.erase(query[i]);
+  }
+  BL_BENCH_END(map, "erase", result);
+
+  BL_BENCH_REPORT_MPI_NAMED(map, "swiss_map", comm);
+}
+
+
 template <typename Kmer, typename Value>
 void benchmark_densehash_map(size_t const count, size_t const query_frac, ::mxx::comm const & comm) {
   BL_BENCH_INIT(map);
@@ -380,9 +476,18 @@ void benchmark_densehash_map(size_t const count, size_t const query_frac, ::mxx:
     });
 //    BL_BENCH_END(map, "generate input", input.size());
 
+    // one element at a time, then batched with prefetching, on a second table of the same size.
     BL_BENCH_START(map);
-    map.insert(input.begin(), input.end());
+    for (auto it = input.begin(); it != input.end(); ++it) map.emplace(*it);
     BL_BENCH_END(map, "insert", map.size());
+
+    ::fsc::swiss_map<Kmer, Value, ::bliss::kmer::hash::farm<Kmer, false> > batched;
+    batched.max_load_factor(max_load);
+    batched.reserve(count);
+
+    BL_BENCH_START(map);
+    batched.insert(input.begin(), input.end());
+    BL_BENCH_END(map, "insert_batch", batched.size());
   }
 
   BL_BENCH_START(map);
@@ -394,6 +499,16 @@ void benchmark_densehash_map(size_t const count, size_t const query_frac, ::mxx:
   }
   BL_BENCH_END(map, "find", result);
 
+  BL_BENCH_START(map);
+  {
+    std::vector<::std::pair<Kmer, Value> > found;
+    found.reserve(query.size());
+    map.find(query.begin(), query.end(), ::std::back_inserter(found));
+    result = 0;
+    for (auto it = found.begin(); it != found.end(); ++it) result ^= it->second;
+  }
+  BL_BENCH_END(map, "find_batch", result);
+
   BL_BENCH_START(map);
   result = 0;
   for (size_t i = 0, max = count / query_frac; i < max; ++i) {
@@ -401,6 +516,26 @@ void benchmark_densehash_map(size_t const count, size_t const query_frac, ::mxx:
   }
   BL_BENCH_END(map, "count", result);
 
+  BL_BENCH_START(map);
+  {
+    std::vector<::std::pair<Kmer, size_t> > counts;
+    counts.reserve(query.size());
+    map.count(query.begin(), query.end(), ::std::back_inserter(counts));
+    result = 0;
+    for (auto it = counts.begin(); it != counts.end(); ++it) result += it->second;
+  }
+  BL_BENCH_END(map, "count_batch", result);
+
+  BL_BENCH_START(map);
+  {
+    // per-query lookups pipelined with the prefetch hint, as in the distributed maps' query processing.
+    result = 0;
+    ::fsc::prefetch_for_each(map, query.begin(), query.end(), [&map, &result](Kmer const & k) {
+      result += map.count(k);
+    });
+  }
+  BL_BENCH_END(map, "count_prefetch", result);
+
   BL_BENCH_START(map);
   result = map.erase(query.begin(), query.end());
 
@@ -1203,6 +1338,18 @@ int main(int argc, char** argv) {
   benchmark_densehash_map<DNA5Kmer, size_t>(count, query_frac, comm);
   BL_BENCH_COLLECTIVE_END(test, "densehash_map_DNA5", count, comm);
 
+  BL_BENCH_START(test);
+  benchmark_swiss_map<Kmer, size_t>(count, query_frac, comm);
+  BL_BENCH_COLLECTIVE_END(test, "swiss_map", count, comm);
+
+  BL_BENCH_START(test);
+  benchmark_swiss_map<Kmer, size_t>(count, query_frac, comm, 0.95f);
+  BL_BENCH_COLLECTIVE_END(test, "swiss_map_0.95", count, comm);
+
+  BL_BENCH_START(test);
+  benchmark_swiss_map<FullKmer, size_t>(count, query_frac, comm);
+  BL_BENCH_COLLECTIVE_END(test, "swiss_full_map", count, comm);
+
   BL_BENCH_START(test);
   benchmark_densehash_full_map<FullKmer, size_t, true>(count, query_frac, comm);
   BL_BENCH_COLLECTIVE_END(test, "densehash_full_map_canonical", count, comm);
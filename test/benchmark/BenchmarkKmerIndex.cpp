@@ -59,6 +59,8 @@
 #include "index/quality_score_iterator.hpp"
 
 #include "index/kmer_index.hpp"
+#include "containers/unordered_csr_multimap.hpp"
+#include "containers/swiss_map.hpp"
 
 #include "utils/benchmark_utils.hpp"
 #include "utils/exception_handling.hpp"
@@ -92,6 +94,10 @@
 #define HASHEDVEC 45
 #define UNORDERED 46
 #define DENSEHASH 47
+#define THREADED 48
+#define PREFIX 49  // sorted map, frozen with a prefix offset table before the queries.
+#define CSR 50  // unordered multimap with compact CSR local storage.  POS values are delta + varint coded.
+#define SWISS 54  // unordered map with fsc::swiss_map local storage, which takes the prefetching insert and query paths.  COUNT only.
 
 #define SINGLE 51
 #define CANONICAL 52
@@ -194,9 +200,18 @@ using CountType = uint32_t;
 
 
 // ==== define Map parameter
-#if (pMAP == SORTED)
+#if (pMAP == SORTED) || (pMAP == PREFIX)
 	// choose a MapParam based on type of map and kmer model (canonical, original, bimolecule)
-	#if (pKmerStore == SINGLE)  // single stranded
+	#if (pMAP == PREFIX) && (pKmerStore == SINGLE)
+		template <typename Key>
+		using MapParams = ::bliss::index::kmer::SingleStrandPrefixSortedMapParams<Key>;
+	#elif (pMAP == PREFIX) && (pKmerStore == CANONICAL)
+		template <typename Key>
+		using MapParams = ::bliss::index::kmer::CanonicalPrefixSortedMapParams<Key>;
+	#elif (pMAP == PREFIX) && (pKmerStore == BIMOLECULE)
+		template <typename Key>
+		using MapParams = ::bliss::index::kmer::BimoleculePrefixSortedMapParams<Key>;
+	#elif (pKmerStore == SINGLE)  // single stranded
 		template <typename Key>
 		using MapParams = ::bliss::index::kmer::SingleStrandSortedMapParams<Key>;
 	#elif (pKmerStore == CANONICAL)
@@ -274,14 +289,36 @@ using CountType = uint32_t;
 //    #elif (pMAP == HASHEDVEC)
 //      using MapType = ::dsc::unordered_multimap_hashvec<
 //          KmerType, ValType, MapParams>;
+    #elif (pMAP == THREADED)
+      using MapType = ::dsc::unordered_multimap<
+          KmerType, ValType, MapParams, ::std::allocator<::std::pair<const KmerType, ValType> >,
+          ::fsc::thread_partitioned<::std::unordered_multimap>::template type>;
+    #elif (pMAP == CSR) && (pINDEX == POS)
+      using MapType = ::dsc::unordered_multimap<
+          KmerType, ValType, MapParams, ::std::allocator<::std::pair<const KmerType, ValType> >,
+          ::fsc::unordered_csr_delta_multimap>;
+    #elif (pMAP == CSR)
+      using MapType = ::dsc::unordered_multimap<
+          KmerType, ValType, MapParams, ::std::allocator<::std::pair<const KmerType, ValType> >,
+          ::fsc::unordered_csr_multimap>;
     #elif (pMAP == DENSEHASH)
       using MapType = ::dsc::densehash_multimap<
           KmerType, ValType, MapParams, SpecialKeys>;
+    #elif (pMAP == SWISS)
+      #error "swiss_map is not a multimap.  use pMAP=SWISS with pINDEX=COUNT."
     #endif
   #elif (pINDEX == COUNT)  // map
     #if (pMAP == DENSEHASH)
       using MapType = ::dsc::counting_densehash_map<
         KmerType, ValType, MapParams, SpecialKeys>;
+    #elif (pMAP == THREADED)
+      using MapType = ::dsc::counting_unordered_map<
+        KmerType, ValType, MapParams, ::std::allocator<::std::pair<const KmerType, ValType> >,
+        ::fsc::thread_partitioned<::std::unordered_map>::template type>;
+    #elif (pMAP == SWISS)
+      using MapType = ::dsc::counting_unordered_map<
+        KmerType, ValType, MapParams, ::std::allocator<::std::pair<const KmerType, ValType> >,
+        ::fsc::swiss_map>;
     #else
       using MapType = ::dsc::counting_unordered_map<
         KmerType, ValType, MapParams>;
@@ -303,7 +340,12 @@ using CountType = uint32_t;
   using IndexType = bliss::index::kmer::PositionQualityIndex<MapType>;
 
 #elif (pINDEX == COUNT)  // map
+  #if (pKmerStore == CANONICAL)
+	// kmers are canonicalized during parsing, so insert skips transform_input.
+	using IndexType = bliss::index::kmer::CanonicalKmerIndex<MapType>;
+  #else
 	using IndexType = bliss::index::kmer::CountIndex<MapType>;
+  #endif
 #endif
 
 
@@ -428,6 +470,14 @@ int main(int argc, char** argv) {
   int sample_ratio = 100;
 
   int reader_algo = -1;
+  size_t chunk_bytes = 0;
+  int solid = 0;
+  int nthreads = 1;
+  int reserve_precision = 0;
+  size_t combiner_capacity = 0;
+#if (pMAP == SWISS)
+  bool single_hash = false;
+#endif
   // Wrap everything in a try block.  Do this every time,
   // because exceptions will be thrown for problems.
   try {
@@ -447,9 +497,35 @@ int main(int argc, char** argv) {
     TCLAP::ValueArg<std::string> queryArg("Q", "query", "FASTQ file path for query. default to same file as index file", false, "", "string", cmd);
 
     TCLAP::ValueArg<int> algoArg("A",
-                                 "algo", "Reader Algorithm id. Fileloader w/o preload = 2, mmap = 5, posix=7, piio = 10. default is 7.",
+                                 "algo", "Reader Algorithm id. Fileloader w/o preload = 2, gzip/BGZF = 4, mmap = 5, windowed mmap (streaming only, needs chunk-bytes) = 6, posix=7, piio = 10. default is 7.",
                                  false, 7, "int", cmd);
 
+    TCLAP::ValueArg<size_t> chunkArg("C",
+                                 "chunk-bytes", "streaming build: max bytes of parsed kmers per rank per insert. 0 = read whole partition first. default=0",
+                                 false, chunk_bytes, "size_t", cmd);
+
+    TCLAP::ValueArg<int> solidArg("L",
+                                 "solid", "streaming build: keep only kmers that occur at least this many times (at most 15), counted in a first pass.  count index only. 0 = keep all. default=0",
+                                 false, solid, "int", cmd);
+
+    TCLAP::ValueArg<int> threadsArg("T",
+                                 "threads", "threads per rank for kmer parsing.  requires OpenMP. 0 = all available. default=1",
+                                 false, nthreads, "int", cmd);
+
+    TCLAP::ValueArg<size_t> combinerArg("B",
+                                 "combiner", "count index: table slots of the local combiner that counts duplicate kmers before they are sent (at least 16). 0 = send every kmer. default=0",
+                                 false, combiner_capacity, "size_t", cmd);
+
+    TCLAP::ValueArg<int> reserveArg("E",
+                                 "reserve-estimation", "HyperLogLog precision (4 to 18) for sizing the local hash tables by the distinct kmers received.  costs an extra hash pass per insert. 0 = reserve for all received kmers. default=0",
+                                 false, reserve_precision, "int", cmd);
+
+#if (pMAP == SWISS)
+    TCLAP::SwitchArg singleHashArg("H",
+                                 "single-hash", "hash each kmer once, with the storage hash:  the rank from its high bits, the swiss_map slot from its low bits.  the hash is sent with the kmer. default=off",
+                                 cmd, single_hash);
+#endif
+
     TCLAP::ValueArg<int> sampleArg("S",
                                  "query-sample", "sampling ratio for the query kmers. default=100",
                                  false, sample_ratio, "int", cmd);
@@ -466,6 +542,17 @@ int main(int argc, char** argv) {
     filename = fileArg.getValue();
     reader_algo = algoArg.getValue();
     sample_ratio = sampleArg.getValue();
+    chunk_bytes = chunkArg.getValue();
+    solid = solidArg.getValue();
+    if ((solid < 0) || (solid > 15)) throw TCLAP::ArgException("must be between 0 and 15", solidArg.longID());
+    nthreads = threadsArg.getValue();
+    reserve_precision = reserveArg.getValue();
+    if ((reserve_precision != 0) && ((reserve_precision < 4) || (reserve_precision > 18))) throw TCLAP::ArgException("must be 0, or between 4 and 18", reserveArg.longID());
+    combiner_capacity = combinerArg.getValue();
+    if ((combiner_capacity != 0) && (combiner_capacity < 16)) throw TCLAP::ArgException("must be 0, or at least 16", combinerArg.longID());
+#if (pMAP == SWISS)
+    single_hash = singleHashArg.getValue();
+#endif
 
     // set the default for query to filename, and reparse
 
@@ -485,6 +572,14 @@ int main(int argc, char** argv) {
 
   // ================  read and get file
   IndexType idx(comm);
+  idx.get_map().set_reserve_estimation(reserve_precision);
+  idx.get_map().set_local_combiner(combiner_capacity);
+#if (pMAP == SWISS)
+  if (single_hash) {
+    if (comm.rank() == 0) printf("single hash mode\n");
+    idx.get_map().set_single_hash(true);
+  }
+#endif
 
   BL_BENCH_INIT(test);
 
@@ -498,7 +593,38 @@ int main(int argc, char** argv) {
   BL_BENCH_COLLECTIVE_END(test, "sample", query.size(), comm);
 
 
-  {
+  if (chunk_bytes > 0) {
+	  if (solid > 1) {
+		if (comm.rank() == 0) printf("solid kmer build, threshold %d\n", solid);
+		idx.set_solid_build(solid);
+	  }
+
+	  BL_BENCH_START(test);
+	  if (reader_algo == 4) {
+		if (comm.rank() == 0) printf("streaming %s via gzip, chunk %lu bytes\n", filename.c_str(), chunk_bytes);
+		idx.build_gzip<PARSER_TYPE, bliss::io::SequencesIterator>(filename, comm, chunk_bytes, nthreads);
+	  } else if (reader_algo == 5) {
+		if (comm.rank() == 0) printf("streaming %s via mmap, chunk %lu bytes\n", filename.c_str(), chunk_bytes);
+		idx.build_mmap<PARSER_TYPE, bliss::io::SequencesIterator>(filename, comm, chunk_bytes, nthreads);
+	  } else if (reader_algo == 6) {
+		if (comm.rank() == 0) printf("streaming %s via windowed mmap, chunk %lu bytes\n", filename.c_str(), chunk_bytes);
+		idx.build_chunked<::bliss::io::parallel::partitioned_file<::bliss::io::windowed_mmap_file, PARSER_TYPE>,
+		  PARSER_TYPE, bliss::io::SequencesIterator>(filename, chunk_bytes, comm, nthreads);
+	  } else if (reader_algo == 7) {
+		if (comm.rank() == 0) printf("streaming %s via posix, chunk %lu bytes\n", filename.c_str(), chunk_bytes);
+		idx.build_posix<PARSER_TYPE, bliss::io::SequencesIterator>(filename, comm, chunk_bytes, nthreads);
+	  } else if (reader_algo == 10){
+		if (comm.rank() == 0) printf("streaming %s via mpiio, chunk %lu bytes\n", filename.c_str(), chunk_bytes);
+		idx.build_mpiio<PARSER_TYPE, bliss::io::SequencesIterator>(filename, comm, chunk_bytes, nthreads);
+	  } else {
+		throw std::invalid_argument("missing file reader type");
+	  }
+	  BL_BENCH_COLLECTIVE_END(test, "build_chunked", idx.local_size(), comm);
+
+	  size_t total = idx.size();
+	  if (comm.rank() == 0) printf("total size after streaming insert is %lu\n", total);
+
+  } else {
 	  ::std::vector<typename IndexType::KmerParserType::value_type> temp;
 
 	  BL_BENCH_START(test);
@@ -509,17 +635,24 @@ int main(int argc, char** argv) {
 //		idx.read_file<PARSER_TYPE, typename IndexType::KmerParserType>(filename, temp, comm);
 //
 //	  } else
+#if defined(USE_ZLIB)
+	  if (reader_algo == 4) {
+		if (comm.rank() == 0) printf("reading %s via gzip\n", filename.c_str());
+		::bliss::io::KmerFileHelper::read_file_gzip<typename IndexType::KmerParserType, PARSER_TYPE, bliss::io::SequencesIterator>(filename, temp, comm, nthreads);
+
+	  } else
+#endif
 	  if (reader_algo == 5) {
 		if (comm.rank() == 0) printf("reading %s via mmap\n", filename.c_str());
-		::bliss::io::KmerFileHelper::read_file_mmap<typename IndexType::KmerParserType, PARSER_TYPE, bliss::io::SequencesIterator>(filename, temp, comm);
+		::bliss::io::KmerFileHelper::read_file_mmap<typename IndexType::KmerParserType, PARSER_TYPE, bliss::io::SequencesIterator>(filename, temp, comm, nthreads);
 
 	  } else if (reader_algo == 7) {
 		if (comm.rank() == 0) printf("reading %s via posix\n", filename.c_str());
-		::bliss::io::KmerFileHelper::read_file_posix<typename IndexType::KmerParserType, PARSER_TYPE, bliss::io::SequencesIterator>(filename, temp, comm);
+		::bliss::io::KmerFileHelper::read_file_posix<typename IndexType::KmerParserType, PARSER_TYPE, bliss::io::SequencesIterator>(filename, temp, comm, nthreads);
 
 	  } else if (reader_algo == 10){
 		if (comm.rank() == 0) printf("reading %s via mpiio\n", filename.c_str());
-		::bliss::io::KmerFileHelper::read_file_mpiio<typename IndexType::KmerParserType, PARSER_TYPE, bliss::io::SequencesIterator>(filename, temp, comm);
+		::bliss::io::KmerFileHelper::read_file_mpiio<typename IndexType::KmerParserType, PARSER_TYPE, bliss::io::SequencesIterator>(filename, temp, comm, nthreads);
 	  } else {
 		throw std::invalid_argument("missing file reader type");
 	  }
@@ -534,6 +667,12 @@ int main(int argc, char** argv) {
 
     total = idx.size();
     if (comm.rank() == 0) printf("total size after insert/rehash is %lu\n", total);
+
+#if (pMAP == PREFIX)
+    BL_BENCH_START(test);
+    idx.get_map().freeze();
+    BL_BENCH_COLLECTIVE_END(test, "freeze", idx.local_size(), comm);
+#endif
   }
 
   {
@@ -550,6 +689,20 @@ int main(int argc, char** argv) {
 		  auto found = idx.find(lquery);
 		  BL_BENCH_COLLECTIVE_END(test, "find", found.size(), comm);
 	  }
+#if (pMAP == UNORDERED) || (pMAP == THREADED) || (pMAP == CSR) || (pMAP == SWISS)
+	  {
+		  // results are visited and dropped per source rank, not materialized.
+		  auto lquery = query;
+		  size_t found = 0;
+		  using ResultIter = IndexType::TupleType const *;
+		  auto visitor = [&found](int, ResultIter first, ResultIter last) {
+			  found += ::std::distance(first, last);
+		  };
+		  BL_BENCH_START(test);
+		  idx.find_stream(lquery, visitor);
+		  BL_BENCH_COLLECTIVE_END(test, "find_stream", found, comm);
+	  }
+#endif
 #if 0
 	  // separate test because of it being potentially very slow depending on imbalance.
 	  {
@@ -46,6 +46,11 @@
 
 
 #include "farmhash/src/farmhash.cc"
+#include "common/kmer.hpp"
+#include "common/alphabets.hpp"
+#include "common/kmer_transform.hpp"
+#include "containers/fsc_container_utils.hpp"  // fsc::sort, radix sort for kmers.
+#include "containers/fsc_sorted_index.hpp"  // eytzinger index for frozen sorted maps.
 #include <vector>
 #include <unordered_map>
 #include <algorithm>  // sort, equal_range,
@@ -191,6 +196,102 @@ void batched_query(const std::vector<std::pair<K, V> > &vec, const size_t entrie
 
 
 
+/// random kmers, with value set to index.
+template <typename K, typename V>
+void insert_kmers(std::vector<std::pair<K, V> > &vec, const size_t entries, unsigned int rand_seed = 1) {
+
+  srand(rand_seed);
+  K kmer;
+  for (size_t i = 0; i < entries; ++i) {
+    for (size_t j = 0; j < 4; ++j) kmer.nextFromChar(rand() % K::KmerAlphabet::SIZE);
+    vec.emplace_back(kmer, i);
+  }
+}
+
+/// compare std::sort against the kmer radix sort, with identity and lex_less (canonical) key transforms.
+template <typename K, typename V, template <typename> class Trans>
+void compare_kmer_sort(const size_t size, const char * name) {
+  using Less = ::fsc::TransformedComparator<K, ::std::less, Trans>;
+
+  TIMER_INIT(ksort);
+
+  std::vector<std::pair<K, V> > input;
+  input.reserve(size);
+  insert_kmers(input, size);
+
+  std::vector<std::pair<K, V> > container(input);
+  TIMER_START(ksort);
+  std::sort(container.begin(), container.end(), Less());
+  TIMER_END(ksort);
+  printf("%ld kmer %s std::sort duration %f\n", size, name, ksort_time_span.count());
+
+  container.assign(input.begin(), input.end());
+  TIMER_START(ksort);
+  ::fsc::radix_sort(container.begin(), container.end(), Less(), 1);
+  TIMER_END(ksort);
+  printf("%ld kmer %s radix sort 1 thread duration %f\n", size, name, ksort_time_span.count());
+
+  container.assign(input.begin(), input.end());
+  TIMER_START(ksort);
+  ::fsc::radix_sort(container.begin(), container.end(), Less());
+  TIMER_END(ksort);
+  printf("%ld kmer %s radix sort all threads duration %f\n", size, name, ksort_time_span.count());
+}
+
+/// compare binary search in a sorted kmer vector against batched lookup in the frozen (eytzinger and prefix) indices.
+template <typename K, typename V, template <typename> class Trans>
+void compare_kmer_search(const size_t size, const char * name) {
+  using Less = ::fsc::TransformedComparator<K, ::std::less, Trans>;
+
+  TIMER_INIT(ksearch);
+
+  std::vector<std::pair<K, V> > container;
+  container.reserve(size);
+  insert_kmers(container, size);
+  ::fsc::sort(container.begin(), container.end(), Less());
+
+  // half present, half random.
+  std::vector<std::pair<K, V> > queries;
+  queries.reserve(size);
+  insert_kmers(queries, size / 2, 1234);
+  for (size_t i = 0; i < size / 2; ++i) queries.emplace_back(container[(i * 7919) % size]);
+  std::random_shuffle(queries.begin(), queries.end());
+
+  std::vector<size_t> gold(queries.size());
+  TIMER_START(ksearch);
+  for (size_t i = 0; i < queries.size(); ++i)
+    gold[i] = std::distance(container.begin(), std::lower_bound(container.begin(), container.end(), queries[i], Less()));
+  TIMER_END(ksearch);
+  printf("%ld kmer %s lower_bound duration %f\n", size, name, ksearch_time_span.count());
+
+  ::fsc::eytzinger_index<K, ::std::less<K>, Trans<K> > index;
+  TIMER_START(ksearch);
+  index.build(container.begin(), container.end());
+  TIMER_END(ksearch);
+  printf("%ld kmer %s eytzinger build duration %f, %ld bytes\n", size, name, ksearch_time_span.count(), index.memory());
+
+  std::vector<size_t> pos(queries.size());
+  TIMER_START(ksearch);
+  index.lower_bound(container.begin(), queries.begin(), queries.size(), pos.data());
+  TIMER_END(ksearch);
+  printf("%ld kmer %s eytzinger batch lower_bound duration %f, %s\n", size, name, ksearch_time_span.count(),
+         (gold == pos) ? "same" : "DIFFERENT");
+
+  ::fsc::prefix_index<K, ::std::less<K>, Trans<K> > prefix;
+  TIMER_START(ksearch);
+  prefix.build(container.begin(), container.end());
+  TIMER_END(ksearch);
+  printf("%ld kmer %s prefix build duration %f, %ld bytes\n", size, name, ksearch_time_span.count(), prefix.memory());
+
+  TIMER_START(ksearch);
+  prefix.lower_bound(container.begin(), queries.begin(), queries.size(), pos.data());
+  TIMER_END(ksearch);
+  printf("%ld kmer %s prefix batch lower_bound duration %f, %s\n", size, name, ksearch_time_span.count(),
+         (gold == pos) ? "same" : "DIFFERENT");
+}
+
+
+
 int main(int argc, char** argv) {
   using KeyType = uint64_t;
   using ValType = int64_t;
@@ -322,6 +423,20 @@ int main(int argc, char** argv) {
 
     }  // clear the memory.
 
+    //============ kmer sort:  comparison vs radix
+    {
+      using KmerType = ::bliss::common::Kmer<31, ::bliss::common::DNA, uint64_t>;
+      compare_kmer_sort<KmerType, uint32_t, ::bliss::transform::identity>(size, "identity");
+      compare_kmer_sort<KmerType, uint32_t, ::bliss::kmer::transform::lex_less>(size, "lex_less");
+    }
+
+    //============ kmer search:  binary search vs frozen index
+    {
+      using KmerType = ::bliss::common::Kmer<31, ::bliss::common::DNA, uint64_t>;
+      compare_kmer_search<KmerType, uint32_t, ::bliss::transform::identity>(size, "identity");
+      compare_kmer_search<KmerType, uint32_t, ::bliss::kmer::transform::lex_less>(size, "lex_less");
+    }
+
 
     //============ report timing
 